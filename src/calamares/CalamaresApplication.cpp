@@ -65,6 +65,10 @@ CalamaresApplication::CalamaresApplication( int& argc, char* argv[] )
 void
 CalamaresApplication::init()
 {
+    if ( Calamares::Settings::instance() )
+    {
+        Logger::setupLogRotation( Calamares::Settings::instance()->logRotation() );
+    }
     Logger::setupLogfile();
     cDebug() << "Calamares version:" << CALAMARES_VERSION;
     cDebug() << Logger::SubEntry
@@ -93,8 +97,8 @@ CalamaresApplication::init()
 
 CalamaresApplication::~CalamaresApplication()
 {
-    Logger::CDebug( Logger::LOGVERBOSE ) << "Shutting down Calamares...";
-    Logger::CDebug( Logger::LOGVERBOSE ) << Logger::SubEntry << "Finished shutdown.";
+    cVerbose() << "Shutting down Calamares...";
+    cVerbose() << Logger::SubEntry << "Finished shutdown.";
 }
 
 
@@ -297,4 +301,11 @@ CalamaresApplication::initJobQueue()
     Calamares::JobQueue* jobQueue = new Calamares::JobQueue( this );
     new CalamaresUtils::System( Calamares::Settings::instance()->doChroot(), this );
     Calamares::Branding::instance()->setGlobals( jobQueue->globalStorage() );
+
+    const QString checkpointFile = Calamares::Settings::instance()->checkpointFile();
+    if ( m_resume && checkpointFile.isEmpty() )
+    {
+        cWarning() << "Cannot resume, settings.conf has no checkpoint-file.";
+    }
+    jobQueue->setCheckpoint( checkpointFile, m_resume );
 }
@@ -40,6 +40,13 @@ public:
     void init();
     static CalamaresApplication* instance();
 
+    /** @brief Resume a failed installation from the checkpoint journal
+     *
+     * Call this before init(); it has no effect unless settings.conf
+     * sets *checkpoint-file*.
+     */
+    void setResume( bool resume ) { m_resume = resume; }
+
     /**
      * @brief mainWindow returns the Calamares application main window.
      */
@@ -59,6 +66,7 @@ private:
 
     CalamaresWindow* m_mainwindow;
     Calamares::ModuleManager* m_moduleManager;
+    bool m_resume = false;
 };
 
 #endif  // CALAMARESAPPLICATION_H
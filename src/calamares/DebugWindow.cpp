@@ -84,11 +84,29 @@ DebugWindow::DebugWindow()
     m_ui->globalStorageView->setModel( m_globals_model.get() );
     m_ui->globalStorageView->expandAll();
 
-    // Do above when the GS changes, too
-    connect( gs, &GlobalStorage::changed, this, [=] {
-        m_globals = JobQueue::instance()->globalStorage()->data();
-        m_globals_model->reload();
-        m_ui->globalStorageView->expandAll();
+    // Do above when the GS changes, too, but only for the key that changed
+    connect( gs, &GlobalStorage::keyChanged, this, [=]( const QString& key ) {
+        QVariantMap globals = m_globals.toMap();
+        m_globals.clear();  // So that globals is not shared, and does not need a copy
+        if ( gs->contains( key ) )
+        {
+            globals.insert( key, gs->value( key ) );
+        }
+        else
+        {
+            globals.remove( key );
+        }
+        m_globals = globals;
+        m_globals_model->reloadKey( key );
+        const QModelIndex keyIndex = m_globals_model->indexForKey( key );
+        if ( keyIndex.isValid() )
+        {
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 13, 0 )
+            m_ui->globalStorageView->expandRecursively( keyIndex );
+#else
+            m_ui->globalStorageView->expandAll();
+#endif
+        }
     } );
 
     // JobQueue page
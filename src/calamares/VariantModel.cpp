@@ -9,55 +9,59 @@
 
 #include "VariantModel.h"
 
-static void
-overallLength( const QVariant& item, quintptr& c, quintptr parent, VariantModel::IndexVector* skiplist )
+#include <algorithm>
+
+std::unique_ptr< VariantModel::Node >
+VariantModel::makeNode( Node* parent, int row, const QVariant& key, const QVariant& value )
 {
-    if ( skiplist )
-    {
-        skiplist->append( parent );
-    }
+    auto n = std::make_unique< Node >();
+    n->parent = parent;
+    n->row = row;
+    n->key = key;
+    n->value = value;
+    return n;
+}
 
-    parent = c++;
-    if ( item.canConvert< QVariantList >() )
+void
+VariantModel::build( Node* n )
+{
+    n->children.clear();
+    if ( n->value.canConvert< QVariantList >() )
     {
-        for ( const auto& subitem : item.toList() )
+        const auto list = n->value.toList();
+        n->children.reserve( static_cast< size_t >( list.count() ) );
+        int row = 0;
+        for ( const auto& subitem : list )
         {
-            overallLength( subitem, c, parent, skiplist );
+            n->children.push_back( makeNode( n, row, row, subitem ) );
+            row++;
         }
     }
-    else if ( item.canConvert< QVariantMap >() )
+    else if ( n->value.canConvert< QVariantMap >() )
     {
-        for ( const auto& subitem : item.toMap() )
+        const auto map = n->value.toMap();
+        n->children.reserve( static_cast< size_t >( map.count() ) );
+        int row = 0;
+        for ( auto it = map.constBegin(); it != map.constEnd(); ++it )
         {
-            overallLength( subitem, c, parent, skiplist );
+            n->children.push_back( makeNode( n, row, it.key(), it.value() ) );
+            row++;
         }
     }
-}
-
-static quintptr
-findNth( const VariantModel::IndexVector& skiplist, quintptr value, int n )
-{
-    constexpr const quintptr invalid_index = static_cast< quintptr >( -1 );
 
-    if ( n < 0 )
+    for ( auto& child : n->children )
     {
-        return invalid_index;
+        build( child.get() );
     }
+}
 
-    int index = static_cast< int >( value );
-    while ( ( n >= 0 ) && ( index < skiplist.count() ) )
+void
+VariantModel::renumber( Node* n, int first )
+{
+    for ( int row = first; row < static_cast< int >( n->children.size() ); ++row )
     {
-        if ( skiplist[ index ] == value )
-        {
-            if ( --n < 0 )
-            {
-                // It's bigger than 0
-                return static_cast< quintptr >( index );
-            }
-        }
-        index++;
+        n->children[ static_cast< size_t >( row ) ]->row = row;
     }
-    return invalid_index;
 }
 
 
@@ -72,81 +76,163 @@ VariantModel::~VariantModel() {}
 void
 VariantModel::reload()
 {
-    constexpr const quintptr invalid_index = static_cast< quintptr >( -1 );
+    beginResetModel();
+    m_root = makeNode( nullptr, 0, QVariant(), *m_p );
+    build( m_root.get() );
+    endResetModel();
+}
 
-    quintptr x = 0;
-    m_rows.clear();  // Start over
-    if ( m_rows.capacity() < 64 )
+void
+VariantModel::reloadKey( const QString& key )
+{
+    if ( !m_root || !m_p->canConvert< QVariantMap >() || !m_root->value.canConvert< QVariantMap >() )
     {
-        m_rows.reserve( 64 );  // Start reasonably-sized
+        reload();
+        return;
     }
-    overallLength( *m_p, x, invalid_index, &m_rows );
-}
 
-int
-VariantModel::columnCount( const QModelIndex& ) const
-{
-    return 2;
+    const auto map = m_p->toMap();
+    m_root->value = *m_p;
+
+    auto& children = m_root->children;
+    const int row = keyRow( key );
+    auto it = children.begin() + row;
+    const bool exists = it != children.end() && ( *it )->key.toString() == key;
+    const auto value = map.constFind( key );
+
+    if ( value == map.constEnd() )
+    {
+        if ( exists )
+        {
+            beginRemoveRows( QModelIndex(), row, row );
+            children.erase( it );
+            renumber( m_root.get(), row );
+            endRemoveRows();
+        }
+        return;
+    }
+
+    if ( !exists )
+    {
+        auto n = makeNode( m_root.get(), row, key, value.value() );
+        build( n.get() );
+        beginInsertRows( QModelIndex(), row, row );
+        children.insert( it, std::move( n ) );
+        renumber( m_root.get(), row );
+        endInsertRows();
+        return;
+    }
+
+    // Replace the subtree of an existing key, leaving the key's row in place
+    Node* n = it->get();
+    const QModelIndex parentIndex = createIndex( row, 0, n );
+    if ( !n->children.empty() )
+    {
+        beginRemoveRows( parentIndex, 0, static_cast< int >( n->children.size() ) - 1 );
+        n->children.clear();
+        endRemoveRows();
+    }
+
+    auto replacement = makeNode( m_root.get(), row, key, value.value() );
+    build( replacement.get() );
+    n->value = replacement->value;
+    if ( !replacement->children.empty() )
+    {
+        beginInsertRows( parentIndex, 0, static_cast< int >( replacement->children.size() ) - 1 );
+        n->children = std::move( replacement->children );
+        for ( auto& child : n->children )
+        {
+            child->parent = n;
+        }
+        endInsertRows();
+    }
+    emit dataChanged( parentIndex, createIndex( row, 1, n ) );
 }
 
 int
-VariantModel::rowCount( const QModelIndex& index ) const
+VariantModel::keyRow( const QString& key ) const
 {
-    quintptr p = index.isValid() ? index.internalId() : 0;
-    return m_rows.count( p );
+    // The children of a map are sorted by key, like the map itself
+    const auto& children = m_root->children;
+    auto it = std::lower_bound(
+        children.cbegin(), children.cend(), key, []( const std::unique_ptr< Node >& n, const QString& k ) {
+            return n->key.toString() < k;
+        } );
+    return static_cast< int >( it - children.cbegin() );
 }
 
 QModelIndex
-VariantModel::index( int row, int column, const QModelIndex& parent ) const
+VariantModel::indexForKey( const QString& key ) const
 {
-    quintptr p = 0;
+    if ( !m_root || !m_root->value.canConvert< QVariantMap >() )
+    {
+        return QModelIndex();
+    }
 
-    if ( parent.isValid() )
+    const int row = keyRow( key );
+    if ( row < static_cast< int >( m_root->children.size() )
+         && m_root->children[ static_cast< size_t >( row ) ]->key.toString() == key )
     {
-        if ( inRange( parent ) )
-        {
-            p = parent.internalId();
-        }
+        return createIndex( row, 0, m_root->children[ static_cast< size_t >( row ) ].get() );
     }
+    return QModelIndex();
+}
 
-    return createIndex( row, column, findNth( m_rows, p, row ) );
+VariantModel::Node*
+VariantModel::node( const QModelIndex& index ) const
+{
+    if ( !index.isValid() )
+    {
+        return m_root.get();
+    }
+    return static_cast< Node* >( index.internalPointer() );
 }
 
-static inline quintptr
-deref( const VariantModel::IndexVector& v, quintptr i )
+int
+VariantModel::columnCount( const QModelIndex& ) const
 {
-    return v[ static_cast< int >( i ) ];
+    return 2;
 }
 
-QModelIndex
-VariantModel::parent( const QModelIndex& index ) const
+int
+VariantModel::rowCount( const QModelIndex& index ) const
 {
-    if ( !index.isValid() || !inRange( index ) )
+    // Only the first column has children
+    if ( index.isValid() && index.column() != 0 )
     {
-        return QModelIndex();
+        return 0;
     }
+    const Node* n = node( index );
+    return n ? static_cast< int >( n->children.size() ) : 0;
+}
 
-    quintptr p = deref( m_rows, index.internalId() );
-    if ( p == 0 )
+QModelIndex
+VariantModel::index( int row, int column, const QModelIndex& parent ) const
+{
+    const Node* p = node( parent );
+    if ( !p || row < 0 || row >= static_cast< int >( p->children.size() ) || column < 0 || column > 1 )
     {
         return QModelIndex();
     }
 
-    if ( !inRange( p ) )
+    return createIndex( row, column, p->children[ static_cast< size_t >( row ) ].get() );
+}
+
+QModelIndex
+VariantModel::parent( const QModelIndex& index ) const
+{
+    if ( !index.isValid() )
     {
         return QModelIndex();
     }
-    quintptr p_pid = deref( m_rows, p );
-    int row = 0;
-    for ( int i = static_cast< int >( p_pid ); i < static_cast< int >( p ); ++i )
+
+    Node* p = node( index )->parent;
+    if ( !p || p == m_root.get() )
     {
-        if ( m_rows[ i ] == p_pid )
-        {
-            row++;
-        }
+        return QModelIndex();
     }
 
-    return createIndex( row, index.column(), p );
+    return createIndex( p->row, 0, p );
 }
 
 QVariant
@@ -167,54 +253,8 @@ VariantModel::data( const QModelIndex& index, int role ) const
         return QVariant();
     }
 
-    if ( !inRange( index ) )
-    {
-        return QVariant();
-    }
-
-    const QVariant thing = underlying( parent( index ) );
-
-    if ( !thing.isValid() )
-    {
-        return QVariant();
-    }
-
-    if ( thing.canConvert< QVariantMap >() )
-    {
-        QVariantMap the_map = thing.toMap();
-        const auto key = the_map.keys().at( index.row() );
-        if ( index.column() == 0 )
-        {
-            return key;
-        }
-        else
-        {
-            return the_map[ key ];
-        }
-    }
-    else if ( thing.canConvert< QVariantList >() )
-    {
-        if ( index.column() == 0 )
-        {
-            return index.row();
-        }
-        else
-        {
-            QVariantList the_list = thing.toList();
-            return the_list.at( index.row() );
-        }
-    }
-    else
-    {
-        if ( index.column() == 0 )
-        {
-            return QVariant();
-        }
-        else
-        {
-            return thing;
-        }
-    }
+    const Node* n = node( index );
+    return index.column() == 0 ? n->key : n->value;
 }
 
 QVariant
@@ -245,27 +285,3 @@ VariantModel::headerData( int section, Qt::Orientation orientation, int role ) c
         return QVariant();
     }
 }
-
-const QVariant
-VariantModel::underlying( const QModelIndex& index ) const
-{
-    if ( !index.isValid() )
-    {
-        return *m_p;
-    }
-
-    const auto& thing = underlying( parent( index ) );
-    if ( thing.canConvert< QVariantMap >() )
-    {
-        const auto& the_map = thing.toMap();
-        return the_map[ the_map.keys()[ index.row() ] ];
-    }
-    else if ( thing.canConvert< QVariantList >() )
-    {
-        return thing.toList()[ index.row() ];
-    }
-    else
-    {
-        return thing;
-    }
-}
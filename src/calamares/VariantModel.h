@@ -12,7 +12,9 @@
 
 #include <QAbstractItemModel>
 #include <QVariantMap>
-#include <QVector>
+
+#include <memory>
+#include <vector>
 
 /** @brief A model that operates directly on a QVariant
  *
@@ -26,19 +28,12 @@
  * Take care of object lifetimes and that the underlying
  * QVariant does not change during use. If the QVariant
  * **does** change, call reload() to re-build the internal
- * representation of the tree.
+ * representation of the tree, or reloadKey() if only one
+ * key of a QVariantMap has changed.
  */
 class VariantModel : public QAbstractItemModel
 {
 public:
-    /** @brief Auxiliary data
-     *
-     * The nodes of the tree are enumerated into a vector
-     * (of length equal to the number of nodes in the tree + 1)
-     * which are used to do index and parent calculations.
-     */
-    using IndexVector = QVector< quintptr >;
-
     /** @brief Constructor
      *
      * The QVariant's lifetime is **not** affected by the model,
@@ -56,6 +51,23 @@ public:
      */
     void reload();
 
+    /** @brief Re-build the part of the tree for one @p key
+     *
+     * Call this when the underlying variant is a QVariantMap and
+     * only the value for @p key has changed, or @p key has been
+     * added or removed. Only the rows for that key are replaced,
+     * so views keep their state for the rest of the tree. If the
+     * variant is not a map, this is the same as reload().
+     */
+    void reloadKey( const QString& key );
+
+    /** @brief The index of the row for @p key
+     *
+     * Returns an invalid index if the variant is not a QVariantMap,
+     * or does not contain @p key.
+     */
+    QModelIndex indexForKey( const QString& key ) const;
+
     int columnCount( const QModelIndex& index ) const override;
     int rowCount( const QModelIndex& index ) const override;
 
@@ -65,39 +77,39 @@ public:
     QVariant headerData( int section, Qt::Orientation orientation, int role ) const override;
 
 private:
-    const QVariant* const m_p;
-
     /** @brief Tree representation of the variant.
      *
-     * At index 0 in the vector , we store -1 to indicate the root.
-     *
-     * Then we enumerate all the elements in the tree (by traversing
-     * the variant and using QVariantMap and QVariantList as having
-     * children, and everything else being a leaf node) and at the index
-     * for a child, store the index of its parent. This means that direct
-     * children of the root store a 0 in their indexes, children of the first
-     * child of the root store a 1, and we can "pointer chase" from an index
-     * through parents back to index 0.
-     *
-     * Because of this structure, the value stored at index i must be
-     * less than i (except for index 0, which is special). This makes it
-     * slightly easier to search for a given value *p*, because we can start
-     * at index *p* (or even *p+1*).
-     *
-     * Given an index *i* into the vector corresponding to a child, we know the
-     * parent, but can also count which row this child should have, by counting
-     * *other* indexes before *i* with the same parent (and by the ordering
-     * of values, we can start counting at index *parent-index*).
+     * Each element of the variant is a node, which knows its parent,
+     * its own row under that parent, and its children (for QVariantMap
+     * and QVariantList; everything else is a leaf node). A node keeps
+     * its key (the map key, or the list index) and a (shared) copy
+     * of its value, so that rowCount(), index(), parent() and data()
+     * do not need to search or walk the variant.
      *
+     * Model indexes point to the node as internal pointer. The root
+     * node corresponds to the whole variant and to the invalid index.
      */
-    IndexVector m_rows;
+    struct Node
+    {
+        Node* parent = nullptr;
+        int row = 0;
+        QVariant key;
+        QVariant value;
+        std::vector< std::unique_ptr< Node > > children;
+    };
 
-    /// @brief Implementation of walking an index through the variant-tree
-    const QVariant underlying( const QModelIndex& index ) const;
+    const QVariant* const m_p;
+    std::unique_ptr< Node > m_root;
 
-    /// @brief Helpers for range-checking
-    inline bool inRange( quintptr p ) const { return p < static_cast< quintptr >( m_rows.count() ); }
-    inline bool inRange( const QModelIndex& index ) const { return inRange( index.internalId() ); }
+    /// @brief The node for @p index (the root for an invalid index)
+    Node* node( const QModelIndex& index ) const;
+    static std::unique_ptr< Node > makeNode( Node* parent, int row, const QVariant& key, const QVariant& value );
+    /// @brief Row where @p key is (or would be inserted) among the children of the root
+    int keyRow( const QString& key ) const;
+    /// @brief Fills in the children of @p n from its value
+    static void build( Node* n );
+    /// @brief Re-numbers the children of @p n from @p first onwards
+    static void renumber( Node* n, int first );
 };
 
 #endif
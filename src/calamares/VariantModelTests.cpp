@@ -0,0 +1,151 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "VariantModel.h"
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 11, 0 )
+#include <QAbstractItemModelTester>
+#endif
+
+class VariantModelTests : public QObject
+{
+    Q_OBJECT
+public:
+    VariantModelTests() {}
+    ~VariantModelTests() override {}
+
+private Q_SLOTS:
+    void testReloadKey();
+};
+
+/// @brief Number of rows expected for @p v (in this test, only maps and lists have children)
+static int
+expectedRows( const QVariant& v )
+{
+    if ( v.type() == QVariant::Map )
+    {
+        return v.toMap().count();
+    }
+    if ( v.type() == QVariant::List )
+    {
+        return v.toList().count();
+    }
+    return 0;
+}
+
+/** @brief Checks that the model's top level matches @p map
+ *
+ * Every key in @p map must have a valid index from indexForKey(),
+ * in the (sorted) row the map has it, with the key and value as data
+ * and the right number of children. Each of @p missing must have
+ * an invalid index.
+ */
+static void
+checkKeys( const VariantModel& model, const QVariantMap& map, const QStringList& missing = QStringList() )
+{
+    QCOMPARE( model.rowCount( QModelIndex() ), map.count() );
+
+    int row = 0;
+    for ( auto it = map.constBegin(); it != map.constEnd(); ++it, ++row )
+    {
+        const QModelIndex index = model.indexForKey( it.key() );
+        QVERIFY( index.isValid() );
+        QCOMPARE( index.row(), row );
+        QCOMPARE( index.column(), 0 );
+        QCOMPARE( index, model.index( row, 0, QModelIndex() ) );
+        QCOMPARE( model.parent( index ), QModelIndex() );
+        QCOMPARE( model.data( index, Qt::DisplayRole ).toString(), it.key() );
+        QCOMPARE( model.data( index.sibling( row, 1 ), Qt::DisplayRole ), it.value() );
+        QCOMPARE( model.rowCount( index ), expectedRows( it.value() ) );
+    }
+
+    for ( const auto& key : missing )
+    {
+        QVERIFY( !model.indexForKey( key ).isValid() );
+    }
+}
+
+void
+VariantModelTests::testReloadKey()
+{
+    QVariantMap map { { "b", 2 }, { "d", QVariantList { 1, 2, 3 } } };
+    QVariant v( map );
+    VariantModel model( &v );
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 11, 0 )
+    // The tester checks the model's consistency on every signal the model emits
+    QAbstractItemModelTester tester( &model, QAbstractItemModelTester::FailureReportingMode::QtTest );
+#endif
+
+    checkKeys( model, map, { "a", "c" } );
+    QPersistentModelIndex dIndex( model.indexForKey( "d" ) );
+    QVERIFY( dIndex.isValid() );
+
+    // Add keys before, between and after the existing ones
+    for ( const QString& key : { QStringLiteral( "a" ), QStringLiteral( "c" ), QStringLiteral( "e" ) } )
+    {
+        map.insert( key, QVariantMap { { "x", key } } );
+        v = map;
+        model.reloadKey( key );
+        checkKeys( model, map );
+    }
+    // Rows for other keys move, but views keep pointing at the same key
+    QVERIFY( dIndex.isValid() );
+    QCOMPARE( QModelIndex( dIndex ), model.indexForKey( "d" ) );
+    QCOMPARE( dIndex.row(), 3 );
+
+    // Change values: leaf to map, list to shorter list, map to leaf
+    map.insert( "b", QVariantMap { { "y", 1 }, { "z", 2 } } );
+    map.insert( "d", QVariantList { 4 } );
+    map.insert( "e", 5 );
+    v = map;
+    for ( const QString& key : { QStringLiteral( "b" ), QStringLiteral( "d" ), QStringLiteral( "e" ) } )
+    {
+        model.reloadKey( key );
+    }
+    checkKeys( model, map );
+    QCOMPARE( QModelIndex( dIndex ), model.indexForKey( "d" ) );
+    QCOMPARE( model.data( model.index( 0, 1, model.indexForKey( "d" ) ), Qt::DisplayRole ).toInt(), 4 );
+
+    // Reloading an unchanged key, and removing a key that isn't there, are harmless
+    model.reloadKey( "c" );
+    model.reloadKey( "q" );
+    checkKeys( model, map, { "q" } );
+
+    // Remove keys from the front, middle and back
+    for ( const QString& key : { QStringLiteral( "a" ), QStringLiteral( "c" ), QStringLiteral( "e" ) } )
+    {
+        map.remove( key );
+        v = map;
+        model.reloadKey( key );
+        checkKeys( model, map, { key } );
+    }
+    QCOMPARE( QModelIndex( dIndex ), model.indexForKey( "d" ) );
+    QCOMPARE( dIndex.row(), 1 );
+
+    map.remove( "d" );
+    v = map;
+    model.reloadKey( "d" );
+    checkKeys( model, map, { "a", "c", "d", "e" } );
+    QVERIFY( !dIndex.isValid() );
+
+    // A variant that is not a map has no keys
+    v = QVariantList { 1, 2 };
+    model.reloadKey( "b" );
+    QCOMPARE( model.rowCount( QModelIndex() ), 2 );
+    QVERIFY( !model.indexForKey( "b" ).isValid() );
+}
+
+QTEST_GUILESS_MAIN( VariantModelTests )
+
+#include "utils/moc-warnings.h"
+
+#include "VariantModelTests.moc"
@@ -0,0 +1,86 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+/**
+ * This is a small tool that turns the structured log written by
+ * `calamares -L` (session.clog) back into text, like the session.log.
+ */
+
+#include "utils/LogRecord.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+
+#include <iostream>
+
+int
+main( int argc, char* argv[] )
+{
+    QCoreApplication a( argc, argv );
+
+    QCommandLineOption levelOption(
+        QStringLiteral( "D" ), "Show only messages up to this level (0-8), default all.", "level" );
+    QCommandLineOption contextOption( QStringList { "c", "context" },
+                                      "Show only messages logged while this job (e.g. unpackfs@unpackfs#0) ran.",
+                                      "context" );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Converts a Calamares structured log to text" );
+    parser.addHelpOption();
+    parser.addOption( levelOption );
+    parser.addOption( contextOption );
+    parser.addPositionalArgument( "file", "Structured log file (session.clog) to read." );
+    parser.process( a );
+
+    const QStringList files = parser.positionalArguments();
+    if ( files.count() != 1 )
+    {
+        parser.showHelp( 1 );
+    }
+
+    bool ok = true;
+    const unsigned int level = parser.isSet( levelOption ) ? parser.value( levelOption ).toUInt( &ok ) : ~0U;
+    if ( !ok )
+    {
+        std::cerr << "Invalid level " << qPrintable( parser.value( levelOption ) ) << '\n';
+        return 1;
+    }
+    const QString context = parser.value( contextOption );
+
+    QFile f( files.first() );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        std::cerr << "Could not open " << qPrintable( files.first() ) << '\n';
+        return 1;
+    }
+    const QByteArray data = f.readAll();
+    if ( !data.startsWith( Logger::structuredLogMagic ) )
+    {
+        std::cerr << qPrintable( files.first() ) << " is not a Calamares structured log.\n";
+        return 1;
+    }
+
+    int offset = Logger::structuredLogMagic.size();
+    Logger::Record r;
+    while ( Logger::decodeRecord( data, offset, r ) )
+    {
+        if ( r.level <= level && ( context.isEmpty() || r.context == context ) )
+        {
+            std::cout << Logger::toText( r ).toUtf8().constData() << '\n';
+        }
+    }
+    if ( offset != data.size() )
+    {
+        // For instance, Calamares crashed while writing
+        std::cerr << "The log is damaged after byte " << offset << ".\n";
+        return 1;
+    }
+    return 0;
+}
@@ -32,12 +32,12 @@
 #include <QDebug>
 #include <QDir>
 
-/** @brief Gets debug-level from -D command-line-option
+/** @brief Gets debug-level from -D (or -F) command-line-option
  *
  * If unset, use LOGERROR (corresponding to -D1), although
  * effectively -D2 is the lowest level you can set for
- * logging-to-the-console, and everything always gets
- * logged to the session file).
+ * logging-to-the-console. The session file gets every
+ * message, unless -F sets a lower level for it.
  */
 static unsigned int
 debug_level( QCommandLineParser& parser, QCommandLineOption& levelOption )
@@ -72,12 +72,18 @@ handle_args( CalamaresApplication& a )
                                     "Also look in current directory for configuration. Implies -D8." );
     QCommandLineOption debugLevelOption(
         QStringLiteral( "D" ), "Verbose output for debugging purposes (0-8).", "level" );
+    QCommandLineOption fileLevelOption(
+        QStringLiteral( "F" ), "Log level for the log file (0-8, default 8); messages up to -D are always logged.", "level" );
     QCommandLineOption debugTxOption( QStringList { "T", "debug-translation" },
                                       "Also look in the current directory for translation." );
 
     QCommandLineOption configOption(
         QStringList { "c", "config" }, "Configuration directory to use, for testing purposes.", "config" );
     QCommandLineOption xdgOption( QStringList { "X", "xdg-config" }, "Use XDG_{CONFIG,DATA}_DIRS as well." );
+    QCommandLineOption structuredLogOption( QStringList { "L", "structured-log" },
+                                            "Also write a structured log (read it with calamares-logreader)." );
+    QCommandLineOption resumeOption( QStringList { "r", "resume" },
+                                     "Resume a failed installation, skipping the jobs that completed." );
 
     QCommandLineParser parser;
     parser.setApplicationDescription( "Distribution-independent installer framework" );
@@ -86,13 +92,22 @@ handle_args( CalamaresApplication& a )
 
     parser.addOption( debugOption );
     parser.addOption( debugLevelOption );
+    parser.addOption( fileLevelOption );
     parser.addOption( configOption );
     parser.addOption( xdgOption );
     parser.addOption( debugTxOption );
+    parser.addOption( structuredLogOption );
+    parser.addOption( resumeOption );
 
     parser.process( a );
 
     Logger::setupLogLevel( parser.isSet( debugOption ) ? Logger::LOGVERBOSE : debug_level( parser, debugLevelOption ) );
+    if ( parser.isSet( fileLevelOption ) )
+    {
+        Logger::setupFileLogLevel( debug_level( parser, fileLevelOption ) );
+    }
+    Logger::setupStructuredLog( parser.isSet( structuredLogOption ) );
+    a.setResume( parser.isSet( resumeOption ) );
     if ( parser.isSet( configOption ) )
     {
         CalamaresUtils::setAppDataDir( QDir( parser.value( configOption ) ) );
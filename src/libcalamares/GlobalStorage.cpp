@@ -41,9 +41,22 @@ public:
         , m_gs( gs )
     {
     }
-    ~WriteLock() { m_gs->changed(); }
+    ~WriteLock()
+    {
+        // Unlock first, so that slots connected directly may read the store
+        unlock();
+        for ( const auto& key : qAsConst( m_keys ) )
+        {
+            emit m_gs->keyChanged( key );
+        }
+        emit m_gs->changed();
+    }
+
+    /// @brief Remember that @p key was modified, for keyChanged()
+    void touch( const QString& key ) { m_keys.append( key ); }
 
     GlobalStorage* m_gs;
+    QStringList m_keys;
 };
 
 GlobalStorage::GlobalStorage( QObject* parent )
@@ -73,6 +86,7 @@ GlobalStorage::insert( const QString& key, const QVariant& value )
 {
     WriteLock l( this );
     m.insert( key, value );
+    l.touch( key );
 }
 
 
@@ -89,6 +103,7 @@ GlobalStorage::remove( const QString& key )
 {
     WriteLock l( this );
     int nItems = m.remove( key );
+    l.touch( key );
     return nItems;
 }
 
@@ -155,6 +170,7 @@ GlobalStorage::loadJson( const QString& filename )
         for ( auto i = map.constBegin(); i != map.constEnd(); ++i )
         {
             m.insert( i.key(), *i );
+            l.touch( i.key() );
         }
         return true;
     }
@@ -182,6 +198,7 @@ GlobalStorage::loadYaml( const QString& filename )
         for ( auto i = map.constBegin(); i != map.constEnd(); ++i )
         {
             m.insert( i.key(), *i );
+            l.touch( i.key() );
         }
         return true;
     }
@@ -154,6 +154,14 @@ signals:
      * is already present.
      */
     void changed();
+    /** @brief Emitted for each @p key that is inserted or removed
+     *
+     * This is emitted (before changed()) for each key that is affected
+     * by a modification, including loading from a file. Use this
+     * to follow individual keys without re-reading the whole store.
+     * As with changed(), the key may not actually have a different value.
+     */
+    void keyChanged( const QString& key );
 
 private:
     class ReadLock;
@@ -109,4 +109,11 @@ Job::prettyStatusMessage() const
 }
 
 
+bool
+Job::isRerunSafe() const
+{
+    return false;
+}
+
+
 }  // namespace Calamares
@@ -126,6 +126,16 @@ public:
      */
     virtual QString prettyStatusMessage() const;
     virtual JobResult exec() = 0;
+    /** @brief Did exec() leave the work of the jobs after this one intact?
+     *
+     * When resuming from a checkpoint journal, completed jobs are skipped
+     * until a job runs that may undo their work (see JobQueue::Resume).
+     * This is asked after exec(): a job that changed nothing that later
+     * jobs depend on (e.g. it only recorded the same plan as before)
+     * returns @c true, so that the completed jobs after it are still
+     * skipped. The default implementation returns @c false.
+     */
+    virtual bool isRerunSafe() const;
 
     bool isEmergency() const { return m_emergency; }
     void setEmergency( bool e ) { m_emergency = e; }
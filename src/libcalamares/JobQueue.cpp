@@ -13,17 +13,35 @@
 #include "CalamaresConfig.h"
 #include "GlobalStorage.h"
 #include "Job.h"
+#include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
+#include "utils/Scheduling.h"
+#include "utils/Variant.h"
 
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QThread>
+#include <QTimer>
 
+#include <atomic>
 #include <memory>
+#include <numeric>
 
 namespace Calamares
 {
 
+/** @brief How often (in milliseconds) the UI is told about progress
+ *
+ * Jobs may report progress thousands of times per second (e.g. for
+ * each file they copy); the queue only passes on the latest report
+ * at this interval, which is about 30 times per second.
+ */
+static constexpr int progressInterval = 33;
+
 struct WeightedJob
 {
     /** @brief Cumulative weight **before** this job starts
@@ -42,9 +60,58 @@ struct WeightedJob
     qreal weight = 0.0;
 
     job_ptr job;
+    /// @brief Priorities for the job (usually from the module)
+    CalamaresUtils::SchedulingPolicy policy;
+    /// @brief Identifies the job in the checkpoint journal, e.g. "unpackfs@unpackfs#0"
+    QString checkpointId;
+    /// @brief What happens to the job when resuming
+    JobQueue::Resume resume = JobQueue::Resume::Rerun;
 };
 using WeightedJobList = QList< WeightedJob >;
 
+/** @brief Reads the checkpoint journal in @p path
+ *
+ * Returns the checkpoint ids of the jobs that completed (and did not
+ * fail when they ran again later) and sets @p globals to the
+ * GlobalStorage snapshot taken after the last completed job.
+ * Lines that cannot be read, like the last line after a crash,
+ * are skipped.
+ */
+static QStringList
+readCheckpoint( const QString& path, QVariantMap& globals )
+{
+    QStringList completed;
+    QFile f( path );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        cWarning() << "Could not read checkpoint journal" << path;
+        return completed;
+    }
+    while ( !f.atEnd() )
+    {
+        const QByteArray line = f.readLine().trimmed();
+        const QVariantMap entry = QJsonDocument::fromJson( line ).toVariant().toMap();
+        const QString id = entry.value( "job" ).toString();
+        if ( id.isEmpty() )
+        {
+            continue;
+        }
+        if ( entry.value( "ok" ).toBool() )
+        {
+            if ( !completed.contains( id ) )
+            {
+                completed.append( id );
+            }
+            globals = entry.value( "globalstorage" ).toMap();
+        }
+        else
+        {
+            completed.removeAll( id );
+        }
+    }
+    return completed;
+}
+
 class JobThread : public QThread
 {
 public:
@@ -70,17 +137,23 @@ public:
             m_overallQueueWeight = 1.0;
         }
 
-        cDebug() << "There are" << m_runningJobs->count() << "jobs, total weight" << m_overallQueueWeight;
-        int c = 0;
-        for ( const auto& j : *m_runningJobs )
-        {
-            cDebug() << Logger::SubEntry << "Job" << ( c + 1 ) << j.job->prettyName() << "+wt" << j.weight << "tot.wt"
-                     << ( j.cumulative + j.weight );
-            c++;
-        }
+        cDebug() << "There are" << m_runningJobs->count() << "jobs, total weight" << m_overallQueueWeight
+                 << Logger::Lazy( [ this ]( QDebug& s ) {
+                        int c = 0;
+                        for ( const auto& j : *m_runningJobs )
+                        {
+                            s << Logger::Continuation << "Job" << ( c + 1 ) << j.job->prettyName() << "+wt" << j.weight
+                              << "tot.wt" << ( j.cumulative + j.weight );
+                            c++;
+                        }
+                    } );
     }
 
-    void enqueue( int moduleWeight, const JobList& jobs )
+    void enqueue( int moduleWeight,
+                  const JobList& jobs,
+                  const CalamaresUtils::SchedulingPolicy& policy,
+                  const ModuleSystem::InstanceKey& key,
+                  JobQueue::Resume resume )
     {
         QMutexLocker qlock( &m_enqueMutex );
 
@@ -96,14 +169,30 @@ public:
             totalJobWeight = 1.0;
         }
 
+        int index = 0;
         for ( const auto& j : jobs )
         {
             qreal jobContribution = ( j->getJobWeight() / totalJobWeight ) * moduleWeight;
-            m_queuedJobs->append( WeightedJob { cumulative, jobContribution, j } );
+            const QString checkpointId
+                = key.isValid() ? key.toString() + QChar( '#' ) + QString::number( index ) : QString();
+            m_queuedJobs->append( WeightedJob { cumulative, jobContribution, j, policy, checkpointId, resume } );
             cumulative += jobContribution;
+            index++;
         }
     }
 
+    /** @brief Sets up the checkpoint journal for the next run
+     *
+     * Called in the GUI thread, before start(). The jobs with ids in
+     * @p completed may be skipped, see JobQueue::Resume.
+     */
+    void setCheckpoint( const QString& path, const QStringList& completed )
+    {
+        QMutexLocker rlock( &m_runMutex );
+        m_checkpointFile = path;
+        m_completedJobs = completed;
+    }
+
     void run() override
     {
         QMutexLocker rlock( &m_runMutex );
@@ -111,6 +200,13 @@ public:
         QString message;  ///< Filled in with errors
         QString details;
 
+        // To go back to after a job that changes the priorities
+        const auto baseline = CalamaresUtils::SchedulingPolicy::ofCurrentThread();
+        bool scheduled = false;
+
+        // Completed jobs are skipped until a job runs that may undo their work
+        bool resuming = !m_completedJobs.isEmpty();
+
         m_jobIndex = 0;
         for ( const auto& jobitem : *m_runningJobs )
         {
@@ -118,13 +214,36 @@ public:
             {
                 cDebug() << "Skipping non-emergency job" << jobitem.job->prettyName();
             }
+            else if ( resuming && jobitem.resume == JobQueue::Resume::Skip
+                      && m_completedJobs.contains( jobitem.checkpointId ) )
+            {
+                cDebug() << "Skipping completed job" << jobitem.job->prettyName() << jobitem.checkpointId;
+                emitProgress( 1.0 );
+                writeCheckpoint( jobitem, JobResult::ok() );
+            }
             else
             {
                 cDebug() << "Starting" << ( failureEncountered ? "EMERGENCY JOB" : "job" ) << jobitem.job->prettyName()
                          << '(' << ( m_jobIndex + 1 ) << '/' << m_runningJobs->count() << ')';
                 emitProgress( 0.0 );  // 0% for *this job*
+                if ( scheduled || !jobitem.policy.isEmpty() )
+                {
+                    baseline.applyToCurrentThread();
+                    jobitem.policy.applyToCurrentThread();
+                    CalamaresUtils::SchedulingPolicy::setCurrent( jobitem.policy );
+                    scheduled = !jobitem.policy.isEmpty();
+                }
                 connect( jobitem.job.data(), &Job::progress, this, &JobThread::emitProgress );
+                // Not the (translated) pretty name, so that the logs can be filtered by job
+                Logger::setContext( jobitem.checkpointId.isEmpty()
+                                        ? QString::fromLatin1( jobitem.job->metaObject()->className() )
+                                        : jobitem.checkpointId );
                 auto result = jobitem.job->exec();
+                Logger::setContext( QString() );
+                // A chroot helper would keep the target busy (e.g. for umount)
+                CalamaresUtils::System::stopChrootSession();
+                // .. and its cgroup, which can only be removed once it is empty
+                CalamaresUtils::SchedulingPolicy::removeCgroups();
                 if ( !failureEncountered && !result )
                 {
                     // so this is the first failure
@@ -132,6 +251,12 @@ public:
                     message = result.message();
                     details = result.details();
                 }
+                writeCheckpoint( jobitem, result );
+                if ( resuming && jobitem.resume != JobQueue::Resume::RerunSafely && !jobitem.job->isRerunSafe() )
+                {
+                    cDebug() << "Jobs after" << jobitem.checkpointId << "run again.";
+                    resuming = false;
+                }
                 QThread::msleep( 16 );  // Very brief rest before reporting the job as complete
                 emitProgress( 1.0 );  // 100% for *this job*
             }
@@ -140,12 +265,17 @@ public:
         if ( failureEncountered )
         {
             QMetaObject::invokeMethod(
-                m_queue, "failed", Qt::QueuedConnection, Q_ARG( QString, message ), Q_ARG( QString, details ) );
+                m_queue, "fail", Qt::QueuedConnection, Q_ARG( QString, message ), Q_ARG( QString, details ) );
         }
         else
         {
             emitProgress( 1.0 );
         }
+        if ( scheduled )
+        {
+            baseline.applyToCurrentThread();
+            CalamaresUtils::SchedulingPolicy::setCurrent( CalamaresUtils::SchedulingPolicy() );
+        }
         m_runningJobs->clear();
         QMetaObject::invokeMethod( m_queue, "finish", Qt::QueuedConnection );
     }
@@ -164,11 +294,65 @@ public:
         return l;
     }
 
+    /** @brief Gets the latest progress, if it changed since the last call
+     *
+     * This is called from the GUI thread. Returns @c true, and fills
+     * in @p progress and @p message, if the job thread has reported
+     * progress since the last call.
+     */
+    bool takeProgress( qreal& progress, QString& message )
+    {
+        if ( !m_progressChanged.exchange( false ) )
+        {
+            return false;
+        }
+        progress = m_progress.load();
+        QMutexLocker mlock( &m_messageMutex );
+        message = m_message;
+        return true;
+    }
+
 private:
+    /** @brief Appends a line for @p jobitem to the checkpoint journal
+     *
+     * Each line is a JSON object, so that a line lost in a crash
+     * does not make the rest of the journal unreadable. Secrets
+     * (e.g. LUKS passphrases) are left out of GlobalStorage.
+     */
+    void writeCheckpoint( const WeightedJob& jobitem, const JobResult& result ) const
+    {
+        if ( m_checkpointFile.isEmpty() || jobitem.checkpointId.isEmpty() )
+        {
+            return;
+        }
+
+        QVariantMap entry;
+        entry.insert( "job", jobitem.checkpointId );
+        entry.insert( "name", jobitem.job->prettyName() );
+        entry.insert( "ok", bool( result ) );
+        if ( !result )
+        {
+            entry.insert( "message", result.message() );
+        }
+        entry.insert( "globalstorage", CalamaresUtils::redactedMap( m_queue->globalStorage()->data() ) );
+
+        QFile f( m_checkpointFile );
+        if ( !f.open( QIODevice::WriteOnly | QIODevice::Append )
+             || !f.setPermissions( QFileDevice::ReadOwner | QFileDevice::WriteOwner )
+             || f.write( QJsonDocument::fromVariant( entry ).toJson( QJsonDocument::Compact ) + '\n' ) < 0 )
+        {
+            cWarning() << "Could not write checkpoint journal" << m_checkpointFile;
+        }
+    }
+
     /* This is called **only** from run(), while m_runMutex is
      * already locked, so we can use the m_runningJobs member safely.
+     *
+     * The progress is not sent to the queue directly: it is stored,
+     * and the queue picks up whatever is latest at progressInterval.
+     * The shared status message is only replaced when it changes.
      */
-    void emitProgress( qreal percentage ) const
+    void emitProgress( qreal percentage )
     {
         percentage = qBound( 0.0, percentage, 1.0 );
 
@@ -197,8 +381,14 @@ private:
             progress = 1.0;
             message = tr( "Done" );
         }
-        QMetaObject::invokeMethod(
-            m_queue, "progress", Qt::QueuedConnection, Q_ARG( qreal, progress ), Q_ARG( QString, message ) );
+        if ( message != m_lastMessage )
+        {
+            m_lastMessage = message;
+            QMutexLocker mlock( &m_messageMutex );
+            m_message = message;
+        }
+        m_progress.store( progress );
+        m_progressChanged.store( true );
     }
 
     mutable QMutex m_runMutex;
@@ -208,8 +398,19 @@ private:
     std::unique_ptr< WeightedJobList > m_queuedJobs = std::make_unique< WeightedJobList >();
 
     JobQueue* m_queue;
+    QString m_checkpointFile;  ///< Journal to write, empty for none
+    QStringList m_completedJobs;  ///< Checkpoint ids that completed in an earlier run
     int m_jobIndex = 0;  ///< Index into m_runningJobs
     qreal m_overallQueueWeight = 0.0;  ///< cumulation when **all** the jobs are done
+
+    // Used only in the job thread
+    QString m_lastMessage;  ///< Last status message, to avoid locking for an unchanged one
+
+    // Shared with the GUI thread, see takeProgress()
+    std::atomic< qreal > m_progress { 0.0 };
+    std::atomic< bool > m_progressChanged { false };
+    QMutex m_messageMutex;
+    QString m_message;
 };
 
 JobThread::~JobThread() {}
@@ -232,9 +433,13 @@ JobQueue::JobQueue( QObject* parent )
     : QObject( parent )
     , m_thread( new JobThread( this ) )
     , m_storage( new GlobalStorage( this ) )
+    , m_progressTimer( new QTimer( this ) )
 {
     Q_ASSERT( !s_instance );
     s_instance = this;
+
+    m_progressTimer->setInterval( progressInterval );
+    connect( m_progressTimer, &QTimer::timeout, this, &JobQueue::updateProgress );
 }
 
 
@@ -259,23 +464,99 @@ void
 JobQueue::start()
 {
     Q_ASSERT( !m_thread->isRunning() );
+
+    // With several exec sections, the journal is started only once
+    if ( !m_checkpointFile.isEmpty() && !m_checkpointStarted )
+    {
+        m_checkpointStarted = true;
+        if ( m_resume && QFile::exists( m_checkpointFile ) )
+        {
+            QVariantMap globals;
+            m_completedJobs = readCheckpoint( m_checkpointFile, globals );
+            cDebug() << "Resuming from checkpoint journal" << m_checkpointFile << "with" << m_completedJobs.count()
+                     << "completed jobs.";
+            // Answers given (again) in this session win over the journal
+            for ( auto it = globals.constBegin(); it != globals.constEnd(); ++it )
+            {
+                if ( m_storage->contains( it.key() ) )
+                {
+                    cDebug() << Logger::SubEntry << "Keeping" << it.key() << "from this session.";
+                }
+                else
+                {
+                    m_storage->insert( it.key(), it.value() );
+                }
+            }
+        }
+        else
+        {
+            QDir().mkpath( QFileInfo( m_checkpointFile ).absolutePath() );
+            QFile::remove( m_checkpointFile );
+        }
+    }
+    m_thread->setCheckpoint( m_checkpointFile, m_completedJobs );
+
     m_thread->finalize();
+    m_failed = false;
     m_finished = false;
     m_thread->start();
+    m_progressTimer->start();
 }
 
 
 void
-JobQueue::enqueue( int moduleWeight, const JobList& jobs )
+JobQueue::enqueue( int moduleWeight,
+                   const JobList& jobs,
+                   const CalamaresUtils::SchedulingPolicy& policy,
+                   const ModuleSystem::InstanceKey& key,
+                   Resume resume )
 {
     Q_ASSERT( !m_thread->isRunning() );
-    m_thread->enqueue( moduleWeight, jobs );
+    m_thread->enqueue( moduleWeight, jobs, policy, key, resume );
     emit queueChanged( m_thread->queuedJobs() );
 }
 
+void
+JobQueue::setCheckpoint( const QString& path, bool resume )
+{
+    Q_ASSERT( !m_thread->isRunning() );
+    m_checkpointFile = path;
+    m_resume = resume;
+    m_checkpointStarted = false;
+    m_completedJobs.clear();
+}
+
+void
+JobQueue::updateProgress()
+{
+    qreal percent = 0.0;
+    QString message;
+    if ( m_thread->takeProgress( percent, message ) )
+    {
+        emit progress( percent, message );
+    }
+}
+
+void
+JobQueue::fail( const QString& message, const QString& details )
+{
+    updateProgress();
+    m_failed = true;
+    emit failed( message, details );
+}
+
 void
 JobQueue::finish()
 {
+    m_progressTimer->stop();
+    updateProgress();
+    if ( !m_failed && !m_checkpointFile.isEmpty() && QFile::exists( m_checkpointFile ) )
+    {
+        // Nothing to resume; a later exec section starts a new journal
+        cDebug() << "Removing checkpoint journal" << m_checkpointFile;
+        QFile::remove( m_checkpointFile );
+        m_completedJobs.clear();
+    }
     m_finished = true;
     emit finished();
     emit queueChanged( m_thread->queuedJobs() );
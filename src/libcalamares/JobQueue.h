@@ -12,9 +12,13 @@
 
 #include "DllMacro.h"
 #include "Job.h"
+#include "modulesystem/InstanceKey.h"
+#include "utils/Scheduling.h"
 
 #include <QObject>
 
+class QTimer;
+
 namespace Calamares
 {
 class GlobalStorage;
@@ -31,12 +35,53 @@ public:
 
     GlobalStorage* globalStorage() const;
 
+    /** @brief What happens to the jobs of a module when resuming
+     *
+     * See setCheckpoint(). Jobs are skipped only while all the jobs
+     * before them were skipped or RerunSafely, so that e.g. unpackfs
+     * runs again after the partitioning has run again. A job of a
+     * module that is not RerunSafely can still say, after it ran, that
+     * it did not change anything (see Job::isRerunSafe()); e.g. the
+     * partition module does so when the partitioning plan is unchanged.
+     */
+    enum class Resume
+    {
+        Rerun,  ///< Run again, and the jobs after it run again too
+        RerunSafely,  ///< Run again, without undoing earlier jobs (e.g. mount)
+        Skip  ///< Skipped if it completed (e.g. unpackfs)
+    };
+
     /** @brief Queues up jobs from a single module source
      *
      * The total weight of the jobs is spread out to fill the weight
-     * of the module.
+     * of the module. The jobs run with the CPU and I/O priorities
+     * of @p policy, and so do the commands they start.
+     *
+     * The @p key of the module instance identifies the jobs in the
+     * checkpoint journal (see setCheckpoint()), and @p resume says
+     * what happens to them when resuming.
      */
-    void enqueue( int moduleWeight, const JobList& jobs );
+    void enqueue( int moduleWeight,
+                  const JobList& jobs,
+                  const CalamaresUtils::SchedulingPolicy& policy = CalamaresUtils::SchedulingPolicy(),
+                  const ModuleSystem::InstanceKey& key = ModuleSystem::InstanceKey(),
+                  Resume resume = Resume::Rerun );
+    /** @brief Keep a journal of the jobs that have run in @p path
+     *
+     * After each job, a line is appended to the journal with the
+     * instance key of the job, its result and a snapshot of
+     * GlobalStorage, without secrets (see CalamaresUtils::redactedMap()).
+     * Only the owner can read the journal. It is removed when the
+     * queue finishes without failure. An empty @p path turns the
+     * journal off.
+     *
+     * Normally, start() starts a new journal. If @p resume is @c true,
+     * the existing journal is continued instead: keys of GlobalStorage
+     * that are not set (again) in this session are restored from the
+     * last completed job, and completed jobs are skipped as described
+     * for Resume.
+     */
+    void setCheckpoint( const QString& path, bool resume );
     /** @brief Starts all the jobs that are enqueued.
      *
      * After this, isRunning() returns @c true until
@@ -53,6 +98,11 @@ signals:
      * overall queue progress (not of the current job), while
      * @p prettyName is the status message from the job -- often
      * just the name of the job, but some jobs include more information.
+     *
+     * While the queue runs, this is emitted at most about 30 times
+     * per second, with the latest progress of the jobs: intermediate
+     * reports are dropped. The final progress is always emitted, before
+     * finished() or failed().
      */
     void progress( qreal percent, const QString& prettyName );
     /** @brief Indicate that the queue is empty, after calling start()
@@ -84,12 +134,23 @@ public slots:
      * which should not be called by other core.
      */
     void finish();
+    /// @brief Implementation detail, like finish()
+    void fail( const QString& message, const QString& details );
 
 private:
+    /// @brief Emits progress() if the job thread reported any
+    void updateProgress();
+
     static JobQueue* s_instance;
 
     JobThread* m_thread;
     GlobalStorage* m_storage;
+    QTimer* m_progressTimer;
+    QString m_checkpointFile;
+    QStringList m_completedJobs;  ///< From the journal, when resuming
+    bool m_resume = false;
+    bool m_checkpointStarted = false;  ///< Journal has been read or created
+    bool m_failed = false;  ///< Since start()
     bool m_finished = true;  ///< Initially, not running
 };
 
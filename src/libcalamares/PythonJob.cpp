@@ -34,6 +34,10 @@ BOOST_PYTHON_FUNCTION_OVERLOADS( check_target_env_output_list_overloads,
                                  CalamaresPython::check_target_env_output,
                                  1,
                                  3 );
+BOOST_PYTHON_FUNCTION_OVERLOADS( check_target_env_progress_overloads,
+                                 CalamaresPython::check_target_env_progress,
+                                 3,
+                                 5 );
 BOOST_PYTHON_MODULE( libcalamares )
 {
     bp::object package = bp::scope();
@@ -135,6 +139,14 @@ BOOST_PYTHON_MODULE( libcalamares )
                                                      "Runs the specified command in the chroot of the target system.\n"
                                                      "Returns the program's standard output, and raises a "
                                                      "subprocess.CalledProcessError if something went wrong." ) );
+    bp::def( "check_target_env_progress",
+             &CalamaresPython::check_target_env_progress,
+             check_target_env_progress_overloads( bp::args( "args", "parser", "callback", "stdin", "timeout" ),
+                                                  "Runs the specified command in the chroot of the target system.\n"
+                                                  "The output is parsed as it arrives, with the named progress "
+                                                  "parser, and callback(progress, message) is called as the "
+                                                  "command progresses. Returns 0, or raises a "
+                                                  "subprocess.CalledProcessError." ) );
     bp::def( "obscure",
              &CalamaresPython::obscure,
              bp::args( "s" ),
@@ -142,7 +154,11 @@ BOOST_PYTHON_MODULE( libcalamares )
              "Returns a string, generated using a simple symmetric encryption.\n"
              "Applying the function to a string obscured by this function will result "
              "in the original string." );
-
+    bp::def( "bounded_worker_count",
+             &CalamaresPython::bounded_worker_count,
+             bp::args( "memory_per_worker" ),
+             "Returns how many commands to run at once: at most one per CPU, "
+             "and each gets memory_per_worker bytes of the available memory." );
 
     bp::def( "gettext_languages",
              &CalamaresPython::gettext_languages,
@@ -16,6 +16,7 @@
 #include "partition/Mount.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
+#include "utils/ProgressParser.h"
 #include "utils/String.h"
 
 #include <QCoreApplication>
@@ -73,9 +74,48 @@ _bp_list_to_qstringlist( const bp::list& args )
     return list;
 }
 
+/** @brief Releases the GIL for the lifetime of the object
+ *
+ * Running a command does not touch any Python objects, so other
+ * Python threads may run meanwhile; this lets a Python module run
+ * commands in the target in parallel from a thread pool.
+ */
+class GILRelease
+{
+public:
+    GILRelease()
+        : m_state( PyEval_SaveThread() )
+    {
+    }
+    ~GILRelease() { PyEval_RestoreThread( m_state ); }
+    GILRelease( const GILRelease& ) = delete;
+    GILRelease& operator=( const GILRelease& ) = delete;
+
+    /// @brief Holds the GIL again for its lifetime, e.g. to call back into Python
+    class Reacquire
+    {
+    public:
+        explicit Reacquire( GILRelease& r )
+            : m_release( r )
+        {
+            PyEval_RestoreThread( m_release.m_state );
+        }
+        ~Reacquire() { m_release.m_state = PyEval_SaveThread(); }
+        Reacquire( const Reacquire& ) = delete;
+        Reacquire& operator=( const Reacquire& ) = delete;
+
+    private:
+        GILRelease& m_release;
+    };
+
+private:
+    PyThreadState* m_state;
+};
+
 static inline CalamaresUtils::ProcessResult
 _target_env_command( const QStringList& args, const std::string& stdin, int timeout )
 {
+    GILRelease release;
     // Since Python doesn't give us the type system for distinguishing
     // seconds from other integral types, massage to seconds here.
     return CalamaresUtils::System::instance()->targetEnvCommand(
@@ -136,10 +176,61 @@ check_target_env_output( const bp::list& args, const std::string& stdin, int tim
     return ec.second.toStdString();
 }
 
+int
+check_target_env_progress( const bp::list& args,
+                           const std::string& parser,
+                           const bp::object& callback,
+                           const std::string& stdin,
+                           int timeout )
+{
+    const QStringList list = _bp_list_to_qstringlist( args );
+    auto progress = CalamaresUtils::ProgressParser::forBackend( QString::fromStdString( parser ) );
+    if ( !progress )
+    {
+        cWarning() << "No progress parser" << QString::fromStdString( parser ) << Logger::Continuation
+                   << "known parsers are" << CalamaresUtils::ProgressParser::backends();
+    }
+
+    using CalamaresUtils::System;
+    auto* system = System::instance();
+    const auto location = system->doChroot() ? System::RunLocation::RunInTarget : System::RunLocation::RunInHost;
+    CalamaresUtils::ProcessResult ec( CalamaresUtils::ProcessResult::Code::FailedToStart );
+    {
+        GILRelease release;
+        ec = System::runCommand(
+            location,
+            list,
+            QString(),
+            QString::fromStdString( stdin ),
+            std::chrono::seconds( timeout ),
+            [ & ]( const QString& line ) {
+                if ( progress && progress->parseLine( line ) )
+                {
+                    GILRelease::Reacquire python( release );
+                    try
+                    {
+                        callback( progress->progress(), progress->message().toStdString() );
+                    }
+                    catch ( bp::error_already_set& )
+                    {
+                        // A broken callback should not break the command
+                        cWarning() << "Progress callback for" << list.first() << "failed.";
+                        PyErr_Print();
+                    }
+                }
+            } );
+    }
+    return _handle_check_target_env_call_error( ec, list.join( ' ' ) );
+}
+
 void
 debug( const std::string& s )
 {
-    Logger::CDebug( Logger::LOGDEBUG ) << "[PYTHON JOB]: " << QString::fromStdString( s );
+    // Python jobs log a lot, so skip the conversion if it is not needed
+    if ( Logger::logLevelEnabled( Logger::LOGDEBUG ) )
+    {
+        Logger::CDebug( Logger::LOGDEBUG ) << "[PYTHON JOB]: " << QString::fromStdString( s );
+    }
 }
 
 void
@@ -175,6 +266,12 @@ obscure( const std::string& string )
     return CalamaresUtils::obscure( QString::fromStdString( string ) ).toStdString();
 }
 
+int
+bounded_worker_count( unsigned long long memoryPerWorker )
+{
+    return CalamaresUtils::System::instance()->boundedWorkerCount( memoryPerWorker );
+}
+
 static QStringList
 _gettext_languages()
 {
@@ -42,8 +42,24 @@ check_target_env_output( const std::string& command, const std::string& stdin =
 std::string
 check_target_env_output( const boost::python::list& args, const std::string& stdin = std::string(), int timeout = 0 );
 
+/** @brief Runs @p args in the target, reporting progress from its output
+ *
+ * The output is parsed with the ProgressParser for @p parser (a package
+ * manager backend name); when the progress or status changes, @p callback
+ * is called with the progress (0 to 1) and the status message. Raises
+ * subprocess.CalledProcessError like check_target_env_call() does.
+ */
+int check_target_env_progress( const boost::python::list& args,
+                               const std::string& parser,
+                               const boost::python::object& callback,
+                               const std::string& stdin = std::string(),
+                               int timeout = 0 );
+
 std::string obscure( const std::string& string );
 
+/// @brief See CalamaresUtils::System::boundedWorkerCount()
+int bounded_worker_count( unsigned long long memoryPerWorker );
+
 boost::python::object gettext_path();
 
 boost::python::list gettext_languages();
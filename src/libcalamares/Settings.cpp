@@ -16,6 +16,7 @@
 #include "CalamaresConfig.h"
 #include "utils/Dirs.h"
 #include "utils/Logger.h"
+#include "utils/Variant.h"
 #include "utils/Yaml.h"
 
 #include <QDir>
@@ -60,6 +61,22 @@ requireBool( const YAML::Node& config, const char* key, bool d )
     }
 }
 
+/** @brief Helper function to grab a bool out of the config, for keys that may be missing. */
+static bool
+optionalBool( const YAML::Node& config, const char* key, bool d )
+{
+    auto v = config[ key ];
+    return hasValue( v ) ? v.as< bool >() : d;
+}
+
+/** @brief Helper function to grab a QString out of the config, for keys that may be missing. */
+static QString
+optionalString( const YAML::Node& config, const char* key )
+{
+    auto v = config[ key ];
+    return hasValue( v ) ? QString::fromStdString( v.as< std::string >() ) : QString();
+}
+
 namespace Calamares
 {
 
@@ -174,6 +191,20 @@ interpretInstances( const YAML::Node& node, Settings::InstanceDescriptionList& c
     }
 }
 
+/// @brief Reads the *log-rotation* map; missing keys keep their defaults
+static Logger::Rotation
+interpretLogRotation( const QVariantMap& map )
+{
+    Logger::Rotation r;
+    if ( map.contains( "size-limit" ) )
+    {
+        r.sizeLimit = CalamaresUtils::getInteger( map, "size-limit", 0 ) * 1024;
+    }
+    r.generations = int( CalamaresUtils::getInteger( map, "generations", r.generations ) );
+    r.compress = CalamaresUtils::getBool( map, "compress", r.compress );
+    return r;
+}
+
 static void
 interpretSequence( const YAML::Node& node, Settings::ModuleSequence& moduleSequence )
 {
@@ -310,6 +341,11 @@ Settings::setConfiguration( const QByteArray& ba, const QString& explainName )
         m_disableCancelDuringExec = requireBool( config, "disable-cancel-during-exec", false );
         m_hideBackAndNextDuringExec = requireBool( config, "hide-back-and-next-during-exec", false );
         m_quitAtEnd = requireBool( config, "quit-at-end", false );
+        m_chrootHelper = optionalBool( config, "chroot-helper", false );
+        m_checkpointFile = optionalString( config, "checkpoint-file" );
+        const auto scheduling = CalamaresUtils::yamlToVariant( config[ "scheduling" ] ).toMap();
+        m_schedulingPolicy = CalamaresUtils::SchedulingPolicy::fromMap( scheduling );
+        m_logRotation = interpretLogRotation( CalamaresUtils::yamlToVariant( config[ "log-rotation" ] ).toMap() );
 
         reconcileInstancesAndSequence();
     }
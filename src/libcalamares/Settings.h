@@ -17,6 +17,8 @@
 #include "DllMacro.h"
 #include "modulesystem/Actions.h"
 #include "modulesystem/InstanceKey.h"
+#include "utils/Logger.h"
+#include "utils/Scheduling.h"
 
 #include <QObject>
 #include <QStringList>
@@ -162,6 +164,24 @@ public:
     /** @brief Is quit-at-end set? (Quit automatically when done) */
     bool quitAtEnd() const { return m_quitAtEnd; }
 
+    /** @brief Is chroot-helper set? (Run target commands in a persistent chroot) */
+    bool chrootHelper() const { return m_chrootHelper; }
+
+    /** @brief The scheduling policy for jobs (from *scheduling*)
+     *
+     * Modules may override parts of this in their module.desc.
+     */
+    CalamaresUtils::SchedulingPolicy schedulingPolicy() const { return m_schedulingPolicy; }
+
+    /** @brief How to rotate the log file (from *log-rotation*) */
+    Logger::Rotation logRotation() const { return m_logRotation; }
+
+    /** @brief Where to keep the journal of jobs (from *checkpoint-file*)
+     *
+     * Empty if there is no journal; see JobQueue::setCheckpoint().
+     */
+    QString checkpointFile() const { return m_checkpointFile; }
+
 private:
     static Settings* s_instance;
 
@@ -181,6 +201,11 @@ private:
     bool m_disableCancelDuringExec = false;
     bool m_hideBackAndNextDuringExec=false;
     bool m_quitAtEnd = false;
+    bool m_chrootHelper = false;
+
+    CalamaresUtils::SchedulingPolicy m_schedulingPolicy;
+    Logger::Rotation m_logRotation;
+    QString m_checkpointFile;
 };
 
 }  // namespace Calamares
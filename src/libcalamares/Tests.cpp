@@ -38,6 +38,8 @@ private Q_SLOTS:
     void testSettings();
 
     void testJobQueue();
+    void testJobQueueCoalesce();
+    void testJobQueueCheckpoint();
 };
 
 void
@@ -45,6 +47,7 @@ TestLibCalamares::testGSModify()
 {
     Calamares::GlobalStorage gs;
     QSignalSpy spy( &gs, &Calamares::GlobalStorage::changed );
+    QSignalSpy keySpy( &gs, &Calamares::GlobalStorage::keyChanged );
 
     const QString key( "derp" );
 
@@ -64,6 +67,9 @@ TestLibCalamares::testGSModify()
     QVERIFY( !gs.contains( key ) );
 
     QCOMPARE( spy.count(), 2 );  // one insert, one remove
+    QCOMPARE( keySpy.count(), 2 );
+    QCOMPARE( keySpy.at( 0 ).at( 0 ).toString(), key );
+    QCOMPARE( keySpy.at( 1 ).at( 0 ).toString(), key );
 }
 
 void
@@ -532,6 +538,7 @@ TestLibCalamares::testJobQueue()
         QCOMPARE( spy_finished.count(), 1 );
         QCOMPARE( spy_failed.count(), 0 );
         QCOMPARE( spy_progress.count(), 1 );  // just one, 100% at queue end
+        QCOMPARE( spy_progress.last().first().toReal(), 1.0 );
     }
 
     // Run a dummy queue
@@ -555,10 +562,16 @@ TestLibCalamares::testJobQueue()
         QCOMPARE( spy_failed.count(), 0 );
         // 0% by the queue at job start
         // 50% by the job itself
-        // 90% by the job itself
+        // 75% by the job itself
         // 100% by the queue at job end
         // 100% by the queue at queue end
-        QCOMPARE( spy_progress.count(), 5 );
+        //
+        // Reports that come in quickly after one another are merged,
+        // so at least 50% (right after 0%) and the end (after the
+        // sleep in the job) are seen.
+        QVERIFY( spy_progress.count() >= 2 );
+        QVERIFY( spy_progress.count() <= 5 );
+        QCOMPARE( spy_progress.last().first().toReal(), 1.0 );
     }
 
     {
@@ -585,12 +598,15 @@ TestLibCalamares::testJobQueue()
         QCOMPARE( spy_failed.count(), 0 );
         // 0% by the queue at job start
         // 50% by the job itself
-        // 90% by the job itself
+        // 75% by the job itself
         // 100% by the queue at job end
         // 4 more for the next job
         // 4 more for the next job
         // 100% by the queue at queue end
-        QCOMPARE( spy_progress.count(), 13 );
+        //
+        // Some of those are merged, but each job sleeps in between.
+        QVERIFY( spy_progress.count() >= 4 );
+        QVERIFY( spy_progress.count() <= 13 );
 
         /* Consider how progress will be reported:
          *
@@ -626,9 +642,260 @@ TestLibCalamares::testJobQueue()
             QVERIFY( progress >= overallProgress );  // Doesn't go backwards
             overallProgress = progress;
         }
+        QCOMPARE( overallProgress, 1.0 );
     }
 }
 
+/// @brief A job that reports progress very often
+class ChattyJob : public Calamares::Job
+{
+public:
+    static constexpr const int steps = 100000;
+
+    ChattyJob( QObject* parent )
+        : Calamares::Job( parent )
+    {
+    }
+    ~ChattyJob() override;
+
+    QString prettyName() const override;
+    QString prettyStatusMessage() const override;
+    Calamares::JobResult exec() override;
+
+private:
+    int m_step = 0;
+};
+
+ChattyJob::~ChattyJob() {}
+
+QString
+ChattyJob::prettyName() const
+{
+    return QString( "ChattyJob" );
+}
+
+QString
+ChattyJob::prettyStatusMessage() const
+{
+    // Changes only now and then, like a job that reports the file it is copying
+    return QString( "Step %1" ).arg( m_step / 1000 );
+}
+
+Calamares::JobResult
+ChattyJob::exec()
+{
+    for ( m_step = 0; m_step < steps; ++m_step )
+    {
+        progress( qreal( m_step ) / steps );
+        if ( m_step % 1000 == 0 )
+        {
+            QThread::msleep( 1 );
+        }
+    }
+    return Calamares::JobResult::ok();
+}
+
+void
+TestLibCalamares::testJobQueueCoalesce()
+{
+    Calamares::JobQueue q;
+    q.enqueue( 1, Calamares::JobList() << Calamares::job_ptr( new ChattyJob( this ) ) );
+    QSignalSpy spy_progress( &q, &Calamares::JobQueue::progress );
+    QSignalSpy spy_finished( &q, &Calamares::JobQueue::finished );
+
+    QEventLoop loop;
+    connect( &q, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+    QTimer::singleShot( MAX_TEST_DURATION, &loop, &QEventLoop::quit );
+    q.start();
+    loop.exec();
+    QCOMPARE( spy_finished.count(), 1 );
+
+    // The job reports many times, but the queue passes on only a few
+    QVERIFY( spy_progress.count() >= 1 );
+    QVERIFY( spy_progress.count() < ChattyJob::steps / 100 );
+    qreal overallProgress = 0.0;
+    for ( const auto& e : spy_progress )
+    {
+        const qreal progress = e.first().toReal();
+        QVERIFY( progress >= overallProgress );
+        overallProgress = progress;
+    }
+    QCOMPARE( overallProgress, 1.0 );
+    QCOMPARE( spy_progress.last().at( 1 ).toString(), QStringLiteral( "Done" ) );
+}
+
+
+/// @brief A job that counts how often it runs, and may fail
+class CountingJob : public Calamares::Job
+{
+public:
+    CountingJob( const QString& name, bool fail, QObject* parent )
+        : Calamares::Job( parent )
+        , m_name( name )
+        , m_fail( fail )
+    {
+    }
+    ~CountingJob() override;
+
+    QString prettyName() const override;
+    Calamares::JobResult exec() override;
+
+    int runs = 0;
+
+private:
+    QString m_name;
+    bool m_fail;
+};
+
+CountingJob::~CountingJob() {}
+
+QString
+CountingJob::prettyName() const
+{
+    return m_name;
+}
+
+Calamares::JobResult
+CountingJob::exec()
+{
+    runs++;
+    Calamares::JobQueue::instance()->globalStorage()->insert( m_name, runs );
+    return m_fail ? Calamares::JobResult::error( QStringLiteral( "Failed" ) ) : Calamares::JobResult::ok();
+}
+
+static int
+countLines( const QString& path )
+{
+    QFile f( path );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return -1;
+    }
+    return f.readAll().count( '\n' );
+}
+
+static void
+runQueue( Calamares::JobQueue& q )
+{
+    QEventLoop loop;
+    QObject::connect( &q, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+    QTimer::singleShot( MAX_TEST_DURATION, &loop, &QEventLoop::quit );
+    q.start();
+    loop.exec();
+    QVERIFY( !q.isRunning() );
+}
+
+void
+TestLibCalamares::testJobQueueCheckpoint()
+{
+    using Calamares::ModuleSystem::InstanceKey;
+    using Resume = Calamares::JobQueue::Resume;
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString journal = dir.filePath( "journal/checkpoint.jsonl" );
+
+    const InstanceKey partitionKey( "partition", "partition" );
+    const InstanceKey mountKey( "mount", "mount" );
+    const InstanceKey unpackKey( "unpackfs", "unpackfs" );
+    const InstanceKey bootKey( "bootloader", "bootloader" );
+    const QString secret( "secret" );
+
+    // A first run, which fails at the end
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( journal, false );
+        auto* partition = new CountingJob( "partition", false, this );
+        auto* mount = new CountingJob( "mount", false, this );
+        auto* unpack = new CountingJob( "unpack", false, this );
+        auto* boot = new CountingJob( "boot", true, this );
+        q.enqueue( 1, { Calamares::job_ptr( partition ) }, {}, partitionKey, Resume::Rerun );
+        q.enqueue( 1, { Calamares::job_ptr( mount ) }, {}, mountKey, Resume::RerunSafely );
+        q.enqueue( 1, { Calamares::job_ptr( unpack ) }, {}, unpackKey, Resume::Skip );
+        q.enqueue( 1, { Calamares::job_ptr( boot ) }, {}, bootKey, Resume::Rerun );
+
+        const QVariantMap luks { { "device", "/dev/sda2" }, { "luksPassphrase", secret } };
+        q.globalStorage()->insert( "partitions", QVariantList { luks } );
+        q.globalStorage()->insert( "username", "alice" );
+
+        QSignalSpy spy_failed( &q, &Calamares::JobQueue::failed );
+        runQueue( q );
+        QCOMPARE( spy_failed.count(), 1 );
+        QCOMPARE( partition->runs, 1 );
+        QCOMPARE( mount->runs, 1 );
+        QCOMPARE( unpack->runs, 1 );
+        QCOMPARE( boot->runs, 1 );
+        QCOMPARE( countLines( journal ), 4 );
+
+        // Only the owner may read it, and the passphrase is not in there
+        const auto others = QFileDevice::ReadGroup | QFileDevice::ReadOther;
+        QCOMPARE( QFile( journal ).permissions() & others, QFileDevice::Permissions() );
+        QFile f( journal );
+        QVERIFY( f.open( QIODevice::ReadOnly ) );
+        QVERIFY( !f.readAll().contains( secret.toUtf8() ) );
+    }
+
+    // Resume without partitioning: mount runs again, and
+    // the idempotent job after it is skipped, its results restored
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( journal, true );
+        auto* mount = new CountingJob( "mount", false, this );
+        auto* unpack = new CountingJob( "unpack", false, this );
+        auto* boot = new CountingJob( "boot", true, this );
+        q.enqueue( 1, { Calamares::job_ptr( mount ) }, {}, mountKey, Resume::RerunSafely );
+        q.enqueue( 1, { Calamares::job_ptr( unpack ) }, {}, unpackKey, Resume::Skip );
+        q.enqueue( 1, { Calamares::job_ptr( boot ) }, {}, bootKey, Resume::Rerun );
+        // Given again in this session
+        q.globalStorage()->insert( "username", "bob" );
+
+        runQueue( q );
+        QCOMPARE( mount->runs, 1 );
+        QCOMPARE( unpack->runs, 0 );
+        QCOMPARE( boot->runs, 1 );
+        QCOMPARE( q.globalStorage()->value( "unpack" ).toInt(), 1 );
+        QCOMPARE( q.globalStorage()->value( "username" ).toString(), QStringLiteral( "bob" ) );
+        QCOMPARE( countLines( journal ), 7 );
+    }
+
+    // Resume where partitioning runs again: nothing after it is skipped,
+    // and the journal is removed once everything succeeded
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( journal, true );
+        auto* partition = new CountingJob( "partition", false, this );
+        auto* mount = new CountingJob( "mount", false, this );
+        auto* unpack = new CountingJob( "unpack", false, this );
+        auto* boot = new CountingJob( "boot", false, this );
+        q.enqueue( 1, { Calamares::job_ptr( partition ) }, {}, partitionKey, Resume::Rerun );
+        q.enqueue( 1, { Calamares::job_ptr( mount ) }, {}, mountKey, Resume::RerunSafely );
+        q.enqueue( 1, { Calamares::job_ptr( unpack ) }, {}, unpackKey, Resume::Skip );
+        q.enqueue( 1, { Calamares::job_ptr( boot ) }, {}, bootKey, Resume::Rerun );
+
+        QSignalSpy spy_failed( &q, &Calamares::JobQueue::failed );
+        runQueue( q );
+        QCOMPARE( spy_failed.count(), 0 );
+        QCOMPARE( partition->runs, 1 );
+        QCOMPARE( mount->runs, 1 );
+        QCOMPARE( unpack->runs, 1 );
+        QCOMPARE( boot->runs, 1 );
+        QVERIFY( !QFile::exists( journal ) );
+    }
+
+    // Not resuming starts a new journal
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( journal, false );
+        auto* unpack = new CountingJob( "unpack", false, this );
+        auto* boot = new CountingJob( "boot", true, this );
+        q.enqueue( 1, { Calamares::job_ptr( unpack ) }, {}, unpackKey, Resume::Skip );
+        q.enqueue( 1, { Calamares::job_ptr( boot ) }, {}, bootKey, Resume::Rerun );
+
+        runQueue( q );
+        QCOMPARE( unpack->runs, 1 );
+        QCOMPARE( countLines( journal ), 2 );
+    }
+}
 
 QTEST_GUILESS_MAIN( TestLibCalamares )
 
@@ -15,11 +15,18 @@
 #include "GeoIPXML.h"
 #endif
 #include "Handler.h"
+#include "Resolver.h"
 
 #include "network/Manager.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
+#include <utime.h>
+
 QTEST_GUILESS_MAIN( GeoIPTests )
 
 using namespace CalamaresUtils::GeoIP;
@@ -264,3 +271,106 @@ GeoIPTests::testFixed()
         QCOMPARE( f.processReply( QByteArray( "derp" ) ), tz );
     }
 }
+
+void
+GeoIPTests::testResolver()
+{
+    using namespace CalamaresUtils::GeoIP;
+
+    QVERIFY( !Resolver().isValid() );
+
+    // The old-style single provider
+    {
+        Resolver r( QVariantMap {
+            { "style", "json" }, { "url", "http://127.0.0.1:9/" }, { "selector", "" } } );
+        QVERIFY( r.isValid() );
+        QCOMPARE( r.count(), 1 );
+        QCOMPARE( r.urls(), QStringList { "http://127.0.0.1:9/" } );
+    }
+    // Unusable providers are skipped
+    {
+        const QVariantList providers {
+            QVariantMap { { "style", "none" }, { "url", "http://127.0.0.1:9/" }, { "selector", "" } },
+            QVariantMap { { "style", "bogus" }, { "url", "http://127.0.0.1:9/" }, { "selector", "" } },
+        };
+        Resolver r( QVariantMap { { "providers", providers } } );
+        QVERIFY( !r.isValid() );
+        QVERIFY( !r.get().isValid() );
+    }
+    // The fixed provider is the fallback when the others fail
+    // (nothing listens on the discard port of localhost)
+    {
+        const QVariantList providers {
+            QVariantMap { { "style", "fixed" }, { "url", "http://127.0.0.1:9/" }, { "selector", "America/Vancouver" } },
+            QVariantMap { { "style", "json" }, { "url", "http://127.0.0.1:9/json" }, { "selector", "" } },
+            QVariantMap { { "style", "json" }, { "url", "http://127.0.0.1:9/other" }, { "selector", "" } },
+        };
+        Resolver r( QVariantMap { { "providers", providers }, { "cache-ttl", 0 } } );
+        QCOMPARE( r.count(), 3 );
+        const auto tz = r.get();
+        QCOMPARE( tz.first, QStringLiteral( "America" ) );
+        QCOMPARE( tz.second, QStringLiteral( "Vancouver" ) );
+
+        auto future = r.queryRaw();
+        future.waitForFinished();
+        QCOMPARE( future.result(), QStringLiteral( "America/Vancouver" ) );
+    }
+}
+
+/// @brief Sets the modification time of @p path to @p secs seconds ago
+static bool
+makeOlder( const QString& path, qint64 secs )
+{
+    const qint64 t = QDateTime::currentDateTime().toSecsSinceEpoch() - secs;
+    struct utimbuf times = { time_t( t ), time_t( t ) };
+    return ::utime( QFile::encodeName( path ).constData(), &times ) == 0;
+}
+
+static bool
+writeProvider( const QString& path, const QByteArray& json )
+{
+    QFile f( path );
+    return f.open( QIODevice::WriteOnly | QIODevice::Truncate ) && f.write( json ) == json.size();
+}
+
+void
+GeoIPTests::testDiskCache()
+{
+    QStandardPaths::setTestModeEnabled( true );
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+
+    // A provider that does not need the network
+    const QString providerFile = dir.filePath( "geoip.json" );
+    const QString url = QUrl::fromLocalFile( providerFile ).toString();
+    const QString cacheFile = QStandardPaths::writableLocation( QStandardPaths::CacheLocation )
+        + QStringLiteral( "/geoip/" )
+        + QString::fromLatin1( QCryptographicHash::hash( url.toUtf8(), QCryptographicHash::Sha1 ).toHex() );
+    QFile::remove( cacheFile );
+
+    const QVariantList providers { QVariantMap { { "style", "json" }, { "url", url }, { "selector", "" } } };
+    Resolver r( QVariantMap { { "providers", providers }, { "cache-ttl", 60 } } );
+
+    QVERIFY( writeProvider( providerFile, "{\"time_zone\":\"Europe/Amsterdam\"}" ) );
+    Resolver::clearCache();
+    QCOMPARE( r.get().second, QStringLiteral( "Amsterdam" ) );
+    QVERIFY( QFile::exists( cacheFile ) );
+
+    // The provider changes, but the cached data is still fresh; it is
+    // used, and not written again (which would keep it from expiring)
+    QVERIFY( writeProvider( providerFile, "{\"time_zone\":\"America/Vancouver\"}" ) );
+    QVERIFY( makeOlder( cacheFile, 30 ) );
+    const QDateTime cachedAt = QFileInfo( cacheFile ).lastModified();
+    Resolver::clearCache();
+    QCOMPARE( r.get().second, QStringLiteral( "Amsterdam" ) );
+    QCOMPARE( QFileInfo( cacheFile ).lastModified(), cachedAt );
+
+    // Once expired, the data is retrieved again, and cached again
+    QVERIFY( makeOlder( cacheFile, 120 ) );
+    Resolver::clearCache();
+    QCOMPARE( r.get().second, QStringLiteral( "Vancouver" ) );
+    QVERIFY( QFileInfo( cacheFile ).lastModified().secsTo( QDateTime::currentDateTime() ) < 60 );
+
+    QFile::remove( cacheFile );
+    Resolver::clearCache();
+}
@@ -30,6 +30,8 @@ private Q_SLOTS:
     void testXMLalt();
     void testXMLbad();
     void testSplitTZ();
+    void testResolver();
+    void testDiskCache();
 
     void testGet();
 };
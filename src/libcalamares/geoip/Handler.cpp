@@ -153,6 +153,20 @@ Handler::query() const
     return QtConcurrent::run( [=] { return do_query( type, url, selector ); } );
 }
 
+RegionZonePair
+Handler::interpret( const QByteArray& data ) const
+{
+    const auto interface = create_interface( m_type, m_selector );
+    return interface ? interface->processReply( data ) : RegionZonePair();
+}
+
+QString
+Handler::interpretRaw( const QByteArray& data ) const
+{
+    const auto interface = create_interface( m_type, m_selector );
+    return interface ? interface->rawReply( data ) : QString();
+}
+
 QString
 Handler::getRaw() const
 {
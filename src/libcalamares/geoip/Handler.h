@@ -70,6 +70,15 @@ public:
     /// @brief Like query, but don't interpret the contents
     QFuture< QString > queryRaw() const;
 
+    /** @brief Interpret @p data that was retrieved from url()
+     *
+     * This is the second half of get(), for callers that do the
+     * retrieval themselves (e.g. Resolver, which caches it).
+     */
+    RegionZonePair interpret( const QByteArray& data ) const;
+    /// @brief Like interpret, but don't interpret the contents
+    QString interpretRaw( const QByteArray& data ) const;
+
     bool isValid() const { return m_type != Type::None; }
     Type type() const { return m_type; }
     QString url() const { return m_url; }
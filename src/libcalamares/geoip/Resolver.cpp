@@ -0,0 +1,363 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "Resolver.h"
+
+#include "network/Manager.h"
+#include "utils/Logger.h"
+#include "utils/Variant.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <memory>
+
+namespace
+{
+/** @brief Data retrieved from providers, by URL
+ *
+ * A URL that is being retrieved is in inFlight; others that
+ * want the same URL wait for it to settle.
+ */
+struct Cache
+{
+    QMutex mutex;
+    QWaitCondition settled;
+    QHash< QString, QByteArray > data;
+    QSet< QString > inFlight;
+};
+
+Cache&
+cache()
+{
+    static Cache c;
+    return c;
+}
+
+/// @brief Threads for the providers
+QThreadPool*
+providerPool()
+{
+    static QThreadPool pool;
+    return &pool;
+}
+
+/// @brief Threads for query(), which wait for the providers
+QThreadPool*
+queryPool()
+{
+    static QThreadPool pool;
+    return &pool;
+}
+
+/** @brief Runs @p f in @p pool, without waiting for a free thread
+ *
+ * The tasks of a resolver hardly use the CPU: they wait for the
+ * network, or for the providers. So the pools are not limited to the
+ * number of CPUs, but grow so that every provider is asked right away.
+ */
+template < typename F >
+auto
+runNow( QThreadPool* pool, F f ) -> QFuture< decltype( f() ) >
+{
+    static QMutex mutex;  // Between counting the threads and starting one
+    QMutexLocker l( &mutex );
+    if ( pool->activeThreadCount() >= pool->maxThreadCount() )
+    {
+        pool->setMaxThreadCount( pool->activeThreadCount() + 1 );
+    }
+    return QtConcurrent::run( pool, f );
+}
+
+/// @brief The first valid result, and how many providers are still busy
+template < typename T >
+struct Race
+{
+    QMutex mutex;
+    QWaitCondition changed;
+    int pending = 0;
+    bool finished = false;
+    T result;
+};
+}  // namespace
+
+static QString
+diskCacheFile( const QString& url )
+{
+    const QString dir = QStandardPaths::writableLocation( QStandardPaths::CacheLocation );
+    if ( dir.isEmpty() )
+    {
+        return QString();
+    }
+    return dir + QStringLiteral( "/geoip/" )
+        + QString::fromLatin1( QCryptographicHash::hash( url.toUtf8(), QCryptographicHash::Sha1 ).toHex() );
+}
+
+static QByteArray
+readDiskCache( const QString& url, std::chrono::seconds ttl )
+{
+    const QString path = ttl > std::chrono::seconds::zero() ? diskCacheFile( url ) : QString();
+    if ( path.isEmpty() )
+    {
+        return QByteArray();
+    }
+    QFileInfo fi( path );
+    if ( !fi.exists() || fi.lastModified().secsTo( QDateTime::currentDateTime() ) > ttl.count() )
+    {
+        return QByteArray();
+    }
+    QFile f( path );
+    return f.open( QIODevice::ReadOnly ) ? f.readAll() : QByteArray();
+}
+
+static void
+writeDiskCache( const QString& url, const QByteArray& data, std::chrono::seconds ttl )
+{
+    const QString path = ttl > std::chrono::seconds::zero() ? diskCacheFile( url ) : QString();
+    if ( path.isEmpty() )
+    {
+        return;
+    }
+    QDir().mkpath( QFileInfo( path ).absolutePath() );
+    QFile f( path );
+    if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate ) || f.write( data ) != data.size() )
+    {
+        cWarning() << "Could not cache GeoIP data in" << path;
+    }
+}
+
+/** @brief Gets the data from @p url, from the cache if possible
+ *
+ * Replies are cached in memory whether or not they turn out to be
+ * usable, since a different selector may still find something in them.
+ * Empty replies (errors) are not cached, so the next lookup tries again.
+ * Sets @p fromNetwork if the data was retrieved (just now), rather than
+ * taken from a cache; only such data needs to go to the disk cache,
+ * so that what is there expires as it should.
+ */
+static QByteArray
+fetch( const QString& url, std::chrono::seconds ttl, bool& fromNetwork )
+{
+    fromNetwork = false;
+    auto& c = cache();
+    {
+        QMutexLocker l( &c.mutex );
+        while ( c.inFlight.contains( url ) )
+        {
+            c.settled.wait( &c.mutex );
+        }
+        const auto it = c.data.constFind( url );
+        if ( it != c.data.constEnd() )
+        {
+            return it.value();
+        }
+        c.inFlight.insert( url );
+    }
+
+    QByteArray data = readDiskCache( url, ttl );
+    if ( data.isEmpty() )
+    {
+        using namespace CalamaresUtils::Network;
+        data = Manager::instance().synchronousGet( url, { RequestOptions::FakeUserAgent } );
+        fromNetwork = !data.isEmpty();
+    }
+
+    QMutexLocker l( &c.mutex );
+    if ( !data.isEmpty() )
+    {
+        c.data.insert( url, data );
+    }
+    c.inFlight.remove( url );
+    c.settled.wakeAll();
+    return data;
+}
+
+/** @brief Asks all the @p handlers, returns the first valid result
+ *
+ * The network providers are asked concurrently; the fixed ones
+ * only if none of the network providers has a valid result. Providers
+ * that are still busy when a result is found are left to finish
+ * on their own, and their answers are ignored (but cached).
+ */
+template < typename T, typename Interpret, typename IsValid >
+static T
+firstValid( const std::vector< CalamaresUtils::GeoIP::Handler >& handlers,
+            std::chrono::seconds ttl,
+            Interpret interpret,
+            IsValid isValid )
+{
+    using CalamaresUtils::GeoIP::Handler;
+
+    auto race = std::make_shared< Race< T > >();
+    std::vector< const Handler* > fallbacks;
+    for ( const auto& h : handlers )
+    {
+        if ( h.type() == Handler::Type::Fixed )
+        {
+            fallbacks.push_back( &h );
+        }
+        else
+        {
+            race->pending++;
+        }
+    }
+
+    for ( const auto& handler : handlers )
+    {
+        if ( handler.type() == Handler::Type::Fixed )
+        {
+            continue;
+        }
+        runNow( providerPool(), [race, h = handler, ttl, interpret, isValid]() {
+            bool fromNetwork = false;
+            const QByteArray data = fetch( h.url(), ttl, fromNetwork );
+            const T r = interpret( h, data );
+            const bool valid = isValid( r );
+            if ( valid && fromNetwork )
+            {
+                writeDiskCache( h.url(), data, ttl );
+            }
+
+            QMutexLocker l( &race->mutex );
+            if ( valid && !race->finished )
+            {
+                cDebug() << "GeoIP result from" << h.url();
+                race->result = r;
+                race->finished = true;
+            }
+            race->pending--;
+            race->changed.wakeAll();
+        } );
+    }
+
+    {
+        QMutexLocker l( &race->mutex );
+        while ( !race->finished && race->pending > 0 )
+        {
+            race->changed.wait( &race->mutex );
+        }
+        if ( race->finished )
+        {
+            return race->result;
+        }
+    }
+
+    for ( const auto* h : fallbacks )
+    {
+        const T r = interpret( *h, QByteArray() );
+        if ( isValid( r ) )
+        {
+            cDebug() << "GeoIP result from fixed setting" << h->selector();
+            return r;
+        }
+    }
+    return T();
+}
+
+namespace CalamaresUtils
+{
+namespace GeoIP
+{
+
+static void
+addHandler( std::vector< Handler >& handlers, const QVariantMap& m )
+{
+    Handler h( getString( m, "style" ), getString( m, "url" ), getString( m, "selector" ) );
+    if ( h.isValid() )
+    {
+        handlers.push_back( h );
+    }
+}
+
+Resolver::Resolver() {}
+
+Resolver::Resolver( const QVariantMap& config )
+{
+    if ( config.contains( "providers" ) )
+    {
+        for ( const auto& p : config.value( "providers" ).toList() )
+        {
+            addHandler( m_handlers, p.toMap() );
+        }
+    }
+    else
+    {
+        addHandler( m_handlers, config );
+    }
+
+    const auto ttl = getInteger( config, "cache-ttl", 0 );
+    m_cacheTtl = std::chrono::seconds( ttl > 0 ? ttl : 0 );
+}
+
+QStringList
+Resolver::urls() const
+{
+    QStringList l;
+    for ( const auto& h : m_handlers )
+    {
+        l << h.url();
+    }
+    return l;
+}
+
+RegionZonePair
+Resolver::get() const
+{
+    return firstValid< RegionZonePair >(
+        m_handlers,
+        m_cacheTtl,
+        []( const Handler& h, const QByteArray& data ) { return h.interpret( data ); },
+        []( const RegionZonePair& r ) { return r.isValid(); } );
+}
+
+QString
+Resolver::getRaw() const
+{
+    return firstValid< QString >(
+        m_handlers,
+        m_cacheTtl,
+        []( const Handler& h, const QByteArray& data ) { return h.interpretRaw( data ); },
+        []( const QString& r ) { return !r.isEmpty(); } );
+}
+
+QFuture< RegionZonePair >
+Resolver::query() const
+{
+    const Resolver r = *this;
+    return runNow( queryPool(), [=] { return r.get(); } );
+}
+
+QFuture< QString >
+Resolver::queryRaw() const
+{
+    const Resolver r = *this;
+    return runNow( queryPool(), [=] { return r.getRaw(); } );
+}
+
+void
+Resolver::clearCache()
+{
+    auto& c = cache();
+    QMutexLocker l( &c.mutex );
+    c.data.clear();
+}
+
+}  // namespace GeoIP
+}  // namespace CalamaresUtils
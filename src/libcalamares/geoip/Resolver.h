@@ -0,0 +1,92 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef GEOIP_RESOLVER_H
+#define GEOIP_RESOLVER_H
+
+#include "Handler.h"
+
+#include <QFuture>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+#include <chrono>
+#include <vector>
+
+namespace CalamaresUtils
+{
+namespace GeoIP
+{
+
+/** @brief GeoIP lookup with several providers
+ *
+ * A resolver asks all of its providers (each one a Handler) at the
+ * same time, and the first valid answer is the result; a slow or
+ * broken provider does not hold up the others. Providers of style
+ * *fixed* do not need the network and are only used if none of the
+ * others give a valid answer.
+ *
+ * The data that providers return is cached for the session by URL,
+ * so that modules asking the same provider (e.g. *welcome* for the
+ * country and *locale* for the timezone, from the same XML) share
+ * a single request; a request that is already underway is waited for.
+ * Optionally the data is also cached on disk, for a limited time,
+ * so that restarting Calamares does not repeat the lookup.
+ */
+class DLLEXPORT Resolver
+{
+public:
+    /** @brief A resolver without providers; this always returns errors. */
+    Resolver();
+    /** @brief A resolver configured from a *geoip* map
+     *
+     * The map is either a single provider, with keys *style*, *url*
+     * and *selector* (as for Handler), or has a key *providers* with
+     * a list of such maps. The key *cache-ttl* sets the number of
+     * seconds that data is cached on disk (the default, 0, caches
+     * only in memory).
+     */
+    explicit Resolver( const QVariantMap& config );
+
+    /// @brief Are there any (valid) providers?
+    bool isValid() const { return !m_handlers.empty(); }
+    /// @brief The URLs of the providers (for checking the network)
+    QStringList urls() const;
+    /// @brief Number of (valid) providers
+    int count() const { return static_cast< int >( m_handlers.size() ); }
+
+    /** @brief Synchronously get the first valid result
+     *
+     * Returns an invalid result if no provider gives a valid one.
+     */
+    RegionZonePair get() const;
+    /// @brief Like get, but don't interpret the contents; the first non-empty result
+    QString getRaw() const;
+
+    /** @brief Asynchronously get the result, see get()
+     *
+     * The lookup waits for the providers in a thread of the resolver's
+     * own, so it does not take a thread from the global thread pool.
+     */
+    QFuture< RegionZonePair > query() const;
+    /// @brief Like query, but don't interpret the contents
+    QFuture< QString > queryRaw() const;
+
+    /// @brief Forget the data cached in memory (e.g. for tests)
+    static void clearCache();
+
+private:
+    std::vector< Handler > m_handlers;
+    std::chrono::seconds m_cacheTtl = std::chrono::seconds::zero();
+};
+
+}  // namespace GeoIP
+}  // namespace CalamaresUtils
+#endif
@@ -85,11 +85,16 @@ Descriptor::fromDescriptorData( const QVariantMap& moduleDesc )
     }
 
     d.m_isEmergeny = CalamaresUtils::getBool( moduleDesc, "emergency", false );
+    d.m_isIdempotent = CalamaresUtils::getBool( moduleDesc, "idempotent", false );
+    d.m_isRerunnable = CalamaresUtils::getBool( moduleDesc, "rerunnable", false );
     d.m_hasConfig = !CalamaresUtils::getBool( moduleDesc, "noconfig", false );  // Inverted logic during load
     d.m_requiredModules = CalamaresUtils::getStringList( moduleDesc, "requiredModules" );
     d.m_weight = int( CalamaresUtils::getInteger( moduleDesc, "weight", -1 ) );
+    bool schedulingOk = false;
+    d.m_scheduling = CalamaresUtils::getSubMap( moduleDesc, "scheduling", schedulingOk );
 
-    QStringList consumedKeys { "type", "interface", "name", "emergency", "noconfig", "requiredModules", "weight" };
+    QStringList consumedKeys { "type",     "interface",       "name",   "emergency",  "idempotent", "rerunnable",
+                               "noconfig", "requiredModules", "weight", "scheduling" };
 
     switch ( d.interface() )
     {
@@ -69,9 +69,27 @@ public:
     Interface interface() const { return m_interface; }
 
     bool isEmergency() const { return m_isEmergeny; }
+    /** @brief Can the jobs be skipped when resuming, once they completed?
+     *
+     * This is for modules whose jobs leave their results in the target
+     * system and GlobalStorage, like unpackfs; see JobQueue::setCheckpoint().
+     */
+    bool isIdempotent() const { return m_isIdempotent; }
+    /** @brief Can the jobs run again without undoing earlier jobs?
+     *
+     * This is for modules like mount, which must run again when
+     * resuming but leave the target alone; see JobQueue::Resume.
+     */
+    bool isRerunnable() const { return m_isRerunnable; }
     bool hasConfig() const { return m_hasConfig; }
     int weight() const { return m_weight < 1 ? 1 : m_weight; }
     bool explicitWeight() const { return m_weight > 0; }
+    /** @brief The *scheduling* settings for the module's jobs
+     *
+     * These override the global scheduling settings from settings.conf;
+     * see CalamaresUtils::SchedulingPolicy::fromMap().
+     */
+    QVariantMap scheduling() const { return m_scheduling; }
 
 
     /// @brief The directory where the module.desc lives
@@ -123,7 +141,10 @@ private:
     Interface m_interface;
     bool m_isValid = false;
     bool m_isEmergeny = false;
+    bool m_isIdempotent = false;
+    bool m_isRerunnable = false;
     bool m_hasConfig = true;
+    QVariantMap m_scheduling;
 
     /** @brief The name of the thing to load
      *
@@ -0,0 +1,361 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "BlockTopology.h"
+
+#include "utils/Logger.h"
+#include "utils/String.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+
+#include <algorithm>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/// @brief Reads the first line of a (small, sysfs) file, or empty on failure
+static QString
+readFirstLine( const QString& path )
+{
+    QFile f( path );
+    if ( f.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        return QString::fromLocal8Bit( f.readLine() ).trimmed();
+    }
+    return QString();
+}
+
+static QString
+readAll( const QString& path )
+{
+    QFile f( path );
+    if ( f.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        return QString::fromLocal8Bit( f.readAll() );
+    }
+    cDebug() << "Could not read" << path;
+    return QString();
+}
+
+/// @brief Entries in a sysfs holders/ or slaves/ directory (they are symlinks)
+static QStringList
+linkNames( const QString& path )
+{
+    return QDir( path ).entryList( QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot, QDir::Name );
+}
+
+/** @brief Undo the octal escapes used in /proc/self/mountinfo
+ *
+ * Space, tab, newline and backslash are written as \ooo.
+ */
+static QString
+unescapeMountField( const QString& field )
+{
+    if ( !field.contains( '\\' ) )
+    {
+        return field;
+    }
+
+    QString s;
+    s.reserve( field.length() );
+    for ( int i = 0; i < field.length(); ++i )
+    {
+        if ( field[ i ] == '\\' && i + 3 < field.length() )
+        {
+            bool ok = false;
+            int c = field.mid( i + 1, 3 ).toInt( &ok, 8 );
+            if ( ok )
+            {
+                s.append( QChar( c ) );
+                i += 3;
+                continue;
+            }
+        }
+        s.append( field[ i ] );
+    }
+    return s;
+}
+
+QString
+lvmVolumeGroupName( const QString& dmName )
+{
+    for ( int i = 0; i < dmName.length(); ++i )
+    {
+        if ( dmName[ i ] != '-' )
+        {
+            continue;
+        }
+        if ( i + 1 < dmName.length() && dmName[ i + 1 ] == '-' )
+        {
+            ++i;  // Skip the escaped dash
+            continue;
+        }
+        if ( i == 0 || i + 1 == dmName.length() )
+        {
+            return QString();
+        }
+        return dmName.left( i ).replace( QStringLiteral( "--" ), QStringLiteral( "-" ) );
+    }
+    return QString();
+}
+
+BlockTopology
+BlockTopology::snapshot( const QString& root )
+{
+    BlockTopology t;
+
+    QDir rootDir( root );
+    const QString sysBlock = rootDir.filePath( QStringLiteral( "sys/block" ) );
+    const QStringList disks = QDir( sysBlock ).entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
+    for ( const QString& disk : disks )
+    {
+        QDir diskDir( sysBlock + '/' + disk );
+        t.readSysBlockDevice( diskDir.path(), disk, QString() );
+
+        // Partitions are subdirectories with a "partition" file in them
+        const QStringList subdirs = diskDir.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name );
+        for ( const QString& sub : subdirs )
+        {
+            if ( QFileInfo::exists( diskDir.filePath( sub + QStringLiteral( "/partition" ) ) ) )
+            {
+                t.readSysBlockDevice( diskDir.filePath( sub ), sub, disk );
+            }
+        }
+    }
+
+    t.addMountInfo( readAll( rootDir.filePath( QStringLiteral( "proc/self/mountinfo" ) ) ) );
+    t.addSwaps( readAll( rootDir.filePath( QStringLiteral( "proc/swaps" ) ) ) );
+    return t;
+}
+
+void
+BlockTopology::readSysBlockDevice( const QString& path, const QString& name, const QString& disk )
+{
+    BlockDevice d;
+    d.name = name;
+    d.disk = disk;
+    d.majorMinor = readFirstLine( path + QStringLiteral( "/dev" ) );
+    d.dmName = readFirstLine( path + QStringLiteral( "/dm/name" ) );
+    d.dmUuid = readFirstLine( path + QStringLiteral( "/dm/uuid" ) );
+    d.holders = linkNames( path + QStringLiteral( "/holders" ) );
+    d.slaves = linkNames( path + QStringLiteral( "/slaves" ) );
+    d.devicePath
+        = d.dmName.isEmpty() ? ( QStringLiteral( "/dev/" ) + name ) : ( QStringLiteral( "/dev/mapper/" ) + d.dmName );
+    addDevice( d );
+}
+
+void
+BlockTopology::addDevice( const BlockDevice& d )
+{
+    m_devices.insert( d.name, d );
+    if ( !d.majorMinor.isEmpty() )
+    {
+        m_namesByMajorMinor.insert( d.majorMinor, d.name );
+    }
+    m_namesByPath.insert( d.devicePath, d.name );
+    m_namesByPath.insert( QStringLiteral( "/dev/" ) + d.name, d.name );
+}
+
+QString
+BlockTopology::nameForPath( const QString& devicePath ) const
+{
+    auto it = m_namesByPath.constFind( devicePath );
+    if ( it != m_namesByPath.constEnd() )
+    {
+        return it.value();
+    }
+
+    // Symlinks like /dev/disk/by-uuid/.. or /dev/vg/lv
+    QFileInfo fi( devicePath );
+    if ( fi.exists() )
+    {
+        return m_namesByPath.value( fi.canonicalFilePath() );
+    }
+    return QString();
+}
+
+void
+BlockTopology::addMountInfo( const QString& mountinfo )
+{
+    // Sample line:
+    //  36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+    //  (1)(2)(3)   (4)   (5)      (6)      (7)   (8) (9)   (10)         (11)
+    // Field (7) may occur zero or more times, so look for the separator (8).
+    const QStringList lines = mountinfo.split( '\n', SplitSkipEmptyParts );
+    for ( const QString& line : lines )
+    {
+        const QStringList fields = line.split( ' ', SplitSkipEmptyParts );
+        const int separator = fields.indexOf( QStringLiteral( "-" ), 6 );
+        if ( fields.count() < 5 || separator < 0 || separator + 2 >= fields.count() )
+        {
+            continue;
+        }
+
+        const QString source = unescapeMountField( fields[ separator + 2 ] );
+        QString name = source.startsWith( '/' ) ? nameForPath( source ) : QString();
+        if ( name.isEmpty() )
+        {
+            // Not always reliable (e.g. btrfs uses anonymous device numbers)
+            name = m_namesByMajorMinor.value( fields[ 2 ] );
+        }
+
+        auto it = m_devices.find( name );
+        if ( it != m_devices.end() )
+        {
+            const QString mountPoint = unescapeMountField( fields[ 4 ] );
+            it->mountPoints.append( mountPoint );
+            m_mounts.append( qMakePair( name, mountPoint ) );
+        }
+    }
+}
+
+void
+BlockTopology::addSwaps( const QString& swaps )
+{
+    // Sample:
+    //  Filename                                Type            Size    Used    Priority
+    //  /dev/sda2                               partition       2097148 0       -2
+    QStringList lines = swaps.split( '\n', SplitSkipEmptyParts );
+    if ( !lines.isEmpty() )
+    {
+        lines.removeFirst();  // That's the header line
+    }
+    for ( const QString& line : qAsConst( lines ) )
+    {
+        const QString filename = unescapeMountField( line.simplified().split( ' ' ).value( 0 ) );
+        auto it = m_devices.find( nameForPath( filename ) );
+        if ( it != m_devices.end() )
+        {
+            it->isSwap = true;
+        }
+    }
+}
+
+QStringList
+BlockTopology::unmountOrder( const QStringList& names ) const
+{
+    QStringList l;
+    for ( auto it = m_mounts.crbegin(); it != m_mounts.crend(); ++it )
+    {
+        if ( names.contains( it->first ) )
+        {
+            l.append( it->second );
+        }
+    }
+    return l;
+}
+
+QStringList
+BlockTopology::partitions( const QString& disk ) const
+{
+    QStringList l;
+    for ( const auto& d : m_devices )
+    {
+        if ( d.disk == disk )
+        {
+            l.append( d.name );
+        }
+    }
+    // Partition names differ only in their number, so sorting by length
+    // first puts sda2 before sda10.
+    std::sort( l.begin(), l.end(), []( const QString& a, const QString& b ) {
+        return a.length() < b.length() || ( a.length() == b.length() && a < b );
+    } );
+    return l;
+}
+
+/** @brief Depth-first collection of holders, post-order
+ *
+ * Every device is appended after all of its holders, so the resulting
+ * list has holders before the devices they are stacked on.
+ */
+static void
+collectHolders( const QHash< QString, BlockDevice >& devices,
+                const QString& name,
+                QSet< QString >& visited,
+                QStringList& order )
+{
+    if ( visited.contains( name ) )
+    {
+        return;
+    }
+    visited.insert( name );
+    for ( const QString& h : devices.value( name ).holders )
+    {
+        collectHolders( devices, h, visited, order );
+    }
+    order.append( name );
+}
+
+QStringList
+BlockTopology::holders( const QString& name ) const
+{
+    QSet< QString > visited;
+    QStringList order;
+    collectHolders( m_devices, name, visited, order );
+    order.removeLast();  // That's name itself
+    return order;
+}
+
+QList< QStringList >
+BlockTopology::holderGroups( const QStringList& names ) const
+{
+    // Each group is a list of "root" names and the set of all devices involved
+    struct Group
+    {
+        QStringList roots;
+        QSet< QString > members;
+    };
+    QList< Group > groups;
+
+    for ( const QString& name : names )
+    {
+        Group g;
+        g.roots.append( name );
+        g.members.insert( name );
+        for ( const QString& h : holders( name ) )
+        {
+            g.members.insert( h );
+        }
+
+        // Merge with any existing group that shares a device
+        for ( int i = groups.count() - 1; i >= 0; --i )
+        {
+            if ( groups[ i ].members.intersects( g.members ) )
+            {
+                g.roots = groups[ i ].roots + g.roots;
+                g.members.unite( groups[ i ].members );
+                groups.removeAt( i );
+            }
+        }
+        groups.append( g );
+    }
+
+    QList< QStringList > result;
+    for ( const auto& g : qAsConst( groups ) )
+    {
+        QSet< QString > visited;
+        QStringList order;
+        for ( const QString& root : g.roots )
+        {
+            collectHolders( m_devices, root, visited, order );
+        }
+        result.append( order );
+    }
+    return result;
+}
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
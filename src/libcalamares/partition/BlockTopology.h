@@ -0,0 +1,141 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+/*
+ * A snapshot of the block-device stack of the running system:
+ * which partitions belong to which disk, which device-mapper
+ * devices (LUKS, LVM) sit on top of which devices, and where
+ * things are mounted or used as swap. All of this is read from
+ * /sys/block, /proc/self/mountinfo and /proc/swaps in one pass,
+ * without running any external tools.
+ */
+
+#ifndef PARTITION_BLOCKTOPOLOGY_H
+#define PARTITION_BLOCKTOPOLOGY_H
+
+#include "DllMacro.h"
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/** @brief One node in the block-device stack
+ *
+ * Devices are identified by their kernel name (e.g. sda1, dm-0),
+ * as used in /sys/block. Relations to other devices also use
+ * kernel names.
+ */
+struct DLLEXPORT BlockDevice
+{
+    QString name;  ///< Kernel name, e.g. sda1 or dm-3
+    QString devicePath;  ///< /dev/<name>, or /dev/mapper/<dm-name>
+    QString majorMinor;  ///< Device number as "major:minor"
+    QString disk;  ///< For partitions, the kernel name of the disk
+    QString dmName;  ///< For device-mapper devices, the mapper name
+    QString dmUuid;  ///< For device-mapper devices, e.g. CRYPT-LUKS2-.. or LVM-..
+    QStringList holders;  ///< Devices directly on top of this one
+    QStringList slaves;  ///< Devices directly underneath this one
+    QStringList mountPoints;  ///< Where this device is mounted, in mount order
+    bool isSwap = false;  ///< Is this device in use as swap?
+
+    bool isValid() const { return !name.isEmpty(); }
+    bool isPartition() const { return !disk.isEmpty(); }
+    bool isCrypt() const { return dmUuid.startsWith( QStringLiteral( "CRYPT-" ) ); }
+    bool isLVM() const { return dmUuid.startsWith( QStringLiteral( "LVM-" ) ); }
+    /// @brief Is the device in use (mounted or swap)?
+    bool isInUse() const { return isSwap || !mountPoints.isEmpty(); }
+};
+
+/** @brief The volume-group name from an LVM device-mapper name
+ *
+ * LVM names its mapper devices <vg>-<lv>, with dashes inside
+ * either name doubled. Returns an empty string if @p dmName
+ * is not of that form.
+ */
+DLLEXPORT QString lvmVolumeGroupName( const QString& dmName );
+
+class DLLEXPORT BlockTopology
+{
+public:
+    /** @brief Reads the current system's block devices
+     *
+     * The files are read relative to @p root, which is useful
+     * only for testing (with a fake sysfs and proc).
+     */
+    static BlockTopology snapshot( const QString& root = QStringLiteral( "/" ) );
+
+    /// @brief The device with kernel name @p name (invalid if there is none)
+    BlockDevice device( const QString& name ) const { return m_devices.value( name ); }
+    /// @brief The device for the given /dev path, (invalid if there is none)
+    BlockDevice deviceForPath( const QString& devicePath ) const { return device( nameForPath( devicePath ) ); }
+    /** @brief Kernel name for a path like /dev/sda1 or /dev/mapper/foo
+     *
+     * Returns an empty string for paths that are not known devices.
+     */
+    QString nameForPath( const QString& devicePath ) const;
+
+    /// @brief Kernel names of the partitions on @p disk, in numerical order
+    QStringList partitions( const QString& disk ) const;
+
+    /** @brief All the devices stacked on top of @p name
+     *
+     * This includes indirect holders (e.g. the LVM volumes inside
+     * a LUKS container on a partition). The list is ordered so that
+     * every device comes before the devices it is stacked on, which
+     * is the order in which they can be taken down.
+     */
+    QStringList holders( const QString& name ) const;
+
+    /** @brief Independent groups of holders of @p names
+     *
+     * Holders of the given devices are collected and split into
+     * groups that share no devices, so that each group can be taken
+     * down independently from (e.g. in parallel with) the others.
+     * Each group is ordered as for holders(), and includes the
+     * given devices themselves (after their holders).
+     */
+    QList< QStringList > holderGroups( const QStringList& names ) const;
+
+    /** @brief Mount points of the devices @p names, in unmount order
+     *
+     * Mounts are listed in the reverse of the order in which they
+     * were mounted, so that a mount nested inside another (possibly
+     * of a different device) comes before the one it is nested in.
+     */
+    QStringList unmountOrder( const QStringList& names ) const;
+
+    int count() const { return m_devices.count(); }
+
+    /// @brief Adds the mount information in the format of /proc/self/mountinfo
+    void addMountInfo( const QString& mountinfo );
+    /// @brief Adds swap information in the format of /proc/swaps
+    void addSwaps( const QString& swaps );
+
+private:
+    void addDevice( const BlockDevice& d );
+    void readSysBlockDevice( const QString& path, const QString& name, const QString& disk );
+
+    QHash< QString, BlockDevice > m_devices;
+    QHash< QString, QString > m_namesByMajorMinor;
+    QHash< QString, QString > m_namesByPath;
+    QList< QPair< QString, QString > > m_mounts;  ///< (name, mount point) in mount order
+};
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
+
+#endif
@@ -0,0 +1,176 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "Metadata.h"
+
+#include "utils/CalamaresUtilsSystem.h"
+#include "utils/Logger.h"
+
+#include <QMutexLocker>
+#include <QStringList>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/** @brief Undo the shell-style escaping that blkid applies in export mode
+ *
+ * Special characters (e.g. spaces in a label) are preceded by a backslash.
+ */
+static QString
+unescapeBlkidValue( const QString& value )
+{
+    if ( !value.contains( '\\' ) )
+    {
+        return value;
+    }
+
+    QString s;
+    s.reserve( value.length() );
+    bool escaped = false;
+    for ( const QChar c : value )
+    {
+        if ( !escaped && c == '\\' )
+        {
+            escaped = true;
+            continue;
+        }
+        escaped = false;
+        s.append( c );
+    }
+    return s;
+}
+
+static void
+insertMetadata( BlockDeviceMetadataHash& h, const BlockDeviceMetadata& m )
+{
+    if ( m.isValid() )
+    {
+        h.insert( m.device, m );
+    }
+}
+
+BlockDeviceMetadataHash
+parseBlkidExport( const QString& output )
+{
+    BlockDeviceMetadataHash devices;
+    BlockDeviceMetadata current;
+
+    const QStringList lines = output.split( '\n' );
+    for ( const QString& rawLine : lines )
+    {
+        const QString line = rawLine.trimmed();
+        if ( line.isEmpty() )
+        {
+            insertMetadata( devices, current );
+            current = BlockDeviceMetadata();
+            continue;
+        }
+
+        const int eq = line.indexOf( '=' );
+        if ( eq <= 0 )
+        {
+            // Not a KEY=value line, e.g. an error message on stderr
+            continue;
+        }
+
+        const QString key = line.left( eq );
+        const QString value = unescapeBlkidValue( line.mid( eq + 1 ) );
+        if ( key == QStringLiteral( "DEVNAME" ) )
+        {
+            // Tolerate missing blank lines between devices
+            insertMetadata( devices, current );
+            current = BlockDeviceMetadata();
+            current.device = value;
+        }
+        else if ( key == QStringLiteral( "TYPE" ) )
+        {
+            current.type = value;
+        }
+        else if ( key == QStringLiteral( "UUID" ) )
+        {
+            current.uuid = value;
+        }
+        else if ( key == QStringLiteral( "LABEL" ) )
+        {
+            current.label = value;
+        }
+        else if ( key == QStringLiteral( "PARTUUID" ) )
+        {
+            current.partUuid = value;
+        }
+        else if ( key == QStringLiteral( "PARTLABEL" ) )
+        {
+            current.partLabel = value;
+        }
+    }
+    insertMetadata( devices, current );
+
+    return devices;
+}
+
+MetadataCache*
+MetadataCache::instance()
+{
+    static MetadataCache* s_instance = new MetadataCache();
+    return s_instance;
+}
+
+void
+MetadataCache::invalidate()
+{
+    QMutexLocker lock( &m_mutex );
+    m_devices.clear();
+    m_loaded = false;
+}
+
+BlockDeviceMetadata
+MetadataCache::metadata( const QString& devicePath )
+{
+    QMutexLocker lock( &m_mutex );
+    load();
+    return m_devices.value( devicePath );
+}
+
+bool
+MetadataCache::contains( const QString& devicePath )
+{
+    QMutexLocker lock( &m_mutex );
+    load();
+    return m_devices.contains( devicePath );
+}
+
+void
+MetadataCache::load()
+{
+    if ( m_loaded )
+    {
+        return;
+    }
+    // Even if blkid fails, don't try again until invalidated: callers
+    // fall back to their own (per-device) lookups for unknown devices.
+    m_loaded = true;
+
+    // -c /dev/null bypasses the blkid cache file, so the information is fresh.
+    auto r = System::runCommand( { "blkid", "-c", "/dev/null", "-o", "export" }, std::chrono::seconds( 30 ) );
+    if ( r.getExitCode() != 0 )
+    {
+        // Exit code 2 means no devices with a recognized type were found
+        cWarning() << "Could not read block-device metadata, blkid exit code" << r.getExitCode();
+        return;
+    }
+
+    m_devices = parseBlkidExport( r.getOutput() );
+    cDebug() << "Read metadata for" << m_devices.count() << "block devices.";
+}
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
@@ -0,0 +1,105 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+/*
+ * Block-device metadata (filesystem type, UUIDs, labels) as reported
+ * by blkid(8). Looking these up one device at a time costs a process
+ * spawn per partition; the cache here probes **all** block devices
+ * with a single blkid invocation and keeps the results until
+ * explicitly invalidated.
+ */
+
+#ifndef PARTITION_METADATA_H
+#define PARTITION_METADATA_H
+
+#include "DllMacro.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+namespace CalamaresUtils
+{
+namespace Partition
+{
+
+/** @brief Metadata for one block device (partition, mapper device, ..)
+ *
+ * All the fields are as reported by blkid, so for a LUKS container
+ * the type is "crypto_LUKS" and the uuid is the LUKS UUID.
+ */
+struct DLLEXPORT BlockDeviceMetadata
+{
+    QString device;  ///< Full path to the device node, e.g. /dev/sda1
+    QString type;  ///< Filesystem (or container) type, e.g. ext4
+    QString uuid;  ///< Filesystem (or container) UUID
+    QString label;  ///< Filesystem label
+    QString partUuid;  ///< Partition UUID (GPT, or MBR pseudo-UUID)
+    QString partLabel;  ///< Partition label (GPT)
+
+    bool isValid() const { return !device.isEmpty(); }
+};
+
+using BlockDeviceMetadataHash = QHash< QString, BlockDeviceMetadata >;
+
+/** @brief Parse the output of `blkid -o export`
+ *
+ * The output consists of blocks of KEY=value lines, separated by
+ * empty lines; each block starts with DEVNAME=. Returns a hash
+ * keyed by device path. Blocks without a DEVNAME are ignored.
+ */
+DLLEXPORT BlockDeviceMetadataHash parseBlkidExport( const QString& output );
+
+/** @brief Process-wide cache of block-device metadata
+ *
+ * The first lookup after construction or invalidate() runs blkid
+ * once for all devices; subsequent lookups are served from memory.
+ * Call invalidate() after anything that changes filesystems or
+ * partition tables (e.g. at the start of the exec phase, or after
+ * re-scanning devices). The cache is thread-safe.
+ */
+class DLLEXPORT MetadataCache
+{
+public:
+    static MetadataCache* instance();
+
+    /// @brief Drop all cached information; the next lookup re-probes.
+    void invalidate();
+
+    /** @brief Metadata for the device at @p devicePath
+     *
+     * Returns an invalid (empty) metadata object if blkid
+     * does not know about the device.
+     */
+    BlockDeviceMetadata metadata( const QString& devicePath );
+
+    /// @brief Convenience for metadata( @p devicePath ).uuid
+    QString uuid( const QString& devicePath ) { return metadata( devicePath ).uuid; }
+    /// @brief Convenience for metadata( @p devicePath ).type
+    QString type( const QString& devicePath ) { return metadata( devicePath ).type; }
+
+    /// @brief Is there (cached) metadata for @p devicePath ?
+    bool contains( const QString& devicePath );
+
+private:
+    MetadataCache() = default;
+
+    /// @brief Runs blkid, if needed; call with the mutex held
+    void load();
+
+    QMutex m_mutex;
+    BlockDeviceMetadataHash m_devices;
+    bool m_loaded = false;
+};
+
+}  // namespace Partition
+}  // namespace CalamaresUtils
+
+#endif
@@ -10,6 +10,8 @@
 
 #include "Tests.h"
 
+#include "BlockTopology.h"
+#include "Metadata.h"
 #include "PartitionSize.h"
 
 using SizeUnit = CalamaresUtils::Partition::SizeUnit;
@@ -19,6 +21,9 @@ Q_DECLARE_METATYPE( SizeUnit )
 
 #include "utils/Logger.h"
 
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 
 QTEST_GUILESS_MAIN( PartitionSizeTests )
@@ -139,3 +144,175 @@ PartitionSizeTests::testUnitNormalisation()
 
     QCOMPARE( PartitionSize( v, u1 ).toBytes(), bytes );
 }
+
+void
+PartitionSizeTests::testBlkidExport()
+{
+    using CalamaresUtils::Partition::parseBlkidExport;
+
+    QVERIFY( parseBlkidExport( QString() ).isEmpty() );
+    QVERIFY( parseBlkidExport( QStringLiteral( "UUID=1234\nTYPE=ext4\n" ) ).isEmpty() );
+
+    const QString output = QStringLiteral(
+        "DEVNAME=/dev/sda1\n"
+        "UUID=0f1e-2d3c\n"
+        "TYPE=vfat\n"
+        "PARTLABEL=EFI\\ System\n"
+        "PARTUUID=5e1f0a2b-01\n"
+        "\n"
+        "DEVNAME=/dev/sda2\n"
+        "UUID=8c7d2f1e-aaaa-bbbb-cccc-0123456789ab\n"
+        "TYPE=crypto_LUKS\n"
+        "\n"
+        "blkid: some error message\n"
+        "DEVNAME=/dev/mapper/luks-8c7d\n"
+        "LABEL=root\n"
+        "UUID=11112222-3333-4444-5555-666677778888\n"
+        "TYPE=ext4\n" );
+
+    const auto devices = parseBlkidExport( output );
+    QCOMPARE( devices.count(), 3 );
+    QVERIFY( devices.contains( "/dev/sda1" ) );
+    QVERIFY( devices.contains( "/dev/sda2" ) );
+    QVERIFY( !devices.contains( "/dev/sda3" ) );
+
+    const auto esp = devices.value( "/dev/sda1" );
+    QCOMPARE( esp.type, QStringLiteral( "vfat" ) );
+    QCOMPARE( esp.uuid, QStringLiteral( "0f1e-2d3c" ) );
+    QCOMPARE( esp.partLabel, QStringLiteral( "EFI System" ) );
+    QCOMPARE( esp.partUuid, QStringLiteral( "5e1f0a2b-01" ) );
+    QVERIFY( esp.label.isEmpty() );
+
+    QCOMPARE( devices.value( "/dev/sda2" ).type, QStringLiteral( "crypto_LUKS" ) );
+    const auto root = devices.value( "/dev/mapper/luks-8c7d" );
+    QCOMPARE( root.label, QStringLiteral( "root" ) );
+    QCOMPARE( root.type, QStringLiteral( "ext4" ) );
+}
+
+void
+PartitionSizeTests::testLVMNames_data()
+{
+    QTest::addColumn< QString >( "dmName" );
+    QTest::addColumn< QString >( "vg" );
+
+    QTest::newRow( "empty" ) << QString() << QString();
+    QTest::newRow( "no-lv" ) << QStringLiteral( "cryptroot" ) << QString();
+    QTest::newRow( "simple" ) << QStringLiteral( "vg0-root" ) << QStringLiteral( "vg0" );
+    QTest::newRow( "dash-vg" ) << QStringLiteral( "my--vg-home" ) << QStringLiteral( "my-vg" );
+    QTest::newRow( "dash-lv" ) << QStringLiteral( "vg-my--home" ) << QStringLiteral( "vg" );
+    QTest::newRow( "lead" ) << QStringLiteral( "-home" ) << QString();
+    QTest::newRow( "trail" ) << QStringLiteral( "vg-" ) << QString();
+}
+
+void
+PartitionSizeTests::testLVMNames()
+{
+    QFETCH( QString, dmName );
+    QFETCH( QString, vg );
+
+    QCOMPARE( CalamaresUtils::Partition::lvmVolumeGroupName( dmName ), vg );
+}
+
+static void
+writeFakeFile( const QDir& root, const QString& path, const QByteArray& contents = QByteArray() )
+{
+    QVERIFY( root.mkpath( QFileInfo( root.filePath( path ) ).path() ) );
+    QFile f( root.filePath( path ) );
+    QVERIFY( f.open( QIODevice::WriteOnly ) );
+    f.write( contents );
+}
+
+void
+PartitionSizeTests::testBlockTopology()
+{
+    using CalamaresUtils::Partition::BlockTopology;
+
+    // A fake sda with three partitions: sda1 is mounted, sda2 is swap,
+    // sda3 is a LUKS container holding an LVM VG with two LVs (one mounted).
+    // sdb1 is an unrelated mounted partition.
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    QDir root( tempRoot.path() );
+
+    writeFakeFile( root, "sys/block/sda/dev", "8:0\n" );
+    writeFakeFile( root, "sys/block/sda/sda1/partition", "1\n" );
+    writeFakeFile( root, "sys/block/sda/sda1/dev", "8:1\n" );
+    writeFakeFile( root, "sys/block/sda/sda2/partition", "2\n" );
+    writeFakeFile( root, "sys/block/sda/sda2/dev", "8:2\n" );
+    writeFakeFile( root, "sys/block/sda/sda3/partition", "3\n" );
+    writeFakeFile( root, "sys/block/sda/sda3/dev", "8:3\n" );
+    writeFakeFile( root, "sys/block/sda/sda3/holders/dm-0" );
+    writeFakeFile( root, "sys/block/sdb/dev", "8:16\n" );
+    writeFakeFile( root, "sys/block/sdb/sdb1/partition", "1\n" );
+    writeFakeFile( root, "sys/block/sdb/sdb1/dev", "8:17\n" );
+    writeFakeFile( root, "sys/block/dm-0/dev", "254:0\n" );
+    writeFakeFile( root, "sys/block/dm-0/dm/name", "luks-1234\n" );
+    writeFakeFile( root, "sys/block/dm-0/dm/uuid", "CRYPT-LUKS2-1234-luks-1234\n" );
+    writeFakeFile( root, "sys/block/dm-0/slaves/sda3" );
+    writeFakeFile( root, "sys/block/dm-0/holders/dm-1" );
+    writeFakeFile( root, "sys/block/dm-0/holders/dm-2" );
+    writeFakeFile( root, "sys/block/dm-1/dev", "254:1\n" );
+    writeFakeFile( root, "sys/block/dm-1/dm/name", "my--vg-root\n" );
+    writeFakeFile( root, "sys/block/dm-1/dm/uuid", "LVM-abcdef\n" );
+    writeFakeFile( root, "sys/block/dm-1/slaves/dm-0" );
+    writeFakeFile( root, "sys/block/dm-2/dev", "254:2\n" );
+    writeFakeFile( root, "sys/block/dm-2/dm/name", "my--vg-home\n" );
+    writeFakeFile( root, "sys/block/dm-2/dm/uuid", "LVM-012345\n" );
+    writeFakeFile( root, "sys/block/dm-2/slaves/dm-0" );
+    writeFakeFile( root,
+                   "proc/self/mountinfo",
+                   "22 1 8:17 / / rw,relatime shared:1 - ext4 /dev/sdb1 rw\n"
+                   "40 22 8:1 / /mnt/old\\040disk rw,relatime shared:5 master:2 - ext4 /dev/sda1 rw\n"
+                   "41 40 254:1 / /mnt/old\\040disk/lv rw,relatime - xfs /dev/mapper/my--vg-root rw\n"
+                   "42 22 0:44 / /run rw - tmpfs tmpfs rw\n" );
+    writeFakeFile( root,
+                   "proc/swaps",
+                   "Filename\t\t\t\tType\t\tSize\tUsed\tPriority\n"
+                   "/dev/sda2                               partition\t2097148\t0\t-2\n" );
+
+    const auto t = BlockTopology::snapshot( root.path() );
+    QCOMPARE( t.count(), 9 );
+    QCOMPARE( t.partitions( "sda" ), QStringList( { "sda1", "sda2", "sda3" } ) );
+    QCOMPARE( t.partitions( "sdb" ), QStringList { "sdb1" } );
+    QVERIFY( t.partitions( "dm-0" ).isEmpty() );
+
+    QCOMPARE( t.nameForPath( "/dev/mapper/luks-1234" ), QStringLiteral( "dm-0" ) );
+    QCOMPARE( t.nameForPath( "/dev/dm-1" ), QStringLiteral( "dm-1" ) );
+    QVERIFY( t.nameForPath( "/dev/sdc" ).isEmpty() );
+
+    QCOMPARE( t.device( "sda1" ).mountPoints, QStringList { "/mnt/old disk" } );
+    QCOMPARE( t.device( "sdb1" ).mountPoints, QStringList { "/" } );
+    QVERIFY( t.device( "sda2" ).isSwap );
+    QVERIFY( t.device( "sda2" ).isInUse() );
+    QVERIFY( !t.device( "sda3" ).isInUse() );
+    QVERIFY( t.device( "dm-0" ).isCrypt() );
+    QVERIFY( t.device( "dm-1" ).isLVM() );
+    QCOMPARE( t.device( "dm-1" ).devicePath, QStringLiteral( "/dev/mapper/my--vg-root" ) );
+    QCOMPARE( t.device( "dm-1" ).mountPoints, QStringList { "/mnt/old disk/lv" } );
+
+    QVERIFY( t.holders( "sda1" ).isEmpty() );
+    QCOMPARE( t.holders( "sda3" ), QStringList( { "dm-1", "dm-2", "dm-0" } ) );
+
+    const auto groups = t.holderGroups( t.partitions( "sda" ) );
+    QCOMPARE( groups.count(), 3 );
+    QCOMPARE( groups[ 0 ], QStringList { "sda1" } );
+    QCOMPARE( groups[ 1 ], QStringList { "sda2" } );
+    QCOMPARE( groups[ 2 ], QStringList( { "dm-1", "dm-2", "dm-0", "sda3" } ) );
+
+    // Asking about the LUKS container as well merges it into the sda3 group
+    const auto mergedGroups = t.holderGroups( { "sda3", "dm-0" } );
+    QCOMPARE( mergedGroups.count(), 1 );
+    QCOMPARE( mergedGroups[ 0 ], QStringList( { "dm-1", "dm-2", "dm-0", "sda3" } ) );
+
+    // The LV is mounted inside sda1's mount, although they are in different
+    // groups; it must be unmounted first, whatever the order of the devices.
+    QStringList affected;
+    for ( const auto& g : groups )
+    {
+        affected.append( g );
+    }
+    QCOMPARE( t.unmountOrder( affected ), QStringList( { "/mnt/old disk/lv", "/mnt/old disk" } ) );
+    QCOMPARE( t.unmountOrder( { "sda1", "dm-1" } ), QStringList( { "/mnt/old disk/lv", "/mnt/old disk" } ) );
+    QCOMPARE( t.unmountOrder( { "dm-1", "sda1" } ), QStringList( { "/mnt/old disk/lv", "/mnt/old disk" } ) );
+    QVERIFY( t.unmountOrder( { "sda2", "sda3" } ).isEmpty() );
+}
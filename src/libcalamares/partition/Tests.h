@@ -28,6 +28,12 @@ private Q_SLOTS:
 
     void testUnitNormalisation_data();
     void testUnitNormalisation();
+
+    void testBlkidExport();
+
+    void testLVMNames_data();
+    void testLVMNames();
+    void testBlockTopology();
 };
 
 #endif
@@ -0,0 +1,669 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "Accounts.h"
+
+#include "utils/Logger.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <QThread>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CalamaresUtils
+{
+
+/// @brief How long to wait for the password-file lock, like lckpwdf(3)
+static constexpr int lockTimeoutMs = 15000;
+static constexpr int lockIntervalMs = 100;
+
+/// @brief Today, in days since the epoch, as used in shadow(5)
+static QByteArray
+daysSinceEpoch()
+{
+    return QByteArray::number( QDateTime::currentSecsSinceEpoch() / ( 24 * 60 * 60 ) );
+}
+
+/** @brief Writes @p data to @p path, all or nothing, and syncs it
+ *
+ * If @p st is not null, the mode and owner are copied from it.
+ */
+static bool
+writeSynced( const QString& path, const QByteArray& data, const struct stat* st )
+{
+    const QByteArray name = QFile::encodeName( path );
+    int fd = ::open( name.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 );
+    if ( fd < 0 )
+    {
+        return false;
+    }
+
+    bool ok = true;
+    if ( st )
+    {
+        // Changing the owner may fail when not running as root, which
+        // is fine if the owner is already us.
+        if ( fchown( fd, st->st_uid, st->st_gid ) && ( st->st_uid != geteuid() ) )
+        {
+            ok = false;
+        }
+        ok = ok && ( fchmod( fd, st->st_mode & 07777 ) == 0 );
+    }
+
+    const char* p = data.constData();
+    qint64 remaining = data.size();
+    while ( ok && remaining > 0 )
+    {
+        ssize_t r = ::write( fd, p, size_t( remaining ) );
+        if ( r < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        if ( r <= 0 )
+        {
+            ok = false;
+            break;
+        }
+        p += r;
+        remaining -= r;
+    }
+    ok = ok && ( fsync( fd ) == 0 );
+    ok = ( ::close( fd ) == 0 ) && ok;
+    if ( !ok )
+    {
+        ::unlink( name.constData() );
+    }
+    return ok;
+}
+
+void
+AccountDatabase::File::append( const QList< QByteArray >& fields )
+{
+    index.insert( fields.first(), entries.count() );
+    entries.append( fields );
+    modified = true;
+}
+
+QList< QByteArray >*
+AccountDatabase::File::find( const QString& name )
+{
+    auto it = index.constFind( name.toUtf8() );
+    return it == index.constEnd() ? nullptr : &entries[ it.value() ];
+}
+
+const QList< QByteArray >*
+AccountDatabase::File::find( const QString& name ) const
+{
+    auto it = index.constFind( name.toUtf8() );
+    return it == index.constEnd() ? nullptr : &entries.at( it.value() );
+}
+
+AccountDatabase::AccountDatabase( const QString& root )
+    : m_root( root )
+{
+    m_passwd.name = QStringLiteral( "passwd" );
+    m_passwd.fieldCount = 7;
+    m_group.name = QStringLiteral( "group" );
+    m_group.fieldCount = 4;
+    m_shadow.name = QStringLiteral( "shadow" );
+    m_shadow.fieldCount = 9;
+    m_shadow.required = false;
+    m_gshadow.name = QStringLiteral( "gshadow" );
+    m_gshadow.fieldCount = 4;
+    m_gshadow.required = false;
+}
+
+AccountDatabase::~AccountDatabase()
+{
+    for ( File* f : { &m_passwd, &m_group, &m_shadow, &m_gshadow } )
+    {
+        unlockFile( *f );
+    }
+    if ( m_lockFd >= 0 )
+    {
+        ::close( m_lockFd );  // Releases the fcntl lock as well
+    }
+}
+
+QString
+AccountDatabase::path( const File& f ) const
+{
+    return QDir( m_root ).filePath( QStringLiteral( "etc/" ) + f.name );
+}
+
+bool
+AccountDatabase::lockFile( File& f )
+{
+    // Like shadow-utils, create <file>.lock containing our PID; a lock
+    // file whose process no longer exists is stale and is removed.
+    const QByteArray lockName = QFile::encodeName( path( f ) + QStringLiteral( ".lock" ) );
+    for ( int attempt = 0; attempt < 2; ++attempt )
+    {
+        int fd = ::open( lockName.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600 );
+        if ( fd >= 0 )
+        {
+            const QByteArray pid = QByteArray::number( qint64( getpid() ) );
+            bool ok = ::write( fd, pid.constData(), size_t( pid.size() ) ) == pid.size();
+            ::close( fd );
+            if ( !ok )
+            {
+                ::unlink( lockName.constData() );
+                return false;
+            }
+            f.locked = true;
+            return true;
+        }
+        if ( errno != EEXIST )
+        {
+            return false;
+        }
+
+        QFile existing( QFile::decodeName( lockName ) );
+        pid_t pid = 0;
+        if ( existing.open( QIODevice::ReadOnly ) )
+        {
+            pid = pid_t( existing.readAll().trimmed().toLongLong() );
+        }
+        if ( pid > 0 && ( ::kill( pid, 0 ) == 0 || errno != ESRCH ) )
+        {
+            cWarning() << "Account file" << path( f ) << "is locked by process" << pid;
+            return false;
+        }
+        cDebug() << "Removing stale lock file" << existing.fileName();
+        ::unlink( lockName.constData() );
+    }
+    return false;
+}
+
+void
+AccountDatabase::unlockFile( File& f )
+{
+    if ( f.locked )
+    {
+        ::unlink( QFile::encodeName( path( f ) + QStringLiteral( ".lock" ) ).constData() );
+        f.locked = false;
+    }
+}
+
+bool
+AccountDatabase::readFile( File& f )
+{
+    QFile file( path( f ) );
+    if ( !file.exists() && !f.required )
+    {
+        return true;
+    }
+    if ( !file.open( QIODevice::ReadOnly ) )
+    {
+        cWarning() << "Could not read account file" << file.fileName();
+        return false;
+    }
+
+    f.exists = true;
+    f.entries.clear();
+    f.index.clear();
+    QList< QByteArray > lines = file.readAll().split( '\n' );
+    if ( !lines.isEmpty() && lines.last().isEmpty() )
+    {
+        lines.removeLast();  // After the trailing newline
+    }
+    for ( const auto& line : qAsConst( lines ) )
+    {
+        // Splitting and joining again is lossless, so lines that
+        // are not valid entries (comments, NIS) survive unchanged.
+        QList< QByteArray > fields = line.split( ':' );
+        const bool isEntry = fields.count() == f.fieldCount && !fields.first().isEmpty()
+            && !line.startsWith( '#' ) && !line.startsWith( '+' ) && !line.startsWith( '-' );
+        if ( isEntry && !f.index.contains( fields.first() ) )
+        {
+            f.index.insert( fields.first(), f.entries.count() );
+        }
+        f.entries.append( fields );
+    }
+    f.modified = false;
+    return true;
+}
+
+bool
+AccountDatabase::writeFile( File& f )
+{
+    if ( !f.modified )
+    {
+        return true;
+    }
+
+    const QString filePath = path( f );
+    struct stat st;
+    const bool hasOriginal = ::stat( QFile::encodeName( filePath ).constData(), &st ) == 0;
+
+    QByteArray data;
+    for ( const auto& fields : qAsConst( f.entries ) )
+    {
+        for ( int i = 0; i < fields.count(); ++i )
+        {
+            if ( i )
+            {
+                data.append( ':' );
+            }
+            data.append( fields.at( i ) );
+        }
+        data.append( '\n' );
+    }
+
+    const QString newPath = filePath + '+';
+    if ( !writeSynced( newPath, data, hasOriginal ? &st : nullptr ) )
+    {
+        cWarning() << "Could not write account file" << newPath;
+        return false;
+    }
+    if ( hasOriginal )
+    {
+        QFile original( filePath );
+        if ( !original.open( QIODevice::ReadOnly )
+             || !writeSynced( filePath + '-', original.readAll(), &st ) )
+        {
+            cWarning() << "Could not back up account file" << filePath;
+        }
+    }
+    if ( ::rename( QFile::encodeName( newPath ).constData(), QFile::encodeName( filePath ).constData() ) )
+    {
+        cWarning() << "Could not replace account file" << filePath;
+        ::unlink( QFile::encodeName( newPath ).constData() );
+        return false;
+    }
+    f.modified = false;
+    return true;
+}
+
+bool
+AccountDatabase::load()
+{
+    if ( m_loaded )
+    {
+        return true;
+    }
+
+    // The password-file lock, as taken by lckpwdf(3)
+    const QString lockPath = QDir( m_root ).filePath( QStringLiteral( "etc/.pwd.lock" ) );
+    m_lockFd = ::open( QFile::encodeName( lockPath ).constData(), O_WRONLY | O_CREAT | O_CLOEXEC, 0600 );
+    if ( m_lockFd < 0 )
+    {
+        cWarning() << "Could not open password-file lock" << lockPath;
+        return false;
+    }
+    struct flock fl = {};
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    int waited = 0;
+    while ( fcntl( m_lockFd, F_SETLK, &fl ) )
+    {
+        if ( ( errno != EACCES && errno != EAGAIN ) || waited >= lockTimeoutMs )
+        {
+            cWarning() << "Could not lock password files in" << m_root;
+            ::close( m_lockFd );
+            m_lockFd = -1;
+            return false;
+        }
+        QThread::msleep( lockIntervalMs );
+        waited += lockIntervalMs;
+    }
+
+    for ( File* f : { &m_passwd, &m_group, &m_shadow, &m_gshadow } )
+    {
+        const bool exists = QFile::exists( path( *f ) );
+        if ( ( exists && !lockFile( *f ) ) || !readFile( *f ) )
+        {
+            for ( File* g : { &m_passwd, &m_group, &m_shadow, &m_gshadow } )
+            {
+                unlockFile( *g );
+            }
+            ::close( m_lockFd );
+            m_lockFd = -1;
+            return false;
+        }
+    }
+
+    // Settings are KEY VALUE, with # comments
+    m_loginDefs.clear();
+    QFile defs( QDir( m_root ).filePath( QStringLiteral( "etc/login.defs" ) ) );
+    if ( defs.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        const QStringList lines = QString::fromLocal8Bit( defs.readAll() ).split( '\n' );
+        for ( const QString& line : lines )
+        {
+            const QStringList parts = line.simplified().split( ' ' );
+            if ( parts.count() >= 2 && !parts.first().startsWith( '#' ) )
+            {
+                m_loginDefs.insert( parts.at( 0 ), parts.at( 1 ) );
+            }
+        }
+    }
+    // The default shell for useradd is KEY=VALUE
+    QFile useradd( QDir( m_root ).filePath( QStringLiteral( "etc/default/useradd" ) ) );
+    if ( useradd.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        const QStringList lines = QString::fromLocal8Bit( useradd.readAll() ).split( '\n' );
+        for ( const QString& line : lines )
+        {
+            if ( line.startsWith( QStringLiteral( "SHELL=" ) ) )
+            {
+                m_defaultShell = line.mid( 6 ).trimmed();
+            }
+        }
+    }
+
+    m_loaded = true;
+    return true;
+}
+
+bool
+AccountDatabase::save()
+{
+    if ( !m_loaded )
+    {
+        return false;
+    }
+    bool ok = true;
+    // Shadow files first, so that passwd never refers to a missing shadow entry
+    for ( File* f : { &m_gshadow, &m_shadow, &m_group, &m_passwd } )
+    {
+        ok = writeFile( *f ) && ok;
+    }
+    return ok;
+}
+
+bool
+AccountDatabase::hasUser( const QString& name ) const
+{
+    return m_passwd.find( name ) != nullptr;
+}
+
+bool
+AccountDatabase::hasGroup( const QString& name ) const
+{
+    return m_group.find( name ) != nullptr;
+}
+
+int
+AccountDatabase::userId( const QString& name ) const
+{
+    const auto* e = m_passwd.find( name );
+    return e ? e->at( 2 ).toInt() : -1;
+}
+
+int
+AccountDatabase::groupId( const QString& name ) const
+{
+    const auto* e = m_group.find( name );
+    return e ? e->at( 2 ).toInt() : -1;
+}
+
+QStringList
+AccountDatabase::groupNames() const
+{
+    QStringList names;
+    for ( const auto& fields : m_group.entries )
+    {
+        if ( m_group.index.contains( fields.first() ) )
+        {
+            names.append( QString::fromUtf8( fields.first() ) );
+        }
+    }
+    return names;
+}
+
+QString
+AccountDatabase::loginDefinition( const QString& key, const QString& defaultValue ) const
+{
+    return m_loginDefs.value( key, defaultValue );
+}
+
+int
+AccountDatabase::loginDefinition( const QString& key, int defaultValue ) const
+{
+    bool ok = false;
+    int v = m_loginDefs.value( key ).toInt( &ok, 0 );
+    return ok ? v : defaultValue;
+}
+
+bool
+AccountDatabase::isIdUsed( const File& f, int id ) const
+{
+    for ( const auto& fields : f.entries )
+    {
+        if ( fields.count() == f.fieldCount && fields.at( 2 ).toInt() == id && f.index.contains( fields.first() ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int
+AccountDatabase::allocateId( const File& f,
+                             const QString& minKey,
+                             int min,
+                             const QString& maxKey,
+                             int max,
+                             bool down ) const
+{
+    const int lo = loginDefinition( minKey, min );
+    const int hi = loginDefinition( maxKey, max );
+    if ( lo > hi )
+    {
+        return -1;
+    }
+
+    QSet< int > used;
+    for ( const auto& fields : f.entries )
+    {
+        bool ok = false;
+        int id = fields.count() == f.fieldCount ? fields.at( 2 ).toInt( &ok ) : -1;
+        if ( ok && id >= lo && id <= hi )
+        {
+            used.insert( id );
+        }
+    }
+
+    // Like shadow-utils, continue after the last-used ID (counting
+    // down for system IDs), and only fill holes when that runs out.
+    if ( used.isEmpty() )
+    {
+        return down ? hi : lo;
+    }
+    int next = down ? *std::min_element( used.cbegin(), used.cend() ) - 1
+                    : *std::max_element( used.cbegin(), used.cend() ) + 1;
+    if ( next >= lo && next <= hi )
+    {
+        return next;
+    }
+    for ( int id = down ? hi : lo; id >= lo && id <= hi; id += down ? -1 : 1 )
+    {
+        if ( !used.contains( id ) )
+        {
+            return id;
+        }
+    }
+    return -1;
+}
+
+int
+AccountDatabase::addGroup( const QString& name, bool system )
+{
+    if ( !m_loaded || name.isEmpty() || hasGroup( name ) )
+    {
+        return -1;
+    }
+
+    const int gidMin = loginDefinition( QStringLiteral( "GID_MIN" ), 1000 );
+    const int gid = system
+        ? allocateId( m_group, QStringLiteral( "SYS_GID_MIN" ), 101, QStringLiteral( "SYS_GID_MAX" ), gidMin - 1, true )
+        : allocateId( m_group, QStringLiteral( "GID_MIN" ), 1000, QStringLiteral( "GID_MAX" ), 60000, false );
+    if ( gid < 0 )
+    {
+        cWarning() << "No free GID for group" << name;
+        return -1;
+    }
+
+    m_group.append( { name.toUtf8(), QByteArray( "x" ), QByteArray::number( gid ), QByteArray() } );
+    if ( m_gshadow.exists )
+    {
+        m_gshadow.append( { name.toUtf8(), QByteArray( "!" ), QByteArray(), QByteArray() } );
+    }
+    return gid;
+}
+
+int
+AccountDatabase::addUser( const QString& name, const QString& fullName, const QString& home, const QString& shell )
+{
+    if ( !m_loaded || name.isEmpty() || hasUser( name ) || hasGroup( name ) )
+    {
+        return -1;
+    }
+
+    const int uid
+        = allocateId( m_passwd, QStringLiteral( "UID_MIN" ), 1000, QStringLiteral( "UID_MAX" ), 60000, false );
+    if ( uid < 0 )
+    {
+        cWarning() << "No free UID for user" << name;
+        return -1;
+    }
+    // The user's own group gets the same number, if it's free
+    const int gid = isIdUsed( m_group, uid )
+        ? allocateId( m_group, QStringLiteral( "GID_MIN" ), 1000, QStringLiteral( "GID_MAX" ), 60000, false )
+        : uid;
+    if ( gid < 0 )
+    {
+        cWarning() << "No free GID for user" << name;
+        return -1;
+    }
+
+    // The GECOS field can't contain the separators
+    QString gecos = fullName;
+    gecos.replace( ':', ' ' ).replace( '\n', ' ' );
+
+    m_passwd.append( { name.toUtf8(),
+                       QByteArray( "x" ),
+                       QByteArray::number( uid ),
+                       QByteArray::number( gid ),
+                       gecos.toUtf8(),
+                       QFile::encodeName( home ),
+                       QFile::encodeName( shell.isEmpty() ? m_defaultShell : shell ) } );
+    if ( m_shadow.exists )
+    {
+        m_shadow.append( { name.toUtf8(),
+                           QByteArray( "!" ),
+                           daysSinceEpoch(),
+                           loginDefinition( QStringLiteral( "PASS_MIN_DAYS" ) ).toUtf8(),
+                           loginDefinition( QStringLiteral( "PASS_MAX_DAYS" ) ).toUtf8(),
+                           loginDefinition( QStringLiteral( "PASS_WARN_AGE" ) ).toUtf8(),
+                           QByteArray(),
+                           QByteArray(),
+                           QByteArray() } );
+    }
+    m_group.append( { name.toUtf8(), QByteArray( "x" ), QByteArray::number( gid ), QByteArray() } );
+    if ( m_gshadow.exists )
+    {
+        m_gshadow.append( { name.toUtf8(), QByteArray( "!" ), QByteArray(), QByteArray() } );
+    }
+    return uid;
+}
+
+/// @brief Adds @p user to the comma-separated list in field @p field
+static void
+addMember( QList< QByteArray >& fields, int field, const QByteArray& user )
+{
+    QList< QByteArray > members = fields.at( field ).split( ',' );
+    members.removeAll( QByteArray() );
+    if ( !members.contains( user ) )
+    {
+        members.append( user );
+    }
+    QByteArray joined;
+    for ( const auto& m : qAsConst( members ) )
+    {
+        if ( !joined.isEmpty() )
+        {
+            joined.append( ',' );
+        }
+        joined.append( m );
+    }
+    fields[ field ] = joined;
+}
+
+bool
+AccountDatabase::addUserToGroups( const QString& user, const QStringList& groups )
+{
+    if ( !m_loaded || !hasUser( user ) )
+    {
+        return false;
+    }
+    for ( const QString& g : groups )
+    {
+        if ( !hasGroup( g ) )
+        {
+            cWarning() << "Group" << g << "does not exist for user" << user;
+            return false;
+        }
+    }
+
+    const QByteArray name = user.toUtf8();
+    for ( const QString& g : groups )
+    {
+        addMember( *m_group.find( g ), 3, name );
+        m_group.modified = true;
+        auto* gshadow = m_gshadow.find( g );
+        if ( gshadow )
+        {
+            addMember( *gshadow, 3, name );
+            m_gshadow.modified = true;
+        }
+    }
+    return true;
+}
+
+bool
+AccountDatabase::setPassword( const QString& user, const QString& encrypted )
+{
+    auto* shadow = m_shadow.find( user );
+    if ( shadow )
+    {
+        ( *shadow )[ 1 ] = encrypted.toUtf8();
+        ( *shadow )[ 2 ] = daysSinceEpoch();
+        m_shadow.modified = true;
+        return true;
+    }
+    auto* passwd = m_passwd.find( user );
+    if ( passwd )
+    {
+        ( *passwd )[ 1 ] = encrypted.toUtf8();
+        m_passwd.modified = true;
+        return true;
+    }
+    return false;
+}
+
+bool
+AccountDatabase::disablePassword( const QString& user )
+{
+    // passwd -d empties the password, -l then prefixes a !
+    return setPassword( user, QStringLiteral( "!" ) );
+}
+
+}  // namespace CalamaresUtils
@@ -0,0 +1,162 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+/*
+ * Native editing of the account database (passwd, group, shadow and
+ * gshadow) of a target system. Creating a user with useradd, usermod,
+ * groupadd and passwd costs a process spawn (into a chroot) for each
+ * step; the AccountDatabase reads the files once, makes all the changes
+ * in memory, and writes each changed file back atomically.
+ */
+
+#ifndef UTILS_ACCOUNTS_H
+#define UTILS_ACCOUNTS_H
+
+#include "DllMacro.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+namespace CalamaresUtils
+{
+
+/** @brief The account database of a (target) system
+ *
+ * The database consists of etc/passwd, etc/group, etc/shadow and
+ * etc/gshadow below a given root (shadow files are optional). The
+ * semantics follow shadow-utils:
+ *  - load() takes the password-file lock (etc/.pwd.lock, with fcntl,
+ *    like lckpwdf(3)) and a lock file <file>.lock for each file,
+ *    then reads the files. The locks are held until the database
+ *    is destroyed.
+ *  - save() writes each **changed** file to <file>+, keeping the
+ *    mode and owner of the original, syncs it, saves the original
+ *    as <file>- and then renames <file>+ over the original.
+ *  - IDs are allocated in the ranges from etc/login.defs, with
+ *    regular IDs counting up and system IDs counting down.
+ *
+ * Lines that are not understood (comments, NIS entries) are kept
+ * exactly as they are. The database is not thread-safe.
+ */
+class DLLEXPORT AccountDatabase
+{
+public:
+    explicit AccountDatabase( const QString& root );
+    AccountDatabase( const AccountDatabase& ) = delete;
+    AccountDatabase& operator=( const AccountDatabase& ) = delete;
+    /// @brief Releases the locks; unsaved changes are lost
+    ~AccountDatabase();
+
+    /** @brief Locks and reads the account files
+     *
+     * Returns @c false if the files cannot be locked (e.g. some other
+     * tool is editing them) or passwd or group cannot be read.
+     */
+    bool load();
+    /** @brief Writes the changed files back
+     *
+     * Returns @c false if any file could not be written; files that
+     * were already written stay written.
+     */
+    bool save();
+
+    bool isLoaded() const { return m_loaded; }
+    QString root() const { return m_root; }
+
+    bool hasUser( const QString& name ) const;
+    bool hasGroup( const QString& name ) const;
+    /// @brief The UID of user @p name, or -1
+    int userId( const QString& name ) const;
+    /// @brief The GID of group @p name, or -1
+    int groupId( const QString& name ) const;
+    /// @brief The names of all the groups, in file order
+    QStringList groupNames() const;
+
+    /** @brief Adds a group, like groupadd(8)
+     *
+     * A system group gets a GID from the SYS_GID range. Returns the
+     * new GID, or -1 if the group exists or no GID is available.
+     */
+    int addGroup( const QString& name, bool system = false );
+    /** @brief Adds a user, like `useradd -U`
+     *
+     * The user gets a UID from the UID range, and a group with the
+     * same name as the user (with GID equal to the UID, if possible)
+     * as primary group. The password is locked. If @p shell is empty,
+     * the SHELL from etc/default/useradd is used. Returns the new UID,
+     * or -1 if the user (or the group) exists or no ID is available.
+     * This does not create the home directory.
+     */
+    int addUser( const QString& name, const QString& fullName, const QString& home, const QString& shell );
+    /** @brief Adds @p user to the supplementary @p groups, like `usermod -aG`
+     *
+     * Returns @c false if the user or any of the groups does not exist,
+     * in which case nothing is changed.
+     */
+    bool addUserToGroups( const QString& user, const QStringList& groups );
+    /// @brief Sets the (already encrypted) password of @p user, like `usermod -p`
+    bool setPassword( const QString& user, const QString& encrypted );
+    /// @brief Deletes and locks the password of @p user, like `passwd -dl`
+    bool disablePassword( const QString& user );
+
+    /** @brief A setting from etc/login.defs, or @p defaultValue
+     *
+     * The file is read by load().
+     */
+    QString loginDefinition( const QString& key, const QString& defaultValue = QString() ) const;
+    /// @brief Numeric setting (decimal, or octal with a leading 0) from etc/login.defs
+    int loginDefinition( const QString& key, int defaultValue ) const;
+
+private:
+    /// @brief One of the account files, as a list of colon-separated entries
+    struct File
+    {
+        QString name;  ///< e.g. "passwd"
+        int fieldCount = 0;  ///< Number of fields in a valid entry
+        bool required = true;  ///< Is it an error if the file doesn't exist?
+        bool exists = false;
+        bool modified = false;
+        bool locked = false;
+        QList< QList< QByteArray > > entries;
+        QHash< QByteArray, int > index;  ///< Index in entries, by name
+
+        /// @brief Adds an entry, updating the index
+        void append( const QList< QByteArray >& fields );
+        /// @brief The entry for @p name, or nullptr
+        QList< QByteArray >* find( const QString& name );
+        const QList< QByteArray >* find( const QString& name ) const;
+    };
+
+    QString path( const File& f ) const;
+    bool lockFile( File& f );
+    void unlockFile( File& f );
+    bool readFile( File& f );
+    bool writeFile( File& f );
+    /// @brief Allocates an ID not used in @p f (field 2) in the given range
+    int allocateId( const File& f, const QString& minKey, int min, const QString& maxKey, int max, bool down ) const;
+    bool isIdUsed( const File& f, int id ) const;
+
+    QString m_root;
+    File m_passwd;
+    File m_group;
+    File m_shadow;
+    File m_gshadow;
+    QHash< QString, QString > m_loginDefs;
+    QString m_defaultShell;  ///< From etc/default/useradd
+    int m_lockFd = -1;
+    bool m_loaded = false;
+};
+
+}  // namespace CalamaresUtils
+
+#endif
@@ -14,12 +14,23 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "Settings.h"
+#include "utils/ChrootSession.h"
 #include "utils/Logger.h"
+#include "utils/Scheduling.h"
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
 #include <QProcess>
 #include <QRegularExpression>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <vector>
 
 #ifdef Q_OS_LINUX
 #include <sys/sysinfo.h>
@@ -74,6 +85,68 @@ operator<<( QDebug& s, const RedactedList& l )
     return s;
 }
 
+/** @brief A process that applies the scheduling policy before exec()
+ *
+ * The policy of the running job is prepared when the process is
+ * created, and applied in the child, so that the command (and any
+ * threads or processes it starts) never runs without it.
+ */
+class ScheduledProcess : public QProcess
+{
+public:
+    ScheduledProcess()
+        : m_setup( CalamaresUtils::SchedulingPolicy::current() )
+    {
+    }
+
+protected:
+    void setupChildProcess() override { m_setup.apply(); }
+
+private:
+    const CalamaresUtils::SchedulingPolicy::ChildSetup m_setup;
+};
+
+/** @brief Logs the result of running @p args
+ *
+ * Special (negative) exit codes are logged as a warning, since there
+ * is no output to show; for regular exit codes the output is logged
+ * if there is an error, or in debug mode.
+ */
+static void
+logProcessResult( const QStringList& args, int r, const QString& output, std::chrono::seconds timeoutSec )
+{
+    if ( r < 0 )
+    {
+        cWarning() << "Process" << args.first() << "failed, code" << r << "(timeout" << timeoutSec.count() << "s)";
+        return;
+    }
+
+    bool showDebug = ( !Calamares::Settings::instance() ) || ( Calamares::Settings::instance()->debugMode() );
+    if ( r == 0 )
+    {
+        if ( showDebug && !output.isEmpty() )
+        {
+            cDebug() << Logger::SubEntry << "Finished. Exit code:" << r << "output:\n" << Logger::NoQuote << output;
+        }
+        else
+        {
+            cDebug() << Logger::SubEntry << "Finished. Exit code:" << r;
+        }
+    }
+    else  // if ( r != 0 )
+    {
+        if ( !output.isEmpty() )
+        {
+            cDebug() << Logger::SubEntry << "Target cmd:" << RedactedList( args ) << "Exit code:" << r << "output:\n"
+                     << Logger::NoQuote << output;
+        }
+        else
+        {
+            cDebug() << Logger::SubEntry << "Target cmd:" << RedactedList( args ) << "Exit code:" << r << "(no output)";
+        }
+    }
+}
+
 namespace CalamaresUtils
 {
 
@@ -93,7 +166,13 @@ System::System( bool doChroot, QObject* parent )
 }
 
 
-System::~System() {}
+System::~System()
+{
+    if ( s_instance == this )
+    {
+        s_instance = nullptr;
+    }
+}
 
 
 System*
@@ -109,12 +188,81 @@ System::instance()
 }
 
 
+/** @brief Passes @p line (with its line ending) to @p lineHandler, and adds it to @p output
+ */
+static void
+handleLine( const QByteArray& line, const System::OutputHandler& lineHandler, QString& output )
+{
+    const QString s = QString::fromLocal8Bit( line );
+    output.append( s );
+    const QString trimmed = s.trimmed();
+    if ( !trimmed.isEmpty() )
+    {
+        lineHandler( trimmed );
+    }
+}
+
+/** @brief Handles the complete lines in @p buffer, and removes them
+ *
+ * Carriage returns also end a line, since that is how progress
+ * bars redraw themselves; those lines are handled as soon as
+ * they are complete, too.
+ */
+static void
+handleLines( QByteArray& buffer, const System::OutputHandler& lineHandler, QString& output )
+{
+    auto lineEnd = [&buffer]() {
+        const int cr = buffer.indexOf( '\r' );
+        const int nl = buffer.indexOf( '\n' );
+        return ( cr < 0 || nl < 0 ) ? qMax( cr, nl ) : qMin( cr, nl );
+    };
+    for ( int end = lineEnd(); end >= 0; end = lineEnd() )
+    {
+        handleLine( buffer.left( end + 1 ), lineHandler, output );
+        buffer.remove( 0, end + 1 );
+    }
+}
+
+/** @brief Reads the output of @p process a line at a time, until it exits
+ *
+ * Returns @c false if the process did not finish within @p timeoutMs
+ * milliseconds (-1 to wait forever).
+ */
+static bool
+readLines( QProcess& process, int timeoutMs, const System::OutputHandler& lineHandler, QString& output )
+{
+    QElapsedTimer timer;
+    timer.start();
+    QByteArray buffer;
+    while ( process.state() != QProcess::NotRunning )
+    {
+        const int remaining = timeoutMs < 0 ? -1 : int( timeoutMs - timer.elapsed() );
+        if ( timeoutMs >= 0 && remaining <= 0 )
+        {
+            return false;
+        }
+        // Returns false when the process exits, too
+        process.waitForReadyRead( remaining );
+        buffer.append( process.readAll() );
+        handleLines( buffer, lineHandler, output );
+    }
+    buffer.append( process.readAll() );
+    handleLines( buffer, lineHandler, output );
+    // Last line may lack a line ending
+    if ( !buffer.isEmpty() )
+    {
+        handleLine( buffer, lineHandler, output );
+    }
+    return true;
+}
+
 ProcessResult
 System::runCommand( System::RunLocation location,
                     const QStringList& args,
                     const QString& workingPath,
                     const QString& stdInput,
-                    std::chrono::seconds timeoutSec )
+                    std::chrono::seconds timeoutSec,
+                    const OutputHandler& lineHandler )
 {
     if ( args.isEmpty() )
     {
@@ -133,10 +281,11 @@ System::runCommand( System::RunLocation location,
 
     QString program;
     QStringList arguments( args );
+    QString destDir;
 
     if ( location == System::RunLocation::RunInTarget )
     {
-        QString destDir = gs->value( "rootMountPoint" ).toString();
+        destDir = gs->value( "rootMountPoint" ).toString();
         if ( !QDir( destDir ).exists() )
         {
             cWarning() << "rootMountPoint points to a dir which does not exist";
@@ -151,7 +300,8 @@ System::runCommand( System::RunLocation location,
         program = "env";
     }
 
-    QProcess process;
+    // Commands may be started from other threads than the job's
+    ScheduledProcess process;
     process.setProgram( program );
     process.setArguments( arguments );
     process.setProcessChannelMode( QProcess::MergedChannels );
@@ -169,6 +319,22 @@ System::runCommand( System::RunLocation location,
         }
     }
 
+    // The chroot helper only reports output once the command is done,
+    // so commands whose output is wanted as it happens do not use it.
+    if ( location == System::RunLocation::RunInTarget && !lineHandler && s_instance
+         && Calamares::Settings::instance()
+         && Calamares::Settings::instance()->chrootHelper() )
+    {
+        // The helper runs from / in the target, like chroot(8) does
+        cDebug() << "Running (in chroot helper)" << RedactedList( args );
+        ProcessResult r( ProcessResult::Code::FailedToStart );
+        if ( s_instance->runInChrootSession( r, destDir, args, stdInput, timeoutSec ) )
+        {
+            logProcessResult( args, r.getExitCode(), r.getOutput(), timeoutSec );
+            return r;
+        }
+    }
+
     cDebug() << "Running" << program << RedactedList( arguments );
     process.start();
     if ( !process.waitForStarted() )
@@ -183,16 +349,32 @@ System::runCommand( System::RunLocation location,
     }
     process.closeWriteChannel();
 
-    if ( !process.waitForFinished( timeoutSec > std::chrono::seconds::zero()
-                                       ? ( static_cast< int >( std::chrono::milliseconds( timeoutSec ).count() ) )
-                                       : -1 ) )
+    const int timeoutMs = timeoutSec > std::chrono::seconds::zero()
+        ? ( static_cast< int >( std::chrono::milliseconds( timeoutSec ).count() ) )
+        : -1;
+    QString output;
+    if ( lineHandler )
     {
-        cWarning() << "Process" << args.first() << "timed out after" << timeoutSec.count() << "s. Output so far:\n"
-                   << Logger::NoQuote << process.readAllStandardOutput();
-        return ProcessResult::Code::TimedOut;
+        if ( !readLines( process, timeoutMs, lineHandler, output ) )
+        {
+            cWarning() << "Process" << args.first() << "timed out after" << timeoutSec.count()
+                       << "s. Output so far:\n"
+                       << Logger::NoQuote << output;
+            return ProcessResult::Code::TimedOut;
+        }
+        output = output.trimmed();
+    }
+    else
+    {
+        if ( !process.waitForFinished( timeoutMs ) )
+        {
+            cWarning() << "Process" << args.first() << "timed out after" << timeoutSec.count()
+                       << "s. Output so far:\n"
+                       << Logger::NoQuote << process.readAllStandardOutput();
+            return ProcessResult::Code::TimedOut;
+        }
+        output = QString::fromLocal8Bit( process.readAllStandardOutput() ).trimmed();
     }
-
-    QString output = QString::fromLocal8Bit( process.readAllStandardOutput() ).trimmed();
 
     if ( process.exitStatus() == QProcess::CrashExit )
     {
@@ -201,31 +383,50 @@ System::runCommand( System::RunLocation location,
     }
 
     auto r = process.exitCode();
-    bool showDebug = ( !Calamares::Settings::instance() ) || ( Calamares::Settings::instance()->debugMode() );
-    if ( r == 0 )
+    logProcessResult( args, r, output, timeoutSec );
+    return ProcessResult( r, output );
+}
+
+bool
+System::runInChrootSession( ProcessResult& result,
+                            const QString& root,
+                            const QStringList& args,
+                            const QString& stdInput,
+                            std::chrono::seconds timeoutSec )
+{
+    // If another thread is using the helper, don't wait for it
+    if ( !m_chrootSessionMutex.tryLock() )
     {
-        if ( showDebug && !output.isEmpty() )
-        {
-            cDebug() << Logger::SubEntry << "Finished. Exit code:" << r << "output:\n" << Logger::NoQuote << output;
-        }
-        else
-        {
-            cDebug() << Logger::SubEntry << "Finished. Exit code:" << r;
-        }
+        return false;
     }
-    else  // if ( r != 0 )
+
+    if ( !m_chrootSession || m_chrootSession->root() != root )
     {
-        if ( !output.isEmpty() )
-        {
-            cDebug() << Logger::SubEntry << "Target cmd:" << RedactedList( args ) << "Exit code:" << r << "output:\n"
-                     << Logger::NoQuote << output;
-        }
-        else
+        m_chrootSession = std::make_unique< ChrootSession >( root );
+    }
+    // An invalid session is not retried for this root, until it is stopped
+    bool ok = m_chrootSession->isValid();
+    if ( ok )
+    {
+        result = m_chrootSession->run( args, QString(), stdInput, timeoutSec );
+        ok = m_chrootSession->isValid();
+        if ( !ok )
         {
-            cDebug() << Logger::SubEntry << "Target cmd:" << RedactedList( args ) << "Exit code:" << r << "(no output)";
+            cWarning() << "Chroot helper for" << root << "failed, falling back to chroot.";
         }
     }
-    return ProcessResult( r, output );
+    m_chrootSessionMutex.unlock();
+    return ok;
+}
+
+void
+System::stopChrootSession()
+{
+    if ( s_instance )
+    {
+        QMutexLocker lock( &s_instance->m_chrootSessionMutex );
+        s_instance->m_chrootSession.reset();
+    }
 }
 
 /// @brief Cheap check if a path is absolute.
@@ -380,6 +581,82 @@ System::getTotalMemoryB() const
 }
 
 
+quint64
+System::getAvailableMemoryB() const
+{
+#ifdef Q_OS_LINUX
+    QFile meminfo( "/proc/meminfo" );
+    if ( meminfo.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        while ( !meminfo.atEnd() )
+        {
+            // Looks like "MemAvailable:    1234567 kB"
+            const QByteArray line = meminfo.readLine();
+            if ( line.startsWith( "MemAvailable:" ) )
+            {
+                const QList< QByteArray > fields = line.simplified().split( ' ' );
+                if ( fields.count() >= 2 )
+                {
+                    return fields.at( 1 ).toULongLong() * 1024;
+                }
+            }
+        }
+    }
+#endif
+    return getTotalMemoryB().first;
+}
+
+int
+System::boundedWorkerCount( quint64 memoryPerWorker ) const
+{
+    int workers = qMax( 1, QThread::idealThreadCount() );
+    const quint64 available = getAvailableMemoryB();
+    if ( available && memoryPerWorker )
+    {
+        workers = int( qMin( quint64( workers ), available / memoryPerWorker ) );
+    }
+    return qMax( 1, workers );
+}
+
+QList< ProcessResult >
+System::targetEnvCommands( const QList< QStringList >& commands,
+                           int workers,
+                           const std::function< void( int ) >& finished )
+{
+    std::vector< ProcessResult > results( commands.count(), ProcessResult::Code::FailedToStart );
+    QSemaphore done;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount( qMax( 1, workers ) );
+    for ( int i = 0; i < commands.count(); ++i )
+    {
+        const QStringList args = commands.at( i );
+        ProcessResult* r = &results[ i ];
+        QtConcurrent::run( &pool, [ this, args, r, &done ] {
+            *r = targetEnvCommand( args );
+            done.release();
+        } );
+    }
+    // Report from this thread, as each command finishes (in any order)
+    for ( int i = 1; i <= commands.count(); ++i )
+    {
+        done.acquire();
+        if ( finished )
+        {
+            finished( i );
+        }
+    }
+    pool.waitForDone();
+
+    QList< ProcessResult > l;
+    l.reserve( int( results.size() ) );
+    for ( const auto& r : results )
+    {
+        l.append( r );
+    }
+    return l;
+}
+
 QString
 System::getCpuDescription() const
 {
@@ -15,14 +15,18 @@
 
 #include "Job.h"
 
+#include <QMutex>
 #include <QObject>
 #include <QPair>
 #include <QString>
 
 #include <chrono>
+#include <functional>
+#include <memory>
 
 namespace CalamaresUtils
 {
+class ChrootSession;
 class ProcessResult : public QPair< int, QString >
 {
 public:
@@ -139,6 +143,13 @@ public:
         RunInTarget
     };
 
+    /** @brief Receives the output of a command, one line at a time
+     *
+     * The line has its trailing newline removed. A line that redraws
+     * itself with carriage returns is passed in pieces.
+     */
+    using OutputHandler = std::function< void( const QString& ) >;
+
     /** @brief Runs a command in the host or the target (select explicitly)
      *
      * @param location whether to run in the host or the target
@@ -149,6 +160,9 @@ public:
      *        standard input (optional).
      * @param timeoutSec the timeout after which the process will be
      *        killed (optional, default is 0 i.e. no timeout).
+     * @param lineHandler called (in the calling thread) with each line
+     *        of output as the command produces it (optional). The whole
+     *        output is still returned in the result.
      *
      * @returns the program's exit code and its output (if any). Special
      *     exit codes (which will never have any output) are:
@@ -161,7 +175,8 @@ public:
                                                const QStringList& args,
                                                const QString& workingPath = QString(),
                                                const QString& stdInput = QString(),
-                                               std::chrono::seconds timeoutSec = std::chrono::seconds( 0 ) );
+                                               std::chrono::seconds timeoutSec = std::chrono::seconds( 0 ),
+                                               const OutputHandler& lineHandler = nullptr );
 
     /** @brief Convenience wrapper for runCommand() in the host
      *
@@ -188,6 +203,20 @@ public:
             m_doChroot ? RunLocation::RunInTarget : RunLocation::RunInHost, args, workingPath, stdInput, timeoutSec );
     }
 
+    /** @brief Runs several commands in the target, concurrently
+     *
+     * Each of @p commands is run like targetEnvCommand() (without working
+     * directory, input or timeout), with at most @p workers running at
+     * a time. Each time a command finishes, @p finished is called -- in
+     * the calling thread -- with the number of commands finished so far,
+     * which is useful for progress reporting.
+     *
+     * Returns the results in the order of @p commands.
+     */
+    DLLEXPORT QList< ProcessResult > targetEnvCommands( const QList< QStringList >& commands,
+                                                        int workers,
+                                                        const std::function< void( int ) >& finished = nullptr );
+
     /** @brief Convenience wrapper for targetEnvCommand() which returns only the exit code */
     inline int targetEnvCall( const QStringList& args,
                               const QString& workingPath = QString(),
@@ -321,6 +350,21 @@ public:
      */
     DLLEXPORT QPair< quint64, float > getTotalMemoryB() const;
 
+    /** @brief The memory available for new work, in bytes
+     *
+     * On Linux, this is MemAvailable from /proc/meminfo (an estimate
+     * that includes reclaimable cache); elsewhere it is the total memory.
+     * Returns 0 if nothing can be found.
+     */
+    DLLEXPORT quint64 getAvailableMemoryB() const;
+
+    /** @brief Number of memory-hungry workers that can run at once
+     *
+     * This is the number of CPUs, but no more than fit in the available
+     * memory at @p memoryPerWorker bytes each, and at least 1.
+     */
+    DLLEXPORT int boundedWorkerCount( quint64 memoryPerWorker ) const;
+
     /**
      * @brief getCpuDescription returns a string describing the CPU.
      *
@@ -337,10 +381,34 @@ public:
 
     DLLEXPORT bool doChroot() const;
 
+    /** @brief Stops the persistent chroot helper, if one is running.
+     *
+     * When *chroot-helper* is set in `settings.conf`, commands run in
+     * the target go through a helper process (see ChrootSession) which
+     * is started on demand. The helper keeps the target root busy,
+     * so it is stopped after each job (the next job starts a new one).
+     * This is safe to call when there is no System instance.
+     */
+    static DLLEXPORT void stopChrootSession();
+
 private:
+    /** @brief Runs @p args in the persistent chroot helper for @p root
+     *
+     * Returns @c false if the helper cannot be used right now (e.g.
+     * because it is busy with another command, or failed to start),
+     * in which case the caller should run the command itself.
+     */
+    bool runInChrootSession( ProcessResult& result,
+                             const QString& root,
+                             const QStringList& args,
+                             const QString& stdInput,
+                             std::chrono::seconds timeoutSec );
+
     static System* s_instance;
 
     bool m_doChroot;
+    QMutex m_chrootSessionMutex;
+    std::unique_ptr< ChrootSession > m_chrootSession;
 };
 
 }  // namespace CalamaresUtils
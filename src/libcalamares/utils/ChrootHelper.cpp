@@ -0,0 +1,297 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+/*
+ * The chroot helper program, calamares-chroot-helper, which is
+ * started by ChrootSession. Usage:
+ *
+ *      calamares-chroot-helper <root>
+ *
+ * The standard input is the socket to ChrootSession. The helper
+ * enters the root, and then runs the commands it receives until
+ * the socket is closed.
+ *
+ * This is a program of its own, rather than a fork() of Calamares,
+ * because the child of a multithreaded process may only make
+ * async-signal-safe calls until it exec()s something.
+ */
+
+#include "ChrootSession_p.h"
+
+#include <chrono>
+#include <csignal>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+
+namespace
+{
+using namespace ChrootProtocol;
+
+struct Request
+{
+    std::vector< std::string > args;
+    std::string workingPath;
+    std::string input;
+    uint32_t timeoutSec = 0;
+};
+
+/** @brief Runs one command in the helper
+ *
+ * Returns the exit code (or one of the special codes) and fills
+ * @p output with the merged stdout and stderr of the command.
+ */
+int
+executeRequest( const Request& request, std::string& output )
+{
+    if ( request.args.empty() )
+    {
+        return int( Code::FailedToStart );
+    }
+
+    int inPipe[ 2 ] = { -1, -1 };
+    int outPipe[ 2 ] = { -1, -1 };
+    int errorPipe[ 2 ] = { -1, -1 };  // Reports exec() failures
+    if ( pipe2( inPipe, O_CLOEXEC ) || pipe2( outPipe, O_CLOEXEC ) || pipe2( errorPipe, O_CLOEXEC ) )
+    {
+        for ( int* p : { inPipe, outPipe, errorPipe } )
+        {
+            closeFd( p[ 0 ] );
+            closeFd( p[ 1 ] );
+        }
+        return int( Code::FailedToStart );
+    }
+
+    std::vector< char* > argv;
+    for ( const auto& a : request.args )
+    {
+        argv.push_back( const_cast< char* >( a.c_str() ) );
+    }
+    argv.push_back( nullptr );
+
+    const pid_t pid = fork();
+    if ( pid == 0 )
+    {
+        // dup2() clears close-on-exec for the new descriptors
+        dup2( inPipe[ 0 ], STDIN_FILENO );
+        dup2( outPipe[ 1 ], STDOUT_FILENO );
+        dup2( outPipe[ 1 ], STDERR_FILENO );
+        signal( SIGPIPE, SIG_DFL );
+        sigset_t none;
+        sigemptyset( &none );
+        sigprocmask( SIG_SETMASK, &none, nullptr );
+
+        int code = int( Code::NoWorkingDirectory );
+        if ( request.workingPath.empty() || chdir( request.workingPath.c_str() ) == 0 )
+        {
+            execvp( argv[ 0 ], argv.data() );
+            code = int( Code::FailedToStart );
+        }
+        ssize_t ignored = write( errorPipe[ 1 ], &code, sizeof( code ) );
+        (void)ignored;
+        _exit( 127 );
+    }
+
+    closeFd( inPipe[ 0 ] );
+    closeFd( outPipe[ 1 ] );
+    closeFd( errorPipe[ 1 ] );
+    if ( pid < 0 )
+    {
+        closeFd( inPipe[ 1 ] );
+        closeFd( outPipe[ 0 ] );
+        closeFd( errorPipe[ 0 ] );
+        return int( Code::FailedToStart );
+    }
+
+    // This read returns 0 bytes once exec() succeeds and closes the pipe
+    int startError = 0;
+    const bool failedToStart
+        = readFully( errorPipe[ 0 ], reinterpret_cast< char* >( &startError ), sizeof( startError ) );
+    closeFd( errorPipe[ 0 ] );
+    if ( failedToStart )
+    {
+        closeFd( inPipe[ 1 ] );
+        closeFd( outPipe[ 0 ] );
+        waitpid( pid, nullptr, 0 );
+        return startError;
+    }
+
+    size_t inputWritten = 0;
+    if ( request.input.empty() )
+    {
+        closeFd( inPipe[ 1 ] );
+    }
+    else
+    {
+        fcntl( inPipe[ 1 ], F_SETFL, fcntl( inPipe[ 1 ], F_GETFL ) | O_NONBLOCK );
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::seconds( request.timeoutSec );
+    int status = 0;
+    bool exited = false;
+    char buffer[ 4096 ];
+    for ( ;; )
+    {
+        if ( !exited && waitpid( pid, &status, WNOHANG ) == pid )
+        {
+            exited = true;
+        }
+        if ( exited && outPipe[ 0 ] < 0 )
+        {
+            break;
+        }
+        if ( !exited && request.timeoutSec > 0 && Clock::now() >= deadline )
+        {
+            kill( pid, SIGKILL );
+            waitpid( pid, nullptr, 0 );
+            closeFd( inPipe[ 1 ] );
+            closeFd( outPipe[ 0 ] );
+            output.clear();
+            return int( Code::TimedOut );
+        }
+
+        pollfd fds[ 2 ];
+        nfds_t count = 0;
+        if ( outPipe[ 0 ] >= 0 )
+        {
+            fds[ count++ ] = { outPipe[ 0 ], POLLIN, 0 };
+        }
+        if ( inPipe[ 1 ] >= 0 )
+        {
+            fds[ count++ ] = { inPipe[ 1 ], POLLOUT, 0 };
+        }
+        // Poll briefly, so that process exit and the deadline are noticed;
+        // once the process has exited, only collect what is already there
+        // (background processes may keep the output open).
+        const int ready = poll( fds, count, exited ? 0 : 50 );
+        if ( ready < 0 && errno != EINTR )
+        {
+            break;
+        }
+        if ( exited && ready <= 0 )
+        {
+            break;
+        }
+
+        for ( nfds_t i = 0; i < count && ready > 0; ++i )
+        {
+            if ( !fds[ i ].revents )
+            {
+                continue;
+            }
+            if ( fds[ i ].fd == outPipe[ 0 ] )
+            {
+                const ssize_t n = read( outPipe[ 0 ], buffer, sizeof( buffer ) );
+                if ( n > 0 )
+                {
+                    output.append( buffer, size_t( n ) );
+                }
+                else if ( n == 0 || errno != EINTR )
+                {
+                    closeFd( outPipe[ 0 ] );
+                }
+            }
+            else if ( fds[ i ].fd == inPipe[ 1 ] )
+            {
+                const ssize_t n = write(
+                    inPipe[ 1 ], request.input.data() + inputWritten, request.input.size() - inputWritten );
+                if ( n > 0 )
+                {
+                    inputWritten += size_t( n );
+                }
+                if ( ( n < 0 && errno != EAGAIN && errno != EINTR ) || inputWritten >= request.input.size() )
+                {
+                    closeFd( inPipe[ 1 ] );
+                }
+            }
+        }
+    }
+
+    closeFd( inPipe[ 1 ] );
+    closeFd( outPipe[ 0 ] );
+    if ( !exited )
+    {
+        waitpid( pid, &status, 0 );
+    }
+    return WIFEXITED( status ) ? WEXITSTATUS( status ) : int( Code::Crashed );
+}
+
+/// @brief Main loop of the helper; never returns
+[[noreturn]] void
+serve( int fd, const std::string& root )
+{
+    // An ignored SIGCHLD is inherited through exec(), and breaks waitpid()
+    signal( SIGCHLD, SIG_DFL );
+    signal( SIGPIPE, SIG_IGN );
+
+    if ( root != "/" && ( chroot( root.c_str() ) != 0 || chdir( "/" ) != 0 ) )
+    {
+        _exit( 1 );
+    }
+
+    for ( ;; )
+    {
+        uint32_t length = 0;
+        if ( !readFully( fd, reinterpret_cast< char* >( &length ), sizeof( length ) ) )
+        {
+            _exit( 0 );  // Parent closed the session
+        }
+        std::string payload( length, '\0' );
+        if ( length > 0 && !readFully( fd, &payload[ 0 ], length ) )
+        {
+            _exit( 0 );
+        }
+
+        FrameReader reader { payload };
+        Request request;
+        const uint32_t argc = reader.u32();
+        for ( uint32_t i = 0; i < argc && reader.ok; ++i )
+        {
+            request.args.push_back( reader.bytes() );
+        }
+        request.workingPath = reader.bytes();
+        request.input = reader.bytes();
+        request.timeoutSec = reader.u32();
+        if ( !reader.ok )
+        {
+            _exit( 2 );
+        }
+
+        std::string output;
+        const int32_t code = executeRequest( request, output );
+
+        std::string response;
+        response.append( reinterpret_cast< const char* >( &code ), sizeof( code ) );
+        appendBytes( response, output.data(), output.size() );
+        if ( !writeFully( fd, response.data(), response.size() ) )
+        {
+            _exit( 0 );
+        }
+    }
+}
+
+}  // namespace
+
+int
+main( int argc, char* argv[] )
+{
+    if ( argc != 2 )
+    {
+        const char usage[] = "Usage: calamares-chroot-helper <root>\n"
+                             "  (this is started by Calamares, with a socket as standard input)\n";
+        ssize_t ignored = write( STDERR_FILENO, usage, sizeof( usage ) - 1 );
+        (void)ignored;
+        return 1;
+    }
+    serve( STDIN_FILENO, argv[ 1 ] );
+}
@@ -0,0 +1,215 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "ChrootSession.h"
+#include "ChrootSession_p.h"
+
+#include "CalamaresConfig.h"
+#include "utils/Logger.h"
+#include "utils/Scheduling.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#include <csignal>
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+using namespace ChrootProtocol;
+using ProcessCode = CalamaresUtils::ProcessResult::Code;
+
+static_assert( int( Code::Crashed ) == int( ProcessCode::Crashed ), "Codes must match" );
+static_assert( int( Code::FailedToStart ) == int( ProcessCode::FailedToStart ), "Codes must match" );
+static_assert( int( Code::NoWorkingDirectory ) == int( ProcessCode::NoWorkingDirectory ), "Codes must match" );
+static_assert( int( Code::TimedOut ) == int( ProcessCode::TimedOut ), "Codes must match" );
+
+/** @brief The helper program
+ *
+ * A helper next to the running program (e.g. the tests, in the build
+ * directory) is preferred over the installed one.
+ */
+static QString
+helperPath()
+{
+    const QString name = QStringLiteral( "calamares-chroot-helper" );
+    if ( QCoreApplication::instance() )
+    {
+        const QString local = QCoreApplication::applicationDirPath() + '/' + name;
+        if ( QFileInfo( local ).isExecutable() )
+        {
+            return local;
+        }
+    }
+    return QStringLiteral( CMAKE_INSTALL_FULL_LIBEXECDIR ) + '/' + name;
+}
+
+/** @brief Closes the file descriptors from @p lowest up
+ *
+ * This is called in the child, after fork(); @p limit (one more than
+ * the highest descriptor that may be open) is determined beforehand.
+ */
+static void
+closeFrom( int lowest, int limit )
+{
+#ifdef SYS_close_range
+    if ( syscall( SYS_close_range, lowest, ~0U, 0 ) == 0 )
+    {
+        return;
+    }
+#endif
+    for ( int fd = lowest; fd < limit; ++fd )
+    {
+        ::close( fd );
+    }
+}
+
+namespace CalamaresUtils
+{
+
+ChrootSession::ChrootSession( const QString& root )
+    : m_root( root )
+{
+    const QString helper = helperPath();
+    if ( !QFileInfo( helper ).isExecutable() )
+    {
+        cWarning() << "Chroot helper" << helper << "is not available.";
+        return;
+    }
+
+    int fds[ 2 ];
+    if ( socketpair( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds ) != 0 )
+    {
+        cWarning() << "Could not create socket for chroot helper:" << strerror( errno );
+        return;
+    }
+
+    // After fork(), the child of this multithreaded process may only make
+    // async-signal-safe calls until it exec()s, so everything it needs is
+    // prepared here.
+    const QByteArray helperFile = QFile::encodeName( helper );
+    const QByteArray rootPath = QFile::encodeName( root );
+    char* const argv[]
+        = { const_cast< char* >( helperFile.constData() ), const_cast< char* >( rootPath.constData() ), nullptr };
+    // The commands it runs inherit these priorities
+    const SchedulingPolicy::ChildSetup scheduling( SchedulingPolicy::current() );
+    // Descriptors beyond this are not expected; Qt opens its files close-on-exec anyway
+    rlimit fileLimit {};
+    const int maxFd = ( getrlimit( RLIMIT_NOFILE, &fileLimit ) == 0 && fileLimit.rlim_cur != RLIM_INFINITY )
+        ? int( qMin< rlim_t >( fileLimit.rlim_cur, 65536 ) )
+        : 1024;
+    sigset_t noSignals;
+    sigemptyset( &noSignals );
+
+    const pid_t pid = fork();
+    if ( pid == 0 )
+    {
+        // The socket becomes standard input; dup2() clears close-on-exec
+        if ( dup2( fds[ 1 ], STDIN_FILENO ) < 0 )
+        {
+            _exit( 127 );
+        }
+        closeFrom( STDERR_FILENO + 1, maxFd );
+        scheduling.apply();
+        // Ignored and blocked signals would be inherited by the helper
+        signal( SIGPIPE, SIG_DFL );
+        sigprocmask( SIG_SETMASK, &noSignals, nullptr );
+        execv( argv[ 0 ], argv );
+        _exit( 127 );
+    }
+
+    ::close( fds[ 1 ] );
+    if ( pid < 0 )
+    {
+        cWarning() << "Could not start chroot helper:" << strerror( errno );
+        ::close( fds[ 0 ] );
+        return;
+    }
+
+    m_socket = fds[ 0 ];
+    m_pid = pid;
+    cDebug() << "Started chroot helper" << pid << "in" << root;
+}
+
+ChrootSession::~ChrootSession()
+{
+    QMutexLocker lock( &m_mutex );
+    stop();
+}
+
+void
+ChrootSession::stop()
+{
+    closeFd( m_socket );  // The helper exits when it sees end-of-file
+    if ( m_pid > 0 )
+    {
+        waitpid( m_pid, nullptr, 0 );
+        m_pid = -1;
+    }
+}
+
+ProcessResult
+ChrootSession::run( const QStringList& args,
+                    const QString& workingPath,
+                    const QString& stdInput,
+                    std::chrono::seconds timeoutSec )
+{
+    QMutexLocker lock( &m_mutex );
+    if ( !isValid() )
+    {
+        return ProcessResult::Code::FailedToStart;
+    }
+
+    std::string payload;
+    appendU32( payload, uint32_t( args.count() ) );
+    for ( const QString& a : args )
+    {
+        const QByteArray b = QFile::encodeName( a );
+        appendBytes( payload, b.constData(), size_t( b.size() ) );
+    }
+    const QByteArray cwd = QFile::encodeName( workingPath );
+    appendBytes( payload, cwd.constData(), size_t( cwd.size() ) );
+    const QByteArray input = stdInput.toLocal8Bit();
+    appendBytes( payload, input.constData(), size_t( input.size() ) );
+    appendU32( payload, uint32_t( timeoutSec.count() > 0 ? timeoutSec.count() : 0 ) );
+
+    std::string frame;
+    appendU32( frame, uint32_t( payload.size() ) );
+    frame.append( payload );
+
+    int32_t code = 0;
+    uint32_t length = 0;
+    if ( !writeFully( m_socket, frame.data(), frame.size() )
+         || !readFully( m_socket, reinterpret_cast< char* >( &code ), sizeof( code ) )
+         || !readFully( m_socket, reinterpret_cast< char* >( &length ), sizeof( length ) ) )
+    {
+        cWarning() << "Chroot helper for" << m_root << "has failed.";
+        stop();
+        return ProcessResult::Code::FailedToStart;
+    }
+    QByteArray output( int( length ), '\0' );
+    if ( length > 0 && !readFully( m_socket, output.data(), length ) )
+    {
+        cWarning() << "Chroot helper for" << m_root << "has failed.";
+        stop();
+        return ProcessResult::Code::FailedToStart;
+    }
+
+    if ( code < 0 )
+    {
+        return static_cast< ProcessResult::Code >( code );
+    }
+    return ProcessResult( code, QString::fromLocal8Bit( output ).trimmed() );
+}
+
+}  // namespace CalamaresUtils
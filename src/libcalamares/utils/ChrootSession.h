@@ -0,0 +1,93 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#ifndef UTILS_CHROOTSESSION_H
+#define UTILS_CHROOTSESSION_H
+
+#include "DllMacro.h"
+
+#include "utils/CalamaresUtilsSystem.h"
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+#include <chrono>
+
+#include <sys/types.h>
+
+namespace CalamaresUtils
+{
+
+/** @brief A long-lived helper process that runs commands in a chroot
+ *
+ * Running a command in the target system normally spawns chroot(8),
+ * which then executes the command. When a job runs dozens of commands
+ * in the target, that overhead adds up. A ChrootSession starts a helper
+ * program (calamares-chroot-helper) **once**, which enters the given
+ * root and then executes commands sent to it over a socketpair,
+ * reporting back the exit code and (merged stdout and stderr) output
+ * of each command. The helper gets only the socket and the standard
+ * output and error of Calamares; no other file descriptors.
+ *
+ * The semantics of run() match those of System::runCommand() with
+ * RunInTarget: the command is executed directly (no shell), with
+ * optional working directory, standard input and timeout, and the
+ * special exit codes of ProcessResult::Code are used for failures.
+ *
+ * The protocol uses native-endian frames, since both ends are the
+ * same program on the same machine:
+ *  - request: u32 length, then the payload: u32 argument-count,
+ *    the arguments, the working directory and the standard input
+ *    (each as u32 length plus bytes) and a u32 timeout in seconds.
+ *  - response: i32 exit code, u32 length and the output bytes.
+ *
+ * A session runs one command at a time; run() is thread-safe.
+ * If @p root is "/" the helper does not chroot at all, which is
+ * useful for testing without privileges.
+ */
+class DLLEXPORT ChrootSession
+{
+public:
+    /// @brief Start a helper for the given @p root
+    explicit ChrootSession( const QString& root );
+    ChrootSession( const ChrootSession& ) = delete;
+    ChrootSession& operator=( const ChrootSession& ) = delete;
+    /// @brief Stops the helper process
+    ~ChrootSession();
+
+    /// @brief Is the helper process running (and has it not failed)?
+    bool isValid() const { return m_socket >= 0; }
+    QString root() const { return m_root; }
+
+    /** @brief Runs the command @p args in the session
+     *
+     * If the helper fails (e.g. it could not chroot, or has died),
+     * the session becomes invalid and FailedToStart is returned;
+     * callers can check isValid() to distinguish that from the
+     * command itself failing to start.
+     */
+    ProcessResult run( const QStringList& args,
+                       const QString& workingPath = QString(),
+                       const QString& stdInput = QString(),
+                       std::chrono::seconds timeoutSec = std::chrono::seconds( 0 ) );
+
+private:
+    void stop();
+
+    QString m_root;
+    QMutex m_mutex;
+    int m_socket = -1;
+    pid_t m_pid = -1;
+};
+
+}  // namespace CalamaresUtils
+
+#endif
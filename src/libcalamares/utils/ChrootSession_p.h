@@ -0,0 +1,145 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+/*
+ * The protocol between ChrootSession and the chroot helper program
+ * (calamares-chroot-helper); see ChrootSession for a description.
+ *
+ * This is shared by both ends. The helper does not use Qt, so this
+ * uses plain POSIX and std:: types only.
+ */
+
+#ifndef UTILS_CHROOTSESSION_P_H
+#define UTILS_CHROOTSESSION_P_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace ChrootProtocol
+{
+
+/// @brief Special exit codes, as in CalamaresUtils::ProcessResult::Code
+enum class Code : int32_t
+{
+    Crashed = -1,
+    FailedToStart = -2,
+    NoWorkingDirectory = -3,
+    TimedOut = -4
+};
+
+inline bool
+writeFully( int fd, const char* data, size_t length )
+{
+    while ( length > 0 )
+    {
+        // Use send() where possible, so that a dead peer does not SIGPIPE us
+        ssize_t n = ::send( fd, data, length, MSG_NOSIGNAL );
+        if ( n < 0 && errno == ENOTSOCK )
+        {
+            n = ::write( fd, data, length );
+        }
+        if ( n < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= size_t( n );
+    }
+    return true;
+}
+
+inline bool
+readFully( int fd, char* data, size_t length )
+{
+    while ( length > 0 )
+    {
+        ssize_t n = ::read( fd, data, length );
+        if ( n < 0 && errno == EINTR )
+        {
+            continue;
+        }
+        if ( n <= 0 )
+        {
+            return false;
+        }
+        data += n;
+        length -= size_t( n );
+    }
+    return true;
+}
+
+inline void
+appendU32( std::string& s, uint32_t v )
+{
+    s.append( reinterpret_cast< const char* >( &v ), sizeof( v ) );
+}
+
+inline void
+appendBytes( std::string& s, const char* data, size_t length )
+{
+    appendU32( s, uint32_t( length ) );
+    s.append( data, length );
+}
+
+struct FrameReader
+{
+    const std::string& s;
+    size_t pos = 0;
+    bool ok = true;
+
+    uint32_t u32()
+    {
+        uint32_t v = 0;
+        if ( pos + sizeof( v ) > s.size() )
+        {
+            ok = false;
+            return 0;
+        }
+        std::memcpy( &v, s.data() + pos, sizeof( v ) );
+        pos += sizeof( v );
+        return v;
+    }
+
+    std::string bytes()
+    {
+        const uint32_t length = u32();
+        if ( !ok || pos + length > s.size() )
+        {
+            ok = false;
+            return std::string();
+        }
+        std::string r = s.substr( pos, length );
+        pos += length;
+        return r;
+    }
+};
+
+inline void
+closeFd( int& fd )
+{
+    if ( fd >= 0 )
+    {
+        ::close( fd );
+        fd = -1;
+    }
+}
+
+}  // namespace ChrootProtocol
+
+#endif
@@ -19,7 +19,12 @@
 #include "utils/Variant.h"
 
 #include <QCoreApplication>
+#include <QFuture>
+#include <QThreadPool>
 #include <QVariantList>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <vector>
 
 namespace CalamaresUtils
 {
@@ -38,8 +43,60 @@ get_variant_object( const QVariantMap& m )
     return CommandLine();
 }
 
+/// @brief Number of workers for a parallel group that doesn't say
+static constexpr int defaultParallelWorkers = 4;
+
+static CommandList_t get_variant_stringlist( const QVariantList& l, QList< int >& parallelWorkers );
+
+/** @brief Reads a parallel group from map @p m
+ *
+ * The group gets the next group number (one more than the number
+ * of groups already in @p parallelWorkers). Duplicate commands in
+ * a group are dropped, since running the same command twice,
+ * concurrently, is never what is intended.
+ */
+static CommandList_t
+get_variant_parallel( const QVariantMap& m, QList< int >& parallelWorkers )
+{
+    const QVariant v = m.value( "parallel" );
+    if ( v.type() != QVariant::List )
+    {
+        cWarning() << "Bad CommandList parallel group" << v;
+        return CommandList_t();
+    }
+
+    QList< int > nested;
+    const CommandList_t commands = get_variant_stringlist( v.toList(), nested );
+    if ( !nested.isEmpty() )
+    {
+        cWarning() << "Nested parallel groups in CommandList are run as a single group.";
+    }
+
+    const int group = parallelWorkers.count() + 1;
+    CommandList_t retl;
+    QStringList seen;
+    for ( auto c : commands )
+    {
+        if ( seen.contains( c.command() ) )
+        {
+            cDebug() << "Dropping duplicate command" << c.command() << "from parallel group" << group;
+            continue;
+        }
+        seen.append( c.command() );
+        c.setParallelGroup( group );
+        retl.append( c );
+    }
+
+    if ( !retl.isEmpty() )
+    {
+        const qint64 workers = CalamaresUtils::getInteger( m, "workers", defaultParallelWorkers );
+        parallelWorkers.append( workers > 0 ? int( workers ) : defaultParallelWorkers );
+    }
+    return retl;
+}
+
 static CommandList_t
-get_variant_stringlist( const QVariantList& l )
+get_variant_stringlist( const QVariantList& l, QList< int >& parallelWorkers )
 {
     CommandList_t retl;
     unsigned int count = 0;
@@ -49,6 +106,10 @@ get_variant_stringlist( const QVariantList& l )
         {
             retl.append( CommandLine( v.toString(), CommandLine::TimeoutNotSet() ) );
         }
+        else if ( v.type() == QVariant::Map && v.toMap().contains( "parallel" ) )
+        {
+            retl.append( get_variant_parallel( v.toMap(), parallelWorkers ) );
+        }
         else if ( v.type() == QVariant::Map )
         {
             auto command( get_variant_object( v.toMap() ) );
@@ -81,7 +142,7 @@ CommandList::CommandList::CommandList( const QVariant& v, bool doChroot, std::ch
         const auto v_list = v.toList();
         if ( v_list.count() )
         {
-            append( get_variant_stringlist( v_list ) );
+            append( get_variant_stringlist( v_list, m_parallelWorkers ) );
         }
         else
         {
@@ -92,6 +153,10 @@ CommandList::CommandList::CommandList( const QVariant& v, bool doChroot, std::ch
     {
         append( v.toString() );
     }
+    else if ( v.type() == QVariant::Map && v.toMap().contains( "parallel" ) )
+    {
+        append( get_variant_parallel( v.toMap(), m_parallelWorkers ) );
+    }
     else if ( v.type() == QVariant::Map )
     {
         auto c( get_variant_object( v.toMap() ) );
@@ -120,6 +185,22 @@ findInCommands( const CommandList& l, const QString& needle )
     return false;
 }
 
+/// @brief A command with substitutions applied, ready to run
+struct PreparedCommand
+{
+    QString command;
+    std::chrono::seconds timeout = std::chrono::seconds( 0 );
+    bool suppressResult = false;
+};
+
+static ProcessResult
+runShellCommand( System::RunLocation location, const PreparedCommand& c )
+{
+    QStringList shell_cmd { "/bin/sh", "-c" };
+    shell_cmd << c.command;
+    return System::runCommand( location, shell_cmd, QString(), QString(), c.timeout );
+}
+
 Calamares::JobResult
 CommandList::run()
 {
@@ -158,39 +239,97 @@ CommandList::run()
     }
     QString user = gs->value( "username" ).toString();  // may be blank if unset
 
-    for ( CommandList::const_iterator i = cbegin(); i != cend(); ++i )
-    {
-        QString processed_cmd = i->command();
-        processed_cmd.replace( rootMagic, root ).replace( userMagic, user );
-        bool suppress_result = false;
-        if ( processed_cmd.startsWith( '-' ) )
+    std::chrono::seconds defaultTimeout = m_timeout;
+    auto prepare = [ & ]( const CommandLine& c ) {
+        PreparedCommand p;
+        p.command = c.command();
+        p.command.replace( rootMagic, root ).replace( userMagic, user );
+        if ( p.command.startsWith( '-' ) )
         {
-            suppress_result = true;
-            processed_cmd.remove( 0, 1 );  // Drop the -
+            p.suppressResult = true;
+            p.command.remove( 0, 1 );  // Drop the -
         }
+        p.timeout = c.timeout() >= std::chrono::seconds::zero() ? c.timeout() : defaultTimeout;
+        return p;
+    };
 
-        QStringList shell_cmd { "/bin/sh", "-c" };
-        shell_cmd << processed_cmd;
+    for ( int i = 0; i < count(); )
+    {
+        // Find the commands that can run together: just the one,
+        // or all of the consecutive commands in the same group.
+        const int group = at( i ).parallelGroup();
+        int end = i + 1;
+        while ( group && end < count() && at( end ).parallelGroup() == group )
+        {
+            ++end;
+        }
 
-        std::chrono::seconds timeout = i->timeout() >= std::chrono::seconds::zero() ? i->timeout() : m_timeout;
-        ProcessResult r = System::runCommand( location, shell_cmd, QString(), QString(), timeout );
+        QList< PreparedCommand > commands;
+        for ( int j = i; j < end; ++j )
+        {
+            commands.append( prepare( at( j ) ) );
+        }
+        std::vector< ProcessResult > results( commands.count(), ProcessResult::Code::FailedToStart );
 
-        if ( r.getExitCode() != 0 )
+        if ( commands.count() == 1 )
         {
-            if ( suppress_result )
+            results[ 0 ] = runShellCommand( location, commands.first() );
+        }
+        else
+        {
+            cDebug() << "Running" << commands.count() << "commands in parallel group" << group << "with"
+                     << parallelWorkers( group ) << "workers";
+            // The substitutions are already done, but runCommand() still looks up
+            // rootMountPoint in GlobalStorage for RunInTarget, from the pool's
+            // threads. That is safe because GlobalStorage does its own locking.
+            QThreadPool pool;
+            pool.setMaxThreadCount( parallelWorkers( group ) );
+            QList< QFuture< void > > futures;
+            for ( int j = 0; j < commands.count(); ++j )
             {
-                cDebug() << "Error code" << r.getExitCode() << "ignored by CommandList configuration.";
+                const PreparedCommand& c = commands.at( j );
+                ProcessResult* r = &results[ j ];
+                futures.append(
+                    QtConcurrent::run( &pool, [ location, c, r ] { *r = runShellCommand( location, c ); } ) );
             }
-            else
+            for ( auto& f : futures )
             {
-                return r.explainProcess( processed_cmd, timeout );
+                f.waitForFinished();
             }
         }
+
+        for ( int j = 0; j < commands.count(); ++j )
+        {
+            const ProcessResult& r = results[ j ];
+            const PreparedCommand& c = commands.at( j );
+            if ( r.getExitCode() != 0 )
+            {
+                if ( c.suppressResult )
+                {
+                    cDebug() << "Error code" << r.getExitCode() << "ignored by CommandList configuration.";
+                }
+                else
+                {
+                    return r.explainProcess( c.command, c.timeout );
+                }
+            }
+        }
+        i = end;
     }
 
     return Calamares::JobResult::ok();
 }
 
+int
+CommandList::parallelWorkers( int group ) const
+{
+    if ( group < 1 || group > m_parallelWorkers.count() )
+    {
+        return 1;
+    }
+    return m_parallelWorkers.at( group - 1 );
+}
+
 void
 CommandList::append( const QString& s )
 {
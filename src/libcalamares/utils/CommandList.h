@@ -50,6 +50,18 @@ struct CommandLine : public QPair< QString, std::chrono::seconds >
     std::chrono::seconds timeout() const { return second; }
 
     bool isValid() const { return !first.isEmpty(); }
+
+    /** @brief The parallel group this command belongs to
+     *
+     * Commands in the same (non-zero) group are consecutive in a
+     * CommandList and may run concurrently. Group 0 means the
+     * command runs on its own, after the previous ones have finished.
+     */
+    int parallelGroup() const { return m_parallelGroup; }
+    void setParallelGroup( int g ) { m_parallelGroup = g; }
+
+private:
+    int m_parallelGroup = 0;
 };
 
 /** @brief Abbreviation, used internally. */
@@ -73,8 +85,23 @@ public:
 
     bool doChroot() const { return m_doChroot; }
 
+    /** @brief Runs the commands in the list
+     *
+     * Commands are run one after the other, except for commands
+     * in a parallel group, which run concurrently (with a bounded
+     * number of workers). All the commands in a group are run to
+     * completion; if any of them fail, the first failure **in list
+     * order** is returned, so that the result does not depend on
+     * scheduling.
+     */
     Calamares::JobResult run();
 
+    /** @brief Number of concurrent workers for parallel group @p group
+     *
+     * Returns 1 for commands that are not in a parallel group.
+     */
+    int parallelWorkers( int group ) const;
+
     using CommandList_t::at;
     using CommandList_t::cbegin;
     using CommandList_t::cend;
@@ -89,6 +116,7 @@ protected:
 private:
     bool m_doChroot;
     std::chrono::seconds m_timeout;
+    QList< int > m_parallelWorkers;  ///< Worker count for group n at index n-1
 };
 
 }  // namespace CalamaresUtils
@@ -0,0 +1,339 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "LogRecord.h"
+
+#include <QDateTime>
+
+/* Qt 5.9 does not have QCborStreamWriter, and the records only use a
+ * handful of CBOR types, so these are encoded and decoded here.
+ */
+namespace
+{
+enum Major : quint8
+{
+    Unsigned = 0,
+    Negative = 1,
+    Bytes = 2,
+    Text = 3,
+    Array = 4,
+    Map = 5,
+    Simple = 7
+};
+
+static constexpr quint8 cborFalse = 20;
+static constexpr quint8 cborTrue = 21;
+static constexpr quint8 cborNull = 22;
+
+/// @brief Records larger than this are considered damaged
+static constexpr quint32 maximumRecordSize = 16 * 1024 * 1024;
+
+void
+appendBigEndian( QByteArray& out, quint64 value, int bytes )
+{
+    for ( int i = bytes - 1; i >= 0; --i )
+    {
+        out.append( static_cast< char >( ( value >> ( 8 * i ) ) & 0xff ) );
+    }
+}
+
+void
+appendHead( QByteArray& out, Major type, quint64 value )
+{
+    const quint8 m = static_cast< quint8 >( type << 5 );
+    if ( value < 24 )
+    {
+        out.append( static_cast< char >( m | value ) );
+    }
+    else if ( value <= 0xff )
+    {
+        out.append( static_cast< char >( m | 24 ) );
+        appendBigEndian( out, value, 1 );
+    }
+    else if ( value <= 0xffff )
+    {
+        out.append( static_cast< char >( m | 25 ) );
+        appendBigEndian( out, value, 2 );
+    }
+    else if ( value <= 0xffffffffULL )
+    {
+        out.append( static_cast< char >( m | 26 ) );
+        appendBigEndian( out, value, 4 );
+    }
+    else
+    {
+        out.append( static_cast< char >( m | 27 ) );
+        appendBigEndian( out, value, 8 );
+    }
+}
+
+void
+appendText( QByteArray& out, const QString& s )
+{
+    const QByteArray utf8 = s.toUtf8();
+    appendHead( out, Text, static_cast< quint64 >( utf8.size() ) );
+    out.append( utf8 );
+}
+
+void
+appendInteger( QByteArray& out, qint64 v )
+{
+    if ( v >= 0 )
+    {
+        appendHead( out, Unsigned, static_cast< quint64 >( v ) );
+    }
+    else
+    {
+        appendHead( out, Negative, static_cast< quint64 >( -1 - v ) );
+    }
+}
+
+void
+appendVariant( QByteArray& out, const QVariant& v )
+{
+    switch ( v.type() )
+    {
+    case QVariant::Bool:
+        out.append( static_cast< char >( ( Simple << 5 ) | ( v.toBool() ? cborTrue : cborFalse ) ) );
+        break;
+    case QVariant::Int:
+    case QVariant::LongLong:
+    case QVariant::UInt:
+    case QVariant::ULongLong:
+        appendInteger( out, v.toLongLong() );
+        break;
+    default:
+        appendText( out, v.toString() );
+    }
+}
+
+/// @brief Reads @p bytes big-endian from @p data at @p pos
+bool
+readBigEndian( const QByteArray& data, int& pos, int bytes, quint64& value )
+{
+    if ( pos + bytes > data.size() )
+    {
+        return false;
+    }
+    value = 0;
+    for ( int i = 0; i < bytes; ++i )
+    {
+        value = ( value << 8 ) | static_cast< quint8 >( data.at( pos++ ) );
+    }
+    return true;
+}
+
+bool
+readHead( const QByteArray& data, int& pos, quint8& type, quint64& value )
+{
+    if ( pos >= data.size() )
+    {
+        return false;
+    }
+    const quint8 initial = static_cast< quint8 >( data.at( pos++ ) );
+    type = initial >> 5;
+    const quint8 info = initial & 0x1f;
+    if ( info < 24 )
+    {
+        value = info;
+        return true;
+    }
+    if ( info > 27 )
+    {
+        // Indefinite lengths and reserved values are not used
+        return false;
+    }
+    return readBigEndian( data, pos, 1 << ( info - 24 ), value );
+}
+
+bool
+readVariant( const QByteArray& data, int& pos, QVariant& v, int depth = 0 )
+{
+    quint8 type = 0;
+    quint64 value = 0;
+    if ( depth > 8 || !readHead( data, pos, type, value ) )
+    {
+        return false;
+    }
+    switch ( type )
+    {
+    case Unsigned:
+        v = static_cast< qint64 >( value );
+        return true;
+    case Negative:
+        v = static_cast< qint64 >( -1 - static_cast< qint64 >( value ) );
+        return true;
+    case Bytes:
+    case Text:
+        if ( value > quint64( data.size() - pos ) )
+        {
+            return false;
+        }
+        if ( type == Text )
+        {
+            v = QString::fromUtf8( data.constData() + pos, int( value ) );
+        }
+        else
+        {
+            v = data.mid( pos, int( value ) );
+        }
+        pos += int( value );
+        return true;
+    case Array:
+    {
+        QVariantList l;
+        for ( quint64 i = 0; i < value; ++i )
+        {
+            QVariant item;
+            if ( !readVariant( data, pos, item, depth + 1 ) )
+            {
+                return false;
+            }
+            l.append( item );
+        }
+        v = l;
+        return true;
+    }
+    case Map:
+    {
+        QVariantMap m;
+        for ( quint64 i = 0; i < value; ++i )
+        {
+            QVariant key, item;
+            if ( !readVariant( data, pos, key, depth + 1 ) || !readVariant( data, pos, item, depth + 1 ) )
+            {
+                return false;
+            }
+            m.insert( key.toString(), item );
+        }
+        v = m;
+        return true;
+    }
+    case Simple:
+        if ( value == cborFalse || value == cborTrue )
+        {
+            v = ( value == cborTrue );
+            return true;
+        }
+        if ( value == cborNull )
+        {
+            v = QVariant();
+            return true;
+        }
+        return false;
+    default:
+        // Tags and floating point are not used
+        return false;
+    }
+}
+}  // namespace
+
+namespace Logger
+{
+
+const QByteArray structuredLogMagic = QByteArrayLiteral( "CALALOG1" );
+
+QByteArray
+encodeRecord( const Record& r )
+{
+    // Level, time, thread and message are always there
+    const int count = 4 + ( r.function.isEmpty() ? 0 : 1 ) + ( r.context.isEmpty() ? 0 : 1 )
+        + ( r.fields.isEmpty() ? 0 : 1 );
+
+    QByteArray out( 4, '\0' );  // Length, filled in at the end
+    out.reserve( 64 + r.message.size() + r.function.size() );
+    appendHead( out, Map, static_cast< quint64 >( count ) );
+    appendText( out, QStringLiteral( "l" ) );
+    appendHead( out, Unsigned, r.level );
+    appendText( out, QStringLiteral( "t" ) );
+    appendInteger( out, r.time );
+    appendText( out, QStringLiteral( "th" ) );
+    appendHead( out, Unsigned, r.thread );
+    if ( !r.function.isEmpty() )
+    {
+        appendText( out, QStringLiteral( "f" ) );
+        appendText( out, r.function );
+    }
+    if ( !r.context.isEmpty() )
+    {
+        appendText( out, QStringLiteral( "c" ) );
+        appendText( out, r.context );
+    }
+    appendText( out, QStringLiteral( "m" ) );
+    appendText( out, r.message );
+    if ( !r.fields.isEmpty() )
+    {
+        appendText( out, QStringLiteral( "kv" ) );
+        appendHead( out, Map, static_cast< quint64 >( r.fields.count() ) );
+        for ( auto it = r.fields.constBegin(); it != r.fields.constEnd(); ++it )
+        {
+            appendText( out, it.key() );
+            appendVariant( out, it.value() );
+        }
+    }
+    QByteArray length;
+    appendBigEndian( length, static_cast< quint64 >( out.size() - 4 ), 4 );
+    out.replace( 0, 4, length );
+    return out;
+}
+
+bool
+decodeRecord( const QByteArray& data, int& offset, Record& r )
+{
+    int pos = offset;
+    quint64 length = 0;
+    if ( !readBigEndian( data, pos, 4, length ) || length > maximumRecordSize
+         || length > quint64( data.size() - pos ) )
+    {
+        return false;
+    }
+
+    const int end = pos + int( length );
+    QVariant v;
+    if ( !readVariant( data, pos, v ) || pos != end || v.type() != QVariant::Map )
+    {
+        return false;
+    }
+
+    const QVariantMap m = v.toMap();
+    r.level = m.value( QStringLiteral( "l" ) ).toUInt();
+    r.time = m.value( QStringLiteral( "t" ) ).toLongLong();
+    r.thread = m.value( QStringLiteral( "th" ) ).toULongLong();
+    r.function = m.value( QStringLiteral( "f" ) ).toString();
+    r.context = m.value( QStringLiteral( "c" ) ).toString();
+    r.message = m.value( QStringLiteral( "m" ) ).toString();
+    r.fields = m.value( QStringLiteral( "kv" ) ).toMap();
+    offset = end;
+    return true;
+}
+
+QString
+toText( const Record& r )
+{
+    const QDateTime when = QDateTime::fromMSecsSinceEpoch( r.time );
+    QString s = when.date().toString( Qt::ISODate ) + QStringLiteral( " - " ) + when.time().toString( Qt::ISODate )
+        + QStringLiteral( " [" ) + QString::number( r.level ) + QStringLiteral( "]: " );
+    if ( !r.context.isEmpty() )
+    {
+        s += QChar( '<' ) + r.context + QStringLiteral( "> " );
+    }
+    if ( !r.function.isEmpty() )
+    {
+        s += r.function + QStringLiteral( "\n    " );
+    }
+    s += r.message;
+    for ( auto it = r.fields.constBegin(); it != r.fields.constEnd(); ++it )
+    {
+        s += QStringLiteral( "\n    " ) + it.key() + QStringLiteral( ": " ) + it.value().toString();
+    }
+    return s;
+}
+
+}  // namespace Logger
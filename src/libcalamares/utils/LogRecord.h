@@ -0,0 +1,80 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#ifndef UTILS_LOGRECORD_H
+#define UTILS_LOGRECORD_H
+
+#include "DllMacro.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+
+namespace Logger
+{
+
+/** @brief One message in the structured log
+ *
+ * The structured log (see setupStructuredLog()) contains the same
+ * messages as the text log, but does not format them into lines:
+ * each message is one record, with its parts kept apart so that
+ * tools do not have to parse text.
+ *
+ * In the file, a record is a CBOR map (RFC 8949) preceded by its
+ * length as a 32-bit big-endian number. The keys of the map are
+ * short strings:
+ *  - *l*, the level (an integer, see the LOG* enum),
+ *  - *t*, the time in milliseconds since the Unix epoch,
+ *  - *th*, an identifier of the thread,
+ *  - *f*, the function that logged the message (may be missing),
+ *  - *c*, the context, e.g. the id of the job that is running,
+ *    like "unpackfs@unpackfs#0" (may be missing),
+ *  - *m*, the message text,
+ *  - *kv*, a map of extra fields (may be missing); the values are
+ *    integers, booleans or strings.
+ * Readers should ignore keys they do not know.
+ *
+ * The file starts with structuredLogMagic, so that it can be recognized.
+ */
+struct DLLEXPORT Record
+{
+    unsigned int level = 0;
+    qint64 time = 0;
+    quint64 thread = 0;
+    QString function;
+    QString context;
+    QString message;
+    QVariantMap fields;
+};
+
+/// @brief The first bytes of a structured log file
+DLLEXPORT extern const QByteArray structuredLogMagic;
+
+/// @brief Encodes @p r as a length-prefixed record
+DLLEXPORT QByteArray encodeRecord( const Record& r );
+
+/** @brief Decodes the record that starts at @p offset in @p data
+ *
+ * On success, returns @c true, fills in @p r and moves @p offset
+ * to the next record. Returns @c false at the end of the data, or if
+ * the record is damaged or incomplete (e.g. the end of the log of
+ * a crashed session); @p offset is left unchanged then.
+ */
+DLLEXPORT bool decodeRecord( const QByteArray& data, int& offset, Record& r );
+
+/** @brief Formats @p r as it would appear in the text log
+ *
+ * The extra fields are appended as continuation lines.
+ */
+DLLEXPORT QString toText( const Record& r );
+
+}  // namespace Logger
+
+#endif
@@ -15,26 +15,34 @@
 
 #include "CalamaresVersionX.h"
 #include "utils/Dirs.h"
+#include "utils/LogRecord.h"
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
 #include <QMutex>
+#include <QProcess>
+#include <QThread>
 #include <QTime>
 #include <QVariant>
 
 #include <fstream>
 #include <iostream>
 
-static constexpr const int LOGFILE_SIZE = 1024 * 256;
-
 static std::ofstream logfile;
+static std::ofstream structuredLogfile;
+static bool s_structured = false;
+static Logger::Rotation s_rotation;
+static thread_local QString s_context;
 static unsigned int s_threshold =
 #ifdef QT_NO_DEBUG
     Logger::LOG_DISABLE;
 #else
     Logger::LOGEXTRA + 1;  // Comparison is < in log() function
 #endif
+/// @brief Threshold for the log file, which by default gets everything (see log())
+static unsigned int s_fileThreshold = Logger::LOGVERBOSE + 1;
 static QMutex s_mutex;
 
 static const char s_Continuation[] = "\n    ";
@@ -54,10 +62,20 @@ setupLogLevel( unsigned int level )
     s_threshold = level + 1;  // Comparison is < in log() function
 }
 
+void
+setupFileLogLevel( unsigned int level )
+{
+    if ( level > LOGVERBOSE )
+    {
+        level = LOGVERBOSE;
+    }
+    s_fileThreshold = level + 1;
+}
+
 bool
 logLevelEnabled( unsigned int level )
 {
-    return level < s_threshold;
+    return level < s_threshold || level < s_fileThreshold;
 }
 
 unsigned int
@@ -66,6 +84,36 @@ logLevel()
     return s_threshold > 0 ? s_threshold - 1 : 0;
 }
 
+/** @brief Writes a record to the structured log, if there is one
+ *
+ * @p msg is the message text, without the function name @p func.
+ */
+static void
+logRecord( unsigned int debugLevel, const char* func, const QString& msg, const QVariantMap& fields = QVariantMap() )
+{
+    if ( !s_structured )
+    {
+        return;
+    }
+
+    Record r;
+    r.level = debugLevel;
+    r.time = QDateTime::currentMSecsSinceEpoch();
+    r.thread = static_cast< quint64 >( reinterpret_cast< quintptr >( QThread::currentThreadId() ) );
+    r.function = QString::fromUtf8( func );
+    r.context = s_context;
+    r.message = msg;
+    r.fields = fields;
+    const QByteArray data = encodeRecord( r );
+
+    QMutexLocker lock( &s_mutex );
+    if ( structuredLogfile.is_open() )
+    {
+        structuredLogfile.write( data.constData(), data.size() );
+        structuredLogfile.flush();
+    }
+}
+
 static void
 log( const char* msg, unsigned int debugLevel, bool withTime = true )
 {
@@ -83,7 +131,7 @@ log( const char* msg, unsigned int debugLevel, bool withTime = true )
         logfile.flush();
     }
 
-    if ( logLevelEnabled( debugLevel ) )
+    if ( debugLevel < s_threshold )
     {
         QMutexLocker lock( &s_mutex );
         if ( withTime )
@@ -97,30 +145,37 @@ log( const char* msg, unsigned int debugLevel, bool withTime = true )
 
 
 static void
-CalamaresLogHandler( QtMsgType type, const QMessageLogContext&, const QString& msg )
+CalamaresLogHandler( QtMsgType type, const QMessageLogContext& context, const QString& msg )
 {
     static QMutex s_mutex;
 
-    QByteArray ba = msg.toUtf8();
-    const char* message = ba.constData();
-
-    QMutexLocker locker( &s_mutex );
+    unsigned int level = 0;
     switch ( type )
     {
     case QtDebugMsg:
-        log( message, LOGVERBOSE );
+        level = LOGVERBOSE;
         break;
 
     case QtInfoMsg:
-        log( message, 1 );
+        level = 1;
         break;
 
     case QtCriticalMsg:
     case QtWarningMsg:
     case QtFatalMsg:
-        log( message, 0 );
+        level = 0;
         break;
     }
+    if ( !logLevelEnabled( level ) )
+    {
+        return;
+    }
+
+    logRecord( level, context.function, msg );
+    QByteArray ba = msg.toUtf8();
+
+    QMutexLocker locker( &s_mutex );
+    log( ba.constData(), level );
 }
 
 
@@ -130,29 +185,88 @@ logFile()
     return CalamaresUtils::appLogDir().filePath( "session.log" );
 }
 
+QString
+structuredLogFile()
+{
+    return CalamaresUtils::appLogDir().filePath( "session.clog" );
+}
 
 void
-setupLogfile()
+setupStructuredLog( bool enabled )
 {
-    if ( QFileInfo( logFile().toLocal8Bit() ).size() > LOGFILE_SIZE )
-    {
-        QByteArray lc;
-        {
-            QFile f( logFile().toLocal8Bit() );
-            f.open( QIODevice::ReadOnly | QIODevice::Text );
-            lc = f.readAll();
-            f.close();
-        }
+    s_structured = enabled;
+}
+
+void
+setContext( const QString& context )
+{
+    s_context = context;
+}
+
+
+void
+setupLogRotation( const Rotation& rotation )
+{
+    s_rotation = rotation;
+}
+
+/// @brief The name of old log number @p n (0 is the current log)
+static QString
+generationFile( int n )
+{
+    return n > 0 ? QStringLiteral( "%1.%2" ).arg( logFile() ).arg( n ) : logFile();
+}
 
-        QFile::remove( logFile().toLocal8Bit() );
+/** @brief Moves the log file out of the way if it is too large
+ *
+ * Each old log moves up one number, and the oldest is removed.
+ * Old logs may have been compressed already.
+ */
+static void
+rotateLogfile()
+{
+    const QString current = logFile();
+    if ( s_rotation.sizeLimit <= 0 || QFileInfo( current ).size() <= s_rotation.sizeLimit )
+    {
+        return;
+    }
+    if ( s_rotation.generations < 1 )
+    {
+        QFile::remove( current );
+        return;
+    }
 
+    const QString suffixes[] = { QString(), QStringLiteral( ".gz" ) };
+    for ( int n = s_rotation.generations; n > 1; --n )
+    {
+        for ( const auto& suffix : suffixes )
         {
-            QFile f( logFile().toLocal8Bit() );
-            f.open( QIODevice::WriteOnly | QIODevice::Text );
-            f.write( lc.right( LOGFILE_SIZE - ( LOGFILE_SIZE / 4 ) ) );
-            f.close();
+            // Renaming does not overwrite, and missing logs are fine
+            QFile::remove( generationFile( n ) + suffix );
+            QFile::rename( generationFile( n - 1 ) + suffix, generationFile( n ) + suffix );
         }
     }
+    for ( const auto& suffix : suffixes )
+    {
+        QFile::remove( generationFile( 1 ) + suffix );
+    }
+    if ( !QFile::rename( current, generationFile( 1 ) ) )
+    {
+        // Start afresh rather than let the log grow without limit
+        QFile::remove( current );
+        return;
+    }
+    if ( s_rotation.compress
+         && !QProcess::startDetached( QStringLiteral( "gzip" ), { QStringLiteral( "-f" ), generationFile( 1 ) } ) )
+    {
+        cWarning() << "Could not compress old log" << generationFile( 1 );
+    }
+}
+
+void
+setupLogfile()
+{
+    rotateLogfile();
 
     // Since the log isn't open yet, this probably only goes to stdout
     cDebug() << "Using log file:" << logFile();
@@ -166,6 +280,17 @@ setupLogfile()
             logfile << "\n\n" << std::endl;
         }
         logfile << "=== START CALAMARES " << CALAMARES_VERSION << std::endl;
+
+        if ( s_structured )
+        {
+            structuredLogfile.open( structuredLogFile().toLocal8Bit(),
+                                    std::ios::out | std::ios::binary | std::ios::trunc );
+            structuredLogfile.write( structuredLogMagic.constData(), structuredLogMagic.size() );
+        }
+    }
+    if ( s_structured )
+    {
+        logRecord( LOGINFO, nullptr, QStringLiteral( "=== START CALAMARES " CALAMARES_VERSION ) );
     }
 
     qInstallMessageHandler( CalamaresLogHandler );
@@ -191,6 +316,12 @@ CDebug::~CDebug()
 {
     if ( logLevelEnabled( m_debugLevel ) )
     {
+        logRecord( m_debugLevel, m_funcinfo, m_msg, m_fields );
+        for ( auto it = m_fields.constBegin(); it != m_fields.constEnd(); ++it )
+        {
+            m_msg.append( QLatin1String( s_Continuation ) + it.key() + QStringLiteral( ": " )
+                          + toString( it.value() ) );
+        }
         if ( m_funcinfo )
         {
             m_msg.prepend( s_Continuation );  // Prepending, so back-to-front
@@ -200,6 +331,13 @@ CDebug::~CDebug()
     }
 }
 
+CDebug&
+CDebug::field( const char* key, const QVariant& value )
+{
+    m_fields.insert( QString::fromUtf8( key ), value );
+    return *this;
+}
+
 constexpr FuncSuppressor::FuncSuppressor( const char s[] )
     : m_s( s )
 {
@@ -17,6 +17,7 @@
 
 #include <QDebug>
 #include <QSharedPointer>
+#include <QVariantMap>
 
 #include <memory>
 
@@ -59,11 +60,21 @@ public:
     explicit CDebug( unsigned int debugLevel = LOGDEBUG, const char* func = nullptr );
     virtual ~CDebug();
 
+    /** @brief Adds a named value to the message
+     *
+     * In the structured log, the fields are kept apart from the
+     * message text; in the text log they are added as lines
+     * after the message. Use it like
+     *      cDebug().field( "device", dev ) << "Formatting";
+     */
+    CDebug& field( const char* key, const QVariant& value );
+
     friend CDebug& operator<<( CDebug&&, const FuncSuppressor& );
     friend CDebug& operator<<( CDebug&&, Once& );
 
 private:
     QString m_msg;
+    QVariantMap m_fields;
     unsigned int m_debugLevel;
     const char* m_funcinfo = nullptr;
 };
@@ -104,10 +115,56 @@ DLLEXPORT QString logFile();
  *
  * Call this (once) to start logging to the log file (usually
  * ~/.cache/calamares/session.log ). An existing log file is
- * rolled over if it is too large.
+ * rotated if it is too large, see setupLogRotation().
  */
 DLLEXPORT void setupLogfile();
 
+/** @brief How the log file is rotated
+ *
+ * When the log is larger than @c sizeLimit bytes at startup, it is
+ * renamed to session.log.1 (and an existing session.log.1 to
+ * session.log.2, and so on). Only @c generations old logs are kept.
+ * The old log is not read, so this is cheap even on slow media.
+ * If @c compress is set, the old log is compressed afterwards by
+ * gzip, which runs in the background.
+ */
+struct Rotation
+{
+    qint64 sizeLimit = 256 * 1024;
+    int generations = 3;
+    bool compress = false;
+};
+
+/** @brief Sets how the log file is rotated
+ *
+ * Call this before setupLogfile(), which does the rotation.
+ */
+DLLEXPORT void setupLogRotation( const Rotation& rotation );
+
+/** @brief The full path of the structured log file. */
+DLLEXPORT QString structuredLogFile();
+
+/**
+ * @brief Also write a structured log
+ *
+ * Call this before setupLogfile() to write, next to the text log,
+ * a log with one binary record per message (see Logger::Record),
+ * which is easier for tools to process than the text. The
+ * structured log is replaced by each new session.
+ */
+DLLEXPORT void setupStructuredLog( bool enabled );
+
+/**
+ * @brief Sets the context for the messages from the calling thread
+ *
+ * The context is written to the structured log with each message.
+ * The job queue sets it to the id of the job that is running, which
+ * is the module instance and the index of the job in the module
+ * (e.g. "unpackfs@unpackfs#0"), or the class name of jobs that
+ * do not belong to a module. Pass an empty string to clear it.
+ */
+DLLEXPORT void setContext( const QString& context );
+
 /**
  * @brief Set a log level for future logging.
  *
@@ -122,9 +179,35 @@ DLLEXPORT void setupLogLevel( unsigned int level );
 /** @brief Return the configured log-level. */
 DLLEXPORT unsigned int logLevel();
 
-/** @brief Would the given @p level really be logged? */
+/**
+ * @brief Set a log level for the log file only
+ *
+ * By default, every message is written to the log file, whatever
+ * the level for the console. This lowers the level for the file, so
+ * that fewer messages are formatted at all, e.g. -D2 -F6 shows warnings
+ * on the console and writes debug messages (but not verbose ones)
+ * to the log. Messages up to the level set by setupLogLevel() are
+ * always written to the file.
+ */
+DLLEXPORT void setupFileLogLevel( unsigned int level );
+
+/** @brief Would the given @p level really be logged (to the console or the file)?
+ *
+ * The logging macros check this before the message is formatted.
+ */
 DLLEXPORT bool logLevelEnabled( unsigned int level );
 
+/** @brief Are messages at LOGVERBOSE compiled in?
+ *
+ * In release builds (with QT_NO_DEBUG) cVerbose() messages are
+ * removed by the compiler, unless DEBUG_VERBOSE_LOGGING is set.
+ */
+#if defined( QT_NO_DEBUG ) && !defined( DEBUG_VERBOSE_LOGGING )
+constexpr bool verboseCompiledIn = false;
+#else
+constexpr bool verboseCompiledIn = true;
+#endif
+
 /**
  * @brief Row-oriented formatted logging.
  *
@@ -243,6 +326,28 @@ public:
     const char kind;
 };
 
+/**
+ * @brief Lazily formatted logging
+ *
+ * The function is called with the debug stream only when the message
+ * is actually logged, so it can loop, or do expensive work, to produce
+ * its output. For instance,
+ *      cDebug() << "Jobs:" << Logger::Lazy( [ & ]( QDebug& s ) {
+ *          for ( const auto& j : jobs ) { s << Logger::Continuation << j->prettyName(); }
+ *      } );
+ * produces a single debug message with one line per job.
+ */
+template < typename F >
+struct Lazy
+{
+    explicit Lazy( F f )
+        : function( f )
+    {
+    }
+
+    F function;
+};
+
 /** @brief output operator for DebugRow */
 template < typename T, typename U >
 inline QDebug&
@@ -278,6 +383,15 @@ operator<<( QDebug& s, const DebugMap& t )
     return s;
 }
 
+/** @brief output operator for Lazy, calls the function */
+template < typename F >
+inline QDebug&
+operator<<( QDebug& s, const Lazy< F >& l )
+{
+    l.function( s );
+    return s;
+}
+
 inline QDebug&
 operator<<( QDebug& s, const Pointer& p )
 {
@@ -316,10 +430,29 @@ operator<<( CDebug&& s, Once& o )
     return s;
 }
 
+/** @brief Helper for the logging macros
+ *
+ * Both branches of the conditional operator in the macros need to
+ * have type void; the & binds more loosely than all the << in a
+ * logging statement, so this swallows the whole statement.
+ */
+struct Voidify
+{
+    void operator&( const QDebug& ) {}
+};
+
 }  // namespace Logger
 
-#define cDebug() Logger::CDebug( Logger::LOGDEBUG, Q_FUNC_INFO )
-#define cWarning() Logger::CDebug( Logger::LOGWARNING, Q_FUNC_INFO )
-#define cError() Logger::CDebug( Logger::LOGERROR, Q_FUNC_INFO )
+/* The message is only formatted if it will be logged: if the level
+ * is not enabled, none of the arguments are evaluated.
+ */
+#define CALAMARES_LOG( enabled, level ) \
+    !( enabled ) ? (void)0 : Logger::Voidify() & Logger::CDebug( level, Q_FUNC_INFO )
+
+#define cVerbose() \
+    CALAMARES_LOG( Logger::verboseCompiledIn && Logger::logLevelEnabled( Logger::LOGVERBOSE ), Logger::LOGVERBOSE )
+#define cDebug() CALAMARES_LOG( Logger::logLevelEnabled( Logger::LOGDEBUG ), Logger::LOGDEBUG )
+#define cWarning() CALAMARES_LOG( Logger::logLevelEnabled( Logger::LOGWARNING ), Logger::LOGWARNING )
+#define cError() CALAMARES_LOG( Logger::logLevelEnabled( Logger::LOGERROR ), Logger::LOGERROR )
 
 #endif
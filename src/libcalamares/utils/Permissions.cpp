@@ -13,7 +13,11 @@
 #include <QString>
 #include <QStringList>
 
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 namespace CalamaresUtils
 {
@@ -119,5 +123,73 @@ Permissions::apply( const QString& path, const CalamaresUtils::Permissions& p )
     return r;
 }
 
+/** @brief Changes the owner of everything in directory @p dirFd
+ *
+ * Takes ownership of @p dirFd. Works relative to directory file
+ * descriptors, so the walk is not confused by renames and does
+ * not build up long paths.
+ */
+static bool
+applyOwnerInDirectory( int dirFd, uid_t uid, gid_t gid )
+{
+    DIR* dir = fdopendir( dirFd );
+    if ( !dir )
+    {
+        close( dirFd );
+        return false;
+    }
+
+    bool ok = true;
+    while ( struct dirent* entry = readdir( dir ) )
+    {
+        const char* name = entry->d_name;
+        if ( ( name[ 0 ] == '.' && name[ 1 ] == 0 ) || ( name[ 0 ] == '.' && name[ 1 ] == '.' && name[ 2 ] == 0 ) )
+        {
+            continue;
+        }
+        if ( fchownat( dirfd( dir ), name, uid, gid, AT_SYMLINK_NOFOLLOW ) )
+        {
+            ok = false;
+        }
+
+        bool isDirectory = entry->d_type == DT_DIR;
+        if ( entry->d_type == DT_UNKNOWN )
+        {
+            struct stat st;
+            isDirectory = fstatat( dirfd( dir ), name, &st, AT_SYMLINK_NOFOLLOW ) == 0 && S_ISDIR( st.st_mode );
+        }
+        if ( isDirectory )
+        {
+            int subFd = openat( dirfd( dir ), name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC );
+            ok = ( subFd >= 0 ) && applyOwnerInDirectory( subFd, uid, gid ) && ok;
+        }
+    }
+    closedir( dir );
+    return ok;
+}
+
+bool
+Permissions::applyOwnerRecursively( const QString& path, int uid, int gid )
+{
+    const QByteArray name = path.toUtf8();
+    if ( lchown( name.constData(), uid_t( uid ), gid_t( gid ) ) )
+    {
+        cDebug() << Logger::SubEntry << "Could not set owner of" << path << "to" << uid << gid;
+        return false;
+    }
+
+    int fd = open( name.constData(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        // Not a directory, so we're done
+        return errno == ENOTDIR || errno == ELOOP;
+    }
+    bool r = applyOwnerInDirectory( fd, uid_t( uid ), gid_t( gid ) );
+    if ( !r )
+    {
+        cDebug() << Logger::SubEntry << "Could not set owner of everything in" << path << "to" << uid << gid;
+    }
+    return r;
+}
 
 }  // namespace CalamaresUtils
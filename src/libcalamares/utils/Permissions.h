@@ -81,6 +81,18 @@ public:
     /// Convenience method for apply(const QString&, const Permissions& )
     bool apply( const QString& path ) const { return apply( path, *this ); }
 
+    /** @brief Sets the owner of @p path and everything below it
+     *
+     * This is `chown -R` with numeric IDs (e.g. from an AccountDatabase
+     * for the target system), without running a process. Symbolic links
+     * are not followed: the links themselves are changed, since from
+     * the host their targets may point out of the target system.
+     * Pass a path that is relative (or absolute) in the **host** system.
+     *
+     * @return @c true if the owner of every file was changed
+     */
+    static bool applyOwnerRecursively( const QString& path, int uid, int gid );
+
 private:
     void parsePermissions( QString const& p );
 
@@ -0,0 +1,235 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "ProgressParser.h"
+
+#include "utils/Logger.h"
+
+namespace CalamaresUtils
+{
+
+ProgressParser::ProgressParser( const QList< Rule >& rules )
+    : m_rules( rules )
+{
+    for ( const auto& r : m_rules )
+    {
+        if ( !r.pattern.isValid() )
+        {
+            cWarning() << "Bad progress pattern" << r.pattern.pattern() << r.pattern.errorString();
+        }
+    }
+}
+
+/// @brief Captured number @p name in @p m, or -1 if it was not captured
+static qreal
+capturedNumber( const QRegularExpressionMatch& m, const QString& name )
+{
+    bool ok = false;
+    const qreal v = m.captured( name ).trimmed().toDouble( &ok );
+    return ok ? v : -1.0;
+}
+
+bool
+ProgressParser::parseLine( const QString& line )
+{
+    for ( int index = 0; index < m_rules.count(); ++index )
+    {
+        const auto& r = m_rules.at( index );
+        const auto m = r.pattern.match( line );
+        if ( !m.hasMatch() )
+        {
+            continue;
+        }
+
+        const qreal done = capturedNumber( m, QStringLiteral( "done" ) );
+        const qreal total = capturedNumber( m, QStringLiteral( "total" ) );
+        const qreal percent = capturedNumber( m, QStringLiteral( "percent" ) );
+
+        qreal fraction = 0.0;
+        if ( done >= 0 && total > 0 )
+        {
+            fraction = done / total;
+        }
+        else if ( percent >= 0 )
+        {
+            fraction = percent / 100.0;
+        }
+        else if ( total > 0 )
+        {
+            // Only sets the number of steps for the rules that count lines
+            m_totalSteps = int( total );
+            m_steps = 0;
+            m_stepRule = -1;
+            return false;
+        }
+        else if ( m_totalSteps > 0 )
+        {
+            // Each rule counts its own lines, e.g. downloads and then installs
+            if ( index != m_stepRule )
+            {
+                m_stepRule = index;
+                m_steps = 0;
+            }
+            fraction = qreal( ++m_steps ) / m_totalSteps;
+        }
+
+        const qreal progress = r.start + ( r.end - r.start ) * qBound( 0.0, fraction, 1.0 );
+        QString message = m.captured( QStringLiteral( "message" ) ).trimmed();
+        if ( message.isEmpty() )
+        {
+            message = line.trimmed();
+        }
+
+        bool changed = message != m_message;
+        m_message = message;
+        if ( progress > m_progress )
+        {
+            m_progress = progress;
+            changed = true;
+        }
+        return changed;
+    }
+    return false;
+}
+
+void
+ProgressParser::reset()
+{
+    m_progress = 0.0;
+    m_message.clear();
+    m_steps = 0;
+    m_stepRule = -1;
+    m_totalSteps = 0;
+}
+
+/// @brief Shorthand for building the rules below
+static inline ProgressParser::Rule
+rule( const char* pattern, qreal start, qreal end )
+{
+    return ProgressParser::Rule { QRegularExpression( QString::fromLatin1( pattern ) ), start, end };
+}
+
+/* The rules for each backend. Downloading and preparing is usually
+ * quicker than the actual installation, which is where the time goes
+ * (on slow media, or because of post-install scripts).
+ */
+
+/** @brief apt-get, run with `-o APT::Status-Fd=1`
+ *
+ * The status lines look like "dlstatus:3:27.5:Retrieving file 3 of 10"
+ * and "pmstatus:foo:40.0:Installing foo (amd64)"; the percentage is
+ * for the whole download, or the whole dpkg run.
+ */
+static QList< ProgressParser::Rule >
+aptRules()
+{
+    return { rule( "^dlstatus:[^:]*:(?<percent>[0-9.]+):(?<message>.*)$", 0.0, 0.4 ),
+             rule( "^pmstatus:[^:]*:(?<percent>[0-9.]+):(?<message>.*)$", 0.4, 1.0 ) };
+}
+
+/** @brief dnf and yum
+ *
+ * Downloads look like "(3/10): foo-1.0.rpm  100 kB/s | 50 kB  00:00",
+ * the transaction like "  Installing   : foo-1.0.x86_64    3/10"
+ * followed by "  Verifying    : foo-1.0.x86_64    3/10".
+ */
+static QList< ProgressParser::Rule >
+dnfRules()
+{
+    return {
+        rule( "^\\(\\s*(?<done>\\d+)/(?<total>\\d+)\\):\\s*(?<message>\\S+)", 0.0, 0.4 ),
+        rule( "^\\s*(?<message>(?:Installing|Upgrading|Reinstalling|Downgrading|Removing|Erasing|Obsoleting|Cleanup|"
+              "Running scriptlet)\\s*:\\s*\\S+)\\s+(?<done>\\d+)/(?<total>\\d+)\\s*$",
+              0.4,
+              0.9 ),
+        rule( "^\\s*(?<message>Verifying\\s*:\\s*\\S+)\\s+(?<done>\\d+)/(?<total>\\d+)\\s*$", 0.9, 1.0 ),
+    };
+}
+
+/** @brief pacman, and tools that use its output
+ *
+ * The transaction summary "Packages (10) foo-1.0 ..." gives the number
+ * of packages, and each download is one line (the wording differs
+ * between pacman versions). On a terminal, each stage of the transaction
+ * counts its steps like "(  3/10) installing foo". Otherwise (as when
+ * run from Calamares) pacman acts as with --noprogressbar: the stages
+ * are a single line like "checking package integrity..." and each
+ * package is a line "installing foo...", counted against the summary.
+ * After the packages come the hooks, which are counted like "(1/3) ..."
+ * in either case.
+ */
+static QList< ProgressParser::Rule >
+pacmanRules()
+{
+    return {
+        rule( "^Packages \\((?<total>\\d+)\\)", 0.0, 0.0 ),
+        rule( "^\\s*downloading (?<message>\\S+)\\.\\.\\.$", 0.0, 0.3 ),
+        rule( "^\\s*(?<message>\\S+) downloading\\.\\.\\.$", 0.0, 0.3 ),
+        rule( "^(?<message>checking (?:keyring|package integrity|for file conflicts|available disk space)|"
+              "loading package files)\\.\\.\\.$",
+              0.3,
+              0.3 ),
+        rule( "^(?<message>(?:installing|upgrading|reinstalling|downgrading|removing) \\S+)\\.\\.\\.$", 0.4, 0.95 ),
+        rule( "^\\(\\s*(?<done>\\d+)/(?<total>\\d+)\\)\\s*(?<message>(?:installing|upgrading|reinstalling|downgrading|"
+              "removing) .*)$",
+              0.4,
+              0.95 ),
+        rule( "^\\(\\s*(?<done>\\d+)/(?<total>\\d+)\\)\\s*(?<message>checking .*|loading .*)$", 0.3, 0.4 ),
+        rule( "^\\(\\s*(?<done>\\d+)/(?<total>\\d+)\\)\\s*(?<message>.*)$", 0.95, 1.0 ),
+    };
+}
+
+/** @brief zypper
+ *
+ * Downloads look like "Retrieving package foo-1.0.x86_64  (3/10),  50.0 KiB",
+ * installation like "(3/10) Installing: foo-1.0.x86_64 [...done]".
+ */
+static QList< ProgressParser::Rule >
+zyppRules()
+{
+    return {
+        rule( "^Retrieving package (?<message>\\S+)\\s+\\((?<done>\\d+)/(?<total>\\d+)\\)", 0.0, 0.4 ),
+        rule( "^\\((?<done>\\d+)/(?<total>\\d+)\\)\\s*(?<message>(?:Installing|Removing):\\s*\\S+)", 0.4, 1.0 ),
+    };
+}
+
+std::unique_ptr< ProgressParser >
+ProgressParser::forBackend( const QString& backend )
+{
+    if ( backend == QStringLiteral( "apt" ) )
+    {
+        return std::make_unique< ProgressParser >( aptRules() );
+    }
+    if ( backend == QStringLiteral( "dnf" ) || backend == QStringLiteral( "yum" ) )
+    {
+        return std::make_unique< ProgressParser >( dnfRules() );
+    }
+    if ( backend == QStringLiteral( "pacman" ) )
+    {
+        return std::make_unique< ProgressParser >( pacmanRules() );
+    }
+    if ( backend == QStringLiteral( "zypp" ) )
+    {
+        return std::make_unique< ProgressParser >( zyppRules() );
+    }
+    return nullptr;
+}
+
+QStringList
+ProgressParser::backends()
+{
+    return { QStringLiteral( "apt" ),
+             QStringLiteral( "dnf" ),
+             QStringLiteral( "pacman" ),
+             QStringLiteral( "yum" ),
+             QStringLiteral( "zypp" ) };
+}
+
+}  // namespace CalamaresUtils
@@ -0,0 +1,97 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#ifndef UTILS_PROGRESSPARSER_H
+#define UTILS_PROGRESSPARSER_H
+
+#include "DllMacro.h"
+
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+namespace CalamaresUtils
+{
+
+/** @brief Turns the output of a long-running command into progress
+ *
+ * Package managers print what they are doing, and often how far along
+ * they are ("(12/345) installing foo"). A parser is fed that output a
+ * line at a time (see System::runCommand() with an output handler) and
+ * keeps track of the progress (from 0 to 1) and a status message.
+ *
+ * The output is described by a list of rules, each of which is a
+ * phase of the work covering a part [start, end] of the progress.
+ * The first rule whose pattern matches a line applies. The pattern
+ * may use these named capture groups:
+ *  - `done` and `total`, for "done out of total" in the phase,
+ *  - `percent`, for the percentage done in the phase,
+ *  - `message`, for the status message (otherwise the whole line).
+ * A rule that captures only a `total` sets the number of steps for
+ * rules that capture no numbers at all: each line matching one of
+ * those counts as one step of its phase (each rule counts its own
+ * steps). Otherwise, a line without numbers just marks the start
+ * of the phase.
+ *
+ * Progress never goes backwards, so phases that are reported more
+ * than once do not make the progress bar jump around.
+ */
+class DLLEXPORT ProgressParser
+{
+public:
+    struct Rule
+    {
+        QRegularExpression pattern;
+        qreal start = 0.0;  ///< Progress when this phase begins
+        qreal end = 0.0;  ///< Progress when this phase is complete
+    };
+
+    explicit ProgressParser( const QList< Rule >& rules );
+
+    /** @brief A parser for the output of package manager @p backend
+     *
+     * The backend names are those of the *packages* module. Returns
+     * nullptr for backends without a parser (see backends()). Some
+     * backends need options to produce parseable output; see the
+     * implementation for the rules of each.
+     */
+    static std::unique_ptr< ProgressParser > forBackend( const QString& backend );
+    /// @brief The names of backends that forBackend() knows
+    static QStringList backends();
+
+    /** @brief Feeds one line of output to the parser
+     *
+     * Returns @c true if the progress or message changed.
+     */
+    bool parseLine( const QString& line );
+
+    /// @brief Progress so far, from 0 to 1
+    qreal progress() const { return m_progress; }
+    /// @brief Description of the current step (may be empty)
+    QString message() const { return m_message; }
+
+    /// @brief Forget the progress so far (e.g. to parse another command)
+    void reset();
+
+private:
+    QList< Rule > m_rules;
+    qreal m_progress = 0.0;
+    QString m_message;
+    int m_steps = 0;  ///< Steps counted, for rules without numbers
+    int m_stepRule = -1;  ///< The rule whose steps are counted
+    int m_totalSteps = 0;  ///< From a rule with only a total
+};
+
+}  // namespace CalamaresUtils
+
+#endif
@@ -0,0 +1,420 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#include "Scheduling.h"
+
+#include "utils/Logger.h"
+#include "utils/Variant.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace CalamaresUtils
+{
+
+const NamedEnumTable< SchedulingPolicy::IOClass >&
+SchedulingPolicy::ioClassNames()
+{
+    using IOClass = SchedulingPolicy::IOClass;
+    // *INDENT-OFF*
+    // clang-format off
+    static const NamedEnumTable< IOClass > table {
+        { QStringLiteral( "realtime" ), IOClass::RealTime },
+        { QStringLiteral( "best-effort" ), IOClass::BestEffort },
+        { QStringLiteral( "idle" ), IOClass::Idle },
+        // Alternate names, as used by ionice(1)
+        { QStringLiteral( "rt" ), IOClass::RealTime },
+        { QStringLiteral( "be" ), IOClass::BestEffort },
+    };
+    // *INDENT-ON*
+    // clang-format on
+    return table;
+}
+
+/// @brief Integer @p key from @p map in [ @p min, @p max ], or @p d if missing or invalid
+static std::optional< int >
+getBoundedInteger( const QVariantMap& map, const char* key, int min, int max, std::optional< int > d )
+{
+    if ( !map.contains( key ) )
+    {
+        return d;
+    }
+    bool ok = false;
+    const int v = map.value( key ).toInt( &ok );
+    if ( !ok || v < min || v > max )
+    {
+        cWarning() << "Scheduling setting" << key << map.value( key ) << "is not in the range" << min << max;
+        return d;
+    }
+    return v;
+}
+
+SchedulingPolicy
+SchedulingPolicy::fromMap( const QVariantMap& map, const SchedulingPolicy& defaults )
+{
+    SchedulingPolicy p = defaults;
+    p.m_nice = getBoundedInteger( map, "nice", -20, 19, defaults.m_nice );
+    p.m_cpuWeight = getBoundedInteger( map, "cpu-weight", 1, 10000, defaults.m_cpuWeight );
+    p.m_ioWeight = getBoundedInteger( map, "io-weight", 1, 10000, defaults.m_ioWeight );
+    p.m_ioPriority = getBoundedInteger( map, "io-priority", 0, 7, defaults.m_ioPriority ).value();
+
+    if ( map.contains( "io-class" ) )
+    {
+        bool ok = false;
+        const QString name = getString( map, "io-class" );
+        const IOClass c = ioClassNames().find( name, ok );
+        if ( ok )
+        {
+            p.m_ioClass = c;
+        }
+        else
+        {
+            cWarning() << "Scheduling setting io-class" << name << "is not a known I/O class";
+        }
+    }
+    return p;
+}
+
+#ifdef Q_OS_LINUX
+// From linux/ioprio.h, which is not always installed
+static constexpr int ioprioWhoProcess = 1;
+static constexpr int ioprioClassShift = 13;
+
+static pid_t
+currentThreadId()
+{
+    return static_cast< pid_t >( syscall( SYS_gettid ) );
+}
+
+/** @brief Sets niceness and I/O priority of task @p who (a thread or process id)
+ *
+ * On Linux, both are attributes of a single task (thread), so for
+ * processes this affects the main thread, which is all there is
+ * just after starting a command.
+ */
+static bool
+applyPriority( pid_t who,
+               const std::optional< int >& nice,
+               const std::optional< SchedulingPolicy::IOClass >& ioClass,
+               int ioPriority )
+{
+    bool ok = true;
+    if ( nice && setpriority( PRIO_PROCESS, static_cast< id_t >( who ), nice.value() ) != 0 )
+    {
+        cWarning() << "Could not set nice" << nice.value() << "for" << who << strerror( errno );
+        ok = false;
+    }
+    if ( ioClass )
+    {
+        const int value = ( static_cast< int >( ioClass.value() ) << ioprioClassShift ) | ioPriority;
+        if ( syscall( SYS_ioprio_set, ioprioWhoProcess, who, value ) != 0 )
+        {
+            cWarning() << "Could not set I/O priority" << int( ioClass.value() ) << ioPriority << "for" << who
+                       << strerror( errno );
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static bool
+writeFile( const QString& path, const QByteArray& contents )
+{
+    QFile f( path );
+    return f.open( QIODevice::WriteOnly ) && f.write( contents ) == contents.size();
+}
+
+static const char cgroupRoot[] = "/sys/fs/cgroup";
+static QMutex s_cgroupMutex;
+static QHash< QString, bool > s_cgroups;  ///< Path to "could be created"
+static std::optional< QString > s_cgroupParent;  ///< Where the cgroups go, empty for nowhere
+
+/** @brief The cgroup (directory) of this process in the cgroup v2 hierarchy
+ *
+ * Returns an empty string if there is no such hierarchy.
+ */
+static QString
+ownCgroup()
+{
+    QFile f( QStringLiteral( "/proc/self/cgroup" ) );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return QString();
+    }
+    // The v2 hierarchy is the line "0::/some/path"; others are v1 controllers
+    for ( const QByteArray& line : f.readAll().split( '\n' ) )
+    {
+        if ( line.startsWith( "0::/" ) )
+        {
+            const QString path = QString::fromUtf8( line.mid( 3 ) );
+            return QDir::cleanPath( QString::fromLatin1( cgroupRoot ) + path );
+        }
+    }
+    return QString();
+}
+
+/** @brief The cgroup below which the cgroups for the weights are created
+ *
+ * This is the cgroup of Calamares itself, so that the weights are
+ * relative to Calamares (and the rest of the system is not touched).
+ * Processes may only live in the leaves of the hierarchy, so before
+ * the controllers are enabled for its children, the processes in it
+ * move to a leaf of their own. Calamares usually runs as root, but
+ * if its cgroup is not writable (e.g. not delegated to it), nothing
+ * is changed and the weights are ignored. Call this with the lock held.
+ */
+static QString
+cgroupParent()
+{
+    if ( s_cgroupParent )
+    {
+        return s_cgroupParent.value();
+    }
+    s_cgroupParent = QString();
+
+    const QString own = ownCgroup();
+    if ( own.isEmpty() || !QFile::exists( own + QStringLiteral( "/cgroup.controllers" ) ) )
+    {
+        cWarning() << "There is no cgroup v2 hierarchy, CPU and I/O weights are ignored.";
+        return QString();
+    }
+    if ( access( QFile::encodeName( own ).constData(), W_OK ) != 0 )
+    {
+        cWarning() << "The cgroup" << own << "is not writable, CPU and I/O weights are ignored.";
+        return QString();
+    }
+
+    // The root of the hierarchy is the exception, it may have processes and children
+    if ( own != QString::fromLatin1( cgroupRoot ) )
+    {
+        const QString leaf = own + QStringLiteral( "/calamares" );
+        QFile procs( own + QStringLiteral( "/cgroup.procs" ) );
+        const QList< QByteArray > pids
+            = procs.open( QIODevice::ReadOnly ) ? procs.readAll().split( '\n' ) : QList< QByteArray >();
+        bool ok = QDir().mkpath( leaf );
+        for ( const QByteArray& pid : pids )
+        {
+            // One pid per write; this moves the process, with all of its threads
+            ok = ok && ( pid.trimmed().isEmpty() || writeFile( leaf + QStringLiteral( "/cgroup.procs" ), pid ) );
+        }
+        if ( !ok )
+        {
+            cWarning() << "Could not move the processes of cgroup" << own << "to" << leaf
+                       << ", CPU and I/O weights are ignored.";
+            return QString();
+        }
+    }
+
+    // Both controllers are enabled for the children, although only one of them may be needed.
+    if ( !writeFile( own + QStringLiteral( "/cgroup.subtree_control" ), QByteArrayLiteral( "+cpu +io" ) ) )
+    {
+        cWarning() << "Could not enable CPU and I/O control for cgroup" << own << ", CPU and I/O weights are ignored.";
+        return QString();
+    }
+    s_cgroupParent = own;
+    return own;
+}
+
+/** @brief The cgroup (directory) for the given weights
+ *
+ * The cgroups are created below Calamares' own cgroup (see cgroupParent()),
+ * once for each combination of weights (until removeCgroups() is called).
+ * Returns an empty string if there is no such cgroup (e.g. on a cgroup
+ * v1 system).
+ */
+static QString
+cgroupFor( const std::optional< int >& cpuWeight, const std::optional< int >& ioWeight )
+{
+    QMutexLocker l( &s_cgroupMutex );
+    const QString parent = cgroupParent();
+    if ( parent.isEmpty() )
+    {
+        return QString();
+    }
+
+    const QString path = parent
+        + QStringLiteral( "/cpu%1-io%2" ).arg( cpuWeight.value_or( 0 ) ).arg( ioWeight.value_or( 0 ) );
+    if ( s_cgroups.contains( path ) )
+    {
+        return s_cgroups.value( path ) ? path : QString();
+    }
+
+    bool ok = QDir().mkpath( path );
+    if ( !ok )
+    {
+        cWarning() << "Could not create cgroup" << path << ", CPU and I/O weights are ignored.";
+    }
+    // A missing weight is not fatal: not every I/O scheduler supports io.weight
+    if ( ok && cpuWeight
+         && !writeFile( path + QStringLiteral( "/cpu.weight" ), QByteArray::number( cpuWeight.value() ) ) )
+    {
+        cWarning() << "Could not set CPU weight" << cpuWeight.value() << "for cgroup" << path;
+    }
+    if ( ok && ioWeight
+         && !writeFile( path + QStringLiteral( "/io.weight" ),
+                        QByteArrayLiteral( "default " ) + QByteArray::number( ioWeight.value() ) ) )
+    {
+        cWarning() << "Could not set I/O weight" << ioWeight.value() << "for cgroup" << path;
+    }
+
+    s_cgroups.insert( path, ok );
+    return ok ? path : QString();
+}
+#endif
+
+SchedulingPolicy
+SchedulingPolicy::ofCurrentThread()
+{
+    SchedulingPolicy p;
+#ifdef Q_OS_LINUX
+    const pid_t tid = currentThreadId();
+    errno = 0;
+    const int nice = getpriority( PRIO_PROCESS, static_cast< id_t >( tid ) );
+    if ( errno == 0 )
+    {
+        p.m_nice = nice;
+    }
+    const long value = syscall( SYS_ioprio_get, ioprioWhoProcess, tid );
+    if ( value >= 0 )
+    {
+        const int ioClass = int( value >> ioprioClassShift );
+        if ( ioClass >= int( IOClass::RealTime ) && ioClass <= int( IOClass::Idle ) )
+        {
+            p.m_ioClass = static_cast< IOClass >( ioClass );
+            p.m_ioPriority = int( value & 0xff );
+        }
+        else
+        {
+            // No class, the kernel derives the priority from the niceness
+            p.m_ioClass = IOClass::BestEffort;
+            p.m_ioPriority = qBound( 0, ( p.m_nice.value_or( 0 ) + 20 ) / 5, 7 );
+        }
+    }
+#endif
+    return p;
+}
+
+bool
+SchedulingPolicy::applyToCurrentThread() const
+{
+#ifdef Q_OS_LINUX
+    return applyPriority( currentThreadId(), m_nice, m_ioClass, m_ioPriority );
+#else
+    return isEmpty();
+#endif
+}
+
+SchedulingPolicy::ChildSetup::ChildSetup( const SchedulingPolicy& policy )
+{
+#ifdef Q_OS_LINUX
+    m_nice = policy.m_nice;
+    if ( policy.m_ioClass )
+    {
+        m_ioPriority = ( static_cast< int >( policy.m_ioClass.value() ) << ioprioClassShift ) | policy.m_ioPriority;
+    }
+    if ( policy.m_cpuWeight || policy.m_ioWeight )
+    {
+        const QString cgroup = cgroupFor( policy.m_cpuWeight, policy.m_ioWeight );
+        if ( !cgroup.isEmpty() )
+        {
+            m_cgroupProcs = QFile::encodeName( cgroup + QStringLiteral( "/cgroup.procs" ) );
+        }
+    }
+#else
+    Q_UNUSED( policy )
+#endif
+}
+
+void
+SchedulingPolicy::ChildSetup::apply() const noexcept
+{
+#ifdef Q_OS_LINUX
+    // 0 is the calling process, which has just the one thread
+    if ( m_nice )
+    {
+        setpriority( PRIO_PROCESS, 0, m_nice.value() );
+    }
+    if ( m_ioPriority >= 0 )
+    {
+        syscall( SYS_ioprio_set, ioprioWhoProcess, 0, m_ioPriority );
+    }
+    if ( !m_cgroupProcs.isEmpty() )
+    {
+        // Writing 0 to cgroup.procs moves the writing process
+        const int fd = open( m_cgroupProcs.constData(), O_WRONLY | O_CLOEXEC );
+        if ( fd >= 0 )
+        {
+            ssize_t ignored = write( fd, "0", 1 );
+            (void)ignored;
+            close( fd );
+        }
+    }
+#endif
+}
+
+void
+SchedulingPolicy::removeCgroups()
+{
+#ifdef Q_OS_LINUX
+    QMutexLocker l( &s_cgroupMutex );
+    for ( auto it = s_cgroups.begin(); it != s_cgroups.end(); )
+    {
+        // Failures are remembered, so that they are only reported once
+        if ( !it.value() )
+        {
+            ++it;
+            continue;
+        }
+        // A cgroup is removed with rmdir(), which fails while it has processes
+        const QString path = it.key();
+        if ( QDir().rmdir( path ) )
+        {
+            it = s_cgroups.erase( it );
+        }
+        else
+        {
+            cDebug() << "Could not remove cgroup" << path << "(it may still be in use).";
+            ++it;
+        }
+    }
+#endif
+}
+
+static QMutex s_currentMutex;
+static SchedulingPolicy s_current;
+
+SchedulingPolicy
+SchedulingPolicy::current()
+{
+    QMutexLocker l( &s_currentMutex );
+    return s_current;
+}
+
+void
+SchedulingPolicy::setCurrent( const SchedulingPolicy& policy )
+{
+    QMutexLocker l( &s_currentMutex );
+    s_current = policy;
+}
+
+}  // namespace CalamaresUtils
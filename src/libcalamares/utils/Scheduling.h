@@ -0,0 +1,151 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ *
+ */
+
+#ifndef UTILS_SCHEDULING_H
+#define UTILS_SCHEDULING_H
+
+#include "DllMacro.h"
+
+#include "utils/NamedEnum.h"
+
+#include <QByteArray>
+#include <QVariantMap>
+
+#include <optional>
+
+namespace CalamaresUtils
+{
+
+/** @brief CPU and I/O priority for the work done by jobs
+ *
+ * During installation the jobs (rsync, unsquashfs, package managers)
+ * compete with the user interface and the slideshow for CPU and disk.
+ * A policy describes how jobs should be scheduled:
+ *  - *nice*, the CPU niceness (-20 to 19) of the job thread and of
+ *    the commands it runs,
+ *  - *io-class* and *io-priority*, the I/O scheduling class (realtime,
+ *    best-effort or idle) and the priority within the class (0 to 7),
+ *  - *cpu-weight* and *io-weight*, the cgroup v2 weights (1 to 10000,
+ *    where 100 is the default) for the commands that are run.
+ *
+ * Each of these is optional; a policy only changes the things that
+ * are set. The GUI thread is never changed.
+ *
+ * Niceness and I/O priority are per-thread on Linux, and are inherited
+ * by child processes. The cgroup weights need a cgroup v2 hierarchy
+ * at /sys/fs/cgroup; commands are moved into a cgroup with the requested
+ * weights, below the (writable) cgroup of Calamares itself, so the weights
+ * are relative to Calamares. If that is not possible, the weights are
+ * ignored (with a warning, once). The cgroups are removed again when
+ * the job is done.
+ */
+class DLLEXPORT SchedulingPolicy
+{
+public:
+    enum class IOClass
+    {
+        RealTime = 1,
+        BestEffort = 2,
+        Idle = 3
+    };
+    static const NamedEnumTable< IOClass >& ioClassNames();
+
+    /// @brief A policy that changes nothing
+    SchedulingPolicy() = default;
+
+    /** @brief Reads a policy from a configuration map
+     *
+     * The keys are those listed in the class description. Keys that
+     * are missing from @p map keep the value from @p defaults, so a
+     * module can override part of the global policy. Values out of
+     * range are ignored, with a warning.
+     */
+    static SchedulingPolicy fromMap( const QVariantMap& map, const SchedulingPolicy& defaults = SchedulingPolicy() );
+
+    /** @brief The niceness and I/O priority of the calling thread
+     *
+     * This is used to restore a thread after applying a policy.
+     * The cgroup weights are not set.
+     */
+    static SchedulingPolicy ofCurrentThread();
+
+    /// @brief Does this policy change anything?
+    bool isEmpty() const { return !m_nice && !m_ioClass && !m_cpuWeight && !m_ioWeight; }
+
+    std::optional< int > nice() const { return m_nice; }
+    std::optional< IOClass > ioClass() const { return m_ioClass; }
+    int ioPriority() const { return m_ioPriority; }
+    std::optional< int > cpuWeight() const { return m_cpuWeight; }
+    std::optional< int > ioWeight() const { return m_ioWeight; }
+
+    /** @brief Applies niceness and I/O priority to the calling thread
+     *
+     * Commands started from the thread afterwards inherit these.
+     * Returns @c false if the kernel refused (e.g. raising the
+     * priority without privileges).
+     */
+    bool applyToCurrentThread() const;
+
+    /** @brief The policy, prepared for a command that is about to start
+     *
+     * A policy is applied in the child process, between fork() and
+     * exec(), so that the command never runs (or starts threads or
+     * children of its own) without it. The child of a multithreaded
+     * process may not allocate or take locks, so everything that does
+     * -- creating the cgroup, building its path -- is done by the
+     * constructor, in the parent. apply() only makes system calls.
+     */
+    class DLLEXPORT ChildSetup
+    {
+    public:
+        explicit ChildSetup( const SchedulingPolicy& policy );
+
+        /** @brief Applies the policy to the calling process
+         *
+         * This is meant to be called in the child; errors are ignored,
+         * since there is no safe way to report them there.
+         */
+        void apply() const noexcept;
+
+    private:
+        std::optional< int > m_nice;
+        int m_ioPriority = -1;  ///< The value for ioprio_set(), or -1
+        QByteArray m_cgroupProcs;  ///< Path of the cgroup.procs file, or empty
+    };
+
+    /** @brief Removes the cgroups created for the weights
+     *
+     * The job queue calls this when a job ends, so that no cgroups
+     * are left behind. A cgroup that still has processes in it (e.g. a
+     * daemon started by the job) can not be removed and is left alone.
+     */
+    static void removeCgroups();
+
+    /** @brief The policy for the job that is running
+     *
+     * This is set by the job queue for each job, and applied by
+     * System::runCommand() to the commands it starts, even
+     * when they are started from other threads than the job's.
+     * Outside of the jobs, the policy is empty.
+     */
+    static SchedulingPolicy current();
+    static void setCurrent( const SchedulingPolicy& policy );
+
+private:
+    std::optional< int > m_nice;
+    std::optional< IOClass > m_ioClass;
+    int m_ioPriority = 4;  ///< Only meaningful with an I/O class
+    std::optional< int > m_cpuWeight;
+    std::optional< int > m_ioWeight;
+};
+
+}  // namespace CalamaresUtils
+
+#endif
@@ -9,10 +9,15 @@
  *
  */
 
+#include "Accounts.h"
 #include "CalamaresUtilsSystem.h"
+#include "ChrootSession.h"
 #include "Entropy.h"
+#include "LogRecord.h"
 #include "Logger.h"
+#include "ProgressParser.h"
 #include "RAII.h"
+#include "Scheduling.h"
 #include "String.h"
 #include "Traits.h"
 #include "UMask.h"
@@ -22,6 +27,12 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 
 #include <QtTest/QtTest>
@@ -39,12 +50,29 @@ public:
 
 private Q_SLOTS:
     void initTestCase();
+    /** @brief Tests that debug messages go to the log file by default (must run first). */
+    void testDebugFileDefault();
     void testDebugLevels();
+    /** @brief Tests that disabled messages are not formatted. */
+    void testDebugLazy();
+    /** @brief Tests encoding and decoding structured log records. */
+    void testLogRecord();
 
     void testLoadSaveYaml();  // Just settings.conf
     void testLoadSaveYamlExtended();  // Do a find() in the src dir
 
     void testCommands();
+    void testCommandOutputLines();
+    void testChrootSession();
+
+    /** @brief Tests turning package-manager output into progress. */
+    void testProgressParser();
+
+    /** @brief Tests reading and applying CPU and I/O priorities. */
+    void testSchedulingPolicy();
+
+    /** @brief Tests editing passwd, group and shadow files. */
+    void testAccountDatabase();
 
     /** @brief Test that all the UMask objects work correctly. */
     void testUmask();
@@ -63,6 +91,8 @@ private Q_SLOTS:
     void testVariantStringListCode();
     void testVariantStringListYAMLDashed();
     void testVariantStringListYAMLBracketed();
+    /** @brief Tests that secrets do not leave GlobalStorage */
+    void testVariantRedacted();
 
     /** @brief Test smart string truncation. */
     void testStringTruncation();
@@ -82,6 +112,24 @@ LibCalamaresTests::initTestCase()
 {
 }
 
+void
+LibCalamaresTests::testDebugFileDefault()
+{
+    QStandardPaths::setTestModeEnabled( true );
+    // As when Calamares runs without -D or -F
+    Logger::setupLogLevel( Logger::LOGERROR );
+    QVERIFY( Logger::logLevelEnabled( Logger::LOGDEBUG ) );
+    QVERIFY( Logger::logLevelEnabled( Logger::LOGVERBOSE ) );
+
+    Logger::setupLogfile();
+    const QString marker = QStringLiteral( "file-default-%1" ).arg( QDateTime::currentMSecsSinceEpoch() );
+    cDebug() << marker;
+
+    QFile log( Logger::logFile() );
+    QVERIFY( log.open( QIODevice::ReadOnly ) );
+    QVERIFY( log.readAll().contains( marker.toUtf8() ) );
+}
+
 void
 LibCalamaresTests::testDebugLevels()
 {
@@ -100,6 +148,104 @@ LibCalamaresTests::testDebugLevels()
             QCOMPARE( Logger::logLevelEnabled( xlevel ), xlevel <= level );
         }
     }
+
+    // The file level adds to the console level
+    Logger::setupLogLevel( Logger::LOGWARNING );
+    Logger::setupFileLogLevel( Logger::LOGDEBUG );
+    QCOMPARE( Logger::logLevel(), static_cast< unsigned int >( Logger::LOGWARNING ) );
+    QVERIFY( Logger::logLevelEnabled( Logger::LOGDEBUG ) );
+    QVERIFY( !Logger::logLevelEnabled( Logger::LOGVERBOSE ) );
+    Logger::setupFileLogLevel( Logger::LOG_DISABLE );
+    QVERIFY( !Logger::logLevelEnabled( Logger::LOGDEBUG ) );
+    QVERIFY( Logger::logLevelEnabled( Logger::LOGWARNING ) );
+}
+
+void
+LibCalamaresTests::testDebugLazy()
+{
+    int evaluated = 0;
+    auto count = [ & ]() { return ++evaluated; };
+    int called = 0;
+    auto lazy = Logger::Lazy( [ & ]( QDebug& s ) {
+        ++called;
+        s << "lazy";
+    } );
+
+    Logger::setupFileLogLevel( Logger::LOG_DISABLE );
+    Logger::setupLogLevel( Logger::LOGWARNING );
+    cDebug() << "Not logged" << count() << lazy;
+    cVerbose() << "Not logged" << count() << lazy;
+    QCOMPARE( evaluated, 0 );
+    QCOMPARE( called, 0 );
+    cWarning() << "Logged" << count() << lazy;
+    QCOMPARE( evaluated, 1 );
+    QCOMPARE( called, 1 );
+
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+    cDebug() << "Logged" << count() << lazy;
+    QCOMPARE( evaluated, 2 );
+    QCOMPARE( called, 2 );
+
+    // Only compiled in for debug builds
+    Logger::setupLogLevel( Logger::LOGVERBOSE );
+    cVerbose() << "Maybe logged" << count();
+    QCOMPARE( evaluated, Logger::verboseCompiledIn ? 3 : 2 );
+
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+}
+
+void
+LibCalamaresTests::testLogRecord()
+{
+    Logger::Record r;
+    r.level = Logger::LOGWARNING;
+    r.time = QDateTime::currentMSecsSinceEpoch();
+    r.thread = 0x7f0012345678ULL;
+    r.function = QStringLiteral( "void f()" );
+    r.context = QStringLiteral( "unpackfs@unpackfs#0" );
+    r.message = QStringLiteral( "Wrote 17 files ✓" );
+    r.fields.insert( QStringLiteral( "count" ), 17 );
+    r.fields.insert( QStringLiteral( "offset" ), qint64( -3000000000LL ) );
+    r.fields.insert( QStringLiteral( "ok" ), true );
+    r.fields.insert( QStringLiteral( "device" ), QStringLiteral( "/dev/sda1" ) );
+
+    Logger::Record minimal;
+    minimal.message = QStringLiteral( "hello" );
+
+    const QByteArray data = Logger::encodeRecord( r ) + Logger::encodeRecord( minimal );
+
+    int offset = 0;
+    Logger::Record d;
+    QVERIFY( Logger::decodeRecord( data, offset, d ) );
+    QCOMPARE( d.level, r.level );
+    QCOMPARE( d.time, r.time );
+    QCOMPARE( d.thread, r.thread );
+    QCOMPARE( d.function, r.function );
+    QCOMPARE( d.context, r.context );
+    QCOMPARE( d.message, r.message );
+    QCOMPARE( d.fields.count(), 4 );
+    QCOMPARE( d.fields.value( "count" ).toInt(), 17 );
+    QCOMPARE( d.fields.value( "offset" ).toLongLong(), -3000000000LL );
+    QCOMPARE( d.fields.value( "ok" ).toBool(), true );
+    QCOMPARE( d.fields.value( "device" ).toString(), QStringLiteral( "/dev/sda1" ) );
+    QVERIFY( Logger::toText( d ).contains( QStringLiteral( "\n    device: /dev/sda1" ) ) );
+
+    QVERIFY( Logger::decodeRecord( data, offset, d ) );
+    QCOMPARE( d.message, minimal.message );
+    QVERIFY( d.function.isEmpty() );
+    QVERIFY( d.context.isEmpty() );
+    QVERIFY( d.fields.isEmpty() );
+    QCOMPARE( offset, data.size() );
+    QVERIFY( !Logger::decodeRecord( data, offset, d ) );
+
+    // A record that was cut off is not decoded
+    const int first = Logger::encodeRecord( r ).size();
+    for ( int cut : { 1, 3, 4, 10, first - 1 } )
+    {
+        int o = 0;
+        QVERIFY( !Logger::decodeRecord( data.left( cut ), o, d ) );
+        QCOMPARE( o, 0 );
+    }
 }
 
 void
@@ -237,6 +383,338 @@ LibCalamaresTests::testCommands()
     QVERIFY( r.getOutput().contains( tfn.fileName() ) );
 }
 
+void
+LibCalamaresTests::testCommandOutputLines()
+{
+    using CalamaresUtils::System;
+    QStringList lines;
+    auto r = System::runCommand( System::RunLocation::RunInHost,
+                                 { "/bin/sh", "-c", "echo one; echo two >&2; printf '3%%\\r4%%\\rdone'" },
+                                 QString(),
+                                 QString(),
+                                 std::chrono::seconds( 0 ),
+                                 [ &lines ]( const QString& line ) { lines.append( line ); } );
+    QCOMPARE( r.getExitCode(), 0 );
+    QCOMPARE( lines, QStringList( { "one", "two", "3%", "4%", "done" } ) );
+    QCOMPARE( r.getOutput(), QStringLiteral( "one\ntwo\n3%\r4%\rdone" ) );
+
+    lines.clear();
+    r = System::runCommand( System::RunLocation::RunInHost,
+                            { "/bin/sh", "-c", "echo before; sleep 5" },
+                            QString(),
+                            QString(),
+                            std::chrono::seconds( 1 ),
+                            [ &lines ]( const QString& line ) { lines.append( line ); } );
+    QCOMPARE( r.getExitCode(), int( CalamaresUtils::ProcessResult::Code::TimedOut ) );
+    QCOMPARE( lines, QStringList( { "before" } ) );
+
+    // A progress bar ends its lines with a carriage return only; they
+    // are handled as they come, not when the next newline comes.
+    lines.clear();
+    QElapsedTimer timer;
+    timer.start();
+    qint64 firstLineAt = -1;
+    r = System::runCommand( System::RunLocation::RunInHost,
+                            { "/bin/sh", "-c", "printf '10%%\\r'; sleep 2; printf '100%%\\rdone\\n'" },
+                            QString(),
+                            QString(),
+                            std::chrono::seconds( 0 ),
+                            [ &lines, &timer, &firstLineAt ]( const QString& line ) {
+                                if ( lines.isEmpty() )
+                                {
+                                    firstLineAt = timer.elapsed();
+                                }
+                                lines.append( line );
+                            } );
+    QCOMPARE( r.getExitCode(), 0 );
+    QCOMPARE( lines, QStringList( { "10%", "100%", "done" } ) );
+    QVERIFY( firstLineAt >= 0 && firstLineAt < 1500 );
+}
+
+void
+LibCalamaresTests::testProgressParser()
+{
+    using CalamaresUtils::ProgressParser;
+
+    QVERIFY( !ProgressParser::forBackend( "dummy" ) );
+    for ( const auto& backend : ProgressParser::backends() )
+    {
+        QVERIFY( ProgressParser::forBackend( backend ) );
+    }
+
+    {
+        auto p = ProgressParser::forBackend( "pacman" );
+        QVERIFY( !p->parseLine( "resolving dependencies..." ) );
+        QVERIFY( !p->parseLine( "Packages (2) foo-1.0-1  bar-2.0-1" ) );  // Just the total
+        QVERIFY( p->parseLine( "downloading foo-1.0-1-x86_64.pkg.tar.zst..." ) );
+        QCOMPARE( p->message(), QStringLiteral( "foo-1.0-1-x86_64.pkg.tar.zst" ) );
+        QVERIFY( p->progress() > 0.1 && p->progress() < 0.2 );
+        QVERIFY( p->parseLine( "(2/2) checking package integrity" ) );
+        QCOMPARE( p->progress(), 0.4 );
+        QVERIFY( p->parseLine( "(1/2) installing foo" ) );
+        QCOMPARE( p->message(), QStringLiteral( "installing foo" ) );
+        const qreal halfway = p->progress();
+        QVERIFY( halfway > 0.4 && halfway < 0.95 );
+        // Going back to an earlier stage keeps the progress
+        QVERIFY( p->parseLine( "(1/1) checking keys in keyring" ) );
+        QCOMPARE( p->progress(), halfway );
+        QVERIFY( p->parseLine( "(  2/2) installing bar" ) );
+        QVERIFY( p->parseLine( "(1/1) Arming ConditionNeedsUpdate..." ) );
+        QCOMPARE( p->progress(), 1.0 );
+
+        p->reset();
+        QCOMPARE( p->progress(), 0.0 );
+        QVERIFY( p->message().isEmpty() );
+    }
+    {
+        // Output of `pacman -S --noconfirm` without a terminal, as it is run from Calamares
+        const QStringList output { "resolving dependencies...",
+                                   "looking for conflicting packages...",
+                                   "Packages (3) bar-2.0-1  baz-0.9-2  foo-1.0-1",
+                                   "Total Download Size:    1.50 MiB",
+                                   "Total Installed Size:   5.00 MiB",
+                                   ":: Proceed with installation? [Y/n] ",
+                                   ":: Retrieving packages...",
+                                   " bar-2.0-1-x86_64 downloading...",
+                                   " baz-0.9-2-any downloading...",
+                                   " foo-1.0-1-x86_64 downloading...",
+                                   "checking keyring...",
+                                   "checking package integrity...",
+                                   "loading package files...",
+                                   "checking for file conflicts...",
+                                   "checking available disk space...",
+                                   ":: Processing package changes...",
+                                   "installing bar...",
+                                   "installing baz...",
+                                   "Optional dependencies for baz",
+                                   "    quux: for the extras",
+                                   "upgrading foo...",
+                                   ":: Running post-transaction hooks...",
+                                   "(1/2) Arming ConditionNeedsUpdate...",
+                                   "(2/2) Updating the info directory file..." };
+        const int firstInstall = output.indexOf( "installing bar..." );
+
+        auto p = ProgressParser::forBackend( "pacman" );
+        qreal previous = 0.0;
+        for ( int i = 0; i < output.count(); ++i )
+        {
+            p->parseLine( output.at( i ) );
+            QVERIFY( p->progress() >= previous );
+            previous = p->progress();
+            if ( i == firstInstall - 1 )
+            {
+                // All the downloads and checks are done
+                QCOMPARE( p->progress(), 0.3 );
+                QCOMPARE( p->message(), QStringLiteral( "checking available disk space" ) );
+            }
+            else if ( i == firstInstall )
+            {
+                // 1 of the 3 packages is done
+                QCOMPARE( p->message(), QStringLiteral( "installing bar" ) );
+                QCOMPARE( p->progress(), 0.4 + 0.55 / 3 );
+            }
+        }
+        QCOMPARE( p->progress(), 1.0 );
+        QCOMPARE( p->message(), QStringLiteral( "Updating the info directory file..." ) );
+    }
+    {
+        auto p = ProgressParser::forBackend( "apt" );
+        QVERIFY( !p->parseLine( "Reading package lists..." ) );
+        QVERIFY( p->parseLine( "dlstatus:1:50.0:Retrieving file 1 of 2" ) );
+        QCOMPARE( p->progress(), 0.2 );
+        QVERIFY( p->parseLine( "pmstatus:foo:50.0:Installing foo (amd64)" ) );
+        QCOMPARE( p->progress(), 0.7 );
+        QCOMPARE( p->message(), QStringLiteral( "Installing foo (amd64)" ) );
+    }
+    {
+        auto p = ProgressParser::forBackend( "dnf" );
+        QVERIFY( p->parseLine( "(1/4): foo-1.0.x86_64.rpm     1.0 MB/s | 50 kB     00:00" ) );
+        QCOMPARE( p->progress(), 0.1 );
+        QVERIFY( p->parseLine( "  Installing       : foo-1.0.x86_64          2/4" ) );
+        QCOMPARE( p->progress(), 0.65 );
+        QVERIFY( p->parseLine( "  Verifying        : foo-1.0.x86_64          4/4" ) );
+        QCOMPARE( p->progress(), 1.0 );
+    }
+    {
+        auto p = ProgressParser::forBackend( "zypp" );
+        QVERIFY( p->parseLine( "Retrieving package foo-1.0.x86_64  (1/2),  50.0 KiB" ) );
+        QCOMPARE( p->progress(), 0.2 );
+        QVERIFY( p->parseLine( "(2/2) Installing: foo-1.0.x86_64 [...done]" ) );
+        QCOMPARE( p->progress(), 1.0 );
+    }
+}
+
+void
+LibCalamaresTests::testChrootSession()
+{
+    using CalamaresUtils::ChrootSession;
+    using Code = CalamaresUtils::ProcessResult::Code;
+
+    // A root of / does not chroot, so this works without privileges
+    ChrootSession session( QStringLiteral( "/" ) );
+    QVERIFY( session.isValid() );
+
+    auto r = session.run( { "echo", "hello" } );
+    QCOMPARE( r.getExitCode(), 0 );
+    QCOMPARE( r.getOutput(), QStringLiteral( "hello" ) );
+
+    // Exit codes, standard input and merged output are preserved per command
+    r = session.run( { "sh", "-c", "cat; echo oops >&2; exit 3" }, QString(), QStringLiteral( "input\n" ) );
+    QCOMPARE( r.getExitCode(), 3 );
+    QCOMPARE( r.getOutput(), QStringLiteral( "input\noops" ) );
+
+    r = session.run( { "pwd" }, QStringLiteral( "/tmp" ) );
+    QCOMPARE( r.getExitCode(), 0 );
+    QCOMPARE( r.getOutput(), QStringLiteral( "/tmp" ) );
+
+    r = session.run( { "pwd" }, QStringLiteral( "/nonexistent-calamares-dir" ) );
+    QCOMPARE( r.getExitCode(), int( Code::NoWorkingDirectory ) );
+
+    r = session.run( { "/nonexistent-calamares-command" } );
+    QCOMPARE( r.getExitCode(), int( Code::FailedToStart ) );
+    QVERIFY( session.isValid() );  // The helper itself is fine
+
+    r = session.run( { "sleep", "5" }, QString(), QString(), std::chrono::seconds( 1 ) );
+    QCOMPARE( r.getExitCode(), int( Code::TimedOut ) );
+
+    r = session.run( { "sh", "-c", "kill -9 $$" } );
+    QCOMPARE( r.getExitCode(), int( Code::Crashed ) );
+
+    // Still usable after all those failures
+    r = session.run( { "true" } );
+    QCOMPARE( r.getExitCode(), 0 );
+    QVERIFY( session.isValid() );
+}
+
+void
+LibCalamaresTests::testSchedulingPolicy()
+{
+    using CalamaresUtils::SchedulingPolicy;
+
+    SchedulingPolicy empty;
+    QVERIFY( empty.isEmpty() );
+    QVERIFY( SchedulingPolicy::fromMap( QVariantMap() ).isEmpty() );
+
+    const QVariantMap global { { "nice", 10 }, { "io-class", "best-effort" }, { "io-priority", 6 } };
+    const auto g = SchedulingPolicy::fromMap( global );
+    QVERIFY( !g.isEmpty() );
+    QCOMPARE( g.nice().value_or( 0 ), 10 );
+    QVERIFY( g.ioClass() == SchedulingPolicy::IOClass::BestEffort );
+    QCOMPARE( g.ioPriority(), 6 );
+    QVERIFY( !g.cpuWeight() );
+    QVERIFY( !g.ioWeight() );
+
+    // A module overrides parts of the global policy
+    const QVariantMap module { { "io-class", "idle" }, { "cpu-weight", 50 } };
+    const auto m = SchedulingPolicy::fromMap( module, g );
+    QCOMPARE( m.nice().value_or( 0 ), 10 );
+    QVERIFY( m.ioClass() == SchedulingPolicy::IOClass::Idle );
+    QCOMPARE( m.cpuWeight().value_or( 0 ), 50 );
+    QVERIFY( !m.ioWeight() );
+
+    // Bad values are ignored, and the defaults stay
+    const QVariantMap bad { { "nice", 40 }, { "io-class", "urgent" }, { "io-priority", "high" }, { "io-weight", 0 } };
+    const auto b = SchedulingPolicy::fromMap( bad, g );
+    QCOMPARE( b.nice().value_or( 0 ), 10 );
+    QVERIFY( b.ioClass() == SchedulingPolicy::IOClass::BestEffort );
+    QCOMPARE( b.ioPriority(), 6 );
+    QVERIFY( !b.ioWeight() );
+
+#ifdef Q_OS_LINUX
+    // Re-applying the current priorities needs no privileges
+    const auto current = SchedulingPolicy::ofCurrentThread();
+    QVERIFY( current.nice() );
+    QVERIFY( current.ioClass() );
+    QVERIFY( current.applyToCurrentThread() );
+#endif
+}
+
+void
+LibCalamaresTests::testAccountDatabase()
+{
+    using CalamaresUtils::AccountDatabase;
+
+    QTemporaryDir root;
+    QVERIFY( root.isValid() );
+    QVERIFY( QDir( root.path() ).mkpath( "etc" ) );
+    auto write = [ &root ]( const QString& name, const QByteArray& contents ) {
+        QFile f( root.filePath( "etc/" + name ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+        f.write( contents );
+    };
+    auto read = [ &root ]( const QString& name ) {
+        QFile f( root.filePath( "etc/" + name ) );
+        return f.open( QIODevice::ReadOnly ) ? f.readAll() : QByteArray();
+    };
+
+    const QByteArray passwd( "root:x:0:0:root:/root:/bin/bash\n+nis\nbin:x:1:1::/:/usr/bin/nologin\n" );
+    write( "passwd", passwd );
+    write( "group", "# Groups\nroot:x:0:root\nwheel:x:998:\naudio:x:997:pulse\nbig:x:1000:\n" );
+    write( "shadow", "root:!:18000::::::\n" );
+    write( "login.defs", "# Comment\nUID_MIN 1000\nGID_MIN\t\t1000\nSYS_GID_MIN 200\nPASS_MAX_DAYS 99999\n" );
+    // No gshadow, that is optional
+
+    {
+        AccountDatabase db( root.path() );
+        QVERIFY( db.load() );
+        QVERIFY( QFile::exists( root.filePath( "etc/passwd.lock" ) ) );
+        QVERIFY( !QFile::exists( root.filePath( "etc/gshadow.lock" ) ) );
+
+        // A second database can't get the locks
+        AccountDatabase other( root.path() );
+        QVERIFY( !other.load() );
+
+        QVERIFY( db.hasUser( "bin" ) );
+        QVERIFY( !db.hasUser( "nis" ) );
+        QVERIFY( !db.hasUser( "+nis" ) );
+        QCOMPARE( db.groupNames(), QStringList( { "root", "wheel", "audio", "big" } ) );
+        QCOMPARE( db.loginDefinition( "PASS_MAX_DAYS", 0 ), 99999 );
+
+        // System groups count down, others count up
+        QCOMPARE( db.addGroup( "video", true ), 996 );
+        QCOMPARE( db.addGroup( "games" ), 1001 );
+        QCOMPARE( db.addGroup( "games" ), -1 );
+
+        // The user's group can't get GID 1000, which is taken
+        QCOMPARE( db.addUser( "alice", "Alice: Cooper", "/home/alice", "/bin/zsh" ), 1000 );
+        QCOMPARE( db.groupId( "alice" ), 1002 );
+        QCOMPARE( db.addUser( "alice", "Again", "/home/alice", "/bin/zsh" ), -1 );
+
+        QVERIFY( !db.addUserToGroups( "alice", { "wheel", "nonexistent" } ) );
+        QVERIFY( db.addUserToGroups( "alice", { "wheel", "audio" } ) );
+        QVERIFY( db.addUserToGroups( "alice", { "audio" } ) );
+        QVERIFY( db.setPassword( "alice", "$6$salt$hash" ) );
+        QVERIFY( db.disablePassword( "root" ) );
+        QVERIFY( !db.setPassword( "bob", "$6$salt$hash" ) );
+
+        QVERIFY( db.save() );
+    }
+    QVERIFY( !QFile::exists( root.filePath( "etc/passwd.lock" ) ) );
+    QVERIFY( !QFile::exists( root.filePath( "etc/gshadow" ) ) );
+
+    QCOMPARE( read( "passwd-" ), passwd );
+    QCOMPARE( read( "passwd" ), passwd + "alice:x:1000:1002:Alice  Cooper:/home/alice:/bin/zsh\n" );
+    QCOMPARE( read( "group" ),
+              QByteArray( "# Groups\nroot:x:0:root\nwheel:x:998:alice\naudio:x:997:pulse,alice\nbig:x:1000:\n"
+                          "video:x:996:\ngames:x:1001:\nalice:x:1002:\n" ) );
+    const QList< QByteArray > shadow = read( "shadow" ).split( '\n' );
+    QCOMPARE( shadow.count(), 3 );  // Including the empty bit after the last newline
+    QVERIFY( shadow.at( 0 ).startsWith( "root:!:" ) );
+    QVERIFY( shadow.at( 1 ).startsWith( "alice:$6$salt$hash:" ) );
+    QVERIFY( shadow.at( 1 ).endsWith( ":99999::::" ) );
+
+    // Again, now with a gshadow
+    write( "gshadow", "wheel:!::\n" );
+    {
+        AccountDatabase db( root.path() );
+        QVERIFY( db.load() );
+        QVERIFY( db.addUserToGroups( "alice", { "wheel" } ) );
+        QCOMPARE( db.addGroup( "docker", true ), 995 );  // Below the lowest used system group
+        QVERIFY( db.save() );
+    }
+    QCOMPARE( read( "gshadow" ), QByteArray( "wheel:!::alice\ndocker:!::\n" ) );
+}
+
 void
 LibCalamaresTests::testUmask()
 {
@@ -500,6 +978,38 @@ strings: [ aap, noot, mies ]
     QVERIFY( !getStringList( m, key ).contains( "lam" ) );
 }
 
+void
+LibCalamaresTests::testVariantRedacted()
+{
+    using CalamaresUtils::redactedMap;
+
+    const QString secret( "secret" );
+    const QVariantMap m { { "username", "alice" },
+                          { "password", secret },
+                          { "setRootPassword", true },
+                          { "nested", QVariantMap { { "rootPassword", secret }, { "size", 3 } } } };
+    const QVariantMap r = redactedMap( m );
+    QCOMPARE( r.count(), m.count() );
+    QCOMPARE( r.value( "username" ).toString(), QStringLiteral( "alice" ) );
+    QVERIFY( r.value( "password" ).toString() != secret );
+    QCOMPARE( r.value( "setRootPassword" ).toBool(), true );
+    const QVariantMap n = r.value( "nested" ).toMap();
+    QVERIFY( n.value( "rootPassword" ).toString() != secret );
+    QCOMPARE( n.value( "size" ).toInt(), 3 );
+
+    // Like the partition module does
+    const QVariantMap luks { { "device", "/dev/sda2" }, { "fs", "ext4" }, { "luksPassphrase", secret } };
+    const QVariantMap plain { { "device", "/dev/sda1" }, { "fs", "fat32" } };
+    const QVariantMap gs { { "partitions", QVariantList { plain, luks } } };
+    const QVariantList partitions = redactedMap( gs ).value( "partitions" ).toList();
+    QCOMPARE( partitions.count(), 2 );
+    QCOMPARE( partitions.at( 0 ).toMap(), plain );
+    const QVariantMap p = partitions.at( 1 ).toMap();
+    QCOMPARE( p.value( "device" ).toString(), QStringLiteral( "/dev/sda2" ) );
+    QVERIFY( p.value( "luksPassphrase" ).toString() != secret );
+    QVERIFY( !QJsonDocument::fromVariant( redactedMap( gs ) ).toJson().contains( secret.toUtf8() ) );
+}
+
 void
 LibCalamaresTests::testStringTruncation()
 {
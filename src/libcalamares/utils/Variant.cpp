@@ -121,4 +121,64 @@ getSubMap( const QVariantMap& map, const QString& key, bool& success, const QVar
     return d;
 }
 
+static bool
+isSecretKey( const QString& key )
+{
+    for ( const auto* word : { "password", "passphrase", "secret" } )
+    {
+        if ( key.contains( QLatin1String( word ), Qt::CaseInsensitive ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static QVariant redactedVariant( const QVariant& v );
+
+static QVariantList
+redactedList( const QVariantList& list )
+{
+    QVariantList r;
+    r.reserve( list.count() );
+    for ( const auto& v : list )
+    {
+        r.append( redactedVariant( v ) );
+    }
+    return r;
+}
+
+static QVariant
+redactedVariant( const QVariant& v )
+{
+    switch ( v.type() )
+    {
+    case QVariant::Map:
+        return redactedMap( v.toMap() );
+    case QVariant::List:
+        return redactedList( v.toList() );
+    default:
+        return v;
+    }
+}
+
+QVariantMap
+redactedMap( const QVariantMap& map )
+{
+    QVariantMap r;
+    for ( auto it = map.constBegin(); it != map.constEnd(); ++it )
+    {
+        // Booleans like setRootPassword say nothing about the secret itself
+        if ( isSecretKey( it.key() ) && it.value().type() != QVariant::Bool )
+        {
+            r.insert( it.key(), QStringLiteral( "<redacted>" ) );
+        }
+        else
+        {
+            r.insert( it.key(), redactedVariant( it.value() ) );
+        }
+    }
+    return r;
+}
+
 }  // namespace CalamaresUtils
@@ -62,6 +62,16 @@ DLLEXPORT QVariantMap getSubMap( const QVariantMap& map,
                                  const QString& key,
                                  bool& success,
                                  const QVariantMap& d = QVariantMap() );
+
+/** @brief Copy of @p map with the secrets blanked out
+ *
+ * Values whose key looks like it holds a secret (it contains
+ * "password", "passphrase" or "secret", e.g. the *luksPassphrase*
+ * of each of the *partitions*) are replaced by "<redacted>", however
+ * deep they are in nested maps and lists. Use this on GlobalStorage
+ * before it leaves Calamares, e.g. for a log upload.
+ */
+DLLEXPORT QVariantMap redactedMap( const QVariantMap& map );
 }  // namespace CalamaresUtils
 
 #endif
@@ -18,6 +18,8 @@
 #include "utils/ImageRegistry.h"
 #include "utils/Logger.h"
 #include "utils/NamedEnum.h"
+#include "utils/Units.h"
+#include "utils/Variant.h"
 #include "utils/Yaml.h"
 
 #include <QDir>
@@ -92,7 +94,9 @@ const QStringList Branding::s_uploadServerStrings =
 {
     "type",
     "url",
-    "port"
+    "port",
+    "sizeLimit",
+    "compression"
 };
 // clang-format on
 // *INDENT-ON*
@@ -253,7 +257,12 @@ Branding::Branding( const QString& brandingFilePath, QObject* parent )
             } );
             loadStrings( m_style, doc, "style", []( const QString& s ) -> QString { return s; } );
 
-            m_uploadServer = uploadServerFromMap( CalamaresUtils::yamlMapToVariant( doc[ "uploadServer" ] ) );
+            const auto uploadServer = CalamaresUtils::yamlMapToVariant( doc[ "uploadServer" ] );
+            m_uploadServer = uploadServerFromMap( uploadServer );
+            const qint64 sizeLimit = CalamaresUtils::getInteger( uploadServer, "sizeLimit", -1 );
+            m_uploadSizeLimit
+                = sizeLimit < 0 ? -1 : CalamaresUtils::KiBtoBytes( static_cast< unsigned long long >( sizeLimit ) );
+            m_uploadCompressed = CalamaresUtils::getString( uploadServer, "compression" ) == QStringLiteral( "gzip" );
         }
         catch ( YAML::Exception& e )
         {
@@ -228,6 +228,14 @@ public:
      */
     using UploadServerInfo = QPair< UploadServerType, QUrl >;
     UploadServerInfo uploadServer() const { return m_uploadServer; }
+    /** @brief Largest part of the log (in bytes) to upload
+     *
+     * This is the *sizeLimit* (in KiB) of the upload server. The end
+     * of the log is uploaded; a negative value means the whole log.
+     */
+    qint64 uploadSizeLimit() const { return m_uploadSizeLimit; }
+    /// @brief Is the upload compressed with gzip? (*compression* of the upload server)
+    bool uploadCompressed() const { return m_uploadCompressed; }
 
     /**
      * Creates a map called "branding" in the global storage, and inserts an
@@ -263,6 +271,8 @@ private:
     QMap< QString, QString > m_images;
     QMap< QString, QString > m_style;
     UploadServerInfo m_uploadServer;
+    qint64 m_uploadSizeLimit = -1;
+    bool m_uploadCompressed = false;
 
     /* The slideshow can be done in one of two ways:
      *  - as a sequence of images
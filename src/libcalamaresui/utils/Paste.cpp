@@ -11,26 +11,44 @@
 
 #include "Branding.h"
 #include "DllMacro.h"
+#include "GlobalStorage.h"
+#include "JobQueue.h"
 #include "utils/Logger.h"
 #include "utils/Units.h"
+#include "utils/Variant.h"
 
 #include <QApplication>
 #include <QClipboard>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QTcpSocket>
+#include <QTimer>
 #include <QUrl>
 #include <QWidget>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <array>
 
 using namespace CalamaresUtils::Units;
 
+/// @brief Size of the pieces in which data is written to the server
+static constexpr qint64 chunkSize = 16_KiB;
+/// @brief Milliseconds without progress before an upload fails
+static constexpr int uploadTimeout = 30000;
+
 /** @brief Reads the logfile, returns its contents.
  *
+ * If @p limit is positive, reads at most the last @p limit bytes.
  * Returns an empty QByteArray() on any kind of error.
  */
 STATICTEST QByteArray
-logFileContents()
+logFileContents( qint64 limit )
 {
     const QString name = Logger::logFile();
     QFile pasteSourceFile( name );
@@ -40,102 +58,377 @@ logFileContents()
         return QByteArray();
     }
     QFileInfo fi( pasteSourceFile );
-    if ( fi.size() > 16_KiB )
+    if ( limit > 0 && fi.size() > limit )
     {
-        pasteSourceFile.seek( fi.size() - 16_KiB );
+        pasteSourceFile.seek( fi.size() - limit );
+        return pasteSourceFile.read( limit );
     }
-    return pasteSourceFile.read( 16_KiB );
+    return pasteSourceFile.readAll();
 }
 
+/// @brief GlobalStorage as (redacted) JSON, with a heading to separate it from the log
+static QByteArray
+globalStorageContents()
+{
+    auto* jobQueue = Calamares::JobQueue::instance();
+    if ( !jobQueue || !jobQueue->globalStorage() )
+    {
+        return QByteArray();
+    }
+    const auto map = CalamaresUtils::redactedMap( jobQueue->globalStorage()->data() );
+    return QByteArrayLiteral( "\n\n=== Global storage ===\n" )
+        + QJsonDocument( QJsonObject::fromVariantMap( map ) ).toJson( QJsonDocument::Indented );
+}
 
-STATICTEST QString
-ficheLogUpload( const QByteArray& pasteData, const QUrl& serverUrl, QObject* parent )
+static quint32
+crc32( const QByteArray& data )
 {
-    QTcpSocket* socket = new QTcpSocket( parent );
-    socket->connectToHost( serverUrl.host(), serverUrl.port() );
+    static const auto table = []() {
+        std::array< quint32, 256 > t {};
+        for ( quint32 i = 0; i < 256; ++i )
+        {
+            quint32 c = i;
+            for ( int k = 0; k < 8; ++k )
+            {
+                c = ( c & 1 ) ? ( 0xedb88320U ^ ( c >> 1 ) ) : ( c >> 1 );
+            }
+            t[ i ] = c;
+        }
+        return t;
+    }();
 
-    if ( !socket->waitForConnected() )
+    quint32 crc = 0xffffffffU;
+    for ( const char c : data )
     {
-        cError() << "Could not connect to paste server";
-        socket->close();
-        return QString();
+        crc = table[ ( crc ^ static_cast< quint8 >( c ) ) & 0xff ] ^ ( crc >> 8 );
+    }
+    return crc ^ 0xffffffffU;
+}
+
+static void
+appendLittleEndian( QByteArray& a, quint32 v )
+{
+    for ( int i = 0; i < 4; ++i )
+    {
+        a.append( static_cast< char >( ( v >> ( 8 * i ) ) & 0xff ) );
     }
+}
+
+/** @brief Compresses @p data in gzip format
+ *
+ * Qt only produces zlib format: a 4-byte length (added by Qt), a 2-byte
+ * header, the deflate stream and a 4-byte checksum. The deflate stream
+ * is re-wrapped in a gzip header and trailer, so that the paste can be
+ * unpacked with plain `curl | gunzip`.
+ */
+STATICTEST QByteArray
+gzipCompress( const QByteArray& data )
+{
+    const QByteArray z = qCompress( data, 9 );
+    if ( z.size() < 10 )
+    {
+        return QByteArray();
+    }
+
+    // Magic, method deflate, no flags, no mtime, max compression, Unix
+    QByteArray gz = QByteArray::fromHex( "1f8b0800000000000203" );
+    gz.append( z.constData() + 6, z.size() - 10 );
+    appendLittleEndian( gz, crc32( data ) );
+    appendLittleEndian( gz, static_cast< quint32 >( data.size() ) );
+    return gz;
+}
+
+namespace CalamaresUtils
+{
+namespace Paste
+{
+
+LogUpload::LogUpload( const QUrl& serverUrl, QObject* parent )
+    : QObject( parent )
+    , m_serverUrl( serverUrl )
+    , m_socket( new QTcpSocket( this ) )
+    , m_timeout( new QTimer( this ) )
+{
+    m_timeout->setSingleShot( true );
+    m_timeout->setInterval( uploadTimeout );
+    connect( m_timeout, &QTimer::timeout, this, [ = ]() { fail( QStringLiteral( "Paste server timed out" ) ); } );
 
-    cDebug() << "Connected to paste server" << serverUrl.host();
+    connect( m_socket, &QTcpSocket::connected, this, [ = ]() {
+        cDebug() << "Connected to paste server" << m_serverUrl.host();
+        m_timeout->start();
+        writeChunk();
+    } );
+    connect( m_socket, &QTcpSocket::bytesWritten, this, &LogUpload::bytesWritten );
+    connect( m_socket, &QTcpSocket::readyRead, this, &LogUpload::readResponse );
+    connect( m_socket, &QTcpSocket::disconnected, this, &LogUpload::readResponse );
+#if QT_VERSION < QT_VERSION_CHECK( 5, 15, 0 )
+    connect( m_socket, QOverload< QAbstractSocket::SocketError >::of( &QAbstractSocket::error ), this, [ = ]() {
+#else
+    connect( m_socket, &QAbstractSocket::errorOccurred, this, [ = ]() {
+#endif
+        // The server closes the connection after replying, which is not an error
+        if ( m_socket->error() != QAbstractSocket::RemoteHostClosedError )
+        {
+            fail( QStringLiteral( "Paste server error " ) + m_socket->errorString() );
+        }
+    } );
+}
 
-    socket->write( pasteData );
+LogUpload::~LogUpload() {}
 
-    if ( !socket->waitForBytesWritten() )
+void
+LogUpload::start( const QByteArray& data )
+{
+    if ( m_running || m_socket->state() != QAbstractSocket::UnconnectedState )
     {
-        cError() << "Could not write to paste server";
-        socket->close();
-        return QString();
+        cWarning() << "Log upload to" << m_serverUrl.host() << "was already started.";
+        return;
+    }
+
+    m_running = true;
+    m_data = data;
+    if ( m_data.isEmpty() || !m_serverUrl.isValid() )
+    {
+        // finished() is never emitted from within start()
+        QTimer::singleShot( 0, this, [ = ]() { fail( QStringLiteral( "No data or no server for paste" ) ); } );
+        return;
     }
 
-    cDebug() << Logger::SubEntry << "Paste data written to paste server";
+    m_timeout->start();
+    m_socket->connectToHost( m_serverUrl.host(), quint16( m_serverUrl.port() ) );
+}
+
+void
+LogUpload::cancel()
+{
+    fail( QStringLiteral( "Paste upload cancelled" ) );
+}
 
-    if ( !socket->waitForReadyRead() )
+void
+LogUpload::writeChunk()
+{
+    const qint64 size = qMin( chunkSize, qint64( m_data.size() ) - m_queued );
+    if ( size > 0 )
     {
-        cError() << "No data from paste server";
-        socket->close();
-        return QString();
+        m_socket->write( m_data.constData() + m_queued, size );
+        m_queued += size;
     }
+}
 
-    cDebug() << Logger::SubEntry << "Reading response from paste server";
-    QByteArray responseText = socket->readLine( 1024 );
-    socket->close();
+void
+LogUpload::bytesWritten( qint64 bytes )
+{
+    m_written += bytes;
+    m_timeout->start();
+    emit progress( m_written, m_data.size() );
+    // Only queue more once the previous chunk is gone, so the socket buffer stays small
+    if ( m_written >= m_queued )
+    {
+        if ( m_queued < m_data.size() )
+        {
+            writeChunk();
+        }
+        else
+        {
+            cDebug() << Logger::SubEntry << "Paste data written to paste server";
+            // The reply may have arrived already
+            readResponse();
+        }
+    }
+}
 
+void
+LogUpload::readResponse()
+{
+    if ( !m_running || m_written < m_data.size() )
+    {
+        if ( m_running && m_socket->state() != QAbstractSocket::ConnectedState )
+        {
+            fail( QStringLiteral( "Paste server closed the connection" ) );
+        }
+        return;
+    }
+    if ( !m_socket->canReadLine() && m_socket->bytesAvailable() < 1024
+         && m_socket->state() == QAbstractSocket::ConnectedState )
+    {
+        // Wait for the rest of the line
+        return;
+    }
+
+    cDebug() << Logger::SubEntry << "Reading response from paste server";
+    const QByteArray responseText = m_socket->readLine( 1024 );
     QUrl pasteUrl = QUrl( QString( responseText ).trimmed(), QUrl::StrictMode );
-    if ( pasteUrl.isValid() && pasteUrl.host() == serverUrl.host() )
+    if ( pasteUrl.isValid() && pasteUrl.host() == m_serverUrl.host() )
     {
         cDebug() << Logger::SubEntry << "Paste server results:" << pasteUrl;
-        return pasteUrl.toString();
+        done( pasteUrl.toString() );
     }
     else
     {
-        cError() << "No data from paste server";
-        return QString();
+        fail( QStringLiteral( "No data from paste server" ) );
     }
 }
 
-QString
-CalamaresUtils::Paste::doLogUpload( QObject* parent )
+void
+LogUpload::done( const QString& url )
 {
-    auto [ type, serverUrl ] = Calamares::Branding::instance()->uploadServer();
-    if ( !serverUrl.isValid() )
+    if ( !m_running )
     {
-        cWarning() << "Upload configure with invalid URL";
-        return QString();
+        return;
     }
-    if ( type == Calamares::Branding::UploadServerType::None )
+    m_running = false;
+    m_timeout->stop();
+    m_socket->abort();
+    m_data.clear();
+    emit finished( url );
+}
+
+void
+LogUpload::fail( const QString& message )
+{
+    if ( m_running )
     {
-        // Early return to avoid reading the log file
-        return QString();
+        cError() << message;
+        done( QString() );
     }
+}
+
+}  // namespace Paste
+}  // namespace CalamaresUtils
 
-    QByteArray pasteData = logFileContents();
+/// @brief Runs an upload of @p pasteData to @p serverUrl to completion
+STATICTEST QString
+ficheLogUpload( const QByteArray& pasteData, const QUrl& serverUrl )
+{
+    CalamaresUtils::Paste::LogUpload upload( serverUrl );
+    QEventLoop loop;
+    QString pasteUrl;
+    QObject::connect( &upload, &CalamaresUtils::Paste::LogUpload::finished, &loop, [ & ]( const QString& url ) {
+        pasteUrl = url;
+        loop.quit();
+    } );
+    upload.start( pasteData );
+    loop.exec();
+    return pasteUrl;
+}
+
+/** @brief Checks the upload configuration
+ *
+ * Returns the URL of the (fiche) server, or an invalid URL
+ * if nothing should be uploaded.
+ */
+static QUrl
+uploadServerUrl()
+{
+    auto [ type, serverUrl ] = Calamares::Branding::instance()->uploadServer();
+    switch ( type )
+    {
+    case Calamares::Branding::UploadServerType::None:
+        return QUrl();
+    case Calamares::Branding::UploadServerType::Fiche:
+        if ( !serverUrl.isValid() )
+        {
+            cWarning() << "Upload configure with invalid URL";
+            return QUrl();
+        }
+        return serverUrl;
+    }
+    return QUrl();
+}
+
+/** @brief The data to upload: log, @p globals, possibly compressed
+ *
+ * Reads at most @p limit bytes of the log. This runs on a worker
+ * thread, since the log may be large and compressing it takes a while.
+ * Returns an empty QByteArray() if the log cannot be read.
+ */
+static QByteArray
+uploadData( qint64 limit, bool compress, const QByteArray& globals )
+{
+    QByteArray pasteData = logFileContents( limit );
     if ( pasteData.isEmpty() )
     {
         // An error has already been logged
-        return QString();
+        return QByteArray();
     }
+    pasteData.append( globals );
+    return compress ? gzipCompress( pasteData ) : pasteData;
+}
 
-    switch ( type )
+/** @brief Prepares the data to upload without blocking the event loop
+ *
+ * GlobalStorage is read in the calling thread; the log is read (and
+ * compressed) on a worker thread while a local event loop runs.
+ */
+static QByteArray
+prepareUploadData()
+{
+    const auto* branding = Calamares::Branding::instance();
+    QFutureWatcher< QByteArray > watcher;
+    QEventLoop loop;
+    QObject::connect( &watcher, &QFutureWatcher< QByteArray >::finished, &loop, &QEventLoop::quit );
+    watcher.setFuture( QtConcurrent::run(
+        uploadData, branding->uploadSizeLimit(), branding->uploadCompressed(), globalStorageContents() ) );
+    if ( !watcher.isFinished() )
     {
-    case Calamares::Branding::UploadServerType::None:
-        cWarning() << "No upload configured.";
+        loop.exec();
+    }
+    return watcher.result();
+}
+
+QString
+CalamaresUtils::Paste::doLogUpload( QObject* parent )
+{
+    Q_UNUSED( parent )
+    const QUrl serverUrl = uploadServerUrl();
+    if ( !serverUrl.isValid() )
+    {
+        // Early return to avoid reading the log file
         return QString();
-    case Calamares::Branding::UploadServerType::Fiche:
-        return ficheLogUpload( pasteData, serverUrl, parent );
     }
-    return QString();
+    const QByteArray pasteData = prepareUploadData();
+    return pasteData.isEmpty() ? QString() : ficheLogUpload( pasteData, serverUrl );
 }
 
 QString
 CalamaresUtils::Paste::doLogUploadUI( QWidget* parent )
 {
     // These strings originated in the ViewManager class
-    QString pasteUrl = CalamaresUtils::Paste::doLogUpload( parent );
+    QString pasteUrl;
+    const QUrl serverUrl = uploadServerUrl();
+    if ( serverUrl.isValid() )
+    {
+        // Busy (no range) while the data is prepared
+        QProgressDialog progress(
+            QCoreApplication::translate( "Calamares::ViewManager", "Uploading the install log..." ),
+            QCoreApplication::translate( "Calamares::ViewManager", "&Cancel" ),
+            0,
+            0,
+            parent );
+        progress.setWindowModality( Qt::WindowModal );
+        progress.setMinimumDuration( 0 );
+        progress.setAutoReset( false );
+
+        const QByteArray pasteData = prepareUploadData();
+        if ( !pasteData.isEmpty() && !progress.wasCanceled() )
+        {
+            progress.setRange( 0, 100 );
+            LogUpload upload( serverUrl );
+            QEventLoop loop;
+            QObject::connect( &upload, &LogUpload::progress, &progress, [ & ]( qint64 sent, qint64 total ) {
+                progress.setValue( total > 0 ? int( ( 100 * sent ) / total ) : 0 );
+            } );
+            QObject::connect( &progress, &QProgressDialog::canceled, &upload, &LogUpload::cancel );
+            QObject::connect( &upload, &LogUpload::finished, &loop, [ & ]( const QString& url ) {
+                pasteUrl = url;
+                loop.quit();
+            } );
+            upload.start( pasteData );
+            loop.exec();
+        }
+        progress.reset();
+    }
+
     QString pasteUrlMessage;
     if ( pasteUrl.isEmpty() )
     {
@@ -10,16 +10,72 @@
 #ifndef UTILS_PASTE_H
 #define UTILS_PASTE_H
 
+#include <QByteArray>
+#include <QObject>
 #include <QString>
+#include <QUrl>
 
-class QObject;
+class QTcpSocket;
+class QTimer;
 class QWidget;
 
 namespace CalamaresUtils
 {
 namespace Paste
 {
+/** @brief Asynchronous upload of data to a fiche-style pastebin
+ *
+ * The data is written to the server in chunks, as the connection
+ * accepts them, so the event loop keeps running during the upload;
+ * progress() is emitted after each chunk. The server replies with
+ * a single line containing the URL of the paste.
+ *
+ * If the server does not respond for some time, or the upload is
+ * cancelled, the upload fails. In all cases finished() is emitted
+ * exactly once, after start() has returned.
+ */
+class LogUpload : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogUpload( const QUrl& serverUrl, QObject* parent = nullptr );
+    ~LogUpload() override;
+
+    /// @brief Starts sending @p data; an upload can be started only once
+    void start( const QByteArray& data );
+    /// @brief Stops the upload, which then fails
+    void cancel();
+
+    bool isRunning() const { return m_running; }
+
+signals:
+    /// @brief @p sent bytes of @p total have been written to the server
+    void progress( qint64 sent, qint64 total );
+    /// @brief The upload is done, and the server returned @p url (empty on failure)
+    void finished( const QString& url );
+
+private:
+    void writeChunk();
+    void bytesWritten( qint64 bytes );
+    void readResponse();
+    void done( const QString& url );
+    void fail( const QString& message );
+
+    QUrl m_serverUrl;
+    QTcpSocket* m_socket = nullptr;
+    QTimer* m_timeout = nullptr;
+    QByteArray m_data;
+    qint64 m_queued = 0;  ///< Bytes handed to the socket
+    qint64 m_written = 0;  ///< Bytes actually written to the connection
+    bool m_running = false;
+};
+
 /** @brief Send the current log file to a pastebin
+ *
+ * The log (up to the size limit set in the branding) and a
+ * snapshot of GlobalStorage -- without passwords -- are sent,
+ * possibly compressed.  This runs a local event loop until the
+ * upload is done.
  *
  * Returns the (string) URL that the pastebin gives us.
  */
@@ -27,7 +83,8 @@ QString doLogUpload( QObject* parent );
 
 /** @brief Send the current log file to a pastebin
  *
- * As doLogUpload(), but also sets the clipboard and displays
+ * As doLogUpload(), but shows the progress of the upload (which can
+ * be cancelled), and afterwards sets the clipboard and displays
  * a message saying it's been done.
  */
 QString doLogUploadUI( QWidget* parent );
@@ -14,10 +14,13 @@
 #include "utils/Logger.h"
 
 #include <QDateTime>
+#include <QTcpServer>
+#include <QTcpSocket>
 #include <QtTest/QtTest>
 
-extern QByteArray logFileContents();
-extern QString ficheLogUpload( const QByteArray& pasteData, const QUrl& serverUrl, QObject* parent );
+extern QByteArray logFileContents( qint64 limit );
+extern QByteArray gzipCompress( const QByteArray& data );
+extern QString ficheLogUpload( const QByteArray& pasteData, const QUrl& serverUrl );
 
 class TestPaste : public QObject
 {
@@ -29,6 +32,9 @@ public:
 
 private Q_SLOTS:
     void testGetLogFile();
+    void testGzip();
+    void testLocalPaste();
+    void testCancelPaste();
     void testFichePaste();
 };
 
@@ -37,14 +43,108 @@ TestPaste::testGetLogFile()
 {
     QFile::remove( Logger::logFile() );
     // This test assumes nothing **else** has set up logging yet
-    QByteArray contentsOfLogfileBefore = logFileContents();
+    QByteArray contentsOfLogfileBefore = logFileContents( -1 );
     QVERIFY( contentsOfLogfileBefore.isEmpty() );
 
     Logger::setupLogLevel( Logger::LOGDEBUG );
     Logger::setupLogfile();
 
-    QByteArray contentsOfLogfileAfterSetup = logFileContents();
+    QByteArray contentsOfLogfileAfterSetup = logFileContents( -1 );
     QVERIFY( !contentsOfLogfileAfterSetup.isEmpty() );
+
+    // The limit takes the end of the log
+    cDebug() << "Some more log so the tail differs from the head";
+    const QByteArray whole = logFileContents( -1 );
+    const QByteArray tail = logFileContents( 16 );
+    QCOMPARE( tail.size(), 16 );
+    QVERIFY( whole.endsWith( tail ) );
+    QCOMPARE( logFileContents( whole.size() + 100 ), whole );
+}
+
+void
+TestPaste::testGzip()
+{
+    const QByteArray check( "123456789" );
+    const QByteArray gz = gzipCompress( check );
+    QVERIFY( gz.size() > 18 );
+    QCOMPARE( gz.left( 3 ), QByteArray::fromHex( "1f8b08" ) );
+    // Well-known CRC32 of the check string, and the size, little-endian
+    QCOMPARE( gz.right( 8 ), QByteArray::fromHex( "2639f4cb09000000" ) );
+
+    // Repetitive data (like a log) compresses well
+    const QByteArray log = QByteArray( "Calamares is installing things\n" ).repeated( 1000 );
+    QVERIFY( gzipCompress( log ).size() < log.size() / 10 );
+}
+
+/** @brief Fiche-like server on localhost
+ *
+ * Collects data until @p expected bytes have arrived, then replies
+ * with a URL on the same host (unless @p reply is false).
+ */
+class LocalPasteServer : public QTcpServer
+{
+public:
+    LocalPasteServer( int expected, bool reply )
+    {
+        listen( QHostAddress::LocalHost );
+        connect( this, &QTcpServer::newConnection, this, [ = ]() {
+            QTcpSocket* s = nextPendingConnection();
+            connect( s, &QTcpSocket::readyRead, this, [ = ]() {
+                received.append( s->readAll() );
+                if ( reply && received.size() >= expected )
+                {
+                    s->write( "http://127.0.0.1/abcd\n" );
+                    s->disconnectFromHost();
+                }
+            } );
+        } );
+    }
+
+    QUrl url() const { return QUrl( QStringLiteral( "http://127.0.0.1:%1" ).arg( serverPort() ) ); }
+
+    QByteArray received;
+};
+
+void
+TestPaste::testLocalPaste()
+{
+    // Several chunks' worth of data
+    const QByteArray d = QByteArray( "the quick brown fox tested Calamares\n" ).repeated( 5000 );
+    LocalPasteServer server( d.size(), true );
+    QVERIFY( server.isListening() );
+
+    QCOMPARE( ficheLogUpload( d, server.url() ), QStringLiteral( "http://127.0.0.1/abcd" ) );
+    QCOMPARE( server.received, d );
+
+    // No data, no upload
+    QVERIFY( ficheLogUpload( QByteArray(), server.url() ).isEmpty() );
+}
+
+void
+TestPaste::testCancelPaste()
+{
+    const QByteArray d( "the quick brown fox tested Calamares" );
+    LocalPasteServer server( d.size(), false );
+    QVERIFY( server.isListening() );
+
+    CalamaresUtils::Paste::LogUpload upload( server.url() );
+    QSignalSpy progressSpy( &upload, &CalamaresUtils::Paste::LogUpload::progress );
+    QSignalSpy finishedSpy( &upload, &CalamaresUtils::Paste::LogUpload::finished );
+    upload.start( d );
+    QVERIFY( upload.isRunning() );
+    QCOMPARE( finishedSpy.count(), 0 );  // Never from start()
+
+    // The server never replies, so this waits until everything is written
+    QVERIFY( progressSpy.wait() );
+    QCOMPARE( progressSpy.last().at( 0 ).toLongLong(), d.size() );
+    QCOMPARE( finishedSpy.count(), 0 );
+
+    upload.cancel();
+    QVERIFY( !upload.isRunning() );
+    QCOMPARE( finishedSpy.count(), 1 );
+    QVERIFY( finishedSpy.first().at( 0 ).toString().isEmpty() );
+    upload.cancel();
+    QCOMPARE( finishedSpy.count(), 1 );
 }
 
 void
@@ -54,7 +154,7 @@ TestPaste::testFichePaste()
     QDateTime now = QDateTime::currentDateTime();
 
     QByteArray d = ( blabla + now.toString() ).toUtf8();
-    QString s = ficheLogUpload( d, QUrl( "http://termbin.com:9999" ), nullptr );
+    QString s = ficheLogUpload( d, QUrl( "http://termbin.com:9999" ) );
 
     cDebug() << "Paste data to" << s;
     QVERIFY( !s.isEmpty() );
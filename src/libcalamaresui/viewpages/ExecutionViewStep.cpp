@@ -141,6 +141,7 @@ ExecutionViewStep::onActivate()
     m_slideshow->changeSlideShowState( Slideshow::Start );
 
     const auto instanceDescriptors = Calamares::Settings::instance()->moduleInstances();
+    const auto schedulingPolicy = Calamares::Settings::instance()->schedulingPolicy();
 
     JobQueue* queue = JobQueue::instance();
     for ( const auto& instanceKey : m_jobInstanceKeys )
@@ -168,7 +169,12 @@ ExecutionViewStep::onActivate()
                     j->setEmergency( true );
                 }
             }
-            queue->enqueue( weight, jl );
+            const auto policy
+                = CalamaresUtils::SchedulingPolicy::fromMap( moduleDescriptor.scheduling(), schedulingPolicy );
+            const auto resume = moduleDescriptor.isIdempotent()
+                ? JobQueue::Resume::Skip
+                : ( moduleDescriptor.isRerunnable() ? JobQueue::Resume::RerunSafely : JobQueue::Resume::Rerun );
+            queue->enqueue( weight, jl, policy, instanceKey, resume );
         }
     }
 
@@ -19,6 +19,9 @@
 #endif
 #include "utils/Retranslator.h"
 
+#include <QEvent>
+#include <QFutureWatcher>
+#include <QImageReader>
 #include <QLabel>
 #include <QMutexLocker>
 #ifdef WITH_QML
@@ -28,6 +31,7 @@
 #include <QQuickWidget>
 #endif
 #include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <chrono>
 
@@ -198,10 +202,14 @@ SlideshowQML::changeSlideShowState( Action state )
 }
 #endif
 
+/// @brief Number of decoded images to keep: the current one and the ones ahead
+static constexpr int ringSize = 3;
+
 SlideshowPictures::SlideshowPictures( QWidget* parent )
     : Slideshow( parent )
     , m_label( new QLabel( parent ) )
     , m_timer( new QTimer( this ) )
+    , m_resizeTimer( new QTimer( this ) )
     , m_imageIndex( 0 )
     , m_images( Branding::instance()->slideshowImages() )
 {
@@ -209,13 +217,23 @@ SlideshowPictures::SlideshowPictures( QWidget* parent )
 
     m_label->setSizePolicy( QSizePolicy::Expanding, QSizePolicy::Expanding );
     m_label->setAlignment( Qt::AlignCenter );
+    m_label->installEventFilter( this );
     m_timer->setInterval( std::chrono::milliseconds( 2000 ) );
     connect( m_timer, &QTimer::timeout, this, &SlideshowPictures::next );
+    m_resizeTimer->setSingleShot( true );
+    m_resizeTimer->setInterval( std::chrono::milliseconds( 200 ) );
+    connect( m_resizeTimer, &QTimer::timeout, this, &SlideshowPictures::resized );
+
+    // One image at a time is plenty to stay ahead of the show
+    m_pool.setMaxThreadCount( 1 );
 }
 
 SlideshowPictures::~SlideshowPictures()
 {
+    m_pool.clear();
+    m_pool.waitForDone();
     delete m_timer;
+    delete m_resizeTimer;
     delete m_label;
 }
 
@@ -239,7 +257,11 @@ SlideshowPictures::changeSlideShowState( Calamares::Slideshow::Action a )
         }
         else
         {
-
+            if ( m_size != m_label->size() )
+            {
+                clearImages();
+                m_size = m_label->size();
+            }
             m_timer->start();
             QTimer::singleShot( 0, this, &SlideshowPictures::next );
         }
@@ -247,6 +269,8 @@ SlideshowPictures::changeSlideShowState( Calamares::Slideshow::Action a )
     else
     {
         m_timer->stop();
+        m_resizeTimer->stop();
+        clearImages();
     }
 }
 
@@ -277,8 +301,152 @@ SlideshowPictures::next()
         return;
     }
 
-    m_label->setPixmap( QPixmap( m_images.at( m_imageIndex ) ) );
+    showCurrent();
+}
+
+void
+SlideshowPictures::showCurrent()
+{
+    const int count = m_images.count();
+    if ( m_imageIndex < 0 || m_imageIndex >= count )
+    {
+        return;
+    }
+
+    // Forget images that have fallen out of the ring
+    QSet< int > ring;
+    for ( int i = 0; i < qMin( ringSize, count ); ++i )
+    {
+        ring.insert( ( m_imageIndex + i ) % count );
+    }
+    for ( auto it = m_ready.begin(); it != m_ready.end(); )
+    {
+        if ( ring.contains( it.key() ) )
+        {
+            ++it;
+        }
+        else
+        {
+            it = m_ready.erase( it );
+        }
+    }
+
+    // If the image is not ready yet, the previous one stays up
+    // until decoded() shows it.
+    if ( m_ready.contains( m_imageIndex ) )
+    {
+        m_label->setPixmap( m_ready.value( m_imageIndex ) );
+    }
+    for ( int i = 0; i < qMin( ringSize, count ); ++i )
+    {
+        prefetch( ( m_imageIndex + i ) % count );
+    }
+}
+
+void
+SlideshowPictures::prefetch( int index )
+{
+    if ( m_ready.contains( index ) || m_pending.contains( index ) || m_failed.contains( index ) )
+    {
+        return;
+    }
+    m_pending.insert( index );
+
+    const int generation = m_generation;
+    auto* watcher = new QFutureWatcher< QImage >( this );
+    connect( watcher, &QFutureWatcher< QImage >::finished, this, [ = ]() {
+        decoded( index, generation, watcher->result() );
+        watcher->deleteLater();
+    } );
+    watcher->setFuture( QtConcurrent::run( &m_pool, &SlideshowPictures::decode, m_images.at( index ), m_size ) );
 }
 
+void
+SlideshowPictures::decoded( int index, int generation, const QImage& image )
+{
+    QMutexLocker l( &m_mutex );
+    if ( generation != m_generation )
+    {
+        // Decoded for a size that is no longer relevant
+        return;
+    }
+    m_pending.remove( index );
+
+    if ( image.isNull() )
+    {
+        m_failed.insert( index );
+        return;
+    }
+
+    const int count = m_images.count();
+    const int ahead = ( index - m_imageIndex + count ) % count;
+    if ( m_imageIndex >= 0 && ahead >= ringSize )
+    {
+        // The show has moved on already
+        return;
+    }
+
+    // Converting to a pixmap must happen in the GUI thread
+    m_ready.insert( index, QPixmap::fromImage( image ) );
+    if ( index == m_imageIndex )
+    {
+        m_label->setPixmap( m_ready.value( index ) );
+    }
+}
+
+void
+SlideshowPictures::clearImages()
+{
+    // Decodes that are already queued finish, and are dropped in decoded()
+    m_ready.clear();
+    m_pending.clear();
+    m_generation++;
+}
+
+void
+SlideshowPictures::resized()
+{
+    QMutexLocker l( &m_mutex );
+    if ( m_size == m_label->size() )
+    {
+        return;
+    }
+    clearImages();
+    m_size = m_label->size();
+    if ( isActive() )
+    {
+        showCurrent();
+    }
+}
+
+bool
+SlideshowPictures::eventFilter( QObject* object, QEvent* event )
+{
+    if ( object == m_label && event->type() == QEvent::Resize && isActive() )
+    {
+        m_resizeTimer->start();
+    }
+    return Slideshow::eventFilter( object, event );
+}
+
+QImage
+SlideshowPictures::decode( const QString& path, QSize size )
+{
+    QImageReader reader( path );
+    reader.setAutoTransform( true );
+    const QSize imageSize = reader.size();
+    if ( imageSize.isValid() && !size.isEmpty()
+         && ( imageSize.width() > size.width() || imageSize.height() > size.height() ) )
+    {
+        reader.setScaledSize( imageSize.scaled( size, Qt::KeepAspectRatio ) );
+    }
+
+    QImage image = reader.read();
+    if ( image.isNull() )
+    {
+        cWarning() << "Could not load slideshow image" << path << reader.errorString();
+    }
+    return image;
+}
 
 }  // namespace Calamares
@@ -14,8 +14,14 @@
 
 #include "CalamaresConfig.h"
 
+#include <QHash>
+#include <QImage>
 #include <QMutex>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
 #include <QStringList>
+#include <QThreadPool>
 #include <QWidget>
 
 class QLabel;
@@ -117,6 +123,13 @@ private:
  * do not use QML at all. It is configured through the Branding
  * setting *slideshow*. When using this widget, the setting must
  * be a list of filenames; the API is set to -1.
+ *
+ * The images are decoded on a worker thread, scaled down to fit
+ * the label, a few images ahead of the one that is shown; the
+ * installation is busy with the disk at the same time, so loading
+ * an image when it is due would make the show stutter. A small ring
+ * of decoded images (the current one and the next few) is kept,
+ * and re-decoded when the label changes size.
  */
 class SlideshowPictures : public Slideshow
 {
@@ -128,14 +141,44 @@ public:
     QWidget* widget() override;
     virtual void changeSlideShowState( Action a ) override;
 
+    /** @brief Decodes the image at @p path to fit @p size
+     *
+     * Images bigger than @p size are scaled down while decoding
+     * (keeping the aspect ratio); smaller ones are decoded as-is.
+     * This is thread-safe.
+     */
+    static QImage decode( const QString& path, QSize size );
+
 public slots:
     void next();
 
+protected:
+    bool eventFilter( QObject* object, QEvent* event ) override;
+
 private:
+    /// @brief Shows the current image, if it is ready, and prefetches the next ones
+    void showCurrent();
+    /// @brief Starts decoding image @p index in the background, unless it is ready or pending
+    void prefetch( int index );
+    /// @brief Decoding of image @p index (for size-generation @p generation) is done
+    void decoded( int index, int generation, const QImage& image );
+    /// @brief Drops decoded images (e.g. because the size has changed)
+    void clearImages();
+    /// @brief The label has been resized (and has settled down)
+    void resized();
+
     QLabel* m_label;
     QTimer* m_timer;
+    QTimer* m_resizeTimer;  ///< Delays re-decoding while the label is being resized
     int m_imageIndex;
     QStringList m_images;
+
+    QThreadPool m_pool;
+    QHash< int, QPixmap > m_ready;  ///< Decoded images by index, the current one and a few ahead
+    QSet< int > m_pending;  ///< Indexes being decoded
+    QSet< int > m_failed;  ///< Indexes that could not be decoded
+    QSize m_size;  ///< Size that images are decoded for
+    int m_generation = 0;  ///< Changes with m_size, to drop stale results
 };
 
 }  // namespace Calamares
@@ -15,9 +15,13 @@
 
 #include "Job.h"
 
+#include <QHash>
 #include <QList>
 #include <QPair>
 #include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantMap>
 
 namespace CalamaresUtils
 {
@@ -47,11 +51,41 @@ struct ValueCheck : public QPair< QString, CalamaresUtils::CommandList* >
     CalamaresUtils::CommandList* commands() const { return second; }
 };
 
+/** @brief A snapshot of GS for evaluating many bindings
+ *
+ * The contents of GS are copied once, and the (sub-)maps found while
+ * resolving dotted variable names are cached, so that bindings for
+ * e.g. *branding.bootloader* and *branding.shortProductName* only
+ * look up *branding* once.
+ */
+class ContextualProcessSnapshot
+{
+public:
+    explicit ContextualProcessSnapshot( Calamares::GlobalStorage* storage );
+    explicit ContextualProcessSnapshot( const QVariantMap& data )
+        : m_data( data )
+    {
+    }
+
+    /** @brief Looks up the value at @p selector (the parts of a dotted name)
+     *
+     * Stores the value (as a string) in @p value and returns true
+     * if the value exists; returns false otherwise.
+     */
+    bool fetch( const QStringList& selector, QString& value );
+
+private:
+    QVariantMap m_data;
+    /// Sub-maps by dotted prefix; an invalid QVariant if there is no map there
+    QHash< QString, QVariant > m_maps;
+};
+
 class ContextualProcessBinding
 {
 public:
     ContextualProcessBinding( const QString& varname )
         : m_variable( varname )
+        , m_selector( varname.split( '.' ) )
     {
     }
 
@@ -77,10 +111,14 @@ public:
      * is for) and false otherwise.
      */
     bool fetch( Calamares::GlobalStorage* storage, QString& value ) const;
+    /// @brief Obtains this binding's value from a snapshot of GS
+    bool fetch( ContextualProcessSnapshot& snapshot, QString& value ) const;
 
 private:
     QString m_variable;
+    QStringList m_selector;  ///< The variable, split at dots
     QList< ValueCheck > m_checks;
+    QHash< QString, CalamaresUtils::CommandList* > m_values;  ///< Lookup table for m_checks
     CalamaresUtils::CommandList* m_wildcard = nullptr;
 };
 
@@ -33,6 +33,10 @@ void
 ContextualProcessBinding::append( const QString& value, CalamaresUtils::CommandList* commands )
 {
     m_checks.append( ValueCheck( value, commands ) );
+    if ( !m_values.contains( value ) )
+    {
+        m_values.insert( value, commands );
+    }
     if ( value == QString( "*" ) )
     {
         m_wildcard = commands;
@@ -42,12 +46,10 @@ ContextualProcessBinding::append( const QString& value, CalamaresUtils::CommandL
 Calamares::JobResult
 ContextualProcessBinding::run( const QString& value ) const
 {
-    for ( const auto& c : m_checks )
+    auto* commands = m_values.value( value, nullptr );
+    if ( commands )
     {
-        if ( value == c.value() )
-        {
-            return c.commands()->run();
-        }
+        return commands->run();
     }
 
     if ( m_wildcard )
@@ -58,27 +60,45 @@ ContextualProcessBinding::run( const QString& value ) const
     return Calamares::JobResult::ok();
 }
 
-///@brief Implementation of fetch() for recursively looking up dotted selector parts.
-static bool
-fetch( QString& value, QStringList& selector, int index, const QVariant& v )
+ContextualProcessSnapshot::ContextualProcessSnapshot( Calamares::GlobalStorage* storage )
+    : m_data( storage ? storage->data() : QVariantMap() )
+{
+}
+
+bool
+ContextualProcessSnapshot::fetch( const QStringList& selector, QString& value )
 {
-    if ( !v.canConvert( QMetaType::QVariantMap ) )
+    value.clear();
+    if ( selector.isEmpty() )
     {
         return false;
     }
-    const QVariantMap map = v.toMap();
-    const QString& key = selector.at( index );
-    if ( index == selector.length() - 1 )
-    {
-        value = map.value( key ).toString();
-        return map.contains( key );
-    }
-    else
+
+    // Find the map holding the last part of the selector
+    QVariantMap map = m_data;
+    QString prefix;
+    for ( int index = 0; index < selector.length() - 1; ++index )
     {
-        return fetch( value, selector, index + 1, map.value( key ) );
+        const QString& key = selector.at( index );
+        prefix = index ? ( prefix + '.' + key ) : key;
+
+        auto it = m_maps.constFind( prefix );
+        if ( it == m_maps.constEnd() )
+        {
+            const QVariant v = map.value( key );
+            it = m_maps.insert( prefix, v.canConvert( QMetaType::QVariantMap ) ? QVariant( v.toMap() ) : QVariant() );
+        }
+        if ( !it->isValid() )
+        {
+            return false;
+        }
+        map = it->toMap();
     }
-}
 
+    const QString& key = selector.last();
+    value = map.value( key ).toString();
+    return map.contains( key );
+}
 
 bool
 ContextualProcessBinding::fetch( Calamares::GlobalStorage* storage, QString& value ) const
@@ -88,16 +108,14 @@ ContextualProcessBinding::fetch( Calamares::GlobalStorage* storage, QString& val
     {
         return false;
     }
-    if ( m_variable.contains( '.' ) )
-    {
-        QStringList steps = m_variable.split( '.' );
-        return ::fetch( value, steps, 1, storage->value( steps.first() ) );
-    }
-    else
-    {
-        value = storage->value( m_variable ).toString();
-        return storage->contains( m_variable );
-    }
+    ContextualProcessSnapshot snapshot( storage );
+    return fetch( snapshot, value );
+}
+
+bool
+ContextualProcessBinding::fetch( ContextualProcessSnapshot& snapshot, QString& value ) const
+{
+    return snapshot.fetch( m_selector, value );
 }
 
 
@@ -123,12 +141,13 @@ ContextualProcessJob::prettyName() const
 Calamares::JobResult
 ContextualProcessJob::exec()
 {
-    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+    // All the bindings are checked against the state of GS when the job starts
+    ContextualProcessSnapshot snapshot( Calamares::JobQueue::instance()->globalStorage() );
 
     for ( const ContextualProcessBinding* binding : m_commands )
     {
         QString value;
-        if ( binding->fetch( gs, value ) )
+        if ( binding->fetch( snapshot, value ) )
         {
             Calamares::JobResult r = binding->run( value );
             if ( !r )
@@ -180,3 +180,43 @@ ContextualProcessTests::testFetch()
         QVERIFY( s.isEmpty() );
     }
 }
+
+void
+ContextualProcessTests::testSnapshot()
+{
+    QVariantMap inner;
+    inner.insert( QStringLiteral( "leaf" ), QStringLiteral( "green" ) );
+    QVariantMap outer;
+    outer.insert( QStringLiteral( "inner" ), inner );
+    outer.insert( QStringLiteral( "colour" ), QStringLiteral( "brown" ) );
+    QVariantMap m;
+    m.insert( QStringLiteral( "tree" ), outer );
+    m.insert( QStringLiteral( "flat" ), 3 );
+
+    ContextualProcessSnapshot snapshot( m );
+    QString s;
+
+    ContextualProcessBinding leaf( QStringLiteral( "tree.inner.leaf" ) );
+    QVERIFY( leaf.fetch( snapshot, s ) );
+    QCOMPARE( s, QStringLiteral( "green" ) );
+    // Again, now from the cached sub-maps
+    QVERIFY( leaf.fetch( snapshot, s ) );
+    QCOMPARE( s, QStringLiteral( "green" ) );
+
+    ContextualProcessBinding colour( QStringLiteral( "tree.colour" ) );
+    QVERIFY( colour.fetch( snapshot, s ) );
+    QCOMPARE( s, QStringLiteral( "brown" ) );
+
+    ContextualProcessBinding flat( QStringLiteral( "flat" ) );
+    QVERIFY( flat.fetch( snapshot, s ) );
+    QCOMPARE( s, QStringLiteral( "3" ) );
+
+    // Not a map along the way; not there at all
+    ContextualProcessBinding notmap( QStringLiteral( "flat.leaf" ) );
+    QVERIFY( !notmap.fetch( snapshot, s ) );
+    QVERIFY( s.isEmpty() );
+    QVERIFY( !notmap.fetch( snapshot, s ) );
+    ContextualProcessBinding missing( QStringLiteral( "tree.branch.leaf" ) );
+    QVERIFY( !missing.fetch( snapshot, s ) );
+    QVERIFY( s.isEmpty() );
+}
@@ -26,6 +26,8 @@ private Q_SLOTS:
 
     // Variable binding lookup
     void testFetch();
+    // Lookup in a snapshot, with nested maps
+    void testSnapshot();
 };
 
 #endif
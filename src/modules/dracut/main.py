@@ -12,6 +12,8 @@
 #   Calamares is Free Software: see the License-Identifier above.
 #
 
+import os
+
 import libcalamares
 from libcalamares.utils import target_env_call
 
@@ -27,13 +29,55 @@ def pretty_name():
     return _("Creating initramfs with dracut.")
 
 
+def kernel_versions(root_mount_point):
+    """
+    Returns the kernel versions installed in the target, which are
+    the subdirectories of /lib/modules that go with a kernel image
+    (in that directory, or in /boot). Left-over directories, e.g.
+    from dkms, would make dracut --kver fail.
+    """
+    modules = os.path.join(root_mount_point, "lib/modules")
+    boot = os.path.join(root_mount_point, "boot")
+    try:
+        candidates = os.listdir(modules)
+    except OSError:
+        return []
+    return sorted(v for v in candidates
+                  if os.path.isfile(os.path.join(modules, v, "vmlinuz"))
+                  or os.path.isfile(os.path.join(boot, "vmlinuz-" + v)))
+
+
 def run_dracut():
     """
     Creates initramfs, even when initramfs already exists.
 
+    With more than one kernel installed, runs one dracut per kernel
+    version concurrently; plain `dracut -f` only builds the image
+    for the running kernel, or the only one that is installed.
+
     :return:
     """
-    return target_env_call(['dracut', '-f'])
+    from concurrent.futures import ThreadPoolExecutor, as_completed
+
+    versions = kernel_versions(libcalamares.globalstorage.value("rootMountPoint"))
+    if len(versions) < 2:
+        return target_env_call(['dracut', '-f'])
+
+    # Compressing the image takes the most memory
+    workers = min(len(versions), libcalamares.utils.bounded_worker_count(512 * 1024 * 1024))
+    libcalamares.utils.debug("Running dracut for {!s} with {!s} workers".format(", ".join(versions), workers))
+    return_codes = {}
+    with ThreadPoolExecutor(max_workers=workers) as pool:
+        futures = {pool.submit(target_env_call, ['dracut', '-f', '--kver', v]): v for v in versions}
+        for f in as_completed(futures):
+            return_codes[futures[f]] = f.result()
+            libcalamares.job.setprogress(len(return_codes) / len(versions))
+
+    for v in versions:
+        if return_codes[v] != 0:
+            libcalamares.utils.warning("dracut failed for kernel {!s}".format(v))
+            return return_codes[v]
+    return 0
 
 
 def run():
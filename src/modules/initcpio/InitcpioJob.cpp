@@ -45,6 +45,51 @@ fixPermissions( const QDir& d )
     }
 }
 
+/** @brief The mkinitcpio presets in directory @p d
+ *
+ * These are the names of the *.preset files, which is how mkinitcpio -P
+ * finds them too.
+ */
+QStringList
+listPresets( const QDir& d )
+{
+    QStringList presets;
+    for ( const auto& fi : d.entryInfoList( { "*.preset" }, QDir::Files, QDir::Name ) )
+    {
+        presets.append( fi.completeBaseName() );
+    }
+    return presets;
+}
+
+/** @brief The mkinitcpio commands for @p kernel
+ *
+ * Each preset is a separate run (which is what -P does, one after the
+ * other). For kernel *all*, those are the @p presets found in the target;
+ * if there are none, mkinitcpio -P looks for them itself.
+ */
+QList< QStringList >
+initcpioCommands( const QString& kernel, const QStringList& presets )
+{
+    if ( kernel != QStringLiteral( "all" ) )
+    {
+        return { { "mkinitcpio", "-p", kernel } };
+    }
+    if ( presets.isEmpty() )
+    {
+        return { { "mkinitcpio", "-P" } };
+    }
+
+    QList< QStringList > commands;
+    for ( const auto& preset : presets )
+    {
+        commands.append( { "mkinitcpio", "-p", preset } );
+    }
+    return commands;
+}
+
+/// @brief Memory to reserve for each concurrent mkinitcpio (compression is the big one)
+static constexpr quint64 memoryPerWorker = 512 * 1024 * 1024;
+
 Calamares::JobResult
 InitcpioJob::exec()
 {
@@ -63,10 +108,30 @@ InitcpioJob::exec()
         }
     }
 
-    cDebug() << "Updating initramfs with kernel" << m_kernel;
-    auto r = CalamaresUtils::System::instance()->targetEnvCommand(
-        { "mkinitcpio", "-p", m_kernel }, QString(), QString() /* no timeout , 0 */ );
-    return r.explainProcess( "mkinitcpio", std::chrono::seconds( 10 ) /* fake timeout */ );
+    auto* system = CalamaresUtils::System::instance();
+    QStringList presets;
+    if ( m_kernel == QStringLiteral( "all" ) )
+    {
+        presets = listPresets( QDir( system->targetPath( "/etc/mkinitcpio.d" ) ) );
+    }
+    const QList< QStringList > commands = initcpioCommands( m_kernel, presets );
+
+    // Build the presets concurrently, as far as memory allows.
+    const int workers = system->boundedWorkerCount( memoryPerWorker );
+    cDebug() << "Updating initramfs for kernel" << m_kernel << "presets" << presets << "with" << workers
+             << "workers";
+    const auto results = system->targetEnvCommands( commands, workers, [ this, &commands ]( int finished ) {
+        emit progress( qreal( finished ) / commands.count() );
+    } );
+    for ( int i = 0; i < results.count(); ++i )
+    {
+        if ( results.at( i ).getExitCode() != 0 )
+        {
+            return results.at( i ).explainProcess( commands.at( i ).join( ' ' ),
+                                                   std::chrono::seconds( 10 ) /* fake timeout */ );
+        }
+    }
+    return Calamares::JobResult::ok();
 }
 
 void
@@ -22,6 +22,8 @@
 #include <QStringList>
 
 extern void fixPermissions( const QDir& d );
+extern QStringList listPresets( const QDir& d );
+extern QList< QStringList > initcpioCommands( const QString& kernel, const QStringList& presets );
 
 QTEST_GUILESS_MAIN( InitcpioTests )
 
@@ -44,3 +46,35 @@ InitcpioTests::testFixPermissions()
     fixPermissions( QDir( "/nonexistent/nonexistent" ) );
     QVERIFY( true );
 }
+
+void
+InitcpioTests::testListPresets()
+{
+    QTemporaryDir tempRoot;
+    QVERIFY( tempRoot.isValid() );
+    QDir d( tempRoot.path() );
+    for ( const char* name : { "linux.preset", "linux-lts.preset", "README", "linux.preset.pacsave" } )
+    {
+        QFile f( d.filePath( name ) );
+        QVERIFY( f.open( QIODevice::WriteOnly ) );
+    }
+    QVERIFY( d.mkdir( "subdir.preset" ) );
+
+    QCOMPARE( listPresets( d ), QStringList( { "linux", "linux-lts" } ) );
+    QVERIFY( listPresets( QDir( "/nonexistent/nonexistent" ) ).isEmpty() );
+}
+
+void
+InitcpioTests::testCommands()
+{
+    using Commands = QList< QStringList >;
+
+    // A named kernel is its own preset
+    QCOMPARE( initcpioCommands( "linux", {} ), Commands( { { "mkinitcpio", "-p", "linux" } } ) );
+    // All of them, one at a time; also when there is only one
+    QCOMPARE( initcpioCommands( "all", { "linux" } ), Commands( { { "mkinitcpio", "-p", "linux" } } ) );
+    QCOMPARE( initcpioCommands( "all", { "linux", "linux-lts" } ),
+              Commands( { { "mkinitcpio", "-p", "linux" }, { "mkinitcpio", "-p", "linux-lts" } } ) );
+    // There is no preset named "all", but mkinitcpio can find them
+    QCOMPARE( initcpioCommands( "all", {} ), Commands( { { "mkinitcpio", "-P" } } ) );
+}
@@ -22,6 +22,8 @@ public:
 private Q_SLOTS:
     void initTestCase();
     void testFixPermissions();
+    void testListPresets();
+    void testCommands();
 };
 
 #endif
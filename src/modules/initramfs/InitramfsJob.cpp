@@ -14,6 +14,9 @@
 #include "utils/UMask.h"
 #include "utils/Variant.h"
 
+#include <QDir>
+#include <QFile>
+
 InitramfsJob::InitramfsJob( QObject* parent )
     : Calamares::CppJob( parent )
 {
@@ -28,6 +31,30 @@ InitramfsJob::prettyName() const
     return tr( "Creating initramfs." );
 }
 
+/** @brief The kernel versions installed in @p modules (/lib/modules)
+ *
+ * These are the subdirectories of /lib/modules, which is where
+ * update-initramfs looks for "all" kernels, too. Only those with a
+ * kernel image (in the directory itself, or in @p boot) count: left-over
+ * directories, e.g. from dkms, would make update-initramfs fail.
+ */
+QStringList
+listKernelVersions( const QDir& modules, const QDir& boot )
+{
+    QStringList versions;
+    for ( const auto& v : modules.entryList( QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name ) )
+    {
+        if ( QFile::exists( modules.filePath( v + QStringLiteral( "/vmlinuz" ) ) )
+             || QFile::exists( boot.filePath( QStringLiteral( "vmlinuz-" ) + v ) ) )
+        {
+            versions.append( v );
+        }
+    }
+    return versions;
+}
+
+/// @brief Memory to reserve for each concurrent update-initramfs (compression is the big one)
+static constexpr quint64 memoryPerWorker = 512 * 1024 * 1024;
 
 Calamares::JobResult
 InitramfsJob::exec()
@@ -53,9 +80,41 @@ InitramfsJob::exec()
     }
 
     // And then do the ACTUAL work.
-    auto r = CalamaresUtils::System::instance()->targetEnvCommand(
-        { "update-initramfs", "-k", m_kernel, "-c", "-t" }, QString(), QString() /* no timeout, 0 */ );
-    return r.explainProcess( "update-initramfs", std::chrono::seconds( 10 ) /* fake timeout */ );
+    auto* system = CalamaresUtils::System::instance();
+    QStringList versions;
+    if ( m_kernel == QStringLiteral( "all" ) )
+    {
+        versions = listKernelVersions( QDir( system->targetPath( "/lib/modules" ) ),
+                                       QDir( system->targetPath( "/boot" ) ) );
+    }
+    if ( versions.count() < 2 )
+    {
+        auto r = system->targetEnvCommand(
+            { "update-initramfs", "-k", m_kernel, "-c", "-t" }, QString(), QString() /* no timeout, 0 */ );
+        return r.explainProcess( "update-initramfs", std::chrono::seconds( 10 ) /* fake timeout */ );
+    }
+
+    // update-initramfs -k all builds the images one after the other;
+    // run one update-initramfs per kernel instead, as far as memory allows.
+    const int workers = system->boundedWorkerCount( memoryPerWorker );
+    cDebug() << Logger::SubEntry << "kernel versions" << versions << "with" << workers << "workers";
+    QList< QStringList > commands;
+    for ( const auto& version : qAsConst( versions ) )
+    {
+        commands.append( { "update-initramfs", "-k", version, "-c", "-t" } );
+    }
+    const auto results = system->targetEnvCommands( commands, workers, [ this, &commands ]( int finished ) {
+        emit progress( qreal( finished ) / commands.count() );
+    } );
+    for ( int i = 0; i < results.count(); ++i )
+    {
+        if ( results.at( i ).getExitCode() != 0 )
+        {
+            return results.at( i ).explainProcess( commands.at( i ).join( ' ' ),
+                                                   std::chrono::seconds( 10 ) /* fake timeout */ );
+        }
+    }
+    return Calamares::JobResult::ok();
 }
 
 
@@ -19,8 +19,12 @@
 
 #include <QtTest/QtTest>
 
+#include <QDir>
 #include <QFileInfo>
 #include <QStringList>
+#include <QTemporaryDir>
+
+extern QStringList listKernelVersions( const QDir& modules, const QDir& boot );
 
 QTEST_GUILESS_MAIN( InitramfsTests )
 
@@ -72,3 +76,31 @@ InitramfsTests::testCreateTargetFile()
 
     QFile::remove( path );
 }
+
+static void
+touch( const QString& path )
+{
+    QFile f( path );
+    QVERIFY( f.open( QIODevice::WriteOnly ) );
+}
+
+void
+InitramfsTests::testListKernelVersions()
+{
+    QTemporaryDir root;
+    QVERIFY( root.isValid() );
+    QDir d( root.path() );
+    for ( const auto* v : { "5.10.0-8-amd64", "5.15.2-arch1", "5.4.0-stale", "extramodules-5.15" } )
+    {
+        QVERIFY( d.mkpath( QStringLiteral( "lib/modules/" ) + v ) );
+    }
+    QVERIFY( d.mkpath( "boot" ) );
+    // Debian-style image in /boot, Arch-style image next to the modules
+    touch( d.filePath( "boot/vmlinuz-5.10.0-8-amd64" ) );
+    touch( d.filePath( "lib/modules/5.15.2-arch1/vmlinuz" ) );
+
+    const QDir modules( d.filePath( "lib/modules" ) );
+    const QDir boot( d.filePath( "boot" ) );
+    QCOMPARE( listKernelVersions( modules, boot ), QStringList( { "5.10.0-8-amd64", "5.15.2-arch1" } ) );
+    QVERIFY( listKernelVersions( QDir( "/nonexistent/nonexistent" ), boot ).isEmpty() );
+}
@@ -10,6 +10,7 @@
 
 #include "Config.h"
 
+#include "KeyboardTables.h"
 #include "SetKeyboardLayoutJob.h"
 #include "keyboardwidget/keyboardpreview.h"
 
@@ -114,36 +115,7 @@ xkbmap_query_grp_option()
 AdditionalLayoutInfo
 Config::getAdditionalLayoutInfo( const QString& layout )
 {
-    QFile layoutTable( ":/non-ascii-layouts" );
-
-    if ( !layoutTable.open( QIODevice::ReadOnly | QIODevice::Text ) )
-    {
-        cError() << "Non-ASCII layout table could not be opened";
-        return AdditionalLayoutInfo();
-    }
-
-    QString tableLine;
-
-    do
-    {
-        tableLine = layoutTable.readLine();
-    } while ( layoutTable.canReadLine() && !tableLine.startsWith( layout ) );
-
-    if ( !tableLine.startsWith( layout ) )
-    {
-        return AdditionalLayoutInfo();
-    }
-
-    QStringList tableEntries = tableLine.split( " ", SplitSkipEmptyParts );
-
-    AdditionalLayoutInfo r;
-
-    r.additionalLayout = tableEntries[ 1 ];
-    r.additionalVariant = tableEntries[ 2 ] == "-" ? "" : tableEntries[ 2 ];
-
-    r.vconsoleKeymap = tableEntries[ 3 ];
-
-    return r;
+    return KeyboardTables::nonAsciiLayoutInfo( layout );
 }
 
 Config::Config( QObject* parent )
@@ -183,12 +155,16 @@ Config::Config( QObject* parent )
 
             if ( !m_additionalLayoutInfo.additionalLayout.isEmpty() )
             {
-                m_additionalLayoutInfo.groupSwitcher = xkbmap_query_grp_option();
-
-                if ( m_additionalLayoutInfo.groupSwitcher.isEmpty() )
+                // Once set, the query returns our own switcher, so ask only once
+                if ( m_groupSwitcher.isEmpty() )
                 {
-                    m_additionalLayoutInfo.groupSwitcher = "grp:alt_shift_toggle";
+                    m_groupSwitcher = xkbmap_query_grp_option();
+                    if ( m_groupSwitcher.isEmpty() )
+                    {
+                        m_groupSwitcher = "grp:alt_shift_toggle";
+                    }
                 }
+                m_additionalLayoutInfo.groupSwitcher = m_groupSwitcher;
 
                 QProcess::execute( "setxkbmap",
                                    xkbmap_layout_args( { m_additionalLayoutInfo.additionalLayout, m_selectedLayout },
@@ -86,6 +86,7 @@ private:
 
     // Layout (and corresponding info) added if current one doesn't support ASCII (e.g. Russian or Japanese)
     AdditionalLayoutInfo m_additionalLayoutInfo;
+    QString m_groupSwitcher;  ///< From the live system, queried once
 
     QTimer m_setxkbmapTimer;
 
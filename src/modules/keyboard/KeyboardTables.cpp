@@ -0,0 +1,128 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "KeyboardTables.h"
+
+#include "KeyboardTables_p.cpp"
+
+#include "utils/Logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace KeyboardTables
+{
+
+/// @brief Is the table sorted (by the given member)? Checked at compile-time.
+template < typename T, std::size_t N >
+static constexpr bool
+isSorted( const T ( &table )[ N ], const char* T::*key )
+{
+    for ( std::size_t i = 1; i < N; ++i )
+    {
+        const char* a = table[ i - 1 ].*key;
+        const char* b = table[ i ].*key;
+        while ( *a && *a == *b )
+        {
+            ++a;
+            ++b;
+        }
+        if ( static_cast< unsigned char >( *a ) > static_cast< unsigned char >( *b ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert( isSorted( keymap_data_table, &KeymapData::layoutKey ), "kbd-model-map table must be sorted" );
+static_assert( isSorted( non_ascii_data_table, &NonAsciiData::layout ), "non-ascii-layouts table must be sorted" );
+
+AdditionalLayoutInfo
+nonAsciiLayoutInfo( const QString& layout )
+{
+    const QByteArray key = layout.toLatin1();
+    const auto* end = non_ascii_data_table + non_ascii_data_size;
+    const auto* p = std::lower_bound( non_ascii_data_table, end, key, []( const NonAsciiData& d, const QByteArray& k ) {
+        return std::strcmp( d.layout, k.constData() ) < 0;
+    } );
+    if ( p == end || key != p->layout )
+    {
+        return AdditionalLayoutInfo();
+    }
+
+    AdditionalLayoutInfo r;
+    r.additionalLayout = QString::fromLatin1( p->additionalLayout );
+    r.additionalVariant = QString::fromLatin1( p->additionalVariant );
+    r.vconsoleKeymap = QString::fromLatin1( p->vconsoleKeymap );
+    return r;
+}
+
+QString
+legacyKeymap( const QString& layout, const QString& model, const QString& variant )
+{
+    cDebug() << "Looking for legacy keymap" << layout << model << variant;
+
+    // Only entries whose first layout is the first of @p layout can
+    // match at all; they are consecutive (and in file order) in the table.
+    const QByteArray key = layout.toLatin1();
+    const QByteArray firstLayout = key.left( key.indexOf( ',' ) );
+    const auto* begin = keymap_data_table;
+    const auto* end = keymap_data_table + keymap_data_size;
+    begin = std::lower_bound( begin, end, firstLayout, []( const KeymapData& d, const QByteArray& k ) {
+        return std::strcmp( d.layoutKey, k.constData() ) < 0;
+    } );
+    end = std::upper_bound( begin, end, firstLayout, []( const QByteArray& k, const KeymapData& d ) {
+        return std::strcmp( k.constData(), d.layoutKey ) < 0;
+    } );
+
+    int bestMatching = 0;
+    const char* name = nullptr;
+    for ( const auto* p = begin; p != end; ++p )
+    {
+        // We assume here that we have one X11 layout. If the UI changes to
+        // allow more than one layout, this should change too.
+        // An exact match is best, otherwise look for an entry whose first layout matches ours.
+        int matching = 0;
+        if ( std::strcmp( p->xlayout, key.constData() ) == 0 )
+        {
+            matching = 10;
+        }
+        else if ( std::strncmp( p->xlayout, key.constData(), key.length() ) == 0 && p->xlayout[ key.length() ] == ',' )
+        {
+            matching = 5;
+        }
+        else
+        {
+            continue;
+        }
+
+        if ( model.isEmpty() || model == QLatin1String( p->xmodel ) )
+        {
+            matching++;
+        }
+        if ( variant == QLatin1String( p->xvariant ) )
+        {
+            matching++;
+        }
+        // We ignore the xkb options, for now. If we ever
+        // allow setting options in the UI, we should match them here.
+
+        if ( matching > bestMatching )
+        {
+            cDebug() << Logger::SubEntry << "Found legacy keymap" << p->consoleLayout << "with score" << matching;
+            bestMatching = matching;
+            name = p->consoleLayout;
+        }
+    }
+
+    return name ? QString::fromLatin1( name ) : QString();
+}
+
+}  // namespace KeyboardTables
@@ -0,0 +1,44 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef KEYBOARD_KEYBOARDTABLES_H
+#define KEYBOARD_KEYBOARDTABLES_H
+
+#include "AdditionalLayoutInfo.h"
+
+#include <QString>
+
+/** @brief Lookups in the compiled-in keyboard tables
+ *
+ * The tables are generated from kbd-model-map and non-ascii-layouts
+ * by `layout-extractor.py --tables`, sorted by X11 layout, so that
+ * lookups are a binary search rather than a scan of a text file.
+ */
+namespace KeyboardTables
+{
+/** @brief Additional layout for non-ASCII @p layout
+ *
+ * Returns an empty info (no additional layout) if @p layout
+ * can type ASCII on its own. The group switcher is not set.
+ */
+AdditionalLayoutInfo nonAsciiLayoutInfo( const QString& layout );
+
+/** @brief The legacy vconsole keymap for the given X11 settings
+ *
+ * This uses the matching rules of systemd-localed: an exact match
+ * of the @p layout is better than a match of the first of several
+ * layouts, and a matching @p model (or empty) and @p variant each
+ * make the match better. Of equally-good matches, the first one
+ * in kbd-model-map wins. Returns an empty string if there is
+ * no match for @p layout at all.
+ */
+QString legacyKeymap( const QString& layout, const QString& model, const QString& variant );
+}  // namespace KeyboardTables
+
+#endif
@@ -0,0 +1,116 @@
+/*   GENERATED FILE DO NOT EDIT
+*
+*  === This file is part of Calamares - <https://calamares.io> ===
+*
+* SPDX-FileCopyrightText: 2015 Systemd authors and contributors
+* SPDX-FileCopyrightText: 2018 Adriaan de Groot <groot@kde.org>
+* SPDX-License-Identifier: GPL-3.0-or-later
+*
+* This file is derived from kbd-model-map and non-ascii-layouts
+* by layout-extractor.py --tables
+*
+*/
+
+// BEGIN Generated from kbd-model-map and non-ascii-layouts
+// *INDENT-OFF*
+// clang-format off
+
+struct KeymapData
+{
+    const char* layoutKey;  // First X11 layout, the sort key
+    const char* xlayout;
+    const char* xmodel;
+    const char* xvariant;  // Empty for - in kbd-model-map
+    const char* consoleLayout;
+};
+
+static constexpr int const keymap_data_size = 68;
+
+static constexpr KeymapData const keymap_data_table[] = {
+{ "at", "at", "pc105", "", "de" },
+{ "be", "be", "pc105", "", "be-latin1" },
+{ "bg", "bg,us", "pc105", ",phonetic", "bg_pho-utf8" },
+{ "bg", "bg,us", "pc105", "", "bg_bds-utf8" },
+{ "br", "br", "abnt2", "", "br-abnt2" },
+{ "by", "by,us", "pc105", "", "by" },
+{ "ca", "ca", "pc105", "", "cf" },
+{ "ch", "ch", "pc105", "de_nodeadkeys", "sg" },
+{ "ch", "ch", "pc105", "fr", "fr_CH" },
+{ "ch", "ch", "pc105", "de_nodeadkeys", "sg-latin1" },
+{ "ch", "ch", "pc105", "fr", "fr_CH-latin1" },
+{ "cz", "cz,us", "pc105", "", "cz-us-qwertz" },
+{ "cz", "cz", "pc105", "qwerty", "cz-lat2" },
+{ "de", "de", "pc105", "", "de" },
+{ "de", "de", "pc105", "", "de-latin1" },
+{ "de", "de", "pc105", "nodeadkeys", "de-latin1-nodeadkeys" },
+{ "dk", "dk", "pc105", "", "dk-latin1" },
+{ "dk", "dk", "pc105", "", "dk" },
+{ "ee", "ee", "pc105", "", "et" },
+{ "es", "es", "pc105", "", "es" },
+{ "fi", "fi", "pc105", "", "fi" },
+{ "fr", "fr", "pc105", "", "fr" },
+{ "fr", "fr", "pc105", "", "fr-latin1" },
+{ "fr", "fr", "pc105", "", "fr-pc" },
+{ "fr", "fr", "pc105", "latin9", "fr-latin9" },
+{ "gb", "gb", "pc105", "", "uk" },
+{ "gr", "gr,us", "pc105", "", "gr" },
+{ "hr", "hr", "pc105", "", "croat" },
+{ "hu", "hu", "pc105", "qwerty", "hu101" },
+{ "hu", "hu", "pc105", "", "hu" },
+{ "ie", "ie", "pc105", "", "ie" },
+{ "il", "il", "pc105", "", "il" },
+{ "is", "is", "pc105", "", "is-latin1" },
+{ "it", "it", "pc105", "", "it2" },
+{ "it", "it", "pc105", "", "it" },
+{ "it", "it", "pc105", "", "it-ibm" },
+{ "jp", "jp", "jp106", "", "jp106" },
+{ "kh", "kh,us", "pc105", "", "khmer" },
+{ "kr", "kr", "pc105", "", "ko" },
+{ "kz", "kz,us", "pc105", "", "kazakh" },
+{ "latam", "latam", "pc105", "", "la-latin1" },
+{ "lt", "lt", "pc105", "", "lt.baltic" },
+{ "lt", "lt", "pc105", "", "lt.l4" },
+{ "lt", "lt", "pc105", "", "lt" },
+{ "mk", "mk,us", "pc105", "", "mk-utf" },
+{ "nl", "nl", "pc105", "", "nl" },
+{ "no", "no", "pc105", "", "no" },
+{ "pl", "pl", "pc105", "", "pl2" },
+{ "pt", "pt", "pc105", "", "pt-latin1" },
+{ "ro", "ro", "pc105", "std", "ro-std" },
+{ "ro", "ro", "pc105", "", "ro" },
+{ "ro", "ro", "pc105", "std_cedilla", "ro-std-cedilla" },
+{ "ro", "ro", "pc105", "cedilla", "ro-cedilla" },
+{ "rs", "rs", "pc105", "latin", "sr-latin" },
+{ "rs", "rs", "pc105", "", "sr-cy" },
+{ "ru", "ru,us", "pc105", "", "ru" },
+{ "se", "se", "pc105", "", "sv-latin1" },
+{ "si", "si", "pc105", "", "slovene" },
+{ "sk", "sk", "pc105", "", "sk-qwerty" },
+{ "sk", "sk", "pc105", "", "sk-qwertz" },
+{ "tj", "tj", "pc105", "", "tj_alt-UTF8" },
+{ "tr", "tr", "pc105", "", "trq" },
+{ "tr", "tr", "pc105", "f", "trf" },
+{ "ua", "ua,us", "pc105", "", "ua-utf" },
+{ "us", "us", "pc105+inet", "", "us" },
+{ "us", "us", "pc105", "intl", "us-acentos" },
+{ "us", "us", "pc105", "dvorak", "dvorak" },
+{ "us", "us", "pc105", "dvorak-alt-intl", "dvorak" },
+};
+
+struct NonAsciiData
+{
+    const char* layout;  // The sort key
+    const char* additionalLayout;
+    const char* additionalVariant;  // Empty for - in non-ascii-layouts
+    const char* vconsoleKeymap;
+};
+
+static constexpr int const non_ascii_data_size = 3;
+
+static constexpr NonAsciiData const non_ascii_data_table[] = {
+{ "gr", "us", "", "gr" },
+{ "ru", "us", "", "ruwin_alt_sh-UTF-8" },
+{ "ua", "us", "", "ua-utf" },
+};
+
+// END Generated from kbd-model-map and non-ascii-layouts
@@ -17,6 +17,8 @@
 
 #include "SetKeyboardLayoutJob.h"
 
+#include "KeyboardTables.h"
+
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "utils/CalamaresUtilsSystem.h"
@@ -84,89 +86,7 @@ SetKeyboardLayoutJob::findConvertedKeymap( const QString& convertedKeymapPath )
 STATICTEST QString
 findLegacyKeymap( const QString& layout, const QString& model, const QString& variant )
 {
-    cDebug() << "Looking for legacy keymap" << layout << model << variant << "in QRC";
-
-    int bestMatching = 0;
-    QString name;
-
-    QFile file( ":/kbd-model-map" );
-    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
-    {
-        cDebug() << Logger::SubEntry << "Could not read QRC";
-        return QString();
-    }
-
-    QTextStream stream( &file );
-    while ( !stream.atEnd() )
-    {
-        QString line = stream.readLine().trimmed();
-        if ( line.isEmpty() || line.startsWith( '#' ) )
-        {
-            continue;
-        }
-
-        QStringList mapping = line.split( '\t', SplitSkipEmptyParts );
-        if ( mapping.size() < 5 )
-        {
-            continue;
-        }
-
-        int matching = 0;
-
-        // Determine how well matching this entry is
-        // We assume here that we have one X11 layout. If the UI changes to
-        // allow more than one layout, this should change too.
-        if ( layout == mapping[ 1 ] )
-        // If we got an exact match, this is best
-        {
-            matching = 10;
-        }
-        // Look for an entry whose first layout matches ours
-        else if ( mapping[ 1 ].startsWith( layout + ',' ) )
-        {
-            matching = 5;
-        }
-
-        if ( matching > 0 )
-        {
-            if ( model.isEmpty() || model == mapping[ 2 ] )
-            {
-                matching++;
-            }
-
-            QString mappingVariant = mapping[ 3 ];
-            if ( mappingVariant == "-" )
-            {
-                mappingVariant = QString();
-            }
-            else if ( mappingVariant.startsWith( ',' ) )
-            {
-                mappingVariant.remove( 1, 0 );
-            }
-
-            if ( variant == mappingVariant )
-            {
-                matching++;
-            }
-
-            // We ignore mapping[4], the xkb options, for now. If we ever
-            // allow setting options in the UI, we should match them here.
-        }
-
-        // The best matching entry so far, then let's save that
-        if ( matching >= qMax( bestMatching, 1 ) )
-        {
-            cDebug() << Logger::SubEntry << "Found legacy keymap" << mapping[ 0 ] << "with score" << matching;
-
-            if ( matching > bestMatching )
-            {
-                bestMatching = matching;
-                name = mapping[ 0 ];
-            }
-        }
-    }
-
-    return name;
+    return KeyboardTables::legacyKeymap( layout, model, variant );
 }
 
 QString
@@ -6,6 +6,8 @@
  *   Calamares is Free Software: see the License-Identifier above.
  *
  */
+#include "KeyboardTables.h"
+
 #include "utils/Logger.h"
 
 #include <QtTest/QtTest>
@@ -25,6 +27,7 @@ private Q_SLOTS:
 
     void testSimpleLayoutLookup_data();
     void testSimpleLayoutLookup();
+    void testNonAsciiLookup();
 };
 
 void
@@ -45,6 +48,12 @@ KeyboardLayoutTests::testSimpleLayoutLookup_data()
     QTest::newRow( "turkish default" ) << QString( "tr" ) << QString() << QString() << QString( "trq" );
     QTest::newRow( "turkish alt-q" ) << QString( "tr" ) << QString() << QString( "alt" ) << QString( "trq" );
     QTest::newRow( "turkish f" ) << QString( "tr" ) << QString() << QString( "f" ) << QString( "trf" );
+    // First of two layouts, bg,us
+    QTest::newRow( "bulgarian" ) << QString( "bg" ) << QString() << QString() << QString( "bg_bds-utf8" );
+    QTest::newRow( "bulgarian phonetic" )
+        << QString( "bg" ) << QString() << QString( ",phonetic" ) << QString( "bg_pho-utf8" );
+    QTest::newRow( "swiss french" ) << QString( "ch" ) << QString() << QString( "fr" ) << QString( "fr_CH" );
+    QTest::newRow( "unknown" ) << QString( "xx" ) << QString() << QString() << QString();
 }
 
 
@@ -59,6 +68,20 @@ KeyboardLayoutTests::testSimpleLayoutLookup()
     QCOMPARE( findLegacyKeymap( layout, model, variant ), vconsole );
 }
 
+void
+KeyboardLayoutTests::testNonAsciiLookup()
+{
+    auto ru = KeyboardTables::nonAsciiLayoutInfo( "ru" );
+    QCOMPARE( ru.additionalLayout, QStringLiteral( "us" ) );
+    QVERIFY( ru.additionalVariant.isEmpty() );
+    QCOMPARE( ru.vconsoleKeymap, QStringLiteral( "ruwin_alt_sh-UTF-8" ) );
+    QCOMPARE( KeyboardTables::nonAsciiLayoutInfo( "gr" ).vconsoleKeymap, QStringLiteral( "gr" ) );
+
+    // ASCII layouts, and prefixes of non-ASCII ones, have no additional layout
+    QVERIFY( KeyboardTables::nonAsciiLayoutInfo( "us" ).additionalLayout.isEmpty() );
+    QVERIFY( KeyboardTables::nonAsciiLayoutInfo( "r" ).additionalLayout.isEmpty() );
+    QVERIFY( KeyboardTables::nonAsciiLayoutInfo( QString() ).additionalLayout.isEmpty() );
+}
 
 QTEST_GUILESS_MAIN( KeyboardLayoutTests )
 
@@ -63,6 +63,9 @@ parseKeyboardModels( const char* filepath )
         return models;
     }
 
+    // The pattern is the same for every line in the section
+    QRegExp rx( "^\\s+(\\S+)\\s+(\\w.*)\n$" );
+
     bool modelsFound = findSection( fh, "! model" );
     // read the file until the end or until we break the loop
     while ( modelsFound && !fh.atEnd() )
@@ -76,9 +79,6 @@ parseKeyboardModels( const char* filepath )
         }
 
         // here we are in the model section, otherwise we would continue or break
-        QRegExp rx;
-        rx.setPattern( "^\\s+(\\S+)\\s+(\\w.*)\n$" );
-
         // insert into the model map
         if ( rx.indexIn( line ) != -1 )
         {
@@ -108,6 +108,8 @@ parseKeyboardLayouts( const char* filepath )
         return layouts;
     }
 
+    QRegExp rx( "^\\s+(\\S+)\\s+(\\w.*)\n$" );
+
     bool layoutsFound = findSection( fh, "! layout" );
     // read the file until the end or we break the loop
     while ( layoutsFound && !fh.atEnd() )
@@ -119,9 +121,6 @@ parseKeyboardLayouts( const char* filepath )
             break;
         }
 
-        QRegExp rx;
-        rx.setPattern( "^\\s+(\\S+)\\s+(\\w.*)\n$" );
-
         // insert into the layout map
         if ( rx.indexIn( line ) != -1 )
         {
@@ -137,6 +136,8 @@ parseKeyboardLayouts( const char* filepath )
 
     //### Get Variants ###//
 
+    rx.setPattern( "^\\s+(\\S+)\\s+(\\S+): (\\w.*)\n$" );
+
     bool variantsFound = findSection( fh, "! variant" );
     // read the file until the end or until we break
     while ( variantsFound && !fh.atEnd() )
@@ -148,9 +149,6 @@ parseKeyboardLayouts( const char* filepath )
             break;
         }
 
-        QRegExp rx;
-        rx.setPattern( "^\\s+(\\S+)\\s+(\\S+): (\\w.*)\n$" );
-
         // insert into the variants multimap, if the pattern matches
         if ( rx.indexIn( line ) != -1 )
         {
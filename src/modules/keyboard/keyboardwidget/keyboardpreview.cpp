@@ -18,6 +18,10 @@
 #include "utils/Logger.h"
 #include "utils/String.h"
 
+#ifdef HAVE_XKBCOMMON
+#include <xkbcommon/xkbcommon.h>
+#endif
+
 KeyBoardPreview::KeyBoardPreview( QWidget* parent )
     : QWidget( parent )
     , layout( "us" )
@@ -67,6 +71,16 @@ KeyBoardPreview::KeyBoardPreview( QWidget* parent )
     kb = &kbList[ KB_104 ];
 }
 
+KeyBoardPreview::~KeyBoardPreview()
+{
+#ifdef HAVE_XKBCOMMON
+    if ( m_xkbContext )
+    {
+        xkb_context_unref( m_xkbContext );
+    }
+#endif
+}
+
 
 void
 KeyBoardPreview::setLayout( QString _layout )
@@ -124,6 +138,118 @@ KeyBoardPreview::loadCodes()
         return false;
     }
 
+    // Scrolling through the layouts list comes back to the same layouts
+    const QString key = variant.isEmpty() ? layout : QStringLiteral( "%1(%2)" ).arg( layout, variant );
+    const auto cached = m_codesCache.constFind( key );
+    if ( cached != m_codesCache.constEnd() )
+    {
+        codes = cached.value();
+        return true;
+    }
+
+    QList< Code > newCodes;
+#ifdef HAVE_XKBCOMMON
+    bool ok = loadCodesXkb( newCodes ) || loadCodesCkbcomp( newCodes );
+#else
+    bool ok = loadCodesCkbcomp( newCodes );
+#endif
+    if ( !ok )
+    {
+        return false;
+    }
+
+    codes = newCodes;
+    m_codesCache.insert( key, newCodes );
+    return true;
+}
+
+#ifdef HAVE_XKBCOMMON
+/// @brief Highest (kernel) keycode that the keyboard types use
+static constexpr xkb_keycode_t maxKeycode = 0x60;
+/// @brief XKB keycodes are kernel keycodes plus 8 (for evdev)
+static constexpr xkb_keycode_t evdevOffset = 8;
+
+/** @brief The label for @p keycode in the given @p state
+ *
+ * Keys that do not produce a printable character (like Escape, or
+ * dead keys) have no label, which matches what ckbcomp's named
+ * keysyms did.
+ */
+static QString
+keyText( xkb_state* state, xkb_keycode_t keycode )
+{
+    uint ucs = xkb_state_key_get_utf32( state, keycode );
+    if ( ucs < 0x20 || ucs == 0x7f )
+    {
+        return QString();
+    }
+    return QString::fromUcs4( &ucs, 1 );
+}
+
+/** @brief Resolves the key labels in-process with libxkbcommon
+ *
+ * This compiles the keymap for the layout and variant from the XKB
+ * data on the system, which is much cheaper than running ckbcomp
+ * (a Perl script) and parsing its output.
+ */
+bool
+KeyBoardPreview::loadCodesXkb( QList< Code >& newCodes )
+{
+    if ( !m_xkbContext )
+    {
+        m_xkbContext = xkb_context_new( XKB_CONTEXT_NO_FLAGS );
+        if ( !m_xkbContext )
+        {
+            cWarning() << "Could not create XKB context.";
+            return false;
+        }
+    }
+
+    const QByteArray layoutName = layout.toUtf8();
+    const QByteArray variantName = variant.toUtf8();
+    xkb_rule_names names {};
+    names.rules = "evdev";
+    names.model = "pc106";
+    names.layout = layoutName.constData();
+    names.variant = variantName.constData();
+
+    xkb_keymap* keymap = xkb_keymap_new_from_names( m_xkbContext, &names, XKB_KEYMAP_COMPILE_NO_FLAGS );
+    if ( !keymap )
+    {
+        cWarning() << "Could not compile XKB keymap for" << layout << variant;
+        return false;
+    }
+    xkb_state* plainState = xkb_state_new( keymap );
+    xkb_state* shiftState = xkb_state_new( keymap );
+    const xkb_mod_index_t shift = xkb_keymap_mod_get_index( keymap, XKB_MOD_NAME_SHIFT );
+    if ( shiftState && shift != XKB_MOD_INVALID )
+    {
+        xkb_state_update_mask( shiftState, xkb_mod_mask_t( 1 ) << shift, 0, 0, 0, 0, 0 );
+    }
+
+    bool ok = plainState && shiftState;
+    if ( ok )
+    {
+        // newCodes[ n - 1 ] is the code for (kernel) keycode n, as with ckbcomp
+        for ( xkb_keycode_t k = 1; k <= maxKeycode; ++k )
+        {
+            Code code;
+            code.plain = keyText( plainState, k + evdevOffset );
+            code.shift = keyText( shiftState, k + evdevOffset );
+            newCodes.append( code );
+        }
+    }
+
+    xkb_state_unref( shiftState );
+    xkb_state_unref( plainState );
+    xkb_keymap_unref( keymap );
+    return ok;
+}
+#endif
+
+bool
+KeyBoardPreview::loadCodesCkbcomp( QList< Code >& newCodes )
+{
     QStringList param;
     param << "-model"
           << "pc106"
@@ -150,9 +276,6 @@ KeyBoardPreview::loadCodes()
         return false;
     }
 
-    // Clear codes
-    codes.clear();
-
     const QStringList list = QString( process.readAll() ).split( "\n", SplitSkipEmptyParts );
 
     for ( const QString& line : list )
@@ -184,7 +307,7 @@ KeyBoardPreview::loadCodes()
             code.alt = "";
         }
 
-        codes.append( code );
+        newCodes.append( code );
     }
 
     return true;
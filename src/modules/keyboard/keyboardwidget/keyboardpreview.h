@@ -17,6 +17,7 @@
 
 #include <QColor>
 #include <QFont>
+#include <QHash>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPen>
@@ -27,12 +28,16 @@
 #include <QStringList>
 #include <QWidget>
 
+#ifdef HAVE_XKBCOMMON
+struct xkb_context;
+#endif
 
 class KeyBoardPreview : public QWidget
 {
     Q_OBJECT
 public:
     explicit KeyBoardPreview( QWidget* parent = nullptr );
+    ~KeyBoardPreview() override;
 
     void setLayout( QString layout );
     void setVariant( QString variant );
@@ -62,6 +67,14 @@ private:
     QList< Code > codes;
     int space, usable_width, key_w;
 
+    /// @brief Codes for each layout(variant) that has been shown
+    QHash< QString, QList< Code > > m_codesCache;
+#ifdef HAVE_XKBCOMMON
+    xkb_context* m_xkbContext = nullptr;
+    bool loadCodesXkb( QList< Code >& newCodes );
+#endif
+    bool loadCodesCkbcomp( QList< Code >& newCodes );
+
     void loadInfo();
     bool loadCodes();
     QString regular_text( int index );
@@ -13,6 +13,11 @@ To use this script, you must have a base.lst in a standard location,
 
 Prints out a few tables of keyboard model, layout, variant names for
 use in translations.
+
+With the argument --tables, the script does not need base.lst;
+it reads kbd-model-map and non-ascii-layouts (in the current
+directory) and writes KeyboardTables_p.cpp, sorted tables for
+looking up vconsole keymaps and additional (ASCII) layouts.
 """
 
 def scrape_file(file, modelsset, layoutsset, variantsset):
@@ -81,7 +86,114 @@ cpp_header_comment = """/*   GENERATED FILE DO NOT EDIT
 // clang-format off
 """
 
+tables_header_comment = """/*   GENERATED FILE DO NOT EDIT
+*
+*  === This file is part of Calamares - <https://calamares.io> ===
+*
+* SPDX-FileCopyrightText: 2015 Systemd authors and contributors
+* SPDX-FileCopyrightText: 2018 Adriaan de Groot <groot@kde.org>
+* SPDX-License-Identifier: GPL-3.0-or-later
+*
+* This file is derived from kbd-model-map and non-ascii-layouts
+* by layout-extractor.py --tables
+*
+*/
+
+// BEGIN Generated from kbd-model-map and non-ascii-layouts
+// *INDENT-OFF*
+// clang-format off
+"""
+
+tables_footer_comment = """
+// END Generated from kbd-model-map and non-ascii-layouts
+"""
+
+
+def read_table(filename, columns):
+    """
+    Reads a whitespace-separated table from @p filename, returns
+    a list of rows (lists) with exactly @p columns entries.
+    Comments and short lines are skipped, like the C++ code did.
+    """
+    rows = []
+    with open(filename, "r", encoding="UTF-8") as f:
+        for line in f.readlines():
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            fields = line.split()
+            if len(fields) < columns:
+                continue
+            rows.append(fields[:columns])
+    return rows
+
+
+def cpp_string(s):
+    return '"{!s}"'.format(s.replace("\\", "\\\\").replace('"', '\\"'))
+
+
+def write_tables(file):
+    # consolelayout xlayout xmodel xvariant xoptions
+    keymaps = read_table("kbd-model-map", 5)
+    # Sort on the first X11 layout; the sort is stable, so entries
+    # for one layout stay in file order (which matters for matching).
+    keymaps = sorted(keymaps, key=lambda row: row[1].split(",")[0])
+    file.write("""
+struct KeymapData
+{{
+    const char* layoutKey;  // First X11 layout, the sort key
+    const char* xlayout;
+    const char* xmodel;
+    const char* xvariant;  // Empty for - in kbd-model-map
+    const char* consoleLayout;
+}};
+
+static constexpr int const keymap_data_size = {!s};
+
+static constexpr KeymapData const keymap_data_table[] = {{
+""".format(len(keymaps)))
+    for row in keymaps:
+        file.write("{{ {!s}, {!s}, {!s}, {!s}, {!s} }},\n".format(
+            cpp_string(row[1].split(",")[0]),
+            cpp_string(row[1]),
+            cpp_string(row[2]),
+            cpp_string("" if row[3] == "-" else row[3]),
+            cpp_string(row[0])))
+    file.write("};\n")
+
+    # layout additional-layout additional-variant vconsole-keymap
+    nonascii = sorted(read_table("non-ascii-layouts", 4), key=lambda row: row[0])
+    file.write("""
+struct NonAsciiData
+{{
+    const char* layout;  // The sort key
+    const char* additionalLayout;
+    const char* additionalVariant;  // Empty for - in non-ascii-layouts
+    const char* vconsoleKeymap;
+}};
+
+static constexpr int const non_ascii_data_size = {!s};
+
+static constexpr NonAsciiData const non_ascii_data_table[] = {{
+""".format(len(nonascii)))
+    for row in nonascii:
+        file.write("{{ {!s}, {!s}, {!s}, {!s} }},\n".format(
+            cpp_string(row[0]),
+            cpp_string(row[1]),
+            cpp_string("" if row[2] == "-" else row[2]),
+            cpp_string(row[3])))
+    file.write("};\n")
+
+
 if __name__ == "__main__":
+    import sys
+    if "--tables" in sys.argv[1:]:
+        with open("KeyboardTables_p.cpp", "w", encoding="UTF-8") as f:
+            f.write(tables_header_comment)
+            write_tables(f)
+            f.write(tables_footer_comment)
+        sys.exit(0)
+
     models=set()
     layouts=set()
     variants=set()
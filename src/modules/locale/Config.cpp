@@ -17,7 +17,6 @@
 #include "locale/Global.h"
 #include "locale/Label.h"
 #include "modulesystem/ModuleManager.h"
-#include "network/Manager.h"
 #include "utils/Logger.h"
 #include "utils/Variant.h"
 
@@ -454,20 +453,16 @@ getStartingTimezone( const QVariantMap& configurationMap, CalamaresUtils::GeoIP:
 }
 
 static inline void
-getGeoIP( const QVariantMap& configurationMap, std::unique_ptr< CalamaresUtils::GeoIP::Handler >& geoip )
+getGeoIP( const QVariantMap& configurationMap, std::unique_ptr< CalamaresUtils::GeoIP::Resolver >& geoip )
 {
     bool ok = false;
     QVariantMap map = CalamaresUtils::getSubMap( configurationMap, "geoip", ok );
     if ( ok )
     {
-        QString url = CalamaresUtils::getString( map, "url" );
-        QString style = CalamaresUtils::getString( map, "style" );
-        QString selector = CalamaresUtils::getString( map, "selector" );
-
-        geoip = std::make_unique< CalamaresUtils::GeoIP::Handler >( style, url, selector );
+        geoip = std::make_unique< CalamaresUtils::GeoIP::Resolver >( map );
         if ( !geoip->isValid() )
         {
-            cWarning() << "GeoIP Style" << style << "is not recognized.";
+            cWarning() << "GeoIP has no usable providers.";
         }
     }
 }
@@ -518,14 +513,12 @@ Config::startGeoIP()
 {
     if ( m_geoip && m_geoip->isValid() )
     {
-        auto& network = CalamaresUtils::Network::Manager::instance();
-        if ( network.hasInternet() || network.synchronousPing( m_geoip->url() ) )
-        {
-            using Watcher = QFutureWatcher< CalamaresUtils::GeoIP::RegionZonePair >;
-            m_geoipWatcher = std::make_unique< Watcher >();
-            m_geoipWatcher->setFuture( m_geoip->query() );
-            connect( m_geoipWatcher.get(), &Watcher::finished, this, &Config::completeGeoIP );
-        }
+        // There is no check for the network here: the providers are
+        // asked in the background, and fail quickly without a network.
+        using Watcher = QFutureWatcher< CalamaresUtils::GeoIP::RegionZonePair >;
+        m_geoipWatcher = std::make_unique< Watcher >();
+        m_geoipWatcher->setFuture( m_geoip->query() );
+        connect( m_geoipWatcher.get(), &Watcher::finished, this, &Config::completeGeoIP );
     }
 }
 
@@ -13,7 +13,7 @@
 #include "LocaleConfiguration.h"
 
 #include "Job.h"
-#include "geoip/Handler.h"
+#include "geoip/Resolver.h"
 #include "geoip/Interface.h"
 #include "locale/TimeZone.h"
 
@@ -173,12 +173,12 @@ private:
      */
     CalamaresUtils::GeoIP::RegionZonePair m_startingTimezone;
 
-    /** @brief Handler for GeoIP lookup (if configured)
+    /** @brief Resolver for GeoIP lookup (if configured)
      *
-     * The GeoIP lookup needs to be started at some suitable time,
-     * by explicitly calling *TODO*
+     * The GeoIP lookup is started once all the modules are loaded,
+     * by startGeoIP().
      */
-    std::unique_ptr< CalamaresUtils::GeoIP::Handler > m_geoip;
+    std::unique_ptr< CalamaresUtils::GeoIP::Resolver > m_geoip;
 
     // Implementation details for doing GeoIP lookup
     void startGeoIP();
@@ -10,13 +10,12 @@
 
 #include "SetTimezoneJob.h"
 
-#include "GlobalStorage.h"
-#include "JobQueue.h"
 #include "Settings.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
 
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 
 
@@ -56,30 +55,30 @@ SetTimezoneJob::exec()
     zoneinfoPath.append( QDir::separator() + m_region );
     zoneinfoPath.append( QDir::separator() + m_zone );
 
-    Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
-    QFileInfo zoneFile( gs->value( "rootMountPoint" ).toString() + zoneinfoPath );
+    // Everything is done directly on the target filesystem, rather
+    // than by running rm and ln in the target.
+    auto* system = CalamaresUtils::System::instance();
+    QFileInfo zoneFile( system->targetPath( zoneinfoPath ) );
     if ( !zoneFile.exists() || !zoneFile.isReadable() )
         return Calamares::JobResult::error( tr( "Cannot access selected timezone path." ),
                                             tr( "Bad path: %1" ).arg( zoneFile.absolutePath() ) );
 
     // Make sure /etc/localtime doesn't exist, otherwise symlinking will fail
-    CalamaresUtils::System::instance()->targetEnvCall( { "rm", "-f", localtimeSlink } );
+    system->removeTargetFile( localtimeSlink );
 
-    int ec = CalamaresUtils::System::instance()->targetEnvCall( { "ln", "-s", zoneinfoPath, localtimeSlink } );
-    if ( ec )
+    // The link is relative to the target root, so it is the zoneinfoPath itself
+    const QString localtimePath = system->targetPath( localtimeSlink );
+    if ( localtimePath.isEmpty() || !QFile::link( zoneinfoPath, localtimePath ) )
         return Calamares::JobResult::error(
             tr( "Cannot set timezone." ),
             tr( "Link creation failed, target: %1; link name: %2" ).arg( zoneinfoPath ).arg( "/etc/localtime" ) );
 
-    QFile timezoneFile( gs->value( "rootMountPoint" ).toString() + "/etc/timezone" );
-
-    if ( !timezoneFile.open( QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate ) )
+    auto r = system->createTargetFile( QStringLiteral( "/etc/timezone" ),
+                                       QString( m_region + '/' + m_zone + '\n' ).toUtf8(),
+                                       CalamaresUtils::System::WriteMode::Overwrite );
+    if ( !r )
         return Calamares::JobResult::error( tr( "Cannot set timezone," ),
                                             tr( "Cannot open /etc/timezone for writing" ) );
 
-    QTextStream out( &timezoneFile );
-    out << m_region << '/' << m_zone << "\n";
-    timezoneFile.close();
-
     return Calamares::JobResult::ok();
 }
@@ -108,6 +108,72 @@ def rewrite_locale_gen(srcfilename, destfilename, locale_conf):
                 gen.write("# Missing: %s\n" % locale)
 
 
+def enabled_locales(filename):
+    """
+    Returns a list of (locale, charset) pairs for the locales that
+    are enabled (not commented-out) in the locale.gen file @p filename.
+    """
+    locales = []
+    with open(filename, "r") as gen:
+        for line in gen.readlines():
+            if is_comment(line):
+                continue
+            fields = RE_TRAILING_COMMENT.sub("", line).strip().split()
+            if len(fields) == 2:
+                locales.append((fields[0], fields[1]))
+    return locales
+
+
+def localedef_args(locale, charset, alias_file):
+    """
+    Returns the localedef command-line that compiles @p locale in
+    @p charset, like locale-gen does: the input (source) file is the
+    locale without its codeset, e.g. de_DE@euro for de_DE.UTF-8@euro.
+    """
+    name, at, modifier = locale.partition("@")
+    source = name.partition(".")[0] + at + modifier
+    args = ["localedef", "-i", source, "-c", "-f", charset]
+    if alias_file:
+        args.extend(["-A", alias_file])
+    args.append(locale)
+    return args
+
+
+def generate_locales(install_path, target_locale_gen):
+    """
+    Compiles the locales enabled in @p target_locale_gen, running one
+    localedef per locale on a pool of workers. This is much faster
+    than locale-gen, which compiles them one after the other.
+
+    Returns False if that isn't possible (there is no localedef in
+    the target) or any of the locales fails, in which case the caller
+    should fall back to locale-gen.
+    """
+    from concurrent.futures import ThreadPoolExecutor
+
+    if not os.path.exists(os.path.join(install_path, "usr/bin/localedef")):
+        return False
+    locales = enabled_locales(target_locale_gen)
+    if not locales:
+        return False
+
+    alias_file = "/usr/share/locale/locale.alias"
+    if not os.path.exists(os.path.join(install_path, alias_file.lstrip("/"))):
+        alias_file = None
+
+    workers = min(len(locales), os.cpu_count() or 1)
+    libcalamares.utils.debug("Generating {!s} locales with {!s} workers".format(len(locales), workers))
+    with ThreadPoolExecutor(max_workers=workers) as pool:
+        results = list(pool.map(lambda l: libcalamares.utils.target_env_call(localedef_args(l[0], l[1], alias_file)),
+                                locales))
+
+    failed = [l[0] for l, r in zip(locales, results) if r != 0]
+    if failed:
+        libcalamares.utils.warning("localedef failed for {!s}".format(", ".join(failed)))
+        return False
+    return True
+
+
 def run():
     """ Create locale """
     import libcalamares
@@ -146,12 +212,13 @@ def run():
         libcalamares.utils.debug("Restored backup {!s} -> {!s}"
             .format(target_locale_gen_bak, target_locale_gen))
 
-    # run locale-gen if detected; this *will* cause an exception
+    # generate locales if detected; this *will* cause an exception
     # if the live system has locale.gen, but the target does not:
     # in that case, fix your installation filesystem.
     if os.path.exists('/etc/locale.gen'):
         rewrite_locale_gen(target_locale_gen, target_locale_gen, locale_conf)
-        libcalamares.utils.target_env_call(['locale-gen'])
+        if not generate_locales(install_path, target_locale_gen):
+            libcalamares.utils.target_env_call(['locale-gen'])
         libcalamares.utils.debug('{!s} done'.format(target_locale_gen))
 
     # write /etc/locale.conf
@@ -21,6 +21,14 @@
 #include <AppStreamQt/pool.h>
 #include <AppStreamQt/screenshot.h>
 
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
 /// @brief Return number of pixels in a size, for < ordering purposes
 static inline quint64
 sizeOrder( const QSize& size )
@@ -54,8 +62,8 @@ setScreenshot( QVariantMap& map, const AppStream::Screenshot& screenshot )
     }
 }
 
-/// @brief Interpret an AppStream Component
-static PackageItem
+/// @brief Interpret an AppStream Component, as a map suitable for PackageItem
+static QVariantMap
 fromComponent( AppStream::Component& component )
 {
     QVariantMap map;
@@ -107,32 +115,181 @@ fromComponent( AppStream::Component& component )
         }
     }
 
-    return PackageItem( map );
+    return map;
 }
 
-PackageItem
-fromAppStream( AppStream::Pool& pool, const QVariantMap& item_map )
+/// @brief Look up @p appstreamId in the @p pool, returns an empty map if not found
+static QVariantMap
+fromPool( AppStream::Pool& pool, const QString& appstreamId )
 {
-    QString appstreamId = CalamaresUtils::getString( item_map, "appstream" );
-    if ( appstreamId.isEmpty() )
-    {
-        cWarning() << "Can't load AppStream without a suitable appstreamId.";
-        return PackageItem();
-    }
     cDebug() << "Loading AppStream data for" << appstreamId;
 
     auto itemList = pool.componentsById( appstreamId );
     if ( itemList.count() < 1 )
     {
         cWarning() << "No AppStream data for" << appstreamId;
-        return PackageItem();
+        return QVariantMap();
     }
     if ( itemList.count() > 1 )
     {
         cDebug() << "Multiple AppStream data for" << appstreamId << "using first.";
     }
+    return fromComponent( itemList.first() );
+}
 
-    auto r = fromComponent( itemList.first() );
+/** @brief Directories where AppStream finds its catalog data
+ *
+ * The catalog (collection) data is in the first group, metainfo
+ * files for installed software are in the last one.
+ */
+static const QStringList&
+catalogDirectories()
+{
+    static const QStringList dirs {
+        QStringLiteral( "/usr/share/swcatalog/xml" ),   QStringLiteral( "/usr/share/swcatalog/yaml" ),
+        QStringLiteral( "/usr/share/app-info/xmls" ),   QStringLiteral( "/usr/share/app-info/yaml" ),
+        QStringLiteral( "/var/cache/app-info/xmls" ),   QStringLiteral( "/var/cache/app-info/yaml" ),
+        QStringLiteral( "/var/lib/app-info/xmls" ),     QStringLiteral( "/var/lib/app-info/yaml" ),
+        QStringLiteral( "/usr/share/metainfo" ),        QStringLiteral( "/usr/share/appdata" ),
+    };
+    return dirs;
+}
+
+/** @brief A stamp for the current state of the AppStream catalog
+ *
+ * This combines the newest modification time and the number of files
+ * in the catalog directories; if either changes, the cache is stale.
+ */
+static QString
+catalogStamp()
+{
+    qint64 newest = 0;
+    int count = 0;
+    for ( const QString& dir : catalogDirectories() )
+    {
+        QFileInfo dirInfo( dir );
+        if ( !dirInfo.isDir() )
+        {
+            continue;
+        }
+        newest = qMax( newest, dirInfo.lastModified().toMSecsSinceEpoch() );
+        const auto files = QDir( dir ).entryInfoList( QDir::Files );
+        for ( const auto& fi : files )
+        {
+            newest = qMax( newest, fi.lastModified().toMSecsSinceEpoch() );
+            ++count;
+        }
+    }
+    return QStringLiteral( "%1:%2" ).arg( newest ).arg( count );
+}
+
+/// @brief Version of the cache file format
+static constexpr quint32 cacheVersion = 1;
+
+static QString
+cacheFileName()
+{
+    return QDir( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) )
+        .filePath( QStringLiteral( "packagechooser-appstream.cache" ) );
+}
+
+/// @brief Reads the cache, if it matches @p stamp; otherwise returns an empty hash
+static QHash< QString, QVariantMap >
+readCache( const QString& stamp )
+{
+    QFile f( cacheFileName() );
+    if ( !f.open( QIODevice::ReadOnly ) )
+    {
+        return {};
+    }
+    QDataStream in( &f );
+    quint32 version = 0;
+    QString cachedStamp;
+    QHash< QString, QVariantMap > components;
+    in >> version;
+    if ( version != cacheVersion )
+    {
+        return {};
+    }
+    in >> cachedStamp >> components;
+    if ( in.status() != QDataStream::Ok || cachedStamp != stamp )
+    {
+        return {};
+    }
+    return components;
+}
+
+static void
+writeCache( const QString& stamp, const QHash< QString, QVariantMap >& components )
+{
+    const QString fileName = cacheFileName();
+    QDir().mkpath( QFileInfo( fileName ).absolutePath() );
+    QSaveFile f( fileName );
+    if ( !f.open( QIODevice::WriteOnly ) )
+    {
+        cWarning() << "Could not write AppStream cache" << fileName;
+        return;
+    }
+    QDataStream out( &f );
+    out << cacheVersion << stamp << components;
+    if ( !f.commit() )
+    {
+        cWarning() << "Could not write AppStream cache" << fileName;
+    }
+}
+
+QHash< QString, QVariantMap >
+loadAppStreamData( const QStringList& appstreamIds )
+{
+    const QString stamp = catalogStamp();
+    QHash< QString, QVariantMap > components = readCache( stamp );
+
+    QStringList missing;
+    for ( const QString& id : appstreamIds )
+    {
+        if ( !components.contains( id ) )
+        {
+            missing.append( id );
+        }
+    }
+    if ( missing.isEmpty() )
+    {
+        cDebug() << "Using cached AppStream data for" << appstreamIds.count() << "components.";
+    }
+    else
+    {
+        AppStream::Pool pool;
+        pool.setLocale( QStringLiteral( "ALL" ) );
+        if ( !pool.load() )
+        {
+            cWarning() << "Could not load AppStream pool.";
+            return components;
+        }
+        // Components that are not found are cached as empty maps
+        for ( const QString& id : qAsConst( missing ) )
+        {
+            components.insert( id, fromPool( pool, id ) );
+        }
+        writeCache( stamp, components );
+    }
+
+    QHash< QString, QVariantMap > result;
+    for ( const QString& id : appstreamIds )
+    {
+        result.insert( id, components.value( id ) );
+    }
+    return result;
+}
+
+PackageItem
+fromAppStream( const QVariantMap& data, const QVariantMap& item_map )
+{
+    if ( data.isEmpty() )
+    {
+        return PackageItem();
+    }
+
+    PackageItem r( data );
     if ( r.isValid() )
     {
         QString id = CalamaresUtils::getString( item_map, "id" );
@@ -148,3 +305,15 @@ fromAppStream( AppStream::Pool& pool, const QVariantMap& item_map )
     }
     return r;
 }
+
+PackageItem
+fromAppStream( AppStream::Pool& pool, const QVariantMap& item_map )
+{
+    QString appstreamId = CalamaresUtils::getString( item_map, "appstream" );
+    if ( appstreamId.isEmpty() )
+    {
+        cWarning() << "Can't load AppStream without a suitable appstreamId.";
+        return PackageItem();
+    }
+    return fromAppStream( fromPool( pool, appstreamId ), item_map );
+}
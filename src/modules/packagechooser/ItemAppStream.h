@@ -12,6 +12,10 @@
 
 #include "PackageModel.h"
 
+#include <QHash>
+#include <QStringList>
+#include <QVariantMap>
+
 namespace AppStream
 {
 class Pool;
@@ -31,4 +35,24 @@ class Pool;
  */
 PackageItem fromAppStream( AppStream::Pool& pool, const QVariantMap& map );
 
+/** @brief Loads AppStream data for the given @p appstreamIds
+ *
+ * Loading the AppStream pool reads the whole catalog, which is slow.
+ * The data for components is cached (in the user's cache directory),
+ * and as long as the catalog does not change, the cached data is used
+ * without loading the pool at all.
+ *
+ * Returns a map for each id (empty if there is no such component),
+ * suitable for fromAppStream() below. This does not use any GUI
+ * classes, so it can be called from a thread.
+ */
+QHash< QString, QVariantMap > loadAppStreamData( const QStringList& appstreamIds );
+
+/** @brief Creates an item from @p data obtained with loadAppStreamData()
+ *
+ * The *id* and *screenshot* keys in @p map override the AppStream data,
+ * as for the other overload. Returns an invalid item if @p data is empty.
+ */
+PackageItem fromAppStream( const QVariantMap& data, const QVariantMap& map );
+
 #endif
@@ -9,6 +9,8 @@
 
 #include "PackageChooserPage.h"
 
+#include "ScreenshotLoader.h"
+
 #include "ui_page_package.h"
 
 #include "utils/CalamaresUtilsGui.h"
@@ -20,15 +22,22 @@
 PackageChooserPage::PackageChooserPage( PackageChooserMode mode, QWidget* parent )
     : QWidget( parent )
     , ui( new Ui::PackageChooserPage )
+    , m_screenshots( new ScreenshotLoader( this ) )
     , m_introduction( QString(),
                       QString(),
                       tr( "Package Selection" ),
                       tr( "Please pick a product from the list. The selected product will be installed." ) )
 {
-    m_introduction.screenshot = QPixmap( QStringLiteral( ":/images/no-selection.png" ) );
+    m_introduction.screenshot = QStringLiteral( ":/images/no-selection.png" );
 
     ui->setupUi( this );
     CALAMARES_RETRANSLATE( updateLabels(); );
+    connect( m_screenshots, &ScreenshotLoader::loaded, this, [ this ]( const QString& path ) {
+        if ( path == m_screenshotPath )
+        {
+            showScreenshot( path );
+        }
+    } );
 
     switch ( mode )
     {
@@ -77,13 +86,36 @@ smartClip( const QPixmap& pixmap, QSize size )
     return pixmap.scaled( size, Qt::KeepAspectRatio );
 }
 
+void
+PackageChooserPage::showScreenshot( const QString& path )
+{
+    const QSize size = ui->productScreenshot->size();
+    m_screenshotPath = path;
+
+    QPixmap pixmap = m_screenshots->screenshot( path, size );
+    if ( pixmap.isNull() && path != m_introduction.screenshot
+         && ( path.isEmpty() || m_screenshots->isFailed( path ) ) )
+    {
+        showScreenshot( m_introduction.screenshot );
+        return;
+    }
+    if ( pixmap.isNull() )
+    {
+        // Show the introduction screenshot until this one is decoded
+        m_screenshots->request( path, size );
+        m_screenshots->request( m_introduction.screenshot, size );
+        pixmap = m_screenshots->screenshot( m_introduction.screenshot, size );
+    }
+    ui->productScreenshot->setPixmap( smartClip( pixmap, size ) );
+}
+
 void
 PackageChooserPage::currentChanged( const QModelIndex& index )
 {
     if ( !index.isValid() || !ui->products->selectionModel()->hasSelection() )
     {
         ui->productName->setText( m_introduction.name.get() );
-        ui->productScreenshot->setPixmap( m_introduction.screenshot );
+        showScreenshot( m_introduction.screenshot );
         ui->productDescription->setText( m_introduction.description.get() );
     }
     else
@@ -92,15 +124,17 @@ PackageChooserPage::currentChanged( const QModelIndex& index )
 
         ui->productName->setText( model->data( index, PackageListModel::NameRole ).toString() );
         ui->productDescription->setText( model->data( index, PackageListModel::DescriptionRole ).toString() );
+        showScreenshot( model->data( index, PackageListModel::ScreenshotRole ).toString() );
 
-        QPixmap currentScreenshot = model->data( index, PackageListModel::ScreenshotRole ).value< QPixmap >();
-        if ( currentScreenshot.isNull() )
-        {
-            ui->productScreenshot->setPixmap( m_introduction.screenshot );
-        }
-        else
+        // Decode the neighbours, so that moving through the list is smooth
+        const QSize size = ui->productScreenshot->size();
+        for ( int row : { index.row() - 1, index.row() + 1 } )
         {
-            ui->productScreenshot->setPixmap( smartClip( currentScreenshot, ui->productScreenshot->size() ) );
+            const QModelIndex neighbour = model->index( row, 0 );
+            if ( neighbour.isValid() )
+            {
+                m_screenshots->request( model->data( neighbour, PackageListModel::ScreenshotRole ).toString(), size );
+            }
         }
     }
 }
@@ -128,6 +162,8 @@ PackageChooserPage::setModel( QAbstractItemModel* model )
              &QItemSelectionModel::selectionChanged,
              this,
              &PackageChooserPage::updateLabels );
+    // Items may be filled in later (e.g. from AppStream data loaded in the background)
+    connect( model, &QAbstractItemModel::dataChanged, this, &PackageChooserPage::updateLabels );
 }
 
 void
@@ -15,6 +15,8 @@
 #include <QAbstractItemModel>
 #include <QWidget>
 
+class ScreenshotLoader;
+
 namespace Ui
 {
 class PackageChooserPage;
@@ -49,7 +51,12 @@ signals:
     void selectionChanged();
 
 private:
+    /// @brief Shows the screenshot from @p path, once it is loaded
+    void showScreenshot( const QString& path );
+
     Ui::PackageChooserPage* ui;
+    ScreenshotLoader* m_screenshots;
+    QString m_screenshotPath;  ///< Screenshot that should be showing
     PackageItem m_introduction;
 };
 
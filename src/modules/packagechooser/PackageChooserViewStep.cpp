@@ -14,8 +14,8 @@
 #endif
 #ifdef HAVE_APPSTREAM
 #include "ItemAppStream.h"
-#include <AppStreamQt/pool.h>
-#include <memory>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 #endif
 #include "PackageChooserPage.h"
 #include "PackageModel.h"
@@ -226,6 +226,21 @@ PackageChooserViewStep::setConfigurationMap( const QVariantMap& configurationMap
     }
 }
 
+#ifdef HAVE_APPSTREAM
+/// @brief An item to show while the AppStream data for @p item_map is loading
+static PackageItem
+appStreamPlaceholder( const QVariantMap& item_map, const QString& appstreamId )
+{
+    const QString id = CalamaresUtils::getString( item_map, "id" );
+    PackageItem item( id.isEmpty() ? appstreamId : id,
+                      QString(),
+                      appstreamId,
+                      PackageChooserViewStep::tr( "Loading package information ..." ) );
+    item.isLoading = true;
+    return item;
+}
+#endif
+
 void
 PackageChooserViewStep::fillModel( const QVariantList& items )
 {
@@ -241,8 +256,9 @@ PackageChooserViewStep::fillModel( const QVariantList& items )
     }
 
 #ifdef HAVE_APPSTREAM
-    std::unique_ptr< AppStream::Pool > pool;
-    bool poolOk = false;
+    QList< QVariantMap > appstreamMaps;
+    QStringList appstreamIds;
+    QList< QPersistentModelIndex > appstreamPlaceholders;
 #endif
 
     cDebug() << "Loading PackageChooser model items from config";
@@ -268,16 +284,16 @@ PackageChooserViewStep::fillModel( const QVariantList& items )
         else if ( item_map.contains( "appstream" ) )
         {
 #ifdef HAVE_APPSTREAM
-            if ( !pool )
-            {
-                pool = std::make_unique< AppStream::Pool >();
-                pool->setLocale( QStringLiteral( "ALL" ) );
-                poolOk = pool->load();
-            }
-            if ( pool && poolOk )
+            const QString appstreamId = CalamaresUtils::getString( item_map, "appstream" );
+            if ( appstreamId.isEmpty() )
             {
-                m_model->addPackage( fromAppStream( *pool, item_map ) );
+                cWarning() << "Can't load AppStream without a suitable appstreamId.";
+                continue;
             }
+            m_model->addPackage( appStreamPlaceholder( item_map, appstreamId ) );
+            appstreamMaps.append( item_map );
+            appstreamIds.append( appstreamId );
+            appstreamPlaceholders.append( m_model->index( m_model->packageCount() - 1, 0 ) );
 #else
             cWarning() << "Loading AppStream data is not supported.";
 #endif
@@ -287,7 +303,54 @@ PackageChooserViewStep::fillModel( const QVariantList& items )
             m_model->addPackage( PackageItem( item_map ) );
         }
     }
+
+#ifdef HAVE_APPSTREAM
+    if ( !appstreamIds.isEmpty() )
+    {
+        loadAppStreamItems( appstreamMaps, appstreamIds, appstreamPlaceholders );
+    }
+#endif
+}
+
+#ifdef HAVE_APPSTREAM
+/** @brief Loads the AppStream data for placeholder items in the background
+ *
+ * Loading the AppStream pool takes long enough to be noticeable in
+ * the UI, so fillModel() adds a placeholder for each AppStream item
+ * right away -- with the configured id, so that the default item can
+ * be found -- and the placeholders are filled in when the data is
+ * available. Items that turn out to have no AppStream data are
+ * removed again. The three lists are parallel.
+ */
+void
+PackageChooserViewStep::loadAppStreamItems( const QList< QVariantMap >& itemMaps,
+                                            const QStringList& appstreamIds,
+                                            const QList< QPersistentModelIndex >& placeholders )
+{
+    using Watcher = QFutureWatcher< QHash< QString, QVariantMap > >;
+    auto* watcher = new Watcher( this );
+    connect( watcher, &Watcher::finished, this, [ = ]() {
+        const auto data = watcher->result();
+        watcher->deleteLater();
+        // Rows shift as invalid items are removed, so go by persistent index
+        for ( int i = 0; i < placeholders.count(); ++i )
+        {
+            const QPersistentModelIndex& idx = placeholders.at( i );
+            if ( m_model && idx.isValid() )
+            {
+                m_model->setPackage( idx.row(), fromAppStream( data.value( appstreamIds.at( i ) ), itemMaps.at( i ) ) );
+            }
+        }
+        cDebug() << "Loaded AppStream data for" << appstreamIds.count() << "PackageChooser items.";
+        // The default could not be selected while it was loading
+        if ( m_widget && !m_widget->hasSelection() )
+        {
+            m_widget->setSelection( m_defaultIdx );
+        }
+    } );
+    watcher->setFuture( QtConcurrent::run( loadAppStreamData, appstreamIds ) );
 }
+#endif
 
 void
 PackageChooserViewStep::hookupModel()
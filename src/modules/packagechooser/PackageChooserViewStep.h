@@ -18,6 +18,7 @@
 #include "PackageModel.h"
 
 #include <QObject>
+#include <QPersistentModelIndex>
 #include <QUrl>
 #include <QVariantMap>
 
@@ -51,6 +52,11 @@ public:
 private:
     void fillModel( const QVariantList& items );
     void hookupModel();
+#ifdef HAVE_APPSTREAM
+    void loadAppStreamItems( const QList< QVariantMap >& itemMaps,
+                             const QStringList& appstreamIds,
+                             const QList< QPersistentModelIndex >& placeholders );
+#endif
 
     PackageChooserPage* m_widget;
     PackageListModel* m_model;
@@ -59,7 +65,7 @@ private:
     PackageChooserMode m_mode;
     QString m_id;
     CalamaresUtils::Locale::TranslatedString* m_stepName;  // As it appears in the sidebar
-    QModelIndex m_defaultIdx;
+    QPersistentModelIndex m_defaultIdx;
 };
 
 CALAMARES_PLUGIN_FACTORY_DECLARATION( PackageChooserViewStepFactory )
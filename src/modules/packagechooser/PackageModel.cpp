@@ -105,6 +105,35 @@ PackageListModel::addPackage( PackageItem&& p )
     }
 }
 
+void
+PackageListModel::setPackage( int row, PackageItem&& p )
+{
+    if ( row < 0 || row >= m_packages.count() )
+    {
+        return;
+    }
+    if ( !p.isValid() )
+    {
+        removePackage( row );
+        return;
+    }
+    m_packages[ row ] = p;
+    QModelIndex changed = index( row, 0 );
+    emit dataChanged( changed, changed );
+}
+
+void
+PackageListModel::removePackage( int row )
+{
+    if ( row < 0 || row >= m_packages.count() )
+    {
+        return;
+    }
+    beginRemoveRows( QModelIndex(), row, row );
+    m_packages.remove( row );
+    endRemoveRows();
+}
+
 int
 PackageListModel::rowCount( const QModelIndex& index ) const
 {
@@ -112,6 +141,17 @@ PackageListModel::rowCount( const QModelIndex& index ) const
     return index.isValid() ? 0 : m_packages.count();
 }
 
+Qt::ItemFlags
+PackageListModel::flags( const QModelIndex& index ) const
+{
+    const int row = index.row();
+    if ( index.isValid() && row >= 0 && row < m_packages.count() && m_packages[ row ].isLoading )
+    {
+        return Qt::NoItemFlags;
+    }
+    return QAbstractListModel::flags( index );
+}
+
 QVariant
 PackageListModel::data( const QModelIndex& index, int role ) const
 {
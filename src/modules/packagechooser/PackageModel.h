@@ -15,7 +15,6 @@
 
 #include <QAbstractListModel>
 #include <QObject>
-#include <QPixmap>
 #include <QVector>
 
 enum class PackageChooserMode
@@ -35,7 +34,19 @@ struct PackageItem
     QString package;
     CalamaresUtils::Locale::TranslatedString name;
     CalamaresUtils::Locale::TranslatedString description;
-    QPixmap screenshot;
+    /** @brief Path to the screenshot
+     *
+     * This may be a QRC path (:/path/in/qrc), a filesystem path or
+     * a file:// URL. The image is not loaded here; the page loads
+     * screenshots in the background, at display size.
+     */
+    QString screenshot;
+    /** @brief Is this a placeholder, whose data is still loading?
+     *
+     * Placeholders are shown (disabled) in the list, but can't be
+     * selected until they are replaced by the real item.
+     */
+    bool isLoading = false;
 
     /// @brief Create blank PackageItem
     PackageItem();
@@ -48,9 +59,8 @@ struct PackageItem
 
     /** @brief Creates a PackageItem from given strings.
      *
-     * Set all the text members and load the screenshot from the given
-     * @p screenshotPath, which may be a QRC path (:/path/in/qrc) or
-     * a filesystem path, whatever QPixmap understands.
+     * Set all the text members and the path of the screenshot
+     * to @p screenshotPath.
      */
     PackageItem( const QString& id,
                  const QString& package,
@@ -95,9 +105,19 @@ public:
      * Only valid packages are added -- that is, they must have a name.
      */
     void addPackage( PackageItem&& p );
+    /** @brief Replace the package in row @p row by @p p
+     *
+     * This is used to fill in placeholder items once their data is
+     * available. Invalid packages are not set; the row is removed instead.
+     */
+    void setPackage( int row, PackageItem&& p );
+    /// @brief Removes the package in row @p row
+    void removePackage( int row );
 
     int rowCount( const QModelIndex& index ) const override;
     QVariant data( const QModelIndex& index, int role ) const override;
+    /// @brief Items that are still loading are not enabled (nor selectable)
+    Qt::ItemFlags flags( const QModelIndex& index ) const override;
 
     /// @brief Direct (non-abstract) access to package data
     const PackageItem& packageData( int r ) const { return m_packages[ r ]; }
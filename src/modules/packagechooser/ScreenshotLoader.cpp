@@ -0,0 +1,112 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "ScreenshotLoader.h"
+
+#include "utils/Logger.h"
+
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QUrl>
+#include <QtConcurrent/QtConcurrentRun>
+
+/// @brief Images this much bigger than the label are trimmed, not scaled (see smartClip())
+static constexpr int trimMargin = 16;
+/// @brief Size of the cache, in kilobytes
+static constexpr int cacheSize = 64 * 1024;
+
+ScreenshotLoader::ScreenshotLoader( QObject* parent )
+    : QObject( parent )
+    , m_cache( cacheSize )
+{
+    // Decoding is memory-hungry; two at a time is enough for
+    // the current item and a neighbour.
+    m_pool.setMaxThreadCount( 2 );
+}
+
+ScreenshotLoader::~ScreenshotLoader()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QString
+ScreenshotLoader::key( const QString& path, QSize size )
+{
+    return QStringLiteral( "%1x%2:%3" ).arg( size.width() ).arg( size.height() ).arg( path );
+}
+
+QPixmap
+ScreenshotLoader::screenshot( const QString& path, QSize size ) const
+{
+    const QPixmap* p = m_cache.object( key( path, size ) );
+    return p ? *p : QPixmap();
+}
+
+QImage
+ScreenshotLoader::decode( const QString& path, QSize size )
+{
+    QString fileName = path;
+    if ( path.startsWith( QStringLiteral( "file:" ) ) )
+    {
+        fileName = QUrl( path ).toLocalFile();
+    }
+
+    QImageReader reader( fileName );
+    reader.setAutoTransform( true );
+    QSize imageSize = reader.size();
+    if ( imageSize.isValid() && size.isValid()
+         && ( imageSize.width() > size.width() + trimMargin || imageSize.height() > size.height() + trimMargin ) )
+    {
+        reader.setScaledSize( imageSize.scaled( size, Qt::KeepAspectRatio ) );
+    }
+
+    QImage image = reader.read();
+    if ( image.isNull() )
+    {
+        cWarning() << "Could not load screenshot" << path << reader.errorString();
+    }
+    return image;
+}
+
+void
+ScreenshotLoader::request( const QString& path, QSize size )
+{
+    const QString k = key( path, size );
+    if ( path.isEmpty() || m_failed.contains( path ) || m_pending.contains( k ) || m_cache.contains( k ) )
+    {
+        return;
+    }
+    m_pending.insert( k );
+
+    auto* watcher = new QFutureWatcher< QImage >( this );
+    connect( watcher, &QFutureWatcher< QImage >::finished, this, [ = ]() {
+        decoded( path, size, watcher->result() );
+        watcher->deleteLater();
+    } );
+    watcher->setFuture( QtConcurrent::run( &m_pool, &ScreenshotLoader::decode, path, size ) );
+}
+
+void
+ScreenshotLoader::decoded( const QString& path, QSize size, const QImage& image )
+{
+    const QString k = key( path, size );
+    m_pending.remove( k );
+    if ( image.isNull() )
+    {
+        m_failed.insert( path );
+    }
+    else
+    {
+        // Converting to a pixmap must happen in the GUI thread
+        auto* pixmap = new QPixmap( QPixmap::fromImage( image ) );
+        m_cache.insert( k, pixmap, qMax( 1, image.bytesPerLine() * image.height() / 1024 ) );
+    }
+    emit loaded( path, size );
+}
@@ -0,0 +1,79 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#ifndef PACKAGECHOOSER_SCREENSHOTLOADER_H
+#define PACKAGECHOOSER_SCREENSHOTLOADER_H
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+
+/** @brief Decodes screenshots in the background, at display size
+ *
+ * Distributions ship screenshots of several megapixels, which take
+ * a noticeable amount of time to decode and are then scaled down
+ * to fit the screenshot label anyway. The loader decodes images on
+ * a worker thread, asking the image reader for a scaled image directly
+ * (which for JPEG is much cheaper than decoding the whole image), and
+ * keeps the results in a cache bounded by memory use.
+ *
+ * Images are cached by path and target size; when a requested image
+ * is ready, loaded() is emitted.
+ */
+class ScreenshotLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ScreenshotLoader( QObject* parent = nullptr );
+    ~ScreenshotLoader() override;
+
+    /** @brief The cached screenshot for @p path at @p size
+     *
+     * Returns a null pixmap if the image has not been loaded (yet),
+     * or could not be loaded at all -- see isFailed().
+     */
+    QPixmap screenshot( const QString& path, QSize size ) const;
+    /// @brief Did loading @p path (at any size) fail?
+    bool isFailed( const QString& path ) const { return m_failed.contains( path ); }
+
+    /** @brief Starts loading @p path at @p size in the background
+     *
+     * Does nothing if the image is already cached, is being loaded,
+     * or has failed to load before. Empty paths are ignored.
+     */
+    void request( const QString& path, QSize size );
+
+    /** @brief Decodes the image at @p path to fit @p size
+     *
+     * Images that fit in @p size plus a small margin are decoded as-is,
+     * so that they can be trimmed rather than scaled. A path may be a
+     * filesystem path, a QRC path or a file:// URL. This is thread-safe.
+     */
+    static QImage decode( const QString& path, QSize size );
+
+signals:
+    /// @brief The image for @p path at @p size is ready (or failed)
+    void loaded( const QString& path, QSize size );
+
+private:
+    static QString key( const QString& path, QSize size );
+    void decoded( const QString& path, QSize size, const QImage& image );
+
+    QThreadPool m_pool;
+    QCache< QString, QPixmap > m_cache;  ///< Cost is in kilobytes
+    QSet< QString > m_pending;  ///< Keys being decoded
+    QSet< QString > m_failed;  ///< Paths that could not be decoded
+};
+
+#endif
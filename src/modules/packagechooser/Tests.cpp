@@ -16,6 +16,7 @@
 #include "ItemAppStream.h"
 #endif
 #include "PackageModel.h"
+#include "ScreenshotLoader.h"
 
 #include "utils/Logger.h"
 
@@ -70,7 +71,8 @@ PackageChooserTests::testAppData()
     QCOMPARE( p1.description.get( QLocale( "en_GB" ) ), QStringLiteral( "Calamares Linux Installer" ) );
     QCOMPARE( p1.description.get( QLocale( "nl" ) ),
               QStringLiteral( "Calamares is een installatieprogramma voor Linux distributies." ) );
-    QVERIFY( p1.screenshot.isNull() );
+    // Screenshots are not loaded, just remembered
+    QCOMPARE( p1.screenshot, QStringLiteral( "https://calamares.io/images/cal_640.png" ) );
 
     m.insert( "id", "calamares" );
     m.insert( "screenshot", ":/images/calamares.png" );
@@ -79,6 +81,91 @@ PackageChooserTests::testAppData()
     QCOMPARE( p2.id, QStringLiteral( "calamares" ) );
     QCOMPARE( p2.description.get( QLocale( "nl" ) ),
               QStringLiteral( "Calamares is een installatieprogramma voor Linux distributies." ) );
-    QVERIFY( !p2.screenshot.isNull() );
+    QCOMPARE( p2.screenshot, QStringLiteral( ":/images/calamares.png" ) );
 #endif
 }
+
+void
+PackageChooserTests::testModelUpdate()
+{
+    PackageListModel model( nullptr );
+    model.addPackage( PackageItem( "kde", "kde", "Plasma", "Loading" ) );
+    model.addPackage( PackageItem( "gnome", "gnome", "GNOME", "Loading" ) );
+    model.addPackage( PackageItem( "xfce", "xfce", "XFCE", "Loading" ) );
+    QCOMPARE( model.packageCount(), 3 );
+
+    QPersistentModelIndex gnome( model.index( 1, 0 ) );
+    QPersistentModelIndex xfce( model.index( 2, 0 ) );
+
+    QSignalSpy changed( &model, &QAbstractItemModel::dataChanged );
+    model.setPackage( 1, PackageItem( "gnome", "gnome", "GNOME", "GNOME Desktop" ) );
+    QCOMPARE( changed.count(), 1 );
+    QCOMPARE( model.packageCount(), 3 );
+    QCOMPARE( model.data( gnome, PackageListModel::DescriptionRole ).toString(), QStringLiteral( "GNOME Desktop" ) );
+
+    // An invalid item removes the row
+    model.setPackage( 0, PackageItem() );
+    QCOMPARE( changed.count(), 1 );
+    QCOMPARE( model.packageCount(), 2 );
+    QCOMPARE( gnome.row(), 0 );
+    QCOMPARE( xfce.row(), 1 );
+    QCOMPARE( model.data( xfce, PackageListModel::IdRole ).toString(), QStringLiteral( "xfce" ) );
+
+    // Out of range is ignored
+    model.setPackage( 5, PackageItem( "lxqt", "lxqt", "LXQt", "LXQt Desktop" ) );
+    model.removePackage( -1 );
+    QCOMPARE( model.packageCount(), 2 );
+
+    // Placeholders can't be selected until they are filled in
+    PackageItem placeholder( "lxqt", QString(), "LXQt", "Loading" );
+    placeholder.isLoading = true;
+    model.addPackage( std::move( placeholder ) );
+    QPersistentModelIndex lxqt( model.index( 2, 0 ) );
+    QVERIFY( model.flags( xfce ) & Qt::ItemIsSelectable );
+    QVERIFY( !( model.flags( lxqt ) & Qt::ItemIsSelectable ) );
+    QVERIFY( !( model.flags( lxqt ) & Qt::ItemIsEnabled ) );
+    model.setPackage( 2, PackageItem( "lxqt", "lxqt", "LXQt", "LXQt Desktop" ) );
+    QVERIFY( model.flags( lxqt ) & Qt::ItemIsSelectable );
+}
+
+void
+PackageChooserTests::testScreenshotDecode()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+
+    const QString bigName = dir.filePath( "big.png" );
+    QImage big( 800, 600, QImage::Format_RGB32 );
+    big.fill( Qt::red );
+    QVERIFY( big.save( bigName ) );
+
+    const QString smallName = dir.filePath( "small.png" );
+    QImage small( 210, 100, QImage::Format_RGB32 );
+    small.fill( Qt::blue );
+    QVERIFY( small.save( smallName ) );
+
+    // Big images are decoded to fit
+    QCOMPARE( ScreenshotLoader::decode( bigName, QSize( 200, 200 ) ).size(), QSize( 200, 150 ) );
+    QCOMPARE( ScreenshotLoader::decode( QStringLiteral( "file://" ) + bigName, QSize( 400, 400 ) ).size(),
+              QSize( 400, 300 ) );
+    // Slightly-too-big images are left for trimming
+    QCOMPARE( ScreenshotLoader::decode( smallName, QSize( 200, 200 ) ).size(), QSize( 210, 100 ) );
+    QVERIFY( ScreenshotLoader::decode( dir.filePath( "nonexistent.png" ), QSize( 200, 200 ) ).isNull() );
+
+    ScreenshotLoader loader;
+    QSignalSpy loaded( &loader, &ScreenshotLoader::loaded );
+    QVERIFY( loader.screenshot( bigName, QSize( 100, 100 ) ).isNull() );
+    loader.request( bigName, QSize( 100, 100 ) );
+    loader.request( bigName, QSize( 100, 100 ) );  // Already pending
+    QVERIFY( loaded.wait( 5000 ) );
+    QCOMPARE( loaded.count(), 1 );
+    QCOMPARE( loader.screenshot( bigName, QSize( 100, 100 ) ).size(), QSize( 100, 75 ) );
+    // Other sizes are separate
+    QVERIFY( loader.screenshot( bigName, QSize( 200, 200 ) ).isNull() );
+
+    const QString missing = dir.filePath( "nonexistent.png" );
+    loader.request( missing, QSize( 100, 100 ) );
+    QVERIFY( loaded.wait( 5000 ) );
+    QVERIFY( loader.isFailed( missing ) );
+    QVERIFY( loader.screenshot( missing, QSize( 100, 100 ) ).isNull() );
+}
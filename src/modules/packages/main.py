@@ -19,7 +19,7 @@ from string import Template
 import subprocess
 
 import libcalamares
-from libcalamares.utils import check_target_env_call, target_env_call
+from libcalamares.utils import check_target_env_call, check_target_env_progress, target_env_call
 from libcalamares.utils import gettext_path, gettext_languages
 
 import gettext
@@ -38,11 +38,13 @@ group_packages = 0  # One group of packages from an -install or -remove entry
 INSTALL = object()
 REMOVE = object()
 mode_packages = None  # Changes to INSTALL or REMOVE
+progress_message = ""  # What the package manager says it is doing
 
 
 def _change_mode(mode):
-    global mode_packages
+    global mode_packages, progress_message
     mode_packages = mode
+    progress_message = ""
     libcalamares.job.setprogress(completed_packages * 1.0 / total_packages)
 
 
@@ -68,9 +70,12 @@ def pretty_status_message():
         # No mode, generic description
         s = _("Install packages.")
 
-    return s % {"num": group_packages,
-                "count": completed_packages,
-                "total": total_packages}
+    s = s % {"num": group_packages,
+             "count": completed_packages,
+             "total": total_packages}
+    if group_packages and progress_message:
+        s = "{!s} ({!s})".format(s, progress_message)
+    return s
 
 
 class PackageManager(metaclass=abc.ABCMeta):
@@ -83,6 +88,7 @@ class PackageManager(metaclass=abc.ABCMeta):
     backends.
     """
     backend = None
+    progress_parser = None  # Name of the progress parser for the output, if any
 
     @abc.abstractmethod
     def install(self, pkgs, from_local=False):
@@ -117,6 +123,31 @@ class PackageManager(metaclass=abc.ABCMeta):
         if script != "":
             check_target_env_call(script.split(" "))
 
+    def check_call(self, args, pkgs):
+        """
+        Runs @p args in the target, like check_target_env_call(),
+        for the packages @p pkgs. If the backend has a progress parser,
+        the output of the command is turned into progress and status
+        messages while it runs.
+
+        Progress is only reported for commands that handle the whole
+        current group of packages; a command for one package out of
+        many only updates the status message.
+        """
+        if not self.progress_parser:
+            check_target_env_call(args)
+            return
+
+        whole_group = len(pkgs) == group_packages
+
+        def report(progress, message):
+            global progress_message
+            progress_message = message
+            if whole_group:
+                libcalamares.job.setprogress((completed_packages + progress * group_packages) / total_packages)
+
+        check_target_env_progress(args, self.progress_parser, report)
+
     def install_package(self, packagedata, from_local=False):
         """
         Install a package from a single entry in the install list.
@@ -162,12 +193,10 @@ class PMApk(PackageManager):
     backend = "apk"
 
     def install(self, pkgs, from_local=False):
-        for pkg in pkgs:
-            check_target_env_call(["apk", "add", pkg])
+        check_target_env_call(["apk", "add"] + pkgs)
 
     def remove(self, pkgs):
-        for pkg in pkgs:
-            check_target_env_call(["apk", "del", pkg])
+        check_target_env_call(["apk", "del"] + pkgs)
 
     def update_db(self):
         check_target_env_call(["apk", "update"])
@@ -178,13 +207,16 @@ class PMApk(PackageManager):
 
 class PMApt(PackageManager):
     backend = "apt"
+    progress_parser = "apt"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["apt-get", "-q", "-y", "install"] + pkgs)
+        # The status-fd output is what the progress parser understands
+        self.check_call(["apt-get", "-q", "-y", "-o", "APT::Status-Fd=1",
+                         "install"] + pkgs, pkgs)
 
     def remove(self, pkgs):
-        check_target_env_call(["apt-get", "--purge", "-q", "-y",
-                               "remove"] + pkgs)
+        self.check_call(["apt-get", "--purge", "-q", "-y", "-o", "APT::Status-Fd=1",
+                         "remove"] + pkgs, pkgs)
         check_target_env_call(["apt-get", "--purge", "-q", "-y",
                                "autoremove"])
 
@@ -198,9 +230,10 @@ class PMApt(PackageManager):
 
 class PMDnf(PackageManager):
     backend = "dnf"
+    progress_parser = "dnf"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["dnf", "-y", "install"] + pkgs)
+        self.check_call(["dnf", "-y", "install"] + pkgs, pkgs)
 
     def remove(self, pkgs):
         # ignore the error code for now because dnf thinks removing a
@@ -260,12 +293,10 @@ class PMPackageKit(PackageManager):
     backend = "packagekit"
 
     def install(self, pkgs, from_local=False):
-        for pkg in pkgs:
-            check_target_env_call(["pkcon", "-py", "install", pkg])
+        check_target_env_call(["pkcon", "-py", "install"] + pkgs)
 
     def remove(self, pkgs):
-        for pkg in pkgs:
-            check_target_env_call(["pkcon", "-py", "remove", pkg])
+        check_target_env_call(["pkcon", "-py", "remove"] + pkgs)
 
     def update_db(self):
         check_target_env_call(["pkcon", "refresh"])
@@ -276,6 +307,7 @@ class PMPackageKit(PackageManager):
 
 class PMPacman(PackageManager):
     backend = "pacman"
+    progress_parser = "pacman"
 
     def install(self, pkgs, from_local=False):
         if from_local:
@@ -283,11 +315,11 @@ class PMPacman(PackageManager):
         else:
             pacman_flags = "-S"
 
-        check_target_env_call(["pacman", pacman_flags,
-                               "--noconfirm"] + pkgs)
+        self.check_call(["pacman", pacman_flags,
+                         "--noconfirm"] + pkgs, pkgs)
 
     def remove(self, pkgs):
-        check_target_env_call(["pacman", "-Rsnc", "--noconfirm"] + pkgs)
+        self.check_call(["pacman", "-Rsnc", "--noconfirm"] + pkgs, pkgs)
 
     def update_db(self):
         check_target_env_call(["pacman", "-Syy"])
@@ -377,13 +409,14 @@ class PMXbps(PackageManager):
 
 class PMYum(PackageManager):
     backend = "yum"
+    progress_parser = "yum"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["yum", "-y", "install"] + pkgs)
+        self.check_call(["yum", "-y", "install"] + pkgs, pkgs)
 
     def remove(self, pkgs):
-        check_target_env_call(["yum", "--disablerepo=*", "-C", "-y",
-                               "remove"] + pkgs)
+        self.check_call(["yum", "--disablerepo=*", "-C", "-y",
+                         "remove"] + pkgs, pkgs)
 
     def update_db(self):
         # Doesn't need updates
@@ -395,16 +428,17 @@ class PMYum(PackageManager):
 
 class PMZypp(PackageManager):
     backend = "zypp"
+    progress_parser = "zypp"
 
     def install(self, pkgs, from_local=False):
-        check_target_env_call(["zypper", "--non-interactive",
-                               "--quiet-install", "install",
-                               "--auto-agree-with-licenses",
-                               "install"] + pkgs)
+        self.check_call(["zypper", "--non-interactive",
+                         "--quiet-install", "install",
+                         "--auto-agree-with-licenses",
+                         "install"] + pkgs, pkgs)
 
     def remove(self, pkgs):
-        check_target_env_call(["zypper", "--non-interactive",
-                               "remove"] + pkgs)
+        self.check_call(["zypper", "--non-interactive",
+                         "remove"] + pkgs, pkgs)
 
     def update_db(self):
         check_target_env_call(["zypper", "--non-interactive", "update"])
@@ -467,6 +501,109 @@ def subst_locale(plist):
     return ret
 
 
+def _operation_direction(key):
+    """
+    Returns INSTALL or REMOVE for the package-operation @p key,
+    or None for keys that are not package operations.
+    """
+    if key in ("install", "try_install", "localInstall"):
+        return INSTALL
+    if key in ("remove", "try_remove"):
+        return REMOVE
+    return None
+
+
+def merge_operations(operations):
+    """
+    Merges the package @p operations (from the configuration and from
+    other modules, like netinstall and packagechooser) into as few
+    operations as possible, so that the package manager runs as few
+    transactions as possible. Each transaction loads the package
+    database, resolves dependencies and runs hooks, so that's expensive.
+
+    Only adjacent operations of the same kind are merged (e.g. two
+    installs, but not an install and a try_install, or two installs
+    with a try_install in between), so the operations still run in
+    the order in which they are listed. Packages named more than once
+    in a merged operation are listed only once, and packages that an
+    earlier install has installed (without a remove since) are dropped
+    from try_install.
+
+    @param operations: list[dict]
+        The operations as in the configuration file.
+    @return: list[dict]
+        Operations with one key each.
+    """
+    merged = []  # List of (key, packages) pairs
+    for entry in operations:
+        for key, packages in entry.items():
+            if key == "source":
+                libcalamares.utils.debug("Package-list from {!s}".format(packages))
+                continue
+
+            if _operation_direction(key) is not None and merged and merged[-1][0] == key:
+                target = merged[-1][1]
+            else:
+                target = []
+                merged.append((key, target))
+            for package in packages:
+                if package not in target:
+                    target.append(package)
+
+    installed = set()
+    for key, packages in merged:
+        if _operation_direction(key) is not INSTALL:
+            installed = set()  # A remove may undo earlier installs
+        elif key == "install":
+            installed.update(p for p in packages if isinstance(p, str))
+        elif key == "try_install":
+            packages[:] = [p for p in packages if not isinstance(p, str) or p not in installed]
+
+    return [{key: packages} for key, packages in merged if packages]
+
+
+def try_packages(batch, single, package_list):
+    """
+    Applies an operation, where failures are allowed, to the packages
+    in @p package_list. The packages are tried all together, as one
+    transaction with @p batch (e.g. install), first; if that fails,
+    they are tried one by one with @p single (e.g. install_package)
+    so that a single failing package won't stop all of them.
+    """
+    if len(package_list) > 1 and all([isinstance(x, str) for x in package_list]):
+        try:
+            batch(package_list)
+            return
+        except subprocess.CalledProcessError:
+            libcalamares.utils.debug("Could not process {!s} packages at once, trying each.".format(len(package_list)))
+
+    for package in package_list:
+        try:
+            single(package)
+        except subprocess.CalledProcessError:
+            libcalamares.utils.warning("Could not process package {!s}".format(package))
+
+
+def package_batches(package_list):
+    """
+    Splits @p package_list, keeping its order, into runs of consecutive
+    package names (as lists), which can go to the package manager in
+    one transaction, and packages with scripts (as they are), which
+    are processed on their own.
+    """
+    names = []
+    for package in package_list:
+        if isinstance(package, str):
+            names.append(package)
+        else:
+            if names:
+                yield names
+                names = []
+            yield package
+    if names:
+        yield names
+
+
 def run_operations(pkgman, entry):
     """
     Call package manager with suitable parameters for the given
@@ -489,45 +626,31 @@ def run_operations(pkgman, entry):
         group_packages = len(package_list)
         if key == "install":
             _change_mode(INSTALL)
-            if all([isinstance(x, str) for x in package_list]):
-                pkgman.install(package_list)
-            else:
-                for package in package_list:
-                    pkgman.install_package(package)
+            for batch in package_batches(package_list):
+                if isinstance(batch, list):
+                    pkgman.install(batch)
+                else:
+                    pkgman.install_package(batch)
         elif key == "try_install":
             _change_mode(INSTALL)
-            # we make a separate package manager call for each package so a
-            # single failing package won't stop all of them
-            for package in package_list:
-                try:
-                    pkgman.install_package(package)
-                except subprocess.CalledProcessError:
-                    warn_text = "Could not install package "
-                    warn_text += str(package)
-                    libcalamares.utils.warning(warn_text)
+            try_packages(pkgman.install, pkgman.install_package, package_list)
         elif key == "remove":
             _change_mode(REMOVE)
-            if all([isinstance(x, str) for x in package_list]):
-                pkgman.remove(package_list)
-            else:
-                for package in package_list:
-                    pkgman.remove_package(package)
+            for batch in package_batches(package_list):
+                if isinstance(batch, list):
+                    pkgman.remove(batch)
+                else:
+                    pkgman.remove_package(batch)
         elif key == "try_remove":
             _change_mode(REMOVE)
-            for package in package_list:
-                try:
-                    pkgman.remove_package(package)
-                except subprocess.CalledProcessError:
-                    warn_text = "Could not remove package "
-                    warn_text += str(package)
-                    libcalamares.utils.warning(warn_text)
+            try_packages(pkgman.remove, pkgman.remove_package, package_list)
         elif key == "localInstall":
             _change_mode(INSTALL)
-            if all([isinstance(x, str) for x in package_list]):
-                pkgman.install(package_list, from_local=True)
-            else:
-                for package in package_list:
-                    pkgman.install_package(package, from_local=True)
+            for batch in package_batches(package_list):
+                if isinstance(batch, list):
+                    pkgman.install(batch, from_local=True)
+                else:
+                    pkgman.install_package(batch, from_local=True)
         elif key == "source":
             libcalamares.utils.debug("Package-list from {!s}".format(entry[key]))
         else:
@@ -574,6 +697,7 @@ def run():
     operations = libcalamares.job.configuration.get("operations", [])
     if libcalamares.globalstorage.contains("packageOperations"):
         operations += libcalamares.globalstorage.value("packageOperations")
+    operations = merge_operations(operations)
 
     mode_packages = None
     total_packages = 0
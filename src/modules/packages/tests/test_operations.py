@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# === This file is part of Calamares - <https://calamares.io> ===
+#
+#   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+#   SPDX-License-Identifier: GPL-3.0-or-later
+#
+#   Calamares is Free Software: see the License-Identifier above.
+#
+"""
+Tests for merge_operations(), try_packages() and package_batches()
+of the packages module.
+
+The module is imported with a stand-in for libcalamares, since these
+functions only use it for logging.
+"""
+
+import os
+import subprocess
+import sys
+import types
+import unittest
+
+
+def _fake_libcalamares():
+    utils = types.ModuleType("libcalamares.utils")
+    utils.debug = lambda s: None
+    utils.warning = lambda s: None
+    for name in ("check_target_env_call", "check_target_env_progress", "target_env_call"):
+        setattr(utils, name, lambda *args, **kwargs: 0)
+    utils.gettext_path = lambda: None
+    utils.gettext_languages = lambda: None
+
+    lib = types.ModuleType("libcalamares")
+    lib.utils = utils
+    sys.modules["libcalamares"] = lib
+    sys.modules["libcalamares.utils"] = utils
+
+
+_fake_libcalamares()
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+import main  # noqa: E402
+
+
+class TestMergeOperations(unittest.TestCase):
+    def test_adjacent(self):
+        ops = [{"install": ["a", "b"]}, {"install": ["b", "c"]}, {"remove": ["d"]}, {"remove": ["e"]}]
+        self.assertEqual(main.merge_operations(ops), [{"install": ["a", "b", "c"]}, {"remove": ["d", "e"]}])
+
+    def test_source_is_not_an_operation(self):
+        ops = [{"source": "netinstall", "install": ["a"]}, {"source": "packagechooser", "install": ["b"]}]
+        self.assertEqual(main.merge_operations(ops), [{"install": ["a", "b"]}])
+
+    def test_keeps_order(self):
+        # Different kinds of install are not merged across each other
+        ops = [{"install": ["a"]}, {"try_install": ["b"]}, {"localInstall": ["/c.pkg"]}, {"install": ["d"]}]
+        self.assertEqual(main.merge_operations(ops), ops)
+        # .. nor across a remove
+        ops = [{"install": ["a"]}, {"remove": ["b"]}, {"install": ["c"]}]
+        self.assertEqual(main.merge_operations(ops), ops)
+
+    def test_try_installed(self):
+        # What is installed before need not be tried
+        ops = [{"install": ["a", "b"]}, {"try_install": ["a", "c"]}]
+        self.assertEqual(main.merge_operations(ops), [{"install": ["a", "b"]}, {"try_install": ["c"]}])
+        ops = [{"install": ["a"]}, {"try_install": ["a"]}]
+        self.assertEqual(main.merge_operations(ops), [{"install": ["a"]}])
+        # What is installed after is still tried first
+        ops = [{"try_install": ["a"]}, {"install": ["a"]}]
+        self.assertEqual(main.merge_operations(ops), ops)
+        # A remove in between undoes the install
+        ops = [{"install": ["a"]}, {"remove": ["a"]}, {"try_install": ["a"]}]
+        self.assertEqual(main.merge_operations(ops), ops)
+
+    def test_scripts(self):
+        scripted = {"package": "a", "pre-script": "touch /a"}
+        ops = [{"install": [scripted]}, {"install": [scripted, "b"]}, {"try_install": [scripted]}]
+        self.assertEqual(main.merge_operations(ops), [{"install": [scripted, "b"]}, {"try_install": [scripted]}])
+
+
+class TestTryPackages(unittest.TestCase):
+    def setUp(self):
+        self.calls = []
+        self.failing = []
+
+    def batch(self, packages):
+        self.calls.append(list(packages))
+        if any(p in self.failing for p in packages):
+            raise subprocess.CalledProcessError(1, "batch")
+
+    def single(self, package):
+        self.calls.append(package)
+        if package in self.failing:
+            raise subprocess.CalledProcessError(1, "single")
+
+    def test_batch(self):
+        main.try_packages(self.batch, self.single, ["a", "b"])
+        self.assertEqual(self.calls, [["a", "b"]])
+
+    def test_one_by_one(self):
+        # A failing package does not stop the others
+        self.failing = ["b"]
+        main.try_packages(self.batch, self.single, ["a", "b", "c"])
+        self.assertEqual(self.calls, [["a", "b", "c"], "a", "b", "c"])
+
+    def test_single(self):
+        # One package, or packages with scripts, are not batched
+        main.try_packages(self.batch, self.single, ["a"])
+        scripted = {"package": "b", "pre-script": "touch /b"}
+        main.try_packages(self.batch, self.single, ["c", scripted])
+        self.assertEqual(self.calls, ["a", "c", scripted])
+
+
+class TestPackageBatches(unittest.TestCase):
+    def test_names(self):
+        self.assertEqual(list(main.package_batches(["a", "b"])), [["a", "b"]])
+        self.assertEqual(list(main.package_batches([])), [])
+
+    def test_scripts_in_place(self):
+        # Only consecutive names are batched; scripted packages stay where they are
+        scripted = {"package": "b", "pre-script": "touch /b"}
+        other = {"package": "e", "post-script": "rm /e"}
+        self.assertEqual(list(main.package_batches(["a", scripted, "c", "d", other])),
+                         [["a"], scripted, ["c", "d"], other])
+        self.assertEqual(list(main.package_batches([scripted, "a"])), [scripted, ["a"]])
+
+
+if __name__ == "__main__":
+    unittest.main()
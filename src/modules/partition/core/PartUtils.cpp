@@ -17,6 +17,7 @@
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
+#include "partition/Metadata.h"
 #include "partition/Mount.h"
 #include "partition/PartitionIterator.h"
 #include "partition/PartitionQuery.h"
@@ -224,22 +225,31 @@ lookForFstabEntries( const QString& partitionPath )
 {
     QStringList mountOptions { "ro" };
 
-    auto r = CalamaresUtils::System::runCommand( CalamaresUtils::System::RunLocation::RunInHost,
-                                                 { "blkid", "-s", "TYPE", "-o", "value", partitionPath } );
-    if ( r.getExitCode() )
+    QString fstype;
+    auto* cache = CalamaresUtils::Partition::MetadataCache::instance();
+    if ( cache->contains( partitionPath ) )
     {
-        cWarning() << "blkid on" << partitionPath << "failed.";
+        fstype = cache->type( partitionPath );
     }
     else
     {
-        QString fstype = r.getOutput().trimmed();
-        if ( ( fstype == "ext3" ) || ( fstype == "ext4" ) )
+        auto r = CalamaresUtils::System::runCommand( CalamaresUtils::System::RunLocation::RunInHost,
+                                                     { "blkid", "-s", "TYPE", "-o", "value", partitionPath } );
+        if ( r.getExitCode() )
         {
-            mountOptions.append( "noload" );
+            cWarning() << "blkid on" << partitionPath << "failed.";
         }
+        else
+        {
+            fstype = r.getOutput().trimmed();
+        }
+    }
+    if ( ( fstype == "ext3" ) || ( fstype == "ext4" ) )
+    {
+        mountOptions.append( "noload" );
     }
 
-    cDebug() << "Checking device" << partitionPath << "for fstab (fs=" << r.getOutput() << ')';
+    cDebug() << "Checking device" << partitionPath << "for fstab (fs=" << fstype << ')';
 
     FstabEntryList fstabEntries;
 
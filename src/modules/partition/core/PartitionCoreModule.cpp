@@ -39,6 +39,7 @@
 #ifdef DEBUG_PARTITION_LAME
 #include "JobExample.h"
 #endif
+#include "partition/Metadata.h"
 #include "partition/PartitionIterator.h"
 #include "partition/PartitionQuery.h"
 #include "utils/Logger.h"
@@ -249,18 +250,25 @@ void
 PartitionCoreModule::doInit()
 {
     FileSystemFactory::init();
+    // Devices are (re-)scanned, so forget what we knew about their metadata
+    CalamaresUtils::Partition::MetadataCache::instance()->invalidate();
 
     using DeviceList = QList< Device* >;
     DeviceList devices = PartUtils::getDevices( PartUtils::DeviceType::WritableOnly );
 
-    cDebug() << "LIST OF DETECTED DEVICES:";
-    cDebug() << "node\tcapacity\tname\tprettyName";
+    cDebug() << "LIST OF DETECTED DEVICES:" << Logger::Lazy( [ &devices ]( QDebug& s ) {
+        s << Logger::Continuation << "node\tcapacity\tname\tprettyName";
+        for ( auto device : devices )
+        {
+            s << Logger::Continuation << device->deviceNode() << device->capacity() << device->name()
+              << device->prettyName();
+        }
+    } );
     for ( auto device : devices )
     {
         // Gives ownership of the Device* to the DeviceInfo object
         auto deviceInfo = new DeviceInfo( device );
         m_deviceInfos << deviceInfo;
-        cDebug() << device->deviceNode() << device->capacity() << device->name() << device->prettyName();
     }
     cDebug() << Logger::SubEntry << devices.count() << "devices detected.";
     m_deviceModel->init( devices );
@@ -68,7 +68,7 @@ void
 PartitionBarsView::setNestedPartitionsMode( PartitionBarsView::NestedPartitionsMode mode )
 {
     m_nestedPartitionsMode = mode;
-    viewport()->repaint();
+    invalidateLayout();
 }
 
 
@@ -93,23 +93,24 @@ PartitionBarsView::paintEvent( QPaintEvent* event )
     painter.fillRect( rect(), palette().window() );
     painter.setRenderHint( QPainter::Antialiasing );
 
-    QRect partitionsRect = rect();
-    partitionsRect.setHeight( VIEW_HEIGHT );
-
-    painter.save();
-    drawPartitions( &painter, partitionsRect, QModelIndex() );
-    painter.restore();
+    for ( const auto& section : sections() )
+    {
+        painter.save();
+        drawSection( &painter, section );
+        painter.restore();
+    }
 }
 
 
 void
-PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, int width, const QModelIndex& index )
+PartitionBarsView::drawSection( QPainter* painter, const Section& section )
 {
-    QColor color
-        = index.isValid() ? index.data( Qt::DecorationRole ).value< QColor >() : ColorUtils::unknownDisklabelColor();
-    bool isFreeSpace = index.isValid() ? index.data( PartitionModel::IsFreeSpaceRole ).toBool() : true;
+    const QModelIndex index = section.index;
+    const QColor& color = section.color;
+    const int x = section.rect.x();
+    const int width = section.rect.width();
 
-    QRect rect = rect_;
+    QRect rect = section.levelRect;
     const int y = rect.y();
     const int height = rect.height();
     const int radius = qMax( 1, CORNER_RADIUS - ( VIEW_HEIGHT - height ) / 2 );
@@ -143,14 +144,14 @@ PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, in
     painter->drawRoundedRect( rect, radius, radius );
 
     // Draw shade
-    if ( !isFreeSpace )
+    if ( !section.isFreeSpace )
     {
         rect.adjust( 2, 2, -2, -2 );
     }
 
     QLinearGradient gradient( 0, 0, 0, height / 2 );
 
-    qreal c = isFreeSpace ? 0 : 1;
+    qreal c = section.isFreeSpace ? 0 : 1;
     gradient.setColorAt( 0, QColor::fromRgbF( c, c, c, 0.3 ) );
     gradient.setColorAt( 1, QColor::fromRgbF( c, c, c, 0 ) );
 
@@ -191,8 +192,25 @@ PartitionBarsView::drawSection( QPainter* painter, const QRect& rect_, int x, in
 }
 
 
+const QVector< PartitionBarsView::Section >&
+PartitionBarsView::sections() const
+{
+    QRect partitionsRect = rect();
+    partitionsRect.setHeight( VIEW_HEIGHT );
+
+    if ( m_layoutDirty || partitionsRect != m_layoutRect )
+    {
+        m_sections.clear();
+        m_layoutRect = partitionsRect;
+        m_layoutDirty = false;
+        layoutSections( partitionsRect, QModelIndex() );
+    }
+    return m_sections;
+}
+
+
 void
-PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const QModelIndex& parent )
+PartitionBarsView::layoutSections( const QRect& rect, const QModelIndex& parent ) const
 {
     PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
     if ( !modl )
@@ -219,7 +237,11 @@ PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const Q
             width = rect.right() - x + 1;
         }
 
-        drawSection( painter, rect, x, width, item.index );
+        m_sections.append( { QRect( x, rect.y(), width, rect.height() ),
+                             rect,
+                             item.index,
+                             item.index.data( Qt::DecorationRole ).value< QColor >(),
+                             item.index.data( PartitionModel::IsFreeSpaceRole ).toBool() } );
 
         if ( m_nestedPartitionsMode == DrawNestedPartitions && modl->hasChildren( item.index ) )
         {
@@ -227,78 +249,38 @@ PartitionBarsView::drawPartitions( QPainter* painter, const QRect& rect, const Q
                            rect.y() + EXTENDED_PARTITION_MARGIN,
                            width - 2 * EXTENDED_PARTITION_MARGIN,
                            rect.height() - 2 * EXTENDED_PARTITION_MARGIN );
-            drawPartitions( painter, subRect, item.index );
+            layoutSections( subRect, item.index );
         }
         x += width;
     }
 
-    if ( !items.count() && !modl->device()->partitionTable() )  // No disklabel or unknown
+    if ( !parent.isValid() && !items.count() && !modl->device()->partitionTable() )  // No disklabel or unknown
     {
-        int width = rect.right() - rect.x() + 1;
-        drawSection( painter, rect, rect.x(), width, QModelIndex() );
+        m_sections.append( { rect, rect, QModelIndex(), ColorUtils::unknownDisklabelColor(), true } );
     }
 }
 
 
-QModelIndex
-PartitionBarsView::indexAt( const QPoint& point ) const
+void
+PartitionBarsView::invalidateLayout()
 {
-    return indexAt( point, rect(), QModelIndex() );
+    m_layoutDirty = true;
+    viewport()->update();
 }
 
 
 QModelIndex
-PartitionBarsView::indexAt( const QPoint& point, const QRect& rect, const QModelIndex& parent ) const
+PartitionBarsView::indexAt( const QPoint& point ) const
 {
-    PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
-    {
-        return QModelIndex();
-    }
-    const int totalWidth = rect.width();
-
-    auto pair = computeItemsVector( parent );
-    QVector< PartitionBarsView::Item >& items = pair.first;
-    qreal& total = pair.second;
-    int x = rect.x();
-    for ( int row = 0; row < items.count(); ++row )
+    // Nested sections come after (and lie within) their parent
+    const auto& all = sections();
+    for ( auto it = all.crbegin(); it != all.crend(); ++it )
     {
-        const auto& item = items[ row ];
-        int width;
-        if ( row < items.count() - 1 )
-        {
-            width = totalWidth * ( item.size / total );
-        }
-        else
-        // Make sure we fill the last pixel column
-        {
-            width = rect.right() - x + 1;
-        }
-
-        QRect thisItemRect( x, rect.y(), width, rect.height() );
-        if ( thisItemRect.contains( point ) )
+        if ( it->rect.contains( point ) )
         {
-            if ( m_nestedPartitionsMode == DrawNestedPartitions && modl->hasChildren( item.index ) )
-            {
-                QRect subRect( x + EXTENDED_PARTITION_MARGIN,
-                               rect.y() + EXTENDED_PARTITION_MARGIN,
-                               width - 2 * EXTENDED_PARTITION_MARGIN,
-                               rect.height() - 2 * EXTENDED_PARTITION_MARGIN );
-
-                if ( subRect.contains( point ) )
-                {
-                    return indexAt( point, subRect, item.index );
-                }
-                return item.index;
-            }
-            else  // contains but no children, we win
-            {
-                return item.index;
-            }
+            return it->index;
         }
-        x += width;
     }
-
     return QModelIndex();
 }
 
@@ -306,62 +288,13 @@ PartitionBarsView::indexAt( const QPoint& point, const QRect& rect, const QModel
 QRect
 PartitionBarsView::visualRect( const QModelIndex& index ) const
 {
-    return visualRect( index, rect(), QModelIndex() );
-}
-
-
-QRect
-PartitionBarsView::visualRect( const QModelIndex& index, const QRect& rect, const QModelIndex& parent ) const
-{
-    PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
+    for ( const auto& section : sections() )
     {
-        return QRect();
-    }
-    const int totalWidth = rect.width();
-
-    auto pair = computeItemsVector( parent );
-    QVector< PartitionBarsView::Item >& items = pair.first;
-    qreal& total = pair.second;
-    int x = rect.x();
-    for ( int row = 0; row < items.count(); ++row )
-    {
-        const auto& item = items[ row ];
-        int width;
-        if ( row < items.count() - 1 )
+        if ( section.index.isValid() && section.index == index )
         {
-            width = totalWidth * ( item.size / total );
-        }
-        else
-        // Make sure we fill the last pixel column
-        {
-            width = rect.right() - x + 1;
+            return section.rect;
         }
-
-        QRect thisItemRect( x, rect.y(), width, rect.height() );
-        if ( item.index == index )
-        {
-            return thisItemRect;
-        }
-
-        if ( m_nestedPartitionsMode == DrawNestedPartitions && modl->hasChildren( item.index )
-             && index.parent() == item.index )
-        {
-            QRect subRect( x + EXTENDED_PARTITION_MARGIN,
-                           rect.y() + EXTENDED_PARTITION_MARGIN,
-                           width - 2 * EXTENDED_PARTITION_MARGIN,
-                           rect.height() - 2 * EXTENDED_PARTITION_MARGIN );
-
-            QRect candidateVisualRect = visualRect( index, subRect, item.index );
-            if ( !candidateVisualRect.isNull() )
-            {
-                return candidateVisualRect;
-            }
-        }
-
-        x += width;
     }
-
     return QRect();
 }
 
@@ -399,7 +332,49 @@ void
 PartitionBarsView::setSelectionModel( QItemSelectionModel* selectionModel )
 {
     QAbstractItemView::setSelectionModel( selectionModel );
-    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { viewport()->repaint(); } );
+    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { viewport()->update(); } );
+}
+
+
+void
+PartitionBarsView::setModel( QAbstractItemModel* model )
+{
+    QAbstractItemView::setModel( model );
+    invalidateLayout();
+}
+
+
+void
+PartitionBarsView::reset()
+{
+    QAbstractItemView::reset();
+    invalidateLayout();
+}
+
+
+void
+PartitionBarsView::dataChanged( const QModelIndex& topLeft,
+                                const QModelIndex& bottomRight,
+                                const QVector< int >& roles )
+{
+    QAbstractItemView::dataChanged( topLeft, bottomRight, roles );
+    invalidateLayout();
+}
+
+
+void
+PartitionBarsView::rowsInserted( const QModelIndex& parent, int start, int end )
+{
+    QAbstractItemView::rowsInserted( parent, start, end );
+    invalidateLayout();
+}
+
+
+void
+PartitionBarsView::rowsAboutToBeRemoved( const QModelIndex& parent, int start, int end )
+{
+    QAbstractItemView::rowsAboutToBeRemoved( parent, start, end );
+    invalidateLayout();
 }
 
 
@@ -449,7 +424,7 @@ PartitionBarsView::setSelection( const QRect& rect, QItemSelectionModel::Selecti
         selectionModel()->select( eventIndex, flags );
     }
 
-    viewport()->repaint();
+    viewport()->update();
 }
 
 
@@ -479,7 +454,7 @@ PartitionBarsView::mouseMoveEvent( QMouseEvent* event )
             QGuiApplication::restoreOverrideCursor();
         }
 
-        viewport()->repaint();
+        viewport()->update();
     }
 }
 
@@ -491,7 +466,7 @@ PartitionBarsView::leaveEvent( QEvent* )
     if ( m_hoveredIndex.isValid() )
     {
         m_hoveredIndex = QModelIndex();
-        viewport()->repaint();
+        viewport()->update();
     }
 }
 
@@ -515,6 +490,7 @@ void
 PartitionBarsView::updateGeometries()
 {
     updateGeometry();  //get a new rect() for redrawing all the labels
+    invalidateLayout();
 }
 
 
@@ -53,6 +53,9 @@ public:
 
     void setSelectionFilter( SelectionFilter canBeSelected );
 
+    void setModel( QAbstractItemModel* model ) override;
+    void reset() override;
+
 protected:
     // QAbstractItemView API
     QRegion visualRegionForSelection( const QItemSelection& selection ) const override;
@@ -68,12 +71,35 @@ protected:
 
 protected slots:
     void updateGeometries() override;
+    void dataChanged( const QModelIndex& topLeft,
+                      const QModelIndex& bottomRight,
+                      const QVector< int >& roles = QVector< int >() ) override;
+    void rowsInserted( const QModelIndex& parent, int start, int end ) override;
+    void rowsAboutToBeRemoved( const QModelIndex& parent, int start, int end ) override;
 
 private:
-    void drawPartitions( QPainter* painter, const QRect& rect, const QModelIndex& parent );
-    void drawSection( QPainter* painter, const QRect& rect_, int x, int width, const QModelIndex& index );
-    QModelIndex indexAt( const QPoint& point, const QRect& rect, const QModelIndex& parent ) const;
-    QRect visualRect( const QModelIndex& index, const QRect& rect, const QModelIndex& parent ) const;
+    /** @brief One colored section of the bar
+     *
+     * The geometry and colors are computed once for the size of the
+     * view and the contents of the model (see sections()), so that
+     * repainting (e.g. on hover) and hit-testing don't walk the model.
+     */
+    struct Section
+    {
+        QRect rect;  ///< The area of this section
+        QRect levelRect;  ///< The bar (or nested bar) that this section is part of
+        QPersistentModelIndex index;  ///< Invalid for an unknown or missing disklabel
+        QColor color;
+        bool isFreeSpace;
+    };
+
+    /// @brief The sections in drawing order: outer ones before the nested ones
+    const QVector< Section >& sections() const;
+    void layoutSections( const QRect& rect, const QModelIndex& parent ) const;
+    /// @brief Forget the layout; it is re-done on the next paint or hit-test
+    void invalidateLayout();
+
+    void drawSection( QPainter* painter, const Section& section );
 
     NestedPartitionsMode m_nestedPartitionsMode;
 
@@ -86,6 +112,10 @@ private:
     };
     inline QPair< QVector< Item >, qreal > computeItemsVector( const QModelIndex& parent ) const;
     QPersistentModelIndex m_hoveredIndex;
+
+    mutable QVector< Section > m_sections;
+    mutable QRect m_layoutRect;  ///< The rect() that m_sections is laid out for
+    mutable bool m_layoutDirty = true;
 };
 
 #endif /* PARTITIONPREVIEW_H */
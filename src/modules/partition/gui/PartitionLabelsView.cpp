@@ -89,16 +89,28 @@ PartitionLabelsView::paintEvent( QPaintEvent* event )
     painter.fillRect( rect(), palette().window() );
     painter.setRenderHint( QPainter::Antialiasing );
 
-    QRect lRect = labelsRect();
-
-    drawLabels( &painter, lRect, QModelIndex() );
-}
+    for ( const Label& label : labels() )
+    {
+        // Draw hover
+        if ( selectionMode() != QAbstractItemView::NoSelection &&  // no hover without selection
+             m_hoveredIndex.isValid() && label.index == m_hoveredIndex )
+        {
+            painter.save();
+            painter.translate( 0.5, 0.5 );
+            QRect hoverRect = label.rect.adjusted( 0, 0, -1, -1 - LAYOUT_MARGIN );
+            painter.setBrush( QPalette().window().color().lighter( 102 ) );
+            painter.setPen( Qt::NoPen );
+            painter.drawRoundedRect( hoverRect, CORNER_RADIUS, CORNER_RADIUS );
+            painter.restore();
+        }
 
+        // Is this element the selected one?
+        bool sel = selectionMode() != QAbstractItemView::NoSelection && label.index.isValid() && selectionModel()
+            && !selectionModel()->selectedIndexes().isEmpty()
+            && selectionModel()->selectedIndexes().first() == label.index;
 
-QRect
-PartitionLabelsView::labelsRect() const
-{
-    return rect().adjusted( 0, LAYOUT_MARGIN, 0, 0 );
+        drawLabel( &painter, label.shownTexts, label.color, label.rect.topLeft() + QPoint( 0, LAYOUT_MARGIN ), sel );
+    }
 }
 
 
@@ -244,104 +256,113 @@ PartitionLabelsView::buildTexts( const QModelIndex& index ) const
 }
 
 
-void
-PartitionLabelsView::drawLabels( QPainter* painter, const QRect& rect, const QModelIndex& parent )
+const QVector< PartitionLabelsView::Label >&
+PartitionLabelsView::labels() const
 {
     PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
+    if ( m_layoutDirty )
     {
-        return;
-    }
-
-    const QModelIndexList indexesToDraw = getIndexesToDraw( parent );
-
-    int label_x = rect.x();
-    int label_y = rect.y();
-    for ( const QModelIndex& index : indexesToDraw )
-    {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
-
-        QColor labelColor = index.data( Qt::DecorationRole ).value< QColor >();
-
-        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
+        m_labels.clear();
+        m_layoutWidth = -1;
+        m_layoutDirty = false;
+        if ( !modl )
         {
-            label_x = rect.x();
-            label_y += labelSize.height() + labelSize.height() / 4;
+            return m_labels;
         }
 
-        // Draw hover
-        if ( selectionMode() != QAbstractItemView::NoSelection &&  // no hover without selection
-             m_hoveredIndex.isValid() && index == m_hoveredIndex )
+        const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
+        m_labels.reserve( indexesToDraw.count() + 1 );
+        for ( const QModelIndex& index : indexesToDraw )
         {
-            painter->save();
-            QRect labelRect( QPoint( label_x, label_y ), labelSize );
-            labelRect.adjust( 0, -LAYOUT_MARGIN, 0, -2 * LAYOUT_MARGIN );
-            painter->translate( 0.5, 0.5 );
-            QRect hoverRect = labelRect.adjusted( 0, 0, -1, -1 );
-            painter->setBrush( QPalette().window().color().lighter( 102 ) );
-            painter->setPen( Qt::NoPen );
-            painter->drawRoundedRect( hoverRect, CORNER_RADIUS, CORNER_RADIUS );
-
-            painter->translate( -0.5, -0.5 );
-            painter->restore();
+            const QStringList texts = buildTexts( index );
+            const QColor color = index.data( Qt::DecorationRole ).value< QColor >();
+            m_labels.append( { index, texts, color, sizeForLabel( texts ) } );
+        }
+        if ( !modl->rowCount() && !modl->device()->partitionTable() )  // No disklabel or unknown
+        {
+            const QStringList texts = buildUnknownDisklabelTexts( modl->device() );
+            m_labels.append( { QModelIndex(), texts, ColorUtils::unknownDisklabelColor(), sizeForLabel( texts ) } );
         }
-
-        // Is this element the selected one?
-        bool sel = selectionMode() != QAbstractItemView::NoSelection && index.isValid() && selectionModel()
-            && !selectionModel()->selectedIndexes().isEmpty() && selectionModel()->selectedIndexes().first() == index;
-
-        drawLabel( painter, texts, labelColor, QPoint( label_x, label_y ), sel );
-
-        label_x += labelSize.width() + LABELS_MARGIN;
     }
 
-    if ( !modl->rowCount() && !modl->device()->partitionTable() )  // No disklabel or unknown
+    const QRect rect = this->rect();
+    if ( m_layoutWidth != rect.width() )
     {
-        QStringList texts = buildUnknownDisklabelTexts( modl->device() );
-        QColor labelColor = ColorUtils::unknownDisklabelColor();
-        drawLabel( painter, texts, labelColor, QPoint( rect.x(), rect.y() ), false /*can't be selected*/ );
+        m_layoutWidth = rect.width();
+        int label_x = rect.x();
+        int label_y = rect.y();
+        const int maxTextWidth = rect.width() - LABEL_PARTITION_SQUARE_MARGIN;
+        for ( Label& label : m_labels )
+        {
+            // A label that does not fit on a line by itself (e.g. a long
+            // filesystem label in a narrow window) is elided.
+            if ( label.fullSize.width() > rect.width() && maxTextWidth > 0 )
+            {
+                label.shownTexts.clear();
+                for ( const QString& text : label.texts )
+                {
+                    label.shownTexts.append( fontMetrics().elidedText( text, Qt::ElideRight, maxTextWidth ) );
+                }
+                label.size = sizeForLabel( label.shownTexts );
+            }
+            else
+            {
+                label.shownTexts = label.texts;
+                label.size = label.fullSize;
+            }
+
+            if ( !label.index.isValid() )
+            {
+                label.rect = QRect( rect.topLeft(), label.size );
+                continue;
+            }
+            if ( label_x + label.size.width() > rect.width() )  //wrap to new line if overflow
+            {
+                label_x = rect.x();
+                label_y += label.size.height() + label.size.height() / 4;
+            }
+            label.rect = QRect( QPoint( label_x, label_y ), label.size );
+            label_x += label.size.width() + LABELS_MARGIN;
+        }
     }
+    return m_labels;
 }
 
 
-QSize
-PartitionLabelsView::sizeForAllLabels( int maxLineWidth ) const
+void
+PartitionLabelsView::invalidateLayout()
 {
-    PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
-    {
-        return QSize();
-    }
+    m_layoutDirty = true;
+    updateGeometry();
+    viewport()->update();
+}
 
-    const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
 
+QSize
+PartitionLabelsView::sizeForAllLabels( int maxLineWidth ) const
+{
     int lineLength = 0;
     int numLines = 1;
     int singleLabelHeight = 0;
-    for ( const QModelIndex& index : indexesToDraw )
+    for ( const Label& label : labels() )
     {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
+        if ( !label.index.isValid() )  // Unknown or no disklabel
+        {
+            singleLabelHeight = label.size.height();
+            continue;
+        }
 
-        if ( lineLength + labelSize.width() > maxLineWidth )
+        if ( lineLength + label.size.width() > maxLineWidth )
         {
             numLines++;
-            lineLength = labelSize.width();
+            lineLength = label.size.width();
         }
         else
         {
-            lineLength += LABELS_MARGIN + labelSize.width();
+            lineLength += LABELS_MARGIN + label.size.width();
         }
 
-        singleLabelHeight = qMax( singleLabelHeight, labelSize.height() );
-    }
-
-    if ( !modl->rowCount() && !modl->device()->partitionTable() )  // Unknown or no disklabel
-    {
-        singleLabelHeight = sizeForLabel( buildUnknownDisklabelTexts( modl->device() ) ).height();
+        singleLabelHeight = qMax( singleLabelHeight, label.size.height() );
     }
 
     int totalHeight = numLines * singleLabelHeight + ( numLines - 1 ) * singleLabelHeight / 4;  //spacings
@@ -403,38 +424,13 @@ PartitionLabelsView::drawLabel( QPainter* painter,
 QModelIndex
 PartitionLabelsView::indexAt( const QPoint& point ) const
 {
-    PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
-    {
-        return QModelIndex();
-    }
-
-    const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
-
-    QRect rect = this->rect();
-    int label_x = rect.x();
-    int label_y = rect.y();
-    for ( const QModelIndex& index : indexesToDraw )
+    for ( const Label& label : labels() )
     {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
-
-        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
+        if ( label.index.isValid() && label.rect.contains( point ) )
         {
-            label_x = rect.x();
-            label_y += labelSize.height() + labelSize.height() / 4;
+            return label.index;
         }
-
-        QRect labelRect( QPoint( label_x, label_y ), labelSize );
-        if ( labelRect.contains( point ) )
-        {
-            return index;
-        }
-
-        label_x += labelSize.width() + LABELS_MARGIN;
     }
-
     return QModelIndex();
 }
 
@@ -442,37 +438,17 @@ PartitionLabelsView::indexAt( const QPoint& point ) const
 QRect
 PartitionLabelsView::visualRect( const QModelIndex& idx ) const
 {
-    PartitionModel* modl = qobject_cast< PartitionModel* >( model() );
-    if ( !modl )
+    if ( !idx.isValid() )
     {
         return QRect();
     }
-
-    const QModelIndexList indexesToDraw = getIndexesToDraw( QModelIndex() );
-
-    QRect rect = this->rect();
-    int label_x = rect.x();
-    int label_y = rect.y();
-    for ( const QModelIndex& index : indexesToDraw )
+    for ( const Label& label : labels() )
     {
-        QStringList texts = buildTexts( index );
-
-        QSize labelSize = sizeForLabel( texts );
-
-        if ( label_x + labelSize.width() > rect.width() )  //wrap to new line if overflow
-        {
-            label_x = rect.x();
-            label_y += labelSize.height() + labelSize.height() / 4;
-        }
-
-        if ( idx.isValid() && idx == index )
+        if ( label.index == idx )
         {
-            return QRect( QPoint( label_x, label_y ), labelSize );
+            return label.rect;
         }
-
-        label_x += labelSize.width() + LABELS_MARGIN;
     }
-
     return QRect();
 }
 
@@ -512,7 +488,7 @@ void
 PartitionLabelsView::setCustomNewRootLabel( const QString& text )
 {
     m_customNewRootLabel = text;
-    viewport()->repaint();
+    invalidateLayout();
 }
 
 
@@ -520,7 +496,7 @@ void
 PartitionLabelsView::setSelectionModel( QItemSelectionModel* selectionModel )
 {
     QAbstractItemView::setSelectionModel( selectionModel );
-    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { viewport()->repaint(); } );
+    connect( selectionModel, &QItemSelectionModel::selectionChanged, this, [=] { viewport()->update(); } );
 }
 
 
@@ -535,6 +511,49 @@ void
 PartitionLabelsView::setExtendedPartitionHidden( bool hidden )
 {
     m_extendedPartitionHidden = hidden;
+    invalidateLayout();
+}
+
+
+void
+PartitionLabelsView::setModel( QAbstractItemModel* model )
+{
+    QAbstractItemView::setModel( model );
+    invalidateLayout();
+}
+
+
+void
+PartitionLabelsView::reset()
+{
+    QAbstractItemView::reset();
+    invalidateLayout();
+}
+
+
+void
+PartitionLabelsView::dataChanged( const QModelIndex& topLeft,
+                                  const QModelIndex& bottomRight,
+                                  const QVector< int >& roles )
+{
+    QAbstractItemView::dataChanged( topLeft, bottomRight, roles );
+    invalidateLayout();
+}
+
+
+void
+PartitionLabelsView::rowsInserted( const QModelIndex& parent, int start, int end )
+{
+    QAbstractItemView::rowsInserted( parent, start, end );
+    invalidateLayout();
+}
+
+
+void
+PartitionLabelsView::rowsAboutToBeRemoved( const QModelIndex& parent, int start, int end )
+{
+    QAbstractItemView::rowsAboutToBeRemoved( parent, start, end );
+    invalidateLayout();
 }
 
 
@@ -594,7 +613,7 @@ PartitionLabelsView::mouseMoveEvent( QMouseEvent* event )
             QGuiApplication::restoreOverrideCursor();
         }
 
-        viewport()->repaint();
+        viewport()->update();
     }
 }
 
@@ -608,7 +627,7 @@ PartitionLabelsView::leaveEvent( QEvent* event )
     if ( m_hoveredIndex.isValid() )
     {
         m_hoveredIndex = QModelIndex();
-        viewport()->repaint();
+        viewport()->update();
     }
 }
 
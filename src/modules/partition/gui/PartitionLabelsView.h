@@ -49,6 +49,9 @@ public:
 
     void setExtendedPartitionHidden( bool hidden );
 
+    void setModel( QAbstractItemModel* model ) override;
+    void reset() override;
+
 protected:
     // QAbstractItemView API
     QRegion visualRegionForSelection( const QItemSelection& selection ) const override;
@@ -64,10 +67,36 @@ protected:
 
 protected slots:
     void updateGeometries() override;
+    void dataChanged( const QModelIndex& topLeft,
+                      const QModelIndex& bottomRight,
+                      const QVector< int >& roles = QVector< int >() ) override;
+    void rowsInserted( const QModelIndex& parent, int start, int end ) override;
+    void rowsAboutToBeRemoved( const QModelIndex& parent, int start, int end ) override;
 
 private:
-    QRect labelsRect() const;
-    void drawLabels( QPainter* painter, const QRect& rect, const QModelIndex& parent );
+    /** @brief A label for one partition (or for the whole disk)
+     *
+     * The texts and colors are built once per change of the model, and
+     * the positions (and texts elided to fit) once per width of the view
+     * (see labels()), so that repainting (e.g. on hover) and hit-testing
+     * don't walk the model.
+     */
+    struct Label
+    {
+        QPersistentModelIndex index;  ///< Invalid for an unknown or missing disklabel
+        QStringList texts;
+        QColor color;
+        QSize fullSize;  ///< Size of the texts
+        QStringList shownTexts;  ///< The texts, elided if they are wider than the view
+        QSize size;  ///< Size of the shown texts
+        QRect rect;  ///< Position for hit-testing; it is drawn LAYOUT_MARGIN lower
+    };
+
+    /// @brief The labels, in drawing order
+    const QVector< Label >& labels() const;
+    /// @brief Forget the labels; they are re-built on the next paint or hit-test
+    void invalidateLayout();
+
     QSize sizeForAllLabels( int maxLineWidth ) const;
     QSize sizeForLabel( const QStringList& text ) const;
     void drawLabel( QPainter* painter, const QStringList& text, const QColor& color, const QPoint& pos, bool selected );
@@ -79,6 +108,10 @@ private:
 
     QString m_customNewRootLabel;
     QPersistentModelIndex m_hoveredIndex;
+
+    mutable QVector< Label > m_labels;
+    mutable int m_layoutWidth = -1;  ///< The width that the labels are positioned for
+    mutable bool m_layoutDirty = true;
 };
 
 #endif  // PARTITIONLABELSVIEW_H
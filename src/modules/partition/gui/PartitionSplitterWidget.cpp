@@ -104,7 +104,7 @@ PartitionSplitterWidget::setupItems( const QVector< PartitionSplitterItem >& ite
 
     m_items.clear();
     m_items = items;
-    repaint();
+    invalidateLayout();
     for ( const PartitionSplitterItem& item : items )
     {
         cDebug() << "PSI added item" << item.itemPath << "size" << item.size;
@@ -236,7 +236,7 @@ PartitionSplitterWidget::setSplitPartition( const QString& path, qint64 minSize,
     cDebug() << "m_itemToResize:    " << !m_itemToResize.isNull() << m_itemToResize.itemPath;
     cDebug() << "m_itemToResizeNext:" << !m_itemToResizeNext.isNull() << m_itemToResizeNext.itemPath;
 
-    repaint();
+    invalidateLayout();
 }
 
 
@@ -285,7 +285,17 @@ PartitionSplitterWidget::paintEvent( QPaintEvent* event )
     painter.fillRect( rect(), palette().window() );
     painter.setRenderHint( QPainter::Antialiasing );
 
-    drawPartitions( &painter, rect(), m_items );
+    updateLayout();
+    for ( const auto& section : qAsConst( m_sections ) )
+    {
+        painter.save();
+        drawSection( &painter, section );
+        painter.restore();
+    }
+    if ( !m_resizeHandleRect.isEmpty() )
+    {
+        drawResizeHandle( &painter, m_resizeHandleRect, m_resizeHandleX );
+    }
 }
 
 
@@ -294,6 +304,7 @@ PartitionSplitterWidget::mousePressEvent( QMouseEvent* event )
 {
     if ( m_itemToResize && m_itemToResizeNext && event->button() == Qt::LeftButton )
     {
+        updateLayout();  // for the handle position
         if ( qAbs( event->x() - m_resizeHandleX ) < HANDLE_SNAP )
         {
             m_resizing = true;
@@ -372,7 +383,7 @@ PartitionSplitterWidget::mouseMoveEvent( QMouseEvent* event )
             return false;
         } );
 
-        repaint();
+        invalidateLayout();
 
         emit partitionResized( itemPath, m_itemToResize.size, m_itemToResizeNext.size );
     }
@@ -380,6 +391,7 @@ PartitionSplitterWidget::mouseMoveEvent( QMouseEvent* event )
     {
         if ( m_itemToResize && m_itemToResizeNext )
         {
+            updateLayout();  // for the handle position
             if ( qAbs( event->x() - m_resizeHandleX ) < HANDLE_SNAP )
             {
                 setCursor( Qt::SplitHCursor );
@@ -403,16 +415,14 @@ PartitionSplitterWidget::mouseReleaseEvent( QMouseEvent* event )
 
 
 void
-PartitionSplitterWidget::drawSection( QPainter* painter,
-                                      const QRect& rect_,
-                                      int x,
-                                      int width,
-                                      const PartitionSplitterItem& item )
+PartitionSplitterWidget::drawSection( QPainter* painter, const Section& section )
 {
-    QColor color = item.color;
-    bool isFreeSpace = item.isFreeSpace;
+    const QColor& color = section.color;
+    const bool isFreeSpace = section.isFreeSpace;
+    const int x = section.rect.x();
+    const int width = section.rect.width();
 
-    QRect rect = rect_;
+    QRect rect = section.levelRect;
     const int y = rect.y();
     const int rectHeight = rect.height();
     const int radius = qMax( 1, CORNER_RADIUS - ( height() - rectHeight ) / 2 );
@@ -497,9 +507,30 @@ PartitionSplitterWidget::drawResizeHandle( QPainter* painter, const QRect& rect_
 
 
 void
-PartitionSplitterWidget::drawPartitions( QPainter* painter,
-                                         const QRect& rect,
-                                         const QVector< PartitionSplitterItem >& itemList )
+PartitionSplitterWidget::updateLayout()
+{
+    if ( !m_layoutDirty && rect() == m_layoutRect )
+    {
+        return;
+    }
+    m_sections.clear();
+    m_resizeHandleRect = QRect();
+    m_layoutRect = rect();
+    m_layoutDirty = false;
+    layoutSections( rect(), m_items );
+}
+
+
+void
+PartitionSplitterWidget::invalidateLayout()
+{
+    m_layoutDirty = true;
+    update();
+}
+
+
+void
+PartitionSplitterWidget::layoutSections( const QRect& rect, const QVector< PartitionSplitterItem >& itemList )
 {
     const int count = itemList.count();
     const int totalWidth = rect.width();
@@ -523,14 +554,14 @@ PartitionSplitterWidget::drawPartitions( QPainter* painter,
             width = rect.right() - x + 1;
         }
 
-        drawSection( painter, rect, x, int( width ), item );
+        m_sections.append( { QRect( x, rect.y(), int( width ), rect.height() ), rect, item.color, item.isFreeSpace } );
         if ( !item.children.isEmpty() )
         {
             QRect subRect( x + EXTENDED_PARTITION_MARGIN,
                            rect.y() + EXTENDED_PARTITION_MARGIN,
                            int( width ) - 2 * EXTENDED_PARTITION_MARGIN,
                            rect.height() - 2 * EXTENDED_PARTITION_MARGIN );
-            drawPartitions( painter, subRect, item.children );
+            layoutSections( subRect, item.children );
         }
 
         // If an item to resize and the following new item both exist,
@@ -540,7 +571,7 @@ PartitionSplitterWidget::drawPartitions( QPainter* painter,
              && !items[ row - 1 ].itemPath.isEmpty() && items[ row - 1 ].itemPath == m_itemToResize.itemPath )
         {
             m_resizeHandleX = x;
-            drawResizeHandle( painter, rect, m_resizeHandleX );
+            m_resizeHandleRect = rect;
         }
 
         x += width;
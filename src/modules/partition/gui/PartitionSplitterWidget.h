@@ -66,10 +66,28 @@ protected:
     void mouseReleaseEvent( QMouseEvent* event ) override;
 
 private:
+    /** @brief One colored section of the bar
+     *
+     * The sections are computed once for the size of the widget and the
+     * items (see updateLayout()), not on every repaint.
+     */
+    struct Section
+    {
+        QRect rect;  ///< The area of this section
+        QRect levelRect;  ///< The bar (or nested bar) that this section is part of
+        QColor color;
+        bool isFreeSpace;
+    };
+
     void setupItems( const QVector< PartitionSplitterItem >& items );
 
-    void drawPartitions( QPainter* painter, const QRect& rect, const QVector< PartitionSplitterItem >& itemList );
-    void drawSection( QPainter* painter, const QRect& rect_, int x, int width, const PartitionSplitterItem& item );
+    /// @brief Re-computes the sections (and resize handle) if needed
+    void updateLayout();
+    void layoutSections( const QRect& rect, const QVector< PartitionSplitterItem >& itemList );
+    /// @brief Forget the layout and schedule a repaint
+    void invalidateLayout();
+
+    void drawSection( QPainter* painter, const Section& section );
     void drawResizeHandle( QPainter* painter, const QRect& rect_, int x );
 
     PartitionSplitterItem _findItem( QVector< PartitionSplitterItem >& items,
@@ -92,6 +110,11 @@ private:
     bool m_resizing;
     int m_resizeHandleX;
 
+    QVector< Section > m_sections;
+    QRect m_resizeHandleRect;  ///< The bar the resize handle is in, or empty if there is no handle
+    QRect m_layoutRect;  ///< The rect() that m_sections is laid out for
+    bool m_layoutDirty = true;
+
     const int HANDLE_SNAP;
 
     bool m_drawNestedPartitions;
@@ -33,6 +33,8 @@ public:
 
     QString prettyName() const override;
     Calamares::JobResult exec() override;
+    /// @brief Automounting does not affect the target system
+    bool isRerunSafe() const override;
 
 private:
     bool m_disable;
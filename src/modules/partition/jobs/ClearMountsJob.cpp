@@ -13,20 +13,22 @@
 
 #include "core/PartitionInfo.h"
 
+#include "partition/BlockTopology.h"
+#include "partition/Metadata.h"
 #include "partition/PartitionIterator.h"
 #include "partition/Sync.h"
 #include "utils/Logger.h"
-#include "utils/String.h"
 
 // KPMcore
 #include <kpmcore/core/device.h>
 #include <kpmcore/core/partition.h>
 #include <kpmcore/util/report.h>
 
-#include <QDir>
 #include <QProcess>
 #include <QStringList>
+#include <QtConcurrent/QtConcurrent>
 
+using CalamaresUtils::Partition::BlockTopology;
 using CalamaresUtils::Partition::PartitionIterator;
 
 ClearMountsJob::ClearMountsJob( Device* device )
@@ -50,35 +52,23 @@ ClearMountsJob::prettyStatusMessage() const
 }
 
 
+/** @brief Is @p device one that the live system itself uses?
+ *
+ * Fedora live images use /dev/mapper/live-* internally. We must not
+ * unmount those devices, because they are used by the live image and
+ * because we need /dev/mapper/live-base in the unpackfs module.
+ */
+static bool
+isLiveDevice( const CalamaresUtils::Partition::BlockDevice& device )
+{
+    return device.dmName.startsWith( "live-" );
+}
+
+/* Not exactly public API, used in tests */
 QStringList
 getPartitionsForDevice( const QString& deviceName )
 {
-    QStringList partitions;
-
-    QFile dev_partitions( "/proc/partitions" );
-    if ( dev_partitions.open( QFile::ReadOnly ) )
-    {
-        cDebug() << "Reading from" << dev_partitions.fileName();
-        QTextStream in( &dev_partitions );
-        (void)in.readLine();  // That's the header line, skip it
-        while ( !in.atEnd() )
-        {
-            // The fourth column (index from 0, so index 3) is the name of the device;
-            // keep it if it is followed by something.
-            QStringList columns = in.readLine().split( ' ', SplitSkipEmptyParts );
-            if ( ( columns.count() >= 4 ) && ( columns[ 3 ].startsWith( deviceName ) )
-                 && ( columns[ 3 ] != deviceName ) )
-            {
-                partitions.append( columns[ 3 ] );
-            }
-        }
-    }
-    else
-    {
-        cDebug() << "Could not open" << dev_partitions.fileName();
-    }
-
-    return partitions;
+    return BlockTopology::snapshot().partitions( deviceName );
 }
 
 Calamares::JobResult
@@ -86,161 +76,157 @@ ClearMountsJob::exec()
 {
     CalamaresUtils::Partition::Syncer s;
 
-    QString deviceName = m_device->deviceNode().split( '/' ).last();
+    const QString deviceName = m_device->deviceNode().split( '/' ).last();
+    const auto topology = BlockTopology::snapshot();
+    const QStringList partitionsList = topology.partitions( deviceName );
+    cDebug() << "Clearing mounts for" << deviceName << "with partitions" << partitionsList;
 
-    QStringList goodNews;
-    QProcess process;
+    // Everything stacked on this device or its partitions (LUKS, LVM, ..)
+    // and the partitions themselves, in independent groups.
+    QStringList devices = partitionsList;
+    devices.prepend( deviceName );
+    const auto groups = topology.holderGroups( devices );
 
-    QStringList partitionsList = getPartitionsForDevice( deviceName );
-
-    // Build a list of partitions of type 82 (Linux swap / Solaris).
-    // We then need to clear them just in case they contain something resumable from a
-    // previous suspend-to-disk.
-    QStringList swapPartitions;
-    process.start( "sfdisk", { "-d", m_device->deviceNode() } );
-    process.waitForFinished();
-    // Sample output:
-    //    % sudo sfdisk -d /dev/sda
-    //    label: dos
-    //    label-id: 0x000ced89
-    //    device: /dev/sda
-    //    unit: sectors
-
-    //    /dev/sda1 : start=          63, size=    29329345, type=83, bootable
-    //    /dev/sda2 : start=    29331456, size=     2125824, type=82
-
-    swapPartitions = QString::fromLocal8Bit( process.readAllStandardOutput() ).split( '\n' );
-    swapPartitions = swapPartitions.filter( "type=82" );
-    for ( QStringList::iterator it = swapPartitions.begin(); it != swapPartitions.end(); ++it )
+    // Mounts may be nested across groups (e.g. an LV mounted inside a
+    // partition's mount), so unmount everything first, serially and
+    // deepest first; only the teardown of the groups is independent.
+    QStringList goodNews;
+    QStringList affected;
+    for ( const QStringList& group : groups )
     {
-        *it = ( *it ).simplified().split( ' ' ).first();
+        for ( const QString& name : group )
+        {
+            if ( !isLiveDevice( topology.device( name ) ) )
+            {
+                affected.append( name );
+            }
+        }
     }
-
-    const QStringList cryptoDevices = getCryptoDevices();
-    for ( const QString& mapperPath : cryptoDevices )
+    for ( const QString& mountPoint : topology.unmountOrder( affected ) )
     {
-        tryUmount( mapperPath );
-        QString news = tryCryptoClose( mapperPath );
+        QString news = tryUmount( mountPoint );
         if ( !news.isEmpty() )
         {
             goodNews.append( news );
         }
     }
 
-    // First we umount all LVM logical volumes we can find
-    process.start( "lvscan", { "-a" } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )  //means LVM2 tools are installed
+    QList< QFuture< QStringList > > futures;
+    for ( const QStringList& group : groups )
     {
-        const QStringList lvscanLines = QString::fromLocal8Bit( process.readAllStandardOutput() ).split( '\n' );
-        for ( const QString& lvscanLine : lvscanLines )
-        {
-            QString lvPath = lvscanLine.simplified().split( ' ' ).value( 1 );  //second column
-            lvPath = lvPath.replace( '\'', "" );
-
-            QString news = tryUmount( lvPath );
-            if ( !news.isEmpty() )
-            {
-                goodNews.append( news );
-            }
-        }
+        futures.append( QtConcurrent::run( [this, &topology, group]() { return clearHolders( topology, group ); } ) );
     }
-    else
+    // Collect in order, so that the report does not depend on timing
+    for ( auto& f : futures )
     {
-        cWarning() << "this system does not seem to have LVM2 tools.";
+        goodNews.append( f.result() );
     }
 
-    // Then we go looking for volume groups that use this device for physical volumes
-    process.start( "pvdisplay", { "-C", "--noheadings" } );
-    process.waitForFinished();
-    if ( process.exitCode() == 0 )  //means LVM2 tools are installed
+    // Now clear swap partitions just in case they contain something
+    // resumable from a previous suspend-to-disk.
+    auto* metadata = CalamaresUtils::Partition::MetadataCache::instance();
+    for ( const QString& p : partitionsList )
     {
-        QString pvdisplayOutput = process.readAllStandardOutput();
-        if ( !pvdisplayOutput.simplified().isEmpty() )  //means there is at least one LVM PV
+        const QString partPath = topology.device( p ).devicePath;
+        const QString type = metadata->type( partPath );
+        // Without cached metadata, fall back to what's in /proc/swaps
+        if ( type == QStringLiteral( "swap" ) || ( type.isEmpty() && topology.device( p ).isSwap ) )
         {
-            QSet< QString > vgSet;
-
-            const QStringList pvdisplayLines = pvdisplayOutput.split( '\n' );
-            for ( const QString& pvdisplayLine : pvdisplayLines )
-            {
-                QString pvPath = pvdisplayLine.simplified().split( ' ' ).value( 0 );
-                QString vgName = pvdisplayLine.simplified().split( ' ' ).value( 1 );
-                if ( !pvPath.contains( deviceName ) )
-                {
-                    continue;
-                }
-
-                vgSet.insert( vgName );
-            }
-
-            foreach ( const QString& vgName, vgSet )
+            QString news = tryClearSwap( partPath );
+            if ( !news.isEmpty() )
             {
-                process.start( "vgchange", { "-an", vgName } );
-                process.waitForFinished();
-                if ( process.exitCode() == 0 )
-                {
-                    goodNews.append( QString( "Successfully disabled volume group %1." ).arg( vgName ) );
-                }
+                goodNews.append( news );
             }
         }
     }
-    else
-    {
-        cWarning() << "this system does not seem to have LVM2 tools.";
-    }
 
-    const QStringList cryptoDevices2 = getCryptoDevices();
-    for ( const QString& mapperPath : cryptoDevices2 )
-    {
-        tryUmount( mapperPath );
-        QString news = tryCryptoClose( mapperPath );
+    Calamares::JobResult ok = Calamares::JobResult::ok();
+    ok.setMessage( tr( "Cleared all mounts for %1" ).arg( m_device->deviceNode() ) );
+    ok.setDetails( goodNews.join( "\n" ) );
+
+    cDebug() << "ClearMountsJob finished. Here's what was done:\n" << goodNews.join( "\n" );
+
+    return ok;
+}
+
+
+QStringList
+ClearMountsJob::clearHolders( const BlockTopology& topology, const QStringList& group ) const
+{
+    QStringList goodNews;
+    auto append = [&goodNews]( const QString& news ) {
         if ( !news.isEmpty() )
         {
             goodNews.append( news );
         }
-    }
+    };
 
-    for ( const QString& p : partitionsList )
-    {
-        QString partPath = QString( "/dev/%1" ).arg( p );
-
-        QString news = tryUmount( partPath );
-        if ( !news.isEmpty() )
+    // Volume groups are deactivated as a whole, once all of
+    // the logical volumes (which come first in the group) are unmounted.
+    QStringList volumeGroups;
+    auto deactivateVolumeGroups = [&]() {
+        for ( const QString& vgName : volumeGroups )
         {
-            goodNews.append( news );
+            append( tryDeactivateVolumeGroup( vgName ) );
         }
-    }
+        volumeGroups.clear();
+    };
 
-    foreach ( QString p, swapPartitions )
+    for ( const QString& name : group )
     {
-        QString news = tryClearSwap( p );
-        if ( !news.isEmpty() )
+        const auto device = topology.device( name );
+        if ( isLiveDevice( device ) )
         {
-            goodNews.append( news );
+            continue;
+        }
+        if ( !device.isLVM() )
+        {
+            deactivateVolumeGroups();
         }
-    }
 
-    Calamares::JobResult ok = Calamares::JobResult::ok();
-    ok.setMessage( tr( "Cleared all mounts for %1" ).arg( m_device->deviceNode() ) );
-    ok.setDetails( goodNews.join( "\n" ) );
+        if ( device.isSwap )
+        {
+            append( trySwapOff( device.devicePath ) );
+        }
 
-    cDebug() << "ClearMountsJob finished. Here's what was done:\n" << goodNews.join( "\n" );
+        if ( device.isCrypt() )
+        {
+            append( tryCryptoClose( device.devicePath ) );
+        }
+        else if ( device.isLVM() )
+        {
+            const QString vgName = CalamaresUtils::Partition::lvmVolumeGroupName( device.dmName );
+            if ( !vgName.isEmpty() && !volumeGroups.contains( vgName ) )
+            {
+                volumeGroups.append( vgName );
+            }
+        }
+    }
+    deactivateVolumeGroups();
 
-    return ok;
+    return goodNews;
 }
 
 
 QString
-ClearMountsJob::tryUmount( const QString& partPath )
+ClearMountsJob::tryUmount( const QString& path ) const
 {
     QProcess process;
-    process.start( "umount", { partPath } );
+    process.start( "umount", { path } );
     process.waitForFinished();
     if ( process.exitCode() == 0 )
     {
-        return QString( "Successfully unmounted %1." ).arg( partPath );
+        return QString( "Successfully unmounted %1." ).arg( path );
     }
 
+    return QString();
+}
+
+
+QString
+ClearMountsJob::trySwapOff( const QString& partPath ) const
+{
+    QProcess process;
     process.start( "swapoff", { partPath } );
     process.waitForFinished();
     if ( process.exitCode() == 0 )
@@ -253,13 +239,41 @@ ClearMountsJob::tryUmount( const QString& partPath )
 
 
 QString
-ClearMountsJob::tryClearSwap( const QString& partPath )
+ClearMountsJob::tryDeactivateVolumeGroup( const QString& vgName ) const
 {
     QProcess process;
-    process.start( "blkid", { "-s", "UUID", "-o", "value", partPath } );
+    process.start( "vgchange", { "-an", vgName } );
     process.waitForFinished();
-    QString swapPartUuid = QString::fromLocal8Bit( process.readAllStandardOutput() ).simplified();
-    if ( process.exitCode() != 0 || swapPartUuid.isEmpty() )
+    if ( process.exitCode() == 0 )
+    {
+        return QString( "Successfully disabled volume group %1." ).arg( vgName );
+    }
+
+    return QString();
+}
+
+
+QString
+ClearMountsJob::tryClearSwap( const QString& partPath ) const
+{
+    QProcess process;
+    QString swapPartUuid;
+    auto* cache = CalamaresUtils::Partition::MetadataCache::instance();
+    if ( cache->contains( partPath ) )
+    {
+        swapPartUuid = cache->uuid( partPath );
+    }
+    else
+    {
+        process.start( "blkid", { "-s", "UUID", "-o", "value", partPath } );
+        process.waitForFinished();
+        swapPartUuid = QString::fromLocal8Bit( process.readAllStandardOutput() ).simplified();
+        if ( process.exitCode() != 0 )
+        {
+            return QString();
+        }
+    }
+    if ( swapPartUuid.isEmpty() )
     {
         return QString();
     }
@@ -276,7 +290,7 @@ ClearMountsJob::tryClearSwap( const QString& partPath )
 
 
 QString
-ClearMountsJob::tryCryptoClose( const QString& mapperPath )
+ClearMountsJob::tryCryptoClose( const QString& mapperPath ) const
 {
     QProcess process;
     process.start( "cryptsetup", { "close", mapperPath } );
@@ -288,26 +302,3 @@ ClearMountsJob::tryCryptoClose( const QString& mapperPath )
 
     return QString();
 }
-
-
-QStringList
-ClearMountsJob::getCryptoDevices() const
-{
-    QDir mapperDir( "/dev/mapper" );
-    const QFileInfoList fiList = mapperDir.entryInfoList( QDir::Files );
-    QStringList list;
-    QProcess process;
-    for ( const QFileInfo& fi : fiList )
-    {
-        QString baseName = fi.baseName();
-        // Fedora live images use /dev/mapper/live-* internally. We must not
-        // unmount those devices, because they are used by the live image and
-        // because we need /dev/mapper/live-base in the unpackfs module.
-        if ( baseName == "control" || baseName.startsWith( "live-" ) )
-        {
-            continue;
-        }
-        list.append( fi.absoluteFilePath() );
-    }
-    return list;
-}
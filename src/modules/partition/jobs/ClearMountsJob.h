@@ -12,6 +12,14 @@
 
 #include "Job.h"
 
+namespace CalamaresUtils
+{
+namespace Partition
+{
+class BlockTopology;
+}  // namespace Partition
+}  // namespace CalamaresUtils
+
 class Device;
 
 /**
@@ -28,10 +36,21 @@ public:
     Calamares::JobResult exec() override;
 
 private:
-    QString tryUmount( const QString& partPath );
-    QString tryClearSwap( const QString& partPath );
-    QString tryCryptoClose( const QString& mapperPath );
-    QStringList getCryptoDevices() const;
+    /** @brief Takes down one group of stacked devices
+     *
+     * The @p group is ordered from the top of the stack down,
+     * as from BlockTopology::holderGroups(). Returns the good news.
+     * The devices must already be unmounted, since mounts may be
+     * nested across groups; the groups can then be cleared concurrently.
+     */
+    QStringList clearHolders( const CalamaresUtils::Partition::BlockTopology& topology,
+                              const QStringList& group ) const;
+
+    QString tryUmount( const QString& path ) const;
+    QString trySwapOff( const QString& partPath ) const;
+    QString tryClearSwap( const QString& partPath ) const;
+    QString tryCryptoClose( const QString& mapperPath ) const;
+    QString tryDeactivateVolumeGroup( const QString& vgName ) const;
     Device* m_device;
 };
 
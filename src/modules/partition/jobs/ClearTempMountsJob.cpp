@@ -96,3 +96,9 @@ ClearTempMountsJob::exec()
 
     return ok;
 }
+
+bool
+ClearTempMountsJob::isRerunSafe() const
+{
+    return true;
+}
@@ -26,6 +26,8 @@ public:
     QString prettyName() const override;
     QString prettyStatusMessage() const override;
     Calamares::JobResult exec() override;
+    /// @brief Only undoes mounts that the mount module redoes
+    bool isRerunSafe() const override;
 };
 
 #endif  // CLEARTEMPMOUNTSJOB_H
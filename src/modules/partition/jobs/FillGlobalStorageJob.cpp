@@ -18,8 +18,10 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "partition/FileSystem.h"
+#include "partition/Metadata.h"
 #include "partition/PartitionIterator.h"
 #include "utils/Logger.h"
+#include "utils/Variant.h"
 
 #include <kpmcore/core/device.h>
 #include <kpmcore/core/partition.h>
@@ -31,12 +33,43 @@
 #include <QFileInfo>
 #include <QProcess>
 
+using CalamaresUtils::Partition::MetadataCache;
 using CalamaresUtils::Partition::PartitionIterator;
 using CalamaresUtils::Partition::untranslatedFS;
 using CalamaresUtils::Partition::userVisibleFS;
 
 typedef QHash< QString, QString > UuidForPartitionHash;
 
+/** @brief Filesystem UUID of partition @p p
+ *
+ * The UUIDs come from the (single-probe) metadata cache; only
+ * when the cache knows nothing about the device do we fall back to
+ * asking KPMcore, which runs one process per partition.
+ *
+ * For an open LUKS container, KPMcore reports the UUID of the
+ * inner filesystem, so look up the mapper device instead.
+ */
+static QString
+readPartitionUuid( Partition* p )
+{
+    QString path = p->partitionPath();
+    if ( p->fileSystem().type() == FileSystem::Luks )
+    {
+        const FS::luks* luksFs = dynamic_cast< const FS::luks* >( &p->fileSystem() );
+        if ( luksFs && luksFs->innerFS() && !luksFs->mapperName().isEmpty() )
+        {
+            path = luksFs->mapperName();
+        }
+    }
+
+    auto* cache = MetadataCache::instance();
+    if ( cache->contains( path ) )
+    {
+        return cache->uuid( path );
+    }
+    return p->fileSystem().readUUID( p->partitionPath() );
+}
+
 static UuidForPartitionHash
 findPartitionUuids( QList< Device* > devices )
 {
@@ -46,9 +79,7 @@ findPartitionUuids( QList< Device* > devices )
         for ( auto it = PartitionIterator::begin( device ); it != PartitionIterator::end( device ); ++it )
         {
             Partition* p = *it;
-            QString path = p->partitionPath();
-            QString uuid = p->fileSystem().readUUID( p->partitionPath() );
-            hash.insert( path, uuid );
+            hash.insert( p->partitionPath(), readPartitionUuid( p ) );
         }
     }
 
@@ -63,6 +94,13 @@ findPartitionUuids( QList< Device* > devices )
 static QString
 getLuksUuid( const QString& path )
 {
+    // For a LUKS container, blkid reports the LUKS UUID
+    auto metadata = MetadataCache::instance()->metadata( path );
+    if ( metadata.isValid() && metadata.type.startsWith( QStringLiteral( "crypto_LUKS" ) ) )
+    {
+        return metadata.uuid;
+    }
+
     QProcess process;
     process.setProgram( "cryptsetup" );
     process.setArguments( { "luksUUID", path } );
@@ -326,6 +364,16 @@ Calamares::JobResult
 FillGlobalStorageJob::exec()
 {
     Calamares::GlobalStorage* storage = Calamares::JobQueue::instance()->globalStorage();
+    // When resuming, these are restored from the checkpoint journal (without secrets)
+    auto plan = [storage]() {
+        return CalamaresUtils::redactedMap(
+            { { "partitions", storage->value( "partitions" ) }, { "bootLoader", storage->value( "bootLoader" ) } } );
+    };
+    const bool hadPlan = storage->contains( "partitions" );
+    const QVariantMap previousPlan = plan();
+
+    // The partitioning jobs have run, so UUIDs may have changed: re-probe
+    MetadataCache::instance()->invalidate();
     const auto partitions = createPartitionList();
     cDebug() << "Saving partition information map to GlobalStorage[\"partitions\"]";
     storage->insert( "partitions", partitions );
@@ -346,9 +394,18 @@ FillGlobalStorageJob::exec()
         cDebug() << "FillGlobalStorageJob writing empty bootLoader value";
         storage->insert( "bootLoader", QVariant() );
     }
+
+    m_unchanged = hadPlan && plan() == previousPlan;
+    cDebug() << "Partition information" << ( m_unchanged ? "is unchanged." : "has changed." );
     return Calamares::JobResult::ok();
 }
 
+bool
+FillGlobalStorageJob::isRerunSafe() const
+{
+    return m_unchanged;
+}
+
 QVariantList
 FillGlobalStorageJob::createPartitionList() const
 {
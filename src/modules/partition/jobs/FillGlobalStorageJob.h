@@ -37,10 +37,13 @@ public:
     QString prettyDescription() const override;
     QString prettyStatusMessage() const override;
     Calamares::JobResult exec() override;
+    /// @brief Is the partition information the same as it was before (e.g. in the journal)?
+    bool isRerunSafe() const override;
 
 private:
     QList< Device* > m_devices;
     QString m_bootLoaderPath;
+    bool m_unchanged = false;
 
     QVariantList createPartitionList() const;
     QVariant createBootLoaderMap() const;
@@ -75,8 +75,11 @@ void AutoMountJobTests::testRunQueue()
 
     QCOMPARE( fail.count(), 0 );
     QCOMPARE( finish.count(), 1 );
-    // 5 progress: 0% and 100% for each *job* and then 100% overall
-    QCOMPARE( progress.count(), 5 );
+    // At most 5 progress: 0% and 100% for each *job* and then 100% overall,
+    // but the queue merges the ones that come in quickly after one another.
+    QVERIFY( progress.count() >= 1 );
+    QVERIFY( progress.count() <= 5 );
+    QCOMPARE( progress.last().first().toReal(), 1.0 );
 }
 
 
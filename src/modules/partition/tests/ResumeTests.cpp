@@ -0,0 +1,178 @@
+/* === This file is part of Calamares - <https://calamares.io> ===
+ *
+ *   SPDX-FileCopyrightText: 2026 Calamares contributors <https://calamares.io>
+ *   SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ *   Calamares is Free Software: see the License-Identifier above.
+ *
+ */
+
+#include "jobs/AutoMountManagementJob.h"
+#include "jobs/ClearTempMountsJob.h"
+#include "jobs/FillGlobalStorageJob.h"
+
+#include "GlobalStorage.h"
+#include "JobQueue.h"
+#include "modulesystem/InstanceKey.h"
+#include "utils/Logger.h"
+
+#include <QObject>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+/// @brief Stands in for the mount and unpackfs modules, and for destructive partition jobs
+class CountingJob : public Calamares::Job
+{
+    Q_OBJECT
+public:
+    CountingJob( const QString& name, bool fail )
+        : m_name( name )
+        , m_fail( fail )
+    {
+    }
+
+    QString prettyName() const override { return m_name; }
+    Calamares::JobResult exec() override
+    {
+        runs++;
+        return m_fail ? Calamares::JobResult::error( QStringLiteral( "Failed" ) ) : Calamares::JobResult::ok();
+    }
+
+    int runs = 0;
+
+private:
+    QString m_name;
+    bool m_fail;
+};
+
+class ResumeTests : public QObject
+{
+    Q_OBJECT
+public:
+    ResumeTests();
+
+private Q_SLOTS:
+    void testResumeUnchanged();
+};
+
+ResumeTests::ResumeTests()
+{
+    Logger::setupLogLevel( Logger::LOGDEBUG );
+}
+
+/** @brief The jobs of the partition module when nothing is changed
+ *
+ * This is what PartitionCoreModule::jobs() produces when no device
+ * is dirty, plus optional @p extra jobs that do change the disk.
+ */
+static Calamares::JobList
+partitionJobs( const Calamares::JobList& extra = Calamares::JobList() )
+{
+    Calamares::job_ptr automountControl( new AutoMountManagementJob( true ) );
+    Calamares::JobList l { automountControl, Calamares::job_ptr( new ClearTempMountsJob() ) };
+    l << extra;
+    l << Calamares::job_ptr( new FillGlobalStorageJob( nullptr, {}, QString() ) ) << automountControl;
+    return l;
+}
+
+static void
+runQueue( Calamares::JobQueue& q )
+{
+    QEventLoop loop;
+    QObject::connect( &q, &Calamares::JobQueue::finished, &loop, &QEventLoop::quit );
+    QTimer::singleShot( std::chrono::milliseconds( 5000 ), &loop, &QEventLoop::quit );
+    q.start();
+    loop.exec();
+    QVERIFY( !q.isRunning() );
+}
+
+void
+ResumeTests::testResumeUnchanged()
+{
+    using Calamares::ModuleSystem::InstanceKey;
+    using Resume = Calamares::JobQueue::Resume;
+
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+    const QString journal = dir.filePath( "checkpoint.jsonl" );
+
+    // The module.desc of each: partition is neither idempotent nor rerunnable
+    const InstanceKey partitionKey( "partition", "partition" );
+    const InstanceKey mountKey( "mount", "mount" );
+    const InstanceKey unpackKey( "unpackfs", "unpackfs" );
+    const InstanceKey bootKey( "bootloader", "bootloader" );
+
+    // A first run, which fails after unpacking
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( journal, false );
+        auto* unpack = new CountingJob( "unpack", false );
+        q.enqueue( 1, partitionJobs(), {}, partitionKey, Resume::Rerun );
+        q.enqueue( 1, { Calamares::job_ptr( new CountingJob( "mount", false ) ) }, {}, mountKey, Resume::RerunSafely );
+        q.enqueue( 1, { Calamares::job_ptr( unpack ) }, {}, unpackKey, Resume::Skip );
+        q.enqueue( 1, { Calamares::job_ptr( new CountingJob( "boot", true ) ) }, {}, bootKey, Resume::Rerun );
+
+        QSignalSpy spy_failed( &q, &Calamares::JobQueue::failed );
+        runQueue( q );
+        QCOMPARE( spy_failed.count(), 1 );
+        QCOMPARE( unpack->runs, 1 );
+    }
+
+    // Resume with the same (empty) partitioning plan: partition and
+    // mount run again, but unpackfs is skipped.
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( journal, true );
+        auto* mount = new CountingJob( "mount", false );
+        auto* unpack = new CountingJob( "unpack", false );
+        auto* boot = new CountingJob( "boot", true );
+        q.enqueue( 1, partitionJobs(), {}, partitionKey, Resume::Rerun );
+        q.enqueue( 1, { Calamares::job_ptr( mount ) }, {}, mountKey, Resume::RerunSafely );
+        q.enqueue( 1, { Calamares::job_ptr( unpack ) }, {}, unpackKey, Resume::Skip );
+        q.enqueue( 1, { Calamares::job_ptr( boot ) }, {}, bootKey, Resume::Rerun );
+
+        runQueue( q );
+        QCOMPARE( mount->runs, 1 );
+        QCOMPARE( unpack->runs, 0 );
+        QCOMPARE( boot->runs, 1 );
+    }
+
+    // Resume where the partition module changes the disk (e.g. formats):
+    // unpackfs runs again. This fails again, to keep the journal.
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( journal, true );
+        auto* format = new CountingJob( "format", false );
+        auto* unpack = new CountingJob( "unpack", false );
+        q.enqueue( 1, partitionJobs( { Calamares::job_ptr( format ) } ), {}, partitionKey, Resume::Rerun );
+        q.enqueue( 1, { Calamares::job_ptr( new CountingJob( "mount", false ) ) }, {}, mountKey, Resume::RerunSafely );
+        q.enqueue( 1, { Calamares::job_ptr( unpack ) }, {}, unpackKey, Resume::Skip );
+        q.enqueue( 1, { Calamares::job_ptr( new CountingJob( "boot", true ) ) }, {}, bootKey, Resume::Rerun );
+
+        runQueue( q );
+        QCOMPARE( format->runs, 1 );
+        QCOMPARE( unpack->runs, 1 );
+    }
+
+    // Resume where the partition information that the partition module
+    // records differs from what was there before, without changing the
+    // disk (e.g. another existing partition is used): unpackfs runs again.
+    {
+        Calamares::JobQueue q;
+        q.setCheckpoint( journal, true );
+        auto* unpack = new CountingJob( "unpack", false );
+        q.enqueue( 1, partitionJobs(), {}, partitionKey, Resume::Rerun );
+        q.enqueue( 1, { Calamares::job_ptr( new CountingJob( "mount", false ) ) }, {}, mountKey, Resume::RerunSafely );
+        q.enqueue( 1, { Calamares::job_ptr( unpack ) }, {}, unpackKey, Resume::Skip );
+        q.globalStorage()->insert( "partitions", QVariantList { QVariantMap { { "device", "/dev/sdb1" } } } );
+
+        runQueue( q );
+        QCOMPARE( unpack->runs, 1 );
+    }
+}
+
+QTEST_GUILESS_MAIN( ResumeTests )
+
+#include "utils/moc-warnings.h"
+
+#include "ResumeTests.moc"
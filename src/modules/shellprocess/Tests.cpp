@@ -199,3 +199,53 @@ script:
     gs->insert( "username", "`id -u`" );
     QVERIFY( bool( CommandList( userScript, false, 10s ).run() ) );
 }
+
+void
+ShellProcessTests::testProcessListParallel()
+{
+    YAML::Node doc = YAML::Load( R"(---
+script:
+    - "ls /tmp"
+    - parallel:
+        - "true"
+        - command: "sleep 1"
+          timeout: 3
+        - "true"
+      workers: 2
+    - parallel:
+        - "-false"
+        - "true"
+    - "ls /tmp"
+)" );
+    CommandList cl( CalamaresUtils::yamlMapToVariant( doc ).value( "script" ) );
+    QCOMPARE( cl.count(), 6 );  // One duplicate dropped
+    QCOMPARE( cl.at( 0 ).parallelGroup(), 0 );
+    QCOMPARE( cl.at( 1 ).parallelGroup(), 1 );
+    QCOMPARE( cl.at( 2 ).parallelGroup(), 1 );
+    QCOMPARE( cl.at( 2 ).timeout(), 3s );
+    QCOMPARE( cl.at( 3 ).parallelGroup(), 2 );
+    QCOMPARE( cl.at( 4 ).parallelGroup(), 2 );
+    QCOMPARE( cl.at( 5 ).parallelGroup(), 0 );
+    QCOMPARE( cl.parallelWorkers( 0 ), 1 );
+    QCOMPARE( cl.parallelWorkers( 1 ), 2 );
+    QCOMPARE( cl.parallelWorkers( 2 ), 4 );
+
+    if ( !Calamares::JobQueue::instance() )
+        (void)new Calamares::JobQueue( nullptr );
+    if ( !Calamares::Settings::instance() )
+        (void)Calamares::Settings::init( QString() );
+
+    QVERIFY( bool( CommandList( CalamaresUtils::yamlMapToVariant( doc ).value( "script" ), false, 10s ).run() ) );
+
+    // The first failure in list order is reported, even though the
+    // quick failure finishes long before the slow one.
+    doc = YAML::Load( R"(---
+script:
+    - parallel:
+        - "sleep 1 ; exit 3"
+        - "exit 4"
+)" );
+    auto r = CommandList( CalamaresUtils::yamlMapToVariant( doc ).value( "script" ), false, 10s ).run();
+    QVERIFY( !bool( r ) );
+    QVERIFY( r.details().contains( "sleep 1" ) );
+}
@@ -33,6 +33,8 @@ private Q_SLOTS:
     void testProcessListFromObject();
     // Check @@ROOT@@ substitution
     void testRootSubstitution();
+    // Parallel groups in a list
+    void testProcessListParallel();
 };
 
 #endif
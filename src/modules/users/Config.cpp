@@ -858,6 +858,13 @@ Config::setConfigurationMap( const QVariantMap& configurationMap )
 
     m_reuseUserPasswordForRoot = CalamaresUtils::getBool( configurationMap, "doReusePassword", false );
 
+#ifdef __FreeBSD__
+    // The pw(8) tool also maintains the password databases, so always use it
+    m_nativeAccounts = false;
+#else
+    m_nativeAccounts = CalamaresUtils::getBool( configurationMap, "nativeAccounts", false );
+#endif
+
     m_permitWeakPasswords = CalamaresUtils::getBool( configurationMap, "allowWeakPasswords", false );
     m_requireStrongPasswords
         = !m_permitWeakPasswords || !CalamaresUtils::getBool( configurationMap, "allowWeakPasswordsDefault", false );
@@ -914,10 +921,10 @@ Config::createJobs() const
     j = new CreateUserJob( this );
     jobs.append( Calamares::job_ptr( j ) );
 
-    j = new SetPasswordJob( loginName(), userPassword() );
+    j = new SetPasswordJob( loginName(), userPassword(), nativeAccounts() );
     jobs.append( Calamares::job_ptr( j ) );
 
-    j = new SetPasswordJob( "root", rootPassword() );
+    j = new SetPasswordJob( "root", rootPassword(), nativeAccounts() );
     jobs.append( Calamares::job_ptr( j ) );
 
     j = new SetHostNameJob( hostName(), hostNameActions() );
@@ -209,6 +209,8 @@ public:
     bool writeRootPassword() const { return m_writeRootPassword; }
     /// Should the user's password be used for root, too? (if root is written at all)
     bool reuseUserPasswordForRoot() const { return m_reuseUserPasswordForRoot; }
+    /// Edit passwd, group and shadow directly, rather than running useradd and friends?
+    bool nativeAccounts() const { return m_nativeAccounts; }
     /// Show UI to change the "require strong password" setting?
     bool permitWeakPasswords() const { return m_permitWeakPasswords; }
     /// Current setting for "require strong password"?
@@ -321,6 +323,8 @@ private:
     bool m_writeRootPassword = true;
     bool m_reuseUserPasswordForRoot = false;
 
+    bool m_nativeAccounts = false;
+
     bool m_permitWeakPasswords = false;
     bool m_requireStrongPasswords = true;
 
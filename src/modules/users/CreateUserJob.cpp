@@ -11,6 +11,7 @@
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
+#include "utils/Accounts.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
 #include "utils/Permissions.h"
@@ -22,6 +23,8 @@
 #include <QProcess>
 #include <QTextStream>
 
+#include <unistd.h>
+
 
 CreateUserJob::CreateUserJob( const Config* config )
     : Calamares::Job()
@@ -106,6 +109,112 @@ setUserGroups( const QString& loginName, const QStringList& groups )
     return Calamares::JobResult::ok();
 }
 
+/** @brief Copies the skeleton directory @p from to @p to, like `useradd -m`
+ *
+ * Modes are preserved, symbolic links are copied as links.
+ */
+static bool
+copySkeleton( const QString& from, const QString& to )
+{
+    bool ok = true;
+    const QFileInfoList entries
+        = QDir( from ).entryInfoList( QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot );
+    for ( const QFileInfo& fi : entries )
+    {
+        const QString target = to + '/' + fi.fileName();
+        if ( fi.isSymLink() )
+        {
+            // QFileInfo resolves the link in the host, so read it directly
+            QByteArray link( 4096, 0 );
+            ssize_t n = readlink( QFile::encodeName( fi.filePath() ).constData(), link.data(), size_t( link.size() ) );
+            ok = n > 0 && n < link.size()
+                && symlink( link.left( int( n ) ).constData(), QFile::encodeName( target ).constData() ) == 0 && ok;
+        }
+        else if ( fi.isDir() )
+        {
+            ok = QDir().mkdir( target ) && QFile::setPermissions( target, fi.permissions() )
+                && copySkeleton( fi.filePath(), target ) && ok;
+        }
+        else
+        {
+            ok = QFile::copy( fi.filePath(), target ) && ok;
+        }
+    }
+    return ok;
+}
+
+/** @brief Creates the home directory for a new user, natively
+ *
+ * Does nothing if the directory already exists (e.g. when re-using
+ * an existing /home), otherwise creates it and fills it from
+ * /etc/skel. Then the ownership of the whole directory is set.
+ */
+static Calamares::JobResult
+createHomeDirectory( const CalamaresUtils::AccountDatabase& db, const QString& loginName, const QString& home )
+{
+    const QString targetHome = db.root() + home;
+    if ( !QFileInfo::exists( targetHome ) )
+    {
+        // Like useradd, use HOME_MODE, or else the mode from UMASK
+        const int mode = db.loginDefinition( QStringLiteral( "HOME_MODE" ),
+                                             0777 & ~db.loginDefinition( QStringLiteral( "UMASK" ), 022 ) );
+        if ( !QDir().mkpath( targetHome ) || !CalamaresUtils::Permissions::apply( targetHome, mode ) )
+        {
+            return Calamares::JobResult::error( CreateUserJob::tr( "Cannot create home directory %1." ).arg( home ) );
+        }
+        if ( !copySkeleton( db.root() + QStringLiteral( "/etc/skel" ), targetHome ) )
+        {
+            cWarning() << "Could not copy all of /etc/skel to" << home;
+        }
+    }
+    else
+    {
+        cDebug() << "Home directory" << home << "already exists, not copying /etc/skel.";
+    }
+
+    if ( !CalamaresUtils::Permissions::applyOwnerRecursively(
+             targetHome, db.userId( loginName ), db.groupId( loginName ) ) )
+    {
+        return Calamares::JobResult::error(
+            CreateUserJob::tr( "Cannot set the owner of home directory %1." ).arg( home ) );
+    }
+    return Calamares::JobResult::ok();
+}
+
+Calamares::JobResult
+CreateUserJob::execNative( const QString& rootMountPoint )
+{
+    const QString loginName = m_config->loginName();
+    const QString home = QStringLiteral( "/home/" ) + loginName;
+
+    m_status = tr( "Creating user %1" ).arg( loginName );
+    emit progress( 0.5 );
+    CalamaresUtils::AccountDatabase db( rootMountPoint );
+    if ( !db.load() )
+    {
+        return Calamares::JobResult::error( tr( "Cannot open the user database." ) );
+    }
+    if ( db.addUser( loginName, m_config->fullName(), home, m_config->userShell() ) < 0 )
+    {
+        return Calamares::JobResult::error( tr( "Cannot create user %1." ).arg( loginName ) );
+    }
+
+    m_status = tr( "Configuring user %1" ).arg( loginName );
+    emit progress( 0.8 );
+    if ( !db.addUserToGroups( loginName, m_config->groupsForThisUser() ) )
+    {
+        return Calamares::JobResult::error( tr( "Cannot add user %1 to groups: %2." )
+                                                .arg( loginName, m_config->groupsForThisUser().join( ',' ) ) );
+    }
+    if ( !db.save() )
+    {
+        return Calamares::JobResult::error( tr( "Cannot create user %1." ).arg( loginName ) );
+    }
+
+    m_status = tr( "Setting file permissions" );
+    emit progress( 0.9 );
+    return createHomeDirectory( db, loginName, home );
+}
 
 Calamares::JobResult
 CreateUserJob::exec()
@@ -139,6 +248,10 @@ CreateUserJob::exec()
     }
 
     cDebug() << "[CREATEUSER]: creating user";
+    if ( m_config->nativeAccounts() )
+    {
+        return execNative( destDir.absolutePath() );
+    }
 
     m_status = tr( "Creating user %1" ).arg( m_config->loginName() );
     emit progress( 0.5 );
@@ -25,6 +25,9 @@ public:
     Calamares::JobResult exec() override;
 
 private:
+    /// @brief Creates the user by editing the account files directly
+    Calamares::JobResult execNative( const QString& rootMountPoint );
+
     const Config* m_config;
     QString m_status;
 };
@@ -14,6 +14,7 @@
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
+#include "utils/Accounts.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Logger.h"
 #include "utils/Permissions.h"
@@ -22,6 +23,8 @@
 #include <QFile>
 #include <QFileInfo>
 
+#include <memory>
+
 SetupSudoJob::SetupSudoJob( const QString& group )
     : m_sudoGroup( group )
 {
@@ -106,12 +109,14 @@ groupsInTargetSystem()
  * Given a list of groups that already exist, @p availableGroups,
  * go through the @p wantedGroups and create each of them. Groups that
  * fail, or which should have already been there, are added to
- * @p missingGroups by name.
+ * @p missingGroups by name. If @p db is not null, the groups are
+ * added to that database, rather than by running groupadd.
  */
 static bool
 ensureGroupsExistInTarget( const QList< GroupDescription >& wantedGroups,
                            const QStringList& availableGroups,
-                           QStringList& missingGroups )
+                           QStringList& missingGroups,
+                           CalamaresUtils::AccountDatabase* db = nullptr )
 {
     int failureCount = 0;
 
@@ -126,6 +131,16 @@ ensureGroupsExistInTarget( const QList< GroupDescription >& wantedGroups,
                 continue;
             }
 
+            if ( db )
+            {
+                if ( db->addGroup( group.name(), group.isSystemGroup() ) < 0 )
+                {
+                    failureCount++;
+                    missingGroups.append( group.name() + QChar( '*' ) );
+                }
+                continue;
+            }
+
             QStringList cmd;
 #ifdef __FreeBSD__
             if ( group.isSystemGroup() )
@@ -169,11 +184,40 @@ SetupGroupsJob::prettyName() const
 Calamares::JobResult
 SetupGroupsJob::exec()
 {
+    std::unique_ptr< CalamaresUtils::AccountDatabase > db;
+    if ( m_config->nativeAccounts() )
+    {
+        Calamares::GlobalStorage* gs = Calamares::JobQueue::instance()->globalStorage();
+        db = std::make_unique< CalamaresUtils::AccountDatabase >( gs->value( "rootMountPoint" ).toString() );
+        if ( !db->load() )
+        {
+            return Calamares::JobResult::error( tr( "Cannot open the user database." ) );
+        }
+    }
+
     const auto& defaultGroups = m_config->defaultGroups();
-    QStringList availableGroups = groupsInTargetSystem();
+    QStringList availableGroups = db ? db->groupNames() : groupsInTargetSystem();
     QStringList missingGroups;
 
-    if ( !ensureGroupsExistInTarget( defaultGroups, availableGroups, missingGroups ) )
+    // With the database, groups that could be created are saved even
+    // if others fail, just like when running groupadd for each.
+    bool created = ensureGroupsExistInTarget( defaultGroups, availableGroups, missingGroups, db.get() );
+    if ( created && missingGroups.isEmpty() && m_config->doAutoLogin() && !m_config->autoLoginGroup().isEmpty() )
+    {
+        // Failure to create the autologin group is not fatal
+        const QString autoLoginGroup = m_config->autoLoginGroup();
+        QStringList missingAutoLoginGroups;
+        (void)ensureGroupsExistInTarget( QList< GroupDescription >() << GroupDescription( autoLoginGroup ),
+                                         availableGroups,
+                                         missingAutoLoginGroups,
+                                         db.get() );
+    }
+    if ( db && !db->save() )
+    {
+        return Calamares::JobResult::error( tr( "Could not create groups in target system" ) );
+    }
+
+    if ( !created )
     {
         return Calamares::JobResult::error( tr( "Could not create groups in target system" ) );
     }
@@ -184,12 +228,5 @@ SetupGroupsJob::exec()
             tr( "These groups are missing in the target system: %1" ).arg( missingGroups.join( ',' ) ) );
     }
 
-    if ( m_config->doAutoLogin() && !m_config->autoLoginGroup().isEmpty() )
-    {
-        const QString autoLoginGroup = m_config->autoLoginGroup();
-        (void)ensureGroupsExistInTarget(
-            QList< GroupDescription >() << GroupDescription( autoLoginGroup ), availableGroups, missingGroups );
-    }
-
     return Calamares::JobResult::ok();
 }
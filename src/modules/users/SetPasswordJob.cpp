@@ -12,6 +12,7 @@
 
 #include "GlobalStorage.h"
 #include "JobQueue.h"
+#include "utils/Accounts.h"
 #include "utils/CalamaresUtilsSystem.h"
 #include "utils/Entropy.h"
 #include "utils/Logger.h"
@@ -26,10 +27,11 @@
 #include <unistd.h>
 
 
-SetPasswordJob::SetPasswordJob( const QString& userName, const QString& newPassword )
+SetPasswordJob::SetPasswordJob( const QString& userName, const QString& newPassword, bool native )
     : Calamares::Job()
     , m_userName( userName )
     , m_newPassword( newPassword )
+    , m_native( native )
 {
 }
 
@@ -81,6 +83,24 @@ SetPasswordJob::exec()
         return Calamares::JobResult::error( tr( "Bad destination system path." ),
                                             tr( "rootMountPoint is %1" ).arg( destDir.absolutePath() ) );
 
+    if ( m_native )
+    {
+        CalamaresUtils::AccountDatabase db( destDir.absolutePath() );
+        if ( !db.load() )
+        {
+            return Calamares::JobResult::error( tr( "Cannot open the user database." ) );
+        }
+        bool ok = ( m_userName == "root" && m_newPassword.isEmpty() )
+            ? db.disablePassword( m_userName )
+            : db.setPassword( m_userName,
+                              QString::fromLatin1( crypt( m_newPassword.toUtf8(), make_salt( 16 ).toUtf8() ) ) );
+        if ( !ok || !db.save() )
+        {
+            return Calamares::JobResult::error( tr( "Cannot set password for user %1." ).arg( m_userName ) );
+        }
+        return Calamares::JobResult::ok();
+    }
+
     if ( m_userName == "root" && m_newPassword.isEmpty() )  //special case for disabling root account
     {
         int ec = CalamaresUtils::System::instance()->targetEnvCall( { "passwd", "-dl", m_userName } );
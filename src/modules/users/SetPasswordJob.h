@@ -18,7 +18,12 @@ class SetPasswordJob : public Calamares::Job
 {
     Q_OBJECT
 public:
-    SetPasswordJob( const QString& userName, const QString& newPassword );
+    /** @brief Job to set the password of @p userName
+     *
+     * When @p native is true, the shadow file is edited directly;
+     * otherwise usermod and passwd are used in the target system.
+     */
+    SetPasswordJob( const QString& userName, const QString& newPassword, bool native = false );
     QString prettyName() const override;
     QString prettyStatusMessage() const override;
     Calamares::JobResult exec() override;
@@ -28,6 +33,7 @@ public:
 private:
     QString m_userName;
     QString m_newPassword;
+    bool m_native;
 };
 
 #endif /* SETPASSWORDJOB_H */
@@ -377,6 +377,7 @@ UserTests::testAutoLogin()
 
     QCOMPARE( c.doAutoLogin(), autoLoginIsSet );
     QCOMPARE( c.autoLoginGroup(), autoLoginGroupName );
+    QVERIFY( !c.nativeAccounts() );  // Not set in any of the test configs
 }
 
 
@@ -13,7 +13,7 @@
 #include "GlobalStorage.h"
 #include "JobQueue.h"
 #include "Settings.h"
-#include "geoip/Handler.h"
+#include "geoip/Resolver.h"
 #include "locale/Global.h"
 #include "locale/Lookup.h"
 #include "modulesystem/ModuleManager.h"
@@ -307,22 +307,18 @@ setLanguageIcon( Config* c, const QVariantMap& configurationMap )
 }
 
 static inline void
-logGeoIPHandler( CalamaresUtils::GeoIP::Handler* handler )
+logGeoIPResolver( const CalamaresUtils::GeoIP::Resolver& resolver )
 {
-    if ( handler )
-    {
-        cDebug() << Logger::SubEntry << "Obtained from" << handler->url() << " ("
-                 << static_cast< int >( handler->type() ) << handler->selector() << ')';
-    }
+    cDebug() << Logger::SubEntry << "Obtained from" << resolver.urls();
 }
 
 static void
-setCountry( Config* config, const QString& countryCode, CalamaresUtils::GeoIP::Handler* handler )
+setCountry( Config* config, const QString& countryCode, const CalamaresUtils::GeoIP::Resolver& resolver )
 {
     if ( countryCode.length() != 2 )
     {
         cDebug() << "Unusable country code" << countryCode;
-        logGeoIPHandler( handler );
+        logGeoIPResolver( resolver );
         return;
     }
 
@@ -330,7 +326,7 @@ setCountry( Config* config, const QString& countryCode, CalamaresUtils::GeoIP::H
     if ( c_l.first == QLocale::Country::AnyCountry )
     {
         cDebug() << "Unusable country code" << countryCode;
-        logGeoIPHandler( handler );
+        logGeoIPResolver( resolver );
         return;
     }
     else
@@ -356,26 +352,19 @@ setGeoIP( Config* config, const QVariantMap& configurationMap )
     {
         using FWString = QFutureWatcher< QString >;
 
-        auto* handler = new CalamaresUtils::GeoIP::Handler( CalamaresUtils::getString( geoip, "style" ),
-                                                            CalamaresUtils::getString( geoip, "url" ),
-                                                            CalamaresUtils::getString( geoip, "selector" ) );
-        if ( handler->type() != CalamaresUtils::GeoIP::Handler::Type::None )
+        const CalamaresUtils::GeoIP::Resolver resolver( geoip );
+        if ( resolver.isValid() )
         {
             auto* future = new FWString();
-            QObject::connect( future, &FWString::finished, [config, future, handler]() {
+            QObject::connect( future, &FWString::finished, [config, future, resolver]() {
                 QString countryResult = future->future().result();
                 cDebug() << "GeoIP result for welcome=" << countryResult;
-                ::setCountry( config, countryResult, handler );
+                ::setCountry( config, countryResult, resolver );
                 future->deleteLater();
-                delete handler;
             } );
-            future->setFuture( handler->queryRaw() );
-        }
-        else
-        {
-            // Would not produce useful country code anyway.
-            delete handler;
+            future->setFuture( resolver.queryRaw() );
         }
+        // Otherwise, it would not produce a useful country code anyway.
     }
 }
 